@@ -0,0 +1,107 @@
+// AVLSetBulkLoad_Bench.cpp
+//
+// Times building an AVLSet from a sorted dump: fromSorted() against
+// calling add() for each element, followed by a full in-order scan of each
+// result, which shows the benefit of fromSorted()'s nodes being laid out
+// in sorted order.  Then it times building from shuffled input with
+// add() and with fromUnsorted() on increasing numbers of threads.
+//
+// Usage: AVLSetBulkLoad_Bench [elements] [max threads]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    double scanMs(const AVLSet<unsigned int>& s, unsigned long long& checksum)
+    {
+        auto start = std::chrono::steady_clock::now();
+        s.inorder([&checksum](const unsigned int& element) { checksum += element; });
+        return elapsedMs(start);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    unsigned int maxThreads = argc > 2 ? std::atoi(argv[2]) : 8;
+
+    std::vector<unsigned int> sorted;
+    sorted.reserve(elements);
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        sorted.push_back(i * 3);
+    }
+
+    unsigned long long checksum = 0;
+    std::printf("%u elements (%u hardware threads)\n", elements, std::thread::hardware_concurrency());
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        AVLSet<unsigned int> s;
+
+        for (unsigned int element : sorted)
+        {
+            s.add(element);
+        }
+
+        double buildMs = elapsedMs(start);
+        std::printf("  sorted, add():            %9.2f ms   scan %8.2f ms   height %d\n",
+            buildMs, scanMs(s, checksum), s.height());
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        AVLSet<unsigned int> s = AVLSet<unsigned int>::fromSorted(sorted.begin(), sorted.end());
+        double buildMs = elapsedMs(start);
+        std::printf("  sorted, fromSorted():     %9.2f ms   scan %8.2f ms   height %d\n",
+            buildMs, scanMs(s, checksum), s.height());
+    }
+
+    std::vector<unsigned int> shuffled;
+    shuffled.reserve(elements);
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        shuffled.push_back(static_cast<unsigned int>(mix64(i)));
+    }
+
+    {
+        auto start = std::chrono::steady_clock::now();
+        AVLSet<unsigned int> s;
+
+        for (unsigned int element : shuffled)
+        {
+            s.add(element);
+        }
+
+        double buildMs = elapsedMs(start);
+        std::printf("  shuffled, add():          %9.2f ms   scan %8.2f ms\n", buildMs, scanMs(s, checksum));
+    }
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+        AVLSet<unsigned int> s = AVLSet<unsigned int>::fromUnsorted(shuffled.begin(), shuffled.end(), threads);
+        double buildMs = elapsedMs(start);
+        std::printf("  shuffled, fromUnsorted(), %u threads: %9.2f ms   scan %8.2f ms\n",
+            threads, buildMs, scanMs(s, checksum));
+    }
+
+    std::printf("  (checksum %llu)\n", checksum);
+    return 0;
+}
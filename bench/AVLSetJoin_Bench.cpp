@@ -0,0 +1,137 @@
+// AVLSetJoin_Bench.cpp
+//
+// Times the join-based set operations on AVLSets.  First, uniting a large
+// set with sets from equal size down to a ten-thousandth of it, with
+// uniteWith() compared against adding the smaller set's elements one at
+// a time, which shows the O(m log(n / m + 1)) work bound at work.  Then,
+// for two large sets, uniteWith(), intersectWith(), and subtract() on
+// increasing numbers of threads, and adding an unsorted batch with
+// addBatch() compared against add().  Since the operations consume their
+// operands, each one is given fresh sets built with fromSorted(), so that
+// every run starts with the same memory layout; building isn't timed.
+//
+// Usage: AVLSetJoin_Bench [large set size] [max threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    // sortedElements() returns n random elements, sorted and distinct.
+    std::vector<unsigned int> sortedElements(unsigned int n, unsigned int salt)
+    {
+        std::vector<unsigned int> elements;
+        elements.reserve(n);
+
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            elements.push_back(static_cast<unsigned int>(mix64(i + salt)));
+        }
+
+        std::sort(elements.begin(), elements.end());
+        elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+        return elements;
+    }
+
+
+    template <typename Operation>
+    double timeOperation(const std::vector<unsigned int>& a, const std::vector<unsigned int>& b, Operation operation)
+    {
+        AVLSet<unsigned int> target = AVLSet<unsigned int>::fromSorted(a.begin(), a.end());
+        AVLSet<unsigned int> other = AVLSet<unsigned int>::fromSorted(b.begin(), b.end());
+
+        auto start = std::chrono::steady_clock::now();
+        operation(target, std::move(other));
+        return elapsedMs(start);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int largeSize = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    unsigned int maxThreads = argc > 2 ? std::atoi(argv[2]) : 8;
+
+    std::vector<unsigned int> large = sortedElements(largeSize, 0);
+
+    std::printf("uniting a set of %zu elements with a smaller one\n", large.size());
+    std::printf("  %-7s %14s %14s\n", "ratio", "add()", "uniteWith()");
+
+    for (unsigned int ratio : {1, 10, 100, 1000, 10000})
+    {
+        std::vector<unsigned int> small = sortedElements(largeSize / ratio, largeSize);
+
+        double addMs = timeOperation(large, small,
+            [](AVLSet<unsigned int>& target, AVLSet<unsigned int> other)
+            {
+                for (unsigned int element : other)
+                {
+                    target.add(element);
+                }
+            });
+
+        double uniteMs = timeOperation(large, small,
+            [](AVLSet<unsigned int>& target, AVLSet<unsigned int> other) { target.uniteWith(std::move(other)); });
+
+        std::printf("  1:%-5u %11.2f ms %11.2f ms\n", ratio, addMs, uniteMs);
+    }
+
+    std::vector<unsigned int> other = sortedElements(largeSize, largeSize / 2);
+
+    // The batch is the other set's elements, shuffled.
+    std::vector<unsigned int> batch = other;
+
+    for (std::size_t i = batch.size(); i > 1; --i)
+    {
+        std::swap(batch[i - 1], batch[mix64(i) % i]);
+    }
+
+    std::printf("two sets of %u elements, half shared (%u hardware threads)\n",
+        largeSize, std::thread::hardware_concurrency());
+    std::printf("  %-8s %14s %14s %14s %14s\n", "threads", "uniteWith()", "intersectWith()", "subtract()", "addBatch()");
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double uniteMs = timeOperation(large, other,
+            [threads](AVLSet<unsigned int>& target, AVLSet<unsigned int> o) { target.uniteWith(std::move(o), threads); });
+
+        double intersectMs = timeOperation(large, other,
+            [threads](AVLSet<unsigned int>& target, AVLSet<unsigned int> o) { target.intersectWith(std::move(o), threads); });
+
+        double subtractMs = timeOperation(large, other,
+            [threads](AVLSet<unsigned int>& target, AVLSet<unsigned int> o) { target.subtract(std::move(o), threads); });
+
+        AVLSet<unsigned int> target = AVLSet<unsigned int>::fromSorted(large.begin(), large.end());
+        auto start = std::chrono::steady_clock::now();
+        target.addBatch(batch.data(), batch.size(), threads);
+        double batchMs = elapsedMs(start);
+
+        std::printf("  %-8u %11.2f ms %12.2f ms %11.2f ms %11.2f ms\n",
+            threads, uniteMs, intersectMs, subtractMs, batchMs);
+    }
+
+    AVLSet<unsigned int> target = AVLSet<unsigned int>::fromSorted(large.begin(), large.end());
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int element : batch)
+    {
+        target.add(element);
+    }
+
+    std::printf("  add() each of the batch:  %11.2f ms   (%u elements)\n", elapsedMs(start), target.size());
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+// AVLSetOrderStatistics_Bench.cpp
+//
+// Times rank(), select(), and countInRange() on an AVLSet of scores
+// against what they cost without subtree sizes: walking through the
+// elements in order with inorder() and counting.  For the traversals,
+// only a sample of the queries is timed, since each one takes O(n) time.
+// It also times add(), so that the cost of keeping the sizes up to date
+// can be compared with the set's other work.
+//
+// Usage: AVLSetOrderStatistics_Bench [elements] [queries]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    unsigned int traversalRank(const AVLSet<unsigned int>& s, unsigned int x)
+    {
+        unsigned int below = 0;
+        s.inorder([&](const unsigned int& element) { below += element < x ? 1 : 0; });
+        return below;
+    }
+
+
+    unsigned int traversalSelect(const AVLSet<unsigned int>& s, unsigned int index)
+    {
+        unsigned int position = 0;
+        unsigned int selected = 0;
+
+        s.inorder(
+            [&](const unsigned int& element)
+            {
+                if (position++ == index)
+                {
+                    selected = element;
+                }
+            });
+
+        return selected;
+    }
+
+
+    unsigned int traversalCount(const AVLSet<unsigned int>& s, unsigned int lo, unsigned int hi)
+    {
+        unsigned int inRange = 0;
+        s.inorder([&](const unsigned int& element) { inRange += lo <= element && element <= hi ? 1 : 0; });
+        return inRange;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned int queries = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    unsigned int sampled = queries / 10000 > 0 ? queries / 10000 : 1;
+
+    std::vector<unsigned int> scores;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        scores.push_back(static_cast<unsigned int>(mix64(i)));
+    }
+
+    AVLSet<unsigned int> s;
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int score : scores)
+    {
+        s.add(score);
+    }
+
+    std::printf("%u elements, add: %.1f ns/element\n", s.size(), elapsedNs(start) / elements);
+    std::printf("  %-14s %14s %16s\n", "", "augmented", "traversal");
+
+    unsigned long long checksum = 0;
+
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < queries; ++i)
+    {
+        checksum += s.rank(scores[i % elements]);
+    }
+
+    double augmented = elapsedNs(start) / queries;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < sampled; ++i)
+    {
+        checksum += traversalRank(s, scores[i % elements]);
+    }
+
+    std::printf("  %-14s %11.1f ns %13.1f us\n", "rank", augmented, elapsedNs(start) / sampled / 1000.0);
+
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < queries; ++i)
+    {
+        checksum += s.select(static_cast<unsigned int>(mix64(i) % s.size()));
+    }
+
+    augmented = elapsedNs(start) / queries;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < sampled; ++i)
+    {
+        checksum += traversalSelect(s, static_cast<unsigned int>(mix64(i) % s.size()));
+    }
+
+    std::printf("  %-14s %11.1f ns %13.1f us\n", "select", augmented, elapsedNs(start) / sampled / 1000.0);
+
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < queries; ++i)
+    {
+        unsigned int lo = scores[i % elements];
+        checksum += s.countInRange(lo, lo + (1u << 24));
+    }
+
+    augmented = elapsedNs(start) / queries;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < sampled; ++i)
+    {
+        unsigned int lo = scores[i % elements];
+        checksum += traversalCount(s, lo, lo + (1u << 24));
+    }
+
+    std::printf("  %-14s %11.1f ns %13.1f us\n", "countInRange", augmented, elapsedNs(start) / sampled / 1000.0);
+    std::printf("  (checksum %llu)\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// AVLSetRange_Bench.cpp
+//
+// Times range scans over an AVLSet of timestamps: visiting every element
+// in a short window with range(), compared with the only way to do it
+// without iterators, which is walking the whole tree with inorder() and
+// skipping everything outside the window.  It also times a full walk with
+// iterators against one with inorder().
+//
+// Usage: AVLSetRange_Bench [elements] [window size] [scans]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "AVLSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    double elapsedUs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 4000000;
+    unsigned int window = argc > 2 ? std::atoi(argv[2]) : 300;
+    unsigned int scans = argc > 3 ? std::atoi(argv[3]) : 10000;
+    unsigned int sampled = scans / 1000 > 0 ? scans / 1000 : 1;
+
+    // Timestamps are spaced 10 apart on average, so a window of w
+    // elements spans about 10 * w time units.
+    AVLSet<unsigned long long> s;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        s.add(i * 10ULL + mix64(i) % 10);
+    }
+
+    unsigned long long span = window * 10ULL;
+    unsigned long long checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < scans; ++i)
+    {
+        unsigned long long lo = mix64(i) % (elements * 10ULL - span);
+
+        for (unsigned long long timestamp : s.range(lo, lo + span - 1))
+        {
+            checksum += timestamp;
+        }
+    }
+
+    double rangeUs = elapsedUs(start) / scans;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < sampled; ++i)
+    {
+        unsigned long long lo = mix64(i) % (elements * 10ULL - span);
+        unsigned long long hi = lo + span - 1;
+
+        s.inorder(
+            [&](const unsigned long long& timestamp)
+            {
+                if (lo <= timestamp && timestamp <= hi)
+                {
+                    checksum += timestamp;
+                }
+            });
+    }
+
+    double inorderUs = elapsedUs(start) / sampled;
+
+    std::printf("%u elements, windows of about %u elements\n", s.size(), window);
+    std::printf("  range():              %12.2f us/scan\n", rangeUs);
+    std::printf("  inorder() and filter: %12.2f us/scan\n", inorderUs);
+
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned long long timestamp : s)
+    {
+        checksum += timestamp;
+    }
+
+    double iteratorUs = elapsedUs(start);
+    start = std::chrono::steady_clock::now();
+    s.inorder([&](const unsigned long long& timestamp) { checksum += timestamp; });
+    inorderUs = elapsedUs(start);
+
+    std::printf("  full walk, iterators: %12.2f ms\n", iteratorUs / 1000.0);
+    std::printf("  full walk, inorder(): %12.2f ms\n", inorderUs / 1000.0);
+    std::printf("  (checksum %llu)\n", checksum);
+
+    return 0;
+}
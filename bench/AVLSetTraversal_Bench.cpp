@@ -0,0 +1,95 @@
+// AVLSetTraversal_Bench.cpp
+//
+// Times full in-order scans of a large AVLSet three ways: inorder() with
+// a std::function, inorder() with a lambda (which is inlined into the
+// templated version), and a range-based for loop over the set's
+// iterators.  Then it times a scan that stops early, at the first element
+// above a threshold.
+//
+// Usage: AVLSetTraversal_Bench [elements] [repetitions]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "AVLSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    unsigned int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    AVLSet<unsigned int> s;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        s.add(static_cast<unsigned int>(mix64(i)));
+    }
+
+    unsigned long long sum = 0;
+    std::function<void(const unsigned int&)> add = [&sum](const unsigned int& element) { sum += element; };
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int r = 0; r < repetitions; ++r)
+    {
+        s.inorder(add);
+    }
+
+    double functionMs = elapsedMs(start) / repetitions;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int r = 0; r < repetitions; ++r)
+    {
+        s.inorder([&sum](const unsigned int& element) { sum += element; });
+    }
+
+    double lambdaMs = elapsedMs(start) / repetitions;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int r = 0; r < repetitions; ++r)
+    {
+        for (unsigned int element : s)
+        {
+            sum += element;
+        }
+    }
+
+    double iteratorMs = elapsedMs(start) / repetitions;
+
+    std::printf("%u elements, full in-order scan\n", s.size());
+    std::printf("  inorder(std::function): %9.2f ms\n", functionMs);
+    std::printf("  inorder(lambda):        %9.2f ms\n", lambdaMs);
+    std::printf("  iterators:              %9.2f ms\n", iteratorMs);
+
+    unsigned int threshold = 1u << 28;
+    unsigned int visited = 0;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int r = 0; r < repetitions; ++r)
+    {
+        s.inorder(
+            [&](const unsigned int& element)
+            {
+                ++visited;
+                return element < threshold;
+            });
+    }
+
+    std::printf("  stop at first >= 2^28:  %9.2f ms   (%u visited per scan)\n",
+        elapsedMs(start) / repetitions, visited / repetitions);
+    std::printf("  (checksum %llu)\n", sum);
+
+    return 0;
+}
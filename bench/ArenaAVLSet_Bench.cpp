@@ -0,0 +1,154 @@
+// ArenaAVLSet_Bench.cpp
+//
+// Builds the same set of random 32-bit integers as an AVLSet and as an
+// ArenaAVLSet, and compares the memory each uses per element (counting
+// every byte they allocate), how long building takes, and how many
+// lookups per second each manages, both hits and misses.  Then it removes half the elements
+// and adds as many new ones, which the ArenaAVLSet does without growing.
+//
+// Usage: ArenaAVLSet_Bench [elements] [lookups]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "ArenaAVLSet.hpp"
+#include "AVLSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    std::size_t allocatedBytes = 0;
+}
+
+
+// Every allocation in the program is counted, so that the memory used by
+// a set can be measured as the difference before and after building it.
+// Each block records its own size just before the memory handed out, so
+// that it can be subtracted again when the block is freed.
+
+void* operator new(std::size_t size)
+{
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    if (void* p = std::malloc(size + HEADER))
+    {
+        allocatedBytes += size;
+        *static_cast<std::size_t*>(p) = size;
+        return static_cast<char*>(p) + HEADER;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void operator delete(void* p) noexcept
+{
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    if (p != nullptr)
+    {
+        void* block = static_cast<char*>(p) - HEADER;
+        allocatedBytes -= *static_cast<std::size_t*>(block);
+        std::free(block);
+    }
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+
+namespace
+{
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    template <typename SetType>
+    void run(const char* name, const std::vector<std::uint32_t>& elements, unsigned int lookups)
+    {
+        std::size_t before = allocatedBytes;
+        auto start = std::chrono::steady_clock::now();
+        SetType s;
+
+        for (std::uint32_t element : elements)
+        {
+            s.add(element);
+        }
+
+        double buildMs = elapsedMs(start);
+        double bytesPerElement = static_cast<double>(allocatedBytes - before) / s.size();
+
+        unsigned int found = 0;
+        start = std::chrono::steady_clock::now();
+
+        for (unsigned int i = 0; i < lookups; ++i)
+        {
+            found += s.contains(elements[mix64(i) % elements.size()]);
+        }
+
+        double hitsPerSecond = lookups / elapsedMs(start) * 1e3;
+        start = std::chrono::steady_clock::now();
+
+        for (unsigned int i = 0; i < lookups; ++i)
+        {
+            found += s.contains(static_cast<std::uint32_t>(mix64(i + elements.size())));
+        }
+
+        double missesPerSecond = lookups / elapsedMs(start) * 1e3;
+
+        std::printf("  %-12s %9.2f %10.2f ms %10.0f/s %10.0f/s   (%u found)\n",
+            name, bytesPerElement, buildMs, hitsPerSecond, missesPerSecond, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int count = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    unsigned int lookups = argc > 2 ? std::atoi(argv[2]) : 4000000;
+
+    std::vector<std::uint32_t> elements;
+    elements.reserve(count);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        elements.push_back(static_cast<std::uint32_t>(mix64(i)));
+    }
+
+    std::printf("%u random 32-bit elements, %u lookups\n", count, lookups);
+    std::printf("  %-12s %9s %13s %12s %12s\n", "", "bytes/elem", "build", "hits", "misses");
+
+    run<AVLSet<std::uint32_t>>("AVLSet", elements, lookups);
+    run<ArenaAVLSet<std::uint32_t>>("ArenaAVLSet", elements, lookups);
+
+    ArenaAVLSet<std::uint32_t> s;
+
+    for (std::uint32_t element : elements)
+    {
+        s.add(element);
+    }
+
+    std::size_t bytes = s.bytesUsed();
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < count; i += 2)
+    {
+        s.remove(elements[i]);
+        s.add(static_cast<std::uint32_t>(mix64(i + 2ULL * count)));
+    }
+
+    std::printf("  churning half the elements: %.2f ms, %zu bytes before, %zu after\n",
+        elapsedMs(start), bytes, s.bytesUsed());
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+// CompactHashSet_Bench.cpp
+//
+// Compares a CompactHashSet against a HashSet (and, for iteration, which
+// HashSet doesn't offer, std::unordered_set) at several sizes: memory per
+// element, time to iterate over every element, time to copy the whole set,
+// and time per lookup.
+//
+// Usage: CompactHashSet_Bench [largest size] [lookups]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_set>
+#include <vector>
+#include "CompactHashSet.hpp"
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    unsigned int identityHash(const unsigned int& element)
+    {
+        return element;
+    }
+
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    template <typename SetType>
+    double iterateNs(const SetType& set, unsigned int rounds, unsigned long long& sum)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int round = 0; round < rounds; ++round)
+        {
+            for (unsigned int element : set)
+            {
+                sum += element;
+            }
+        }
+
+        return elapsedNs(start) / rounds / set.size();
+    }
+
+
+    template <typename SetType>
+    double copyNs(const SetType& set, unsigned int rounds, unsigned long long& sum)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int round = 0; round < rounds; ++round)
+        {
+            SetType copy{set};
+            sum += copy.size();
+        }
+
+        return elapsedNs(start) / rounds;
+    }
+
+
+    template <typename SetType>
+    double lookupNs(const SetType& set, const std::vector<unsigned int>& probes, unsigned long long& sum)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int probe : probes)
+        {
+            sum += set.contains(probe) ? 1 : 0;
+        }
+
+        return elapsedNs(start) / probes.size();
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int largest = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned int lookups = argc > 2 ? std::atoi(argv[2]) : 10000000;
+
+    unsigned long long sum = 0;
+
+    std::printf("%9s | %-21s | %-21s | %-21s | %-21s\n",
+        "", "bytes/element", "iterate ns/element", "copy us", "lookup ns");
+    std::printf("%9s | %10s %10s | %10s %10s | %10s %10s | %10s %10s\n",
+        "elements", "HashSet", "compact", "unordered", "compact", "HashSet", "compact", "HashSet", "compact");
+
+    for (unsigned int elements = 10; elements <= largest; elements *= 10)
+    {
+        HashSet<unsigned int, FunctionHash<unsigned int>> hashSet{identityHash};
+        CompactHashSet<unsigned int, FunctionHash<unsigned int>> compact{identityHash};
+        std::unordered_set<unsigned int> unordered;
+        std::vector<unsigned int> probes;
+
+        for (unsigned int i = 0; i < elements; ++i)
+        {
+            unsigned int element = static_cast<unsigned int>(mix64(i));
+            hashSet.add(element);
+            compact.add(element);
+            unordered.insert(element);
+        }
+
+        for (unsigned int i = 0; i < lookups; ++i)
+        {
+            probes.push_back(static_cast<unsigned int>(mix64(i % (2 * elements))));
+        }
+
+        // Smaller sets get more rounds, so each measurement covers a
+        // similar amount of work.
+        unsigned int rounds = largest / elements * 10;
+
+        double hashSetBytes = hashSet.diagnostics().bytesPerValue;
+        double compactBytes = static_cast<double>(compact.sizeInBytes()) / compact.size();
+        double unorderedIterate = iterateNs(unordered, rounds, sum);
+        double compactIterate = iterateNs(compact, rounds, sum);
+        double hashSetCopy = copyNs(hashSet, rounds / 10 + 1, sum) / 1e3;
+        double compactCopy = copyNs(compact, rounds / 10 + 1, sum) / 1e3;
+        double hashSetLookup = lookupNs(hashSet, probes, sum);
+        double compactLookup = lookupNs(compact, probes, sum);
+
+        std::printf("%9u | %10.1f %10.1f | %10.2f %10.2f | %10.2f %10.2f | %10.1f %10.1f\n",
+            elements, hashSetBytes, compactBytes, unorderedIterate, compactIterate,
+            hashSetCopy, compactCopy, hashSetLookup, compactLookup);
+    }
+
+    std::printf("(checksum %llu)\n", sum);
+    return 0;
+}
@@ -0,0 +1,174 @@
+// ConcurrentHashSet_Bench.cpp
+//
+// Measures how the throughput of a shared set scales with the number of
+// threads, for a read-mostly (90% contains, 10% writes) and a write-heavy
+// (50/50) mix of operations.  Writes alternate between add() and remove(),
+// so the size of the set stays roughly constant.  The baseline is a
+// HashSet guarded by a single std::mutex, which is what the concurrent
+// set is meant to replace.
+//
+// Usage: ConcurrentHashSet_Bench [maxThreads] [elements] [opsPerThread]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ConcurrentHashSet.hpp"
+#include "HashSet.hpp"
+
+
+namespace
+{
+    unsigned int mixHash(const unsigned int& element)
+    {
+        unsigned int h = element * 0x9E3779B1u;
+        return h ^ (h >> 15);
+    }
+
+
+    class LockedHashSet
+    {
+    public:
+        LockedHashSet()
+            : set{mixHash}
+        {
+        }
+
+        void add(unsigned int element)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            set.add(element);
+        }
+
+        bool contains(unsigned int element)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            return set.contains(element);
+        }
+
+        void remove(unsigned int element)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            set.remove(element);
+        }
+
+    private:
+        std::mutex mutex;
+        HashSet<unsigned int, FunctionHash<unsigned int>> set;
+    };
+
+
+    class SharedConcurrentHashSet
+    {
+    public:
+        SharedConcurrentHashSet()
+            : set{mixHash}
+        {
+        }
+
+        void add(unsigned int element)
+        {
+            set.add(element);
+        }
+
+        bool contains(unsigned int element)
+        {
+            return set.contains(element);
+        }
+
+        void remove(unsigned int element)
+        {
+            set.remove(element);
+        }
+
+    private:
+        ConcurrentHashSet<unsigned int, FunctionHash<unsigned int>> set;
+    };
+
+
+    template <typename SharedSet>
+    double run(unsigned int threads, unsigned int elements, unsigned int opsPerThread, unsigned int readPercent)
+    {
+        SharedSet set;
+
+        for (unsigned int i = 0; i < elements; ++i)
+        {
+            set.add(i * 2);
+        }
+
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&set, t, elements, opsPerThread, readPercent]
+                {
+                    std::minstd_rand random{t + 1};
+                    unsigned int found = 0;
+
+                    for (unsigned int i = 0; i < opsPerThread; ++i)
+                    {
+                        unsigned int r = random();
+                        unsigned int element = r % (elements * 2);
+
+                        if (r % 100 < readPercent)
+                        {
+                            found += set.contains(element) ? 1 : 0;
+                        }
+                        else if (i % 2 == 0)
+                        {
+                            set.add(element);
+                        }
+                        else
+                        {
+                            set.remove(element);
+                        }
+                    }
+
+                    volatile unsigned int sink = found;
+                    (void)sink;
+                });
+        }
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return threads * static_cast<double>(opsPerThread) / seconds / 1e6;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : std::thread::hardware_concurrency();
+    unsigned int elements = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    unsigned int opsPerThread = argc > 3 ? std::atoi(argv[3]) : 1000000;
+
+    if (maxThreads == 0)
+    {
+        maxThreads = 1;
+    }
+
+    for (unsigned int readPercent : {90u, 50u})
+    {
+        std::printf("%u%% contains / %u%% writes (Mops/s)\n", readPercent, 100 - readPercent);
+        std::printf("%8s %20s %20s\n", "threads", "mutex + HashSet", "ConcurrentHashSet");
+
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            double locked = run<LockedHashSet>(threads, elements, opsPerThread, readPercent);
+            double concurrent = run<SharedConcurrentHashSet>(threads, elements, opsPerThread, readPercent);
+            std::printf("%8u %20.2f %20.2f\n", threads, locked, concurrent);
+        }
+
+        std::printf("\n");
+    }
+
+    return 0;
+}
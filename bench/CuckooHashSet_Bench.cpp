@@ -0,0 +1,148 @@
+// CuckooHashSet_Bench.cpp
+//
+// Compares a CuckooHashSet (with four and eight slots per bucket) against
+// a HashSet.  It reports how full each CuckooHashSet was when it had to
+// grow, and memory per element, and then times lookups one at a time
+// to report the distribution of their latencies: the median and the 99th,
+// 99.9th, and 99.99th percentiles, and the worst.  The cost of reading the
+// clock is measured and subtracted.
+//
+// Usage: CuckooHashSet_Bench [elements] [lookups]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include "CuckooHashSet.hpp"
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    typedef CuckooHashSet<unsigned int, IntegerHash, std::equal_to<unsigned int>, 4> FourSlotSet;
+    typedef CuckooHashSet<unsigned int, IntegerHash, std::equal_to<unsigned int>, 8> EightSlotSet;
+
+
+    // fill() adds the elements, returning the lowest load factor at which
+    // the set had to grow.  (Tiny tables are left out, since they can
+    // easily fill up completely.)
+    template <typename SetType>
+    double fill(SetType& set, const std::vector<unsigned int>& elements)
+    {
+        double growthLoad = 1.0;
+
+        for (unsigned int element : elements)
+        {
+            std::size_t capacity = set.capacity();
+            double load = set.loadFactor();
+            set.add(element);
+
+            if (set.capacity() != capacity && capacity >= 4096)
+            {
+                growthLoad = std::min(growthLoad, load);
+            }
+        }
+
+        return growthLoad;
+    }
+
+
+    double clockOverheadNs()
+    {
+        std::vector<double> samples;
+
+        for (int i = 0; i < 100000; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+
+    template <typename SetType>
+    void timeLookups(const char* name, const SetType& set, const std::vector<unsigned int>& probes, double overhead)
+    {
+        std::vector<double> samples;
+        samples.reserve(probes.size());
+        unsigned int found = 0;
+
+        for (unsigned int probe : probes)
+        {
+            auto start = std::chrono::steady_clock::now();
+            found += set.contains(probe) ? 1 : 0;
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::max(0.0, std::chrono::duration<double, std::nano>(end - start).count() - overhead));
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        auto percentile = [&](double p) { return samples[static_cast<std::size_t>(p * (samples.size() - 1))]; };
+
+        std::printf("  %-14s %7.0f %7.0f %7.0f %7.0f %8.0f   (%u found)\n", name,
+            percentile(0.5), percentile(0.99), percentile(0.999), percentile(0.9999), samples.back(), found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 4000000;
+    unsigned int lookups = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    std::vector<unsigned int> present;
+    std::vector<unsigned int> hits;
+    std::vector<unsigned int> misses;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        present.push_back(static_cast<unsigned int>(mix64(i) << 1));
+    }
+
+    for (unsigned int i = 0; i < lookups; ++i)
+    {
+        hits.push_back(present[mix64(i + elements) % elements]);
+        misses.push_back(static_cast<unsigned int>(mix64(i) << 1) | 1);
+    }
+
+    HashSet<unsigned int, IntegerHash> hashSet{IntegerHash{}};
+    FourSlotSet four;
+    EightSlotSet eight;
+
+    for (unsigned int element : present)
+    {
+        hashSet.add(element);
+    }
+
+    double fourLoad = fill(four, present);
+    double eightLoad = fill(eight, present);
+
+    std::printf("%u elements\n", elements);
+    std::printf("  %-14s %6.1f bytes/element\n", "HashSet", hashSet.diagnostics().bytesPerValue);
+    std::printf("  %-14s %6.1f bytes/element   grew at %.1f%%   stash %u\n", "cuckoo, 4 slots",
+        static_cast<double>(four.sizeInBytes()) / four.size(), fourLoad * 100.0, four.stashSize());
+    std::printf("  %-14s %6.1f bytes/element   grew at %.1f%%   stash %u\n", "cuckoo, 8 slots",
+        static_cast<double>(eight.sizeInBytes()) / eight.size(), eightLoad * 100.0, eight.stashSize());
+
+    double overhead = clockOverheadNs();
+    std::printf("lookup latency in ns (clock overhead of %.0f ns subtracted)\n", overhead);
+    std::printf("  %-14s %7s %7s %7s %7s %8s\n", "", "p50", "p99", "p99.9", "p99.99", "max");
+
+    std::printf("hits\n");
+    timeLookups("HashSet", hashSet, hits, overhead);
+    timeLookups("cuckoo, 4", four, hits, overhead);
+    timeLookups("cuckoo, 8", eight, hits, overhead);
+
+    std::printf("misses\n");
+    timeLookups("HashSet", hashSet, misses, overhead);
+    timeLookups("cuckoo, 4", four, misses, overhead);
+    timeLookups("cuckoo, 8", eight, misses, overhead);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+// FilteredSet_Bench.cpp
+//
+// Measures what a filter in front of a set buys on a lookup workload that
+// is mostly misses.  For each kind of set (HashSet, AVLSet, SkipListSet),
+// it times lookups against the bare set, then against the same set behind
+// a BloomFilter and behind a CuckooFilter, and reports the speedup, the
+// filter's memory cost in bits per element, and the false positive rate
+// actually observed.
+//
+// Usage: FilteredSet_Bench [elements] [missPercent] [falsePositiveRate]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "AVLSet.hpp"
+#include "BloomFilter.hpp"
+#include "CuckooFilter.hpp"
+#include "FilteredSet.hpp"
+#include "Hashing.hpp"
+#include "HashSet.hpp"
+#include "SkipListSet.hpp"
+
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+
+
+    // timeLookups() adds the elements to the set, then returns the mean
+    // time (in nanoseconds) of looking up each probe in it.
+    template <typename SetType>
+    double timeLookups(SetType& set, const std::vector<int>& elements, const std::vector<int>& probes, unsigned int& found)
+    {
+        for (int element : elements)
+        {
+            set.add(element);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        found = 0;
+
+        for (int probe : probes)
+        {
+            found += set.contains(probe) ? 1 : 0;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / probes.size();
+    }
+
+
+    template <typename SetType, typename Filter>
+    void runFiltered(
+        const char* filterName, const SetType& empty, const std::vector<int>& elements,
+        const std::vector<int>& absent, const std::vector<int>& probes, double rate,
+        double bareNs, unsigned int bareFound)
+    {
+        FilteredSet<int, SetType, Filter> set{identityHash, static_cast<unsigned int>(elements.size()), rate, empty};
+
+        unsigned int found;
+        double ns = timeLookups(set, elements, probes, found);
+
+        unsigned int falsePositives = 0;
+
+        for (int element : absent)
+        {
+            falsePositives += set.filter().mayContain(mix64(identityHash(element))) ? 1 : 0;
+        }
+
+        std::printf("%-12s %-6s %7.1f ns/lookup   %5.2fx   %5.2f bits/element   measured FPR %.4f%s%s\n",
+            "", filterName, ns, bareNs / ns,
+            static_cast<double>(set.filter().sizeInBits()) / elements.size(),
+            static_cast<double>(falsePositives) / absent.size(),
+            found == bareFound ? "" : "   MISMATCH",
+            set.isFiltering() ? "" : "   (bypassed: filter full)");
+    }
+
+
+    template <typename SetType>
+    void run(
+        const char* name, const SetType& empty, const std::vector<int>& elements,
+        const std::vector<int>& absent, const std::vector<int>& probes, double rate)
+    {
+        unsigned int found;
+        double ns;
+
+        {
+            SetType set = empty;
+            ns = timeLookups(set, elements, probes, found);
+        }
+
+        std::printf("%-12s %-6s %7.1f ns/lookup   (%u found)\n", name, "bare", ns, found);
+
+        runFiltered<SetType, BloomFilter>("bloom", empty, elements, absent, probes, rate, ns, found);
+        runFiltered<SetType, CuckooFilter<>>("cuckoo", empty, elements, absent, probes, rate, ns, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned int missPercent = argc > 2 ? std::atoi(argv[2]) : 95;
+    double rate = argc > 3 ? std::atof(argv[3]) : 0.01;
+
+    // Even values of mix64() are elements and odd ones are not, so the
+    // elements and the misses are scattered over the same range.
+    std::vector<int> elements;
+    std::vector<int> absent;
+
+    for (std::uint64_t i = 0; elements.size() < count || absent.size() < count; ++i)
+    {
+        int value = static_cast<int>(mix64(i));
+        std::vector<int>& destination = (value & 1) == 0 ? elements : absent;
+
+        if (destination.size() < count)
+        {
+            destination.push_back(value);
+        }
+    }
+
+    std::vector<int> probes;
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        bool miss = mix64(i + count) % 100 < missPercent;
+        probes.push_back(miss ? absent[i] : elements[mix64(i) % count]);
+    }
+
+    run("HashSet", HashSet<int, FunctionHash<int>>{identityHash}, elements, absent, probes, rate);
+    run("AVLSet", AVLSet<int>{}, elements, absent, probes, rate);
+    run("SkipListSet", SkipListSet<int>{}, elements, absent, probes, rate);
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+// FrozenHashSet_Bench.cpp
+//
+// Compares a FrozenHashSet against the HashSet it was frozen from: how long
+// freezing takes (compared to building the HashSet in the first place),
+// how much memory each uses per element, and how fast each one answers
+// lookups, both hits and misses.
+//
+// Usage: FrozenHashSet_Bench [elements] [lookups]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "FrozenHashSet.hpp"
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    unsigned int identityHash(const unsigned int& element)
+    {
+        return element;
+    }
+
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    template <typename SetType>
+    void timeLookups(const char* name, const SetType& set, const std::vector<unsigned int>& probes)
+    {
+        auto start = std::chrono::steady_clock::now();
+        unsigned int found = 0;
+
+        for (unsigned int probe : probes)
+        {
+            found += set.contains(probe) ? 1 : 0;
+        }
+
+        double ns = elapsedNs(start) / probes.size();
+
+        std::printf("  %-8s %6.1f ns/lookup   %6.1f M lookups/s   (%u found)\n",
+            name, ns, 1000.0 / ns, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned int lookups = argc > 2 ? std::atoi(argv[2]) : 10000000;
+
+    // Even values of mix64() are elements and odd ones are not.
+    std::vector<unsigned int> present;
+    std::vector<unsigned int> absent;
+
+    for (std::uint64_t i = 0; present.size() < elements || absent.size() < elements; ++i)
+    {
+        unsigned int value = static_cast<unsigned int>(mix64(i));
+        std::vector<unsigned int>& destination = (value & 1) == 0 ? present : absent;
+
+        if (destination.size() < elements)
+        {
+            destination.push_back(value);
+        }
+    }
+
+    std::vector<unsigned int> hits;
+    std::vector<unsigned int> misses;
+
+    for (unsigned int i = 0; i < lookups; ++i)
+    {
+        hits.push_back(present[mix64(i) % elements]);
+        misses.push_back(absent[mix64(i + lookups) % elements]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    HashSet<unsigned int, FunctionHash<unsigned int>> set{identityHash};
+
+    for (unsigned int element : present)
+    {
+        set.add(element);
+    }
+
+    double buildNs = elapsedNs(start);
+
+    start = std::chrono::steady_clock::now();
+    FrozenHashSet<unsigned int, FunctionHash<unsigned int>> frozen = set.freeze();
+    double freezeNs = elapsedNs(start);
+
+    HashTableDiagnostics d = set.diagnostics();
+
+    std::printf("%u elements\n", set.size());
+    std::printf("  HashSet build   %7.1f ms   %6.1f bytes/element\n",
+        buildNs / 1e6, d.bytesPerValue);
+    std::printf("  freeze()        %7.1f ms   %6.1f bytes/element   %.2f bits/element of perfect hash\n",
+        freezeNs / 1e6, static_cast<double>(frozen.sizeInBytes()) / frozen.size(),
+        static_cast<double>(frozen.hashSizeInBits()) / frozen.size());
+
+    std::printf("hits\n");
+    timeLookups("HashSet", set, hits);
+    timeLookups("frozen", frozen, hits);
+
+    std::printf("misses\n");
+    timeLookups("HashSet", set, misses);
+    timeLookups("frozen", frozen, misses);
+
+    return 0;
+}
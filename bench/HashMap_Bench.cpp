@@ -0,0 +1,157 @@
+// HashMap_Bench.cpp
+//
+// Compares HashMap against std::unordered_map on the key shapes we use:
+// 64-bit integer IDs, short strings (which fit in std::string's small
+// buffer), and long strings.  Each run inserts every key with try_emplace,
+// looks every key up (hits), looks up the same number of absent keys
+// (misses), and erases every key.  Both maps use the same hash function
+// for each key shape, so the comparison is between the tables themselves.
+//
+// Usage: HashMap_Bench [keys]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "HashMap.hpp"
+
+
+namespace
+{
+    struct IdHash
+    {
+        unsigned int operator()(std::uint64_t id) const noexcept
+        {
+            id *= 0x9E3779B97F4A7C15ull;
+            return static_cast<unsigned int>(id >> 32);
+        }
+    };
+
+
+    double nsPer(std::chrono::steady_clock::time_point start, std::size_t count)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    }
+
+
+    template <typename Map, typename Key>
+    void run(const char* name, Map& map, const std::vector<Key>& keys, const std::vector<Key>& absent)
+    {
+        unsigned long long checksum = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            map.try_emplace(keys[i], i);
+        }
+
+        double insert = nsPer(start, keys.size());
+        start = std::chrono::steady_clock::now();
+
+        for (const Key& key : keys)
+        {
+            checksum += map.find(key) != map.end() ? 1 : 0;
+        }
+
+        double hit = nsPer(start, keys.size());
+        start = std::chrono::steady_clock::now();
+
+        for (const Key& key : absent)
+        {
+            checksum += map.find(key) != map.end() ? 1 : 0;
+        }
+
+        double miss = nsPer(start, absent.size());
+        start = std::chrono::steady_clock::now();
+
+        for (const Key& key : keys)
+        {
+            map.erase(key);
+        }
+
+        double erase = nsPer(start, keys.size());
+
+        std::printf("  %-20s insert %7.1f  hit %7.1f  miss %7.1f  erase %7.1f ns  (%llu)\n",
+            name, insert, hit, miss, erase, checksum);
+    }
+
+
+    // Adapts HashMap to the few std::unordered_map member functions that
+    // run() uses, so the same loop drives both.
+    template <typename Key, typename Hash>
+    struct HashMapAdapter
+    {
+        HashMapAdapter()
+            : map{Hash{}}
+        {
+        }
+
+        void try_emplace(const Key& key, std::size_t value)
+        {
+            map.try_emplace(key, value);
+        }
+
+        const std::size_t* find(const Key& key) const
+        {
+            return map.find(key);
+        }
+
+        const std::size_t* end() const
+        {
+            return nullptr;
+        }
+
+        void erase(const Key& key)
+        {
+            map.erase(key);
+        }
+
+        HashMap<Key, std::size_t, Hash> map;
+    };
+
+
+    template <typename Key, typename Hash>
+    void compare(const char* shape, const std::vector<Key>& keys, const std::vector<Key>& absent)
+    {
+        std::printf("%s\n", shape);
+
+        std::unordered_map<Key, std::size_t, Hash> standard;
+        run("std::unordered_map", standard, keys, absent);
+
+        HashMapAdapter<Key, Hash> ours;
+        run("HashMap", ours, keys, absent);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    std::size_t count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    std::vector<std::uint64_t> ids;
+    std::vector<std::uint64_t> absentIds;
+    std::vector<std::string> shortKeys;
+    std::vector<std::string> absentShortKeys;
+    std::vector<std::string> longKeys;
+    std::vector<std::string> absentLongKeys;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        ids.push_back(i * 7919 + 1);
+        absentIds.push_back(i * 7919 + 2);
+        shortKeys.push_back("u" + std::to_string(i));
+        absentShortKeys.push_back("x" + std::to_string(i));
+        longKeys.push_back("tenant/region/service/instance/" + std::to_string(i));
+        absentLongKeys.push_back("tenant/region/service/missing/" + std::to_string(i));
+    }
+
+    compare<std::uint64_t, IdHash>("64-bit IDs", ids, absentIds);
+    compare<std::string, StringHash>("short strings", shortKeys, absentShortKeys);
+    compare<std::string, StringHash>("long strings", longKeys, absentLongKeys);
+
+    return 0;
+}
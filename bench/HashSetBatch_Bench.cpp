@@ -0,0 +1,114 @@
+// HashSetBatch_Bench.cpp
+//
+// Compares HashSet::containsBatch() and addBatch() against loops of
+// contains() and add() on a set that's much larger than the last-level
+// cache, where every independent lookup stalls on main memory.  The probe
+// keys are random, half present and half absent, so neither the hardware
+// prefetcher nor the branch predictor can help the loop.
+//
+// Usage: HashSetBatch_Bench [elements] [probes] [batchSize]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include "HashSet.hpp"
+
+
+namespace
+{
+    struct MixHash
+    {
+        unsigned int operator()(unsigned int element) const noexcept
+        {
+            element *= 0x9E3779B1u;
+            return element ^ (element >> 16);
+        }
+    };
+
+
+    double nsPer(std::chrono::steady_clock::time_point start, std::size_t count)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    std::size_t elements = argc > 1 ? std::atoi(argv[1]) : 8000000;
+    std::size_t probes = argc > 2 ? std::atoi(argv[2]) : 4000000;
+    std::size_t batchSize = argc > 3 ? std::atoi(argv[3]) : 4096;
+
+    std::vector<unsigned int> inserted(elements);
+
+    for (std::size_t i = 0; i < elements; ++i)
+    {
+        inserted[i] = static_cast<unsigned int>(i * 2);
+    }
+
+    std::shuffle(inserted.begin(), inserted.end(), std::mt19937{1});
+
+    HashSet<unsigned int, MixHash> looped{MixHash{}};
+    HashSet<unsigned int, MixHash> batched{MixHash{}};
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int element : inserted)
+    {
+        looped.add(element);
+    }
+
+    double addLoop = nsPer(start, elements);
+    start = std::chrono::steady_clock::now();
+
+    for (std::size_t first = 0; first < elements; first += batchSize)
+    {
+        batched.addBatch(inserted.data() + first, std::min(batchSize, elements - first));
+    }
+
+    double addBatch = nsPer(start, elements);
+
+    std::mt19937 random{2};
+    std::uniform_int_distribution<unsigned int> distribution{0, static_cast<unsigned int>(elements * 2 - 1)};
+    std::vector<unsigned int> keys(probes);
+
+    for (unsigned int& key : keys)
+    {
+        key = distribution(random);
+    }
+
+    std::unique_ptr<bool[]> out{new bool[probes]};
+    std::size_t found = 0;
+
+    start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < probes; ++i)
+    {
+        out[i] = looped.contains(keys[i]);
+    }
+
+    double containsLoop = nsPer(start, probes);
+    found += std::count(out.get(), out.get() + probes, true);
+
+    start = std::chrono::steady_clock::now();
+
+    for (std::size_t first = 0; first < probes; first += batchSize)
+    {
+        looped.containsBatch(keys.data() + first, std::min(batchSize, probes - first), out.get() + first);
+    }
+
+    double containsBatch = nsPer(start, probes);
+    found += std::count(out.get(), out.get() + probes, true);
+
+    std::printf("%zu elements, %zu probes, batches of %zu\n", elements, probes, batchSize);
+    std::printf("  add loop        %7.1f ns/element\n", addLoop);
+    std::printf("  addBatch        %7.1f ns/element\n", addBatch);
+    std::printf("  contains loop   %7.1f ns/probe\n", containsLoop);
+    std::printf("  containsBatch   %7.1f ns/probe   (%zu found)\n", containsBatch, found);
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+// HashSetBuild_Bench.cpp
+//
+// Compares building a HashSet by calling add() on every element against
+// HashSet::build(), which sizes the array once and fills disjoint ranges
+// of it on several threads, for a range of thread counts.  The input has
+// some duplicates, so that deduplication is part of the work.
+//
+// Usage: HashSetBuild_Bench [elements] [maxThreads]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    unsigned int identityHash(const unsigned int& element)
+    {
+        return element;
+    }
+
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    unsigned int maxThreads = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    maxThreads = maxThreads != 0 ? maxThreads : 1;
+
+    // About one element in ten is a repeat of an earlier one.
+    std::vector<unsigned int> input;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        input.push_back(static_cast<unsigned int>(mix64(i % (elements - elements / 10))));
+    }
+
+    double addMs;
+    unsigned int size;
+
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        HashSet<unsigned int, FunctionHash<unsigned int>> set{identityHash};
+
+        for (unsigned int element : input)
+        {
+            set.add(element);
+        }
+
+        addMs = elapsedMs(start);
+        size = set.size();
+    }
+
+    std::printf("%u elements (%u distinct), %u hardware threads\n",
+        elements, size, std::thread::hardware_concurrency());
+    std::printf("  add()              %8.1f ms\n", addMs);
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        HashSet<unsigned int, FunctionHash<unsigned int>> set{identityHash};
+        set.build(input.begin(), input.end(), threads);
+
+        double ms = elapsedMs(start);
+
+        std::printf("  build(), %2u threads %8.1f ms   %5.2fx vs add()%s\n",
+            threads, ms, addMs / ms, set.size() == size ? "" : "   MISMATCH");
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+// HashSetCachedHash_Bench.cpp
+//
+// Compares a HashSet of long string keys that caches each element's hash
+// in its node against one that doesn't.  Building the set exercises the
+// resizes, which rehash everything unless the hashes are cached; looking
+// up keys that share a long common prefix exercises the chain walks, where
+// a cached hash avoids most of the expensive string comparisons.
+//
+// Usage: HashSetCachedHash_Bench [elements] [keyLength]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "HashSet.hpp"
+
+
+namespace
+{
+    template <bool CacheHash>
+    void run(const char* name, const std::vector<std::string>& keys)
+    {
+        typedef HashSet<std::string, StringHash, std::equal_to<>, CacheHash> Set;
+
+        auto start = std::chrono::steady_clock::now();
+
+        Set set{StringHash{}};
+
+        for (const std::string& key : keys)
+        {
+            set.add(key);
+        }
+
+        auto built = std::chrono::steady_clock::now();
+
+        unsigned int found = 0;
+
+        for (int round = 0; round < 5; ++round)
+        {
+            for (const std::string& key : keys)
+            {
+                found += set.contains(key) ? 1 : 0;
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        double buildNs = std::chrono::duration<double, std::nano>(built - start).count() / keys.size();
+        double lookupNs = std::chrono::duration<double, std::nano>(end - built).count() / (keys.size() * 5);
+
+        std::printf("%-12s build %8.1f ns/element   lookup %8.1f ns/element   (%u found)\n",
+            name, buildNs, lookupNs, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 500000;
+    unsigned int keyLength = argc > 2 ? std::atoi(argv[2]) : 128;
+
+    std::vector<std::string> keys;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        std::string key(keyLength, 'k');
+        std::string suffix = std::to_string(i);
+        key.replace(key.size() - suffix.size(), suffix.size(), suffix);
+        keys.push_back(key);
+    }
+
+    run<false>("uncached", keys);
+    run<true>("cached", keys);
+
+    return 0;
+}
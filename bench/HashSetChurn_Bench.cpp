@@ -0,0 +1,158 @@
+// HashSetChurn_Bench.cpp
+//
+// Measures a HashSet used for rolling-window deduplication: a stream of
+// keys, of which only the most recent "window" are remembered.  Three ways
+// of keeping the window are compared:
+//
+// * rebuild: since a set without removal can only grow, it's discarded and
+//   rebuilt from the window's keys every time the window slides by a full
+//   window's length.
+//
+// * clear: the same, but the set is cleared and refilled rather than
+//   rebuilt, so its array is reused.
+//
+// * remove: the set is kept at exactly the window's contents by removing
+//   each key as it falls out of the window; the set stays at a steady size,
+//   and its capacity stays put.
+//
+// Every approach checks each key against the set before adding it, which
+// is the dedup itself.  The stream has a fixed fraction of repeats.
+//
+// Usage: HashSetChurn_Bench [window] [streamLength] [repeatPercent]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    unsigned int mixHash(const std::uint64_t& key)
+    {
+        return static_cast<unsigned int>(mix64(key));
+    }
+
+
+    typedef HashSet<std::uint64_t, FunctionHash<std::uint64_t>> Set;
+
+
+    void report(const char* name, std::chrono::steady_clock::time_point start, std::size_t n, unsigned int duplicates)
+    {
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / n;
+
+        std::printf("%-8s %7.1f ns/key   %6.2f M keys/s   (%u duplicates seen)\n",
+            name, ns, 1000.0 / ns, duplicates);
+    }
+
+
+    // The set is rebuilt (or refilled) from the last window of keys every
+    // time a full window of new keys has arrived, so at any moment it holds
+    // between one and two windows' worth; that's the best a set without
+    // removal can do.
+    template <bool Clear>
+    void runRebuild(const char* name, const std::vector<std::uint64_t>& stream, std::size_t window)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        Set set{mixHash};
+        unsigned int duplicates = 0;
+
+        for (std::size_t i = 0; i < stream.size(); ++i)
+        {
+            if (i % window == 0 && i >= window)
+            {
+                if constexpr (Clear)
+                {
+                    set.clear();
+                }
+                else
+                {
+                    set = Set{mixHash};
+                }
+
+                for (std::size_t j = i - window; j < i; ++j)
+                {
+                    set.add(stream[j]);
+                }
+            }
+
+            duplicates += set.contains(stream[i]) ? 1 : 0;
+            set.add(stream[i]);
+        }
+
+        report(name, start, stream.size(), duplicates);
+    }
+
+
+    void runRemove(const std::vector<std::uint64_t>& stream, std::size_t window)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // Duplicates within the window are counted, so that removing a key
+        // that's still in the window (because it was repeated) is avoided.
+        Set set{mixHash};
+        unsigned int duplicates = 0;
+
+        std::vector<unsigned int> copies(stream.size(), 0);
+
+        for (std::size_t i = 0; i < stream.size(); ++i)
+        {
+            if (i >= window)
+            {
+                std::uint64_t expired = stream[i - window];
+
+                // The stream's values are indexes into "copies", since
+                // every key is drawn from [0, stream.size()).
+                if (--copies[expired] == 0)
+                {
+                    set.remove(expired);
+                }
+            }
+
+            duplicates += set.contains(stream[i]) ? 1 : 0;
+            set.add(stream[i]);
+            ++copies[stream[i]];
+        }
+
+        report("remove", start, stream.size(), duplicates);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    std::size_t window = argc > 1 ? std::atoi(argv[1]) : 100000;
+    std::size_t length = argc > 2 ? std::atoi(argv[2]) : 5000000;
+    unsigned int repeatPercent = argc > 3 ? std::atoi(argv[3]) : 10;
+
+    // Each key is either new or (with the given probability) a repeat of
+    // one of the recent keys.
+    std::vector<std::uint64_t> stream;
+    std::uint64_t next = 0;
+
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        std::uint64_t r = mix64(i);
+
+        if (i > 0 && r % 100 < repeatPercent)
+        {
+            std::size_t back = 1 + (r >> 32) % (i < window ? i : window);
+            stream.push_back(stream[i - back]);
+        }
+        else
+        {
+            stream.push_back(next++);
+        }
+    }
+
+    runRebuild<false>("rebuild", stream, window);
+    runRebuild<true>("clear", stream, window);
+    runRemove(stream, window);
+
+    return 0;
+}
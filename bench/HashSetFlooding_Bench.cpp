@@ -0,0 +1,97 @@
+// HashSetFlooding_Bench.cpp
+//
+// Shows what a HashSet's flooding defense does when the keys are chosen
+// to collide.  With the identity hash function, keys that are multiples of
+// 10 * 2^12 all land in the same cell at every capacity up to that many
+// cells, and in very few cells beyond it, which is exactly what an attacker
+// who knows the hash function would send.  The set notices
+// the long chain, starts scrambling hashes with a random seed, and the
+// elements spread out again.
+//
+// For each kind of key, the set's diagnostics are printed, along with the
+// cost of building it and of looking every key up.
+//
+// Usage: HashSetFlooding_Bench [elements]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    unsigned int identityHash(const unsigned int& element)
+    {
+        return element;
+    }
+
+
+    void run(const char* name, const std::vector<unsigned int>& keys)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        HashSet<unsigned int, FunctionHash<unsigned int>> set{identityHash};
+
+        for (unsigned int key : keys)
+        {
+            set.add(key);
+        }
+
+        auto built = std::chrono::steady_clock::now();
+
+        unsigned int found = 0;
+
+        for (unsigned int key : keys)
+        {
+            found += set.contains(key) ? 1 : 0;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+
+        HashTableDiagnostics d = set.diagnostics();
+
+        std::printf("%s\n", name);
+        std::printf("  build %.1f ns/element, lookup %.1f ns/element (%u found)\n",
+            std::chrono::duration<double, std::nano>(built - start).count() / keys.size(),
+            std::chrono::duration<double, std::nano>(end - built).count() / keys.size(), found);
+        std::printf("  size %u, capacity %u, longest chain %u, seeded %s\n",
+            d.size, d.capacity, d.longestChain, d.seeded ? "yes" : "no");
+        std::printf("  collisions %u (%.1f expected), %.1f bytes/element\n",
+            d.collisions, d.expectedCollisions, d.bytesPerValue);
+        std::printf("  chain lengths:");
+
+        for (std::size_t k = 0; k < d.chainLengths.size(); ++k)
+        {
+            if (d.chainLengths[k] != 0)
+            {
+                std::printf(" %zu:%u", k, d.chainLengths[k]);
+            }
+        }
+
+        std::printf("\n");
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    // There are only about 100,000 distinct 32-bit multiples of 10 * 2^12.
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    std::vector<unsigned int> random;
+    std::vector<unsigned int> adversarial;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        random.push_back(static_cast<unsigned int>(mix64(i)));
+        adversarial.push_back(i * (10u << 12));
+    }
+
+    run("random keys", random);
+    run("colliding keys", adversarial);
+
+    return 0;
+}
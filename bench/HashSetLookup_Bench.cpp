@@ -0,0 +1,120 @@
+// HashSetLookup_Bench.cpp
+//
+// Measures the cost of looking up std::string keys in a HashSet when the
+// keys arrive as (pointer, length) slices of a larger buffer, comparing a
+// lookup that builds a temporary std::string against a heterogeneous lookup
+// through a std::string_view.  Allocations are counted by replacing the
+// global operator new.
+//
+// Usage: HashSetLookup_Bench [elements] [lookups]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HashSet.hpp"
+
+
+namespace
+{
+    std::atomic<unsigned long long> allocations{0};
+}
+
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size != 0 ? size : 1))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+namespace
+{
+    template <typename Lookup>
+    void run(const char* name, unsigned int lookups, Lookup lookup)
+    {
+        unsigned long long before = allocations.load();
+        auto start = std::chrono::steady_clock::now();
+
+        unsigned int found = 0;
+
+        for (unsigned int i = 0; i < lookups; ++i)
+        {
+            found += lookup(i) ? 1 : 0;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        unsigned long long allocated = allocations.load() - before;
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+        std::printf("%-28s %8.1f ns/lookup  %6.3f allocations/lookup  (%u found)\n",
+            name, ns / lookups, static_cast<double>(allocated) / lookups, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 100000;
+    unsigned int lookups = argc > 2 ? std::atoi(argv[2]) : 1000000;
+
+    // Keys are long enough (32 characters) to defeat the small-string
+    // optimization, as network identifiers usually are.
+    std::string buffer;
+    std::vector<std::size_t> offsets;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        char key[40];
+        std::snprintf(key, sizeof(key), "session-identifier-%013u", i * 2654435761u);
+        offsets.push_back(buffer.size());
+        buffer += key;
+    }
+
+    const std::size_t keyLength = 32;
+
+    HashSet<std::string, StringHash, std::equal_to<>> set{StringHash{}};
+
+    for (std::size_t offset : offsets)
+    {
+        set.add(buffer.substr(offset, keyLength));
+    }
+
+    run("contains(std::string{...})", lookups,
+        [&](unsigned int i)
+        {
+            const char* p = buffer.data() + offsets[i % elements];
+            return set.contains(std::string{p, keyLength});
+        });
+
+    run("contains(std::string_view)", lookups,
+        [&](unsigned int i)
+        {
+            const char* p = buffer.data() + offsets[i % elements];
+            return set.contains(std::string_view{p, keyLength});
+        });
+
+    return 0;
+}
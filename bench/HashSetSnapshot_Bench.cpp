@@ -0,0 +1,111 @@
+// HashSetSnapshot_Bench.cpp
+//
+// Compares two ways of getting a large HashSet back after a restart:
+// loading a snapshot saved with save(), and adding every element again.
+// It times saving, loading (with and without verifying the checksum)
+// followed by a first lookup, rebuilding from scratch, lookups into the
+// loaded set while it's still mapped compared with lookups into an
+// ordinary one, and the promotion that the first change to a loaded set
+// causes.
+//
+// Usage: HashSetSnapshot_Bench [elements] [snapshot path]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+
+namespace
+{
+    typedef HashSet<unsigned int, IntegerHash> IdSet;
+
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    double lookupNs(const IdSet& s, const std::vector<unsigned int>& keys, unsigned int& found)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int key : keys)
+        {
+            found += s.contains(key) ? 1 : 0;
+        }
+
+        return elapsedMs(start) * 1e6 / keys.size();
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    std::string path = argc > 2 ? argv[2] : "/tmp/HashSetSnapshot_Bench.snapshot";
+
+    std::vector<unsigned int> keys;
+    keys.reserve(elements);
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        keys.push_back(static_cast<unsigned int>(mix64(i)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    IdSet original{IntegerHash{}};
+
+    for (unsigned int key : keys)
+    {
+        original.add(key);
+    }
+
+    double rebuildMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    original.save(path);
+    double saveMs = elapsedMs(start);
+
+    unsigned int found = 0;
+
+    start = std::chrono::steady_clock::now();
+    IdSet verified{IntegerHash{}};
+    verified.load(path);
+    found += verified.contains(keys[0]) ? 1 : 0;
+    double verifiedLoadMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    IdSet mapped{IntegerHash{}};
+    mapped.load(path, false);
+    found += mapped.contains(keys[0]) ? 1 : 0;
+    double unverifiedLoadMs = elapsedMs(start);
+
+    std::printf("%u elements\n", original.size());
+    std::printf("  add every element:             %9.2f ms\n", rebuildMs);
+    std::printf("  save:                          %9.2f ms\n", saveMs);
+    std::printf("  load + first lookup:           %9.2f ms\n", verifiedLoadMs);
+    std::printf("  load (unverified) + lookup:    %9.2f ms\n", unverifiedLoadMs);
+
+    std::vector<unsigned int> probes;
+
+    for (unsigned int i = 0; i < 1000000; ++i)
+    {
+        probes.push_back(keys[mix64(i + elements) % elements] + (i % 2));
+    }
+
+    std::printf("  lookup, ordinary set:          %9.2f ns\n", lookupNs(original, probes, found));
+    std::printf("  lookup, mapped set:            %9.2f ns\n", lookupNs(mapped, probes, found));
+
+    start = std::chrono::steady_clock::now();
+    mapped.add(0);
+    std::printf("  promotion (first add):         %9.2f ms\n", elapsedMs(start));
+    std::printf("  (%u found)\n", found);
+
+    std::remove(path.c_str());
+    return 0;
+}
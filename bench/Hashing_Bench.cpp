@@ -0,0 +1,115 @@
+// Hashing_Bench.cpp
+//
+// Measures the throughput of the hash functions in Hashing.hpp on keys from
+// 8 bytes to 4 KB, alongside the 32-bit FNV-1a loop that StringHash used to
+// be, plus the time per key of IntegerHash.  Build with -msse4.2 (or
+// -march=native) to measure crc32c() using the CRC32 instruction.
+//
+// Usage: Hashing_Bench [bytes hashed per measurement]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Hashing.hpp"
+
+
+namespace
+{
+    unsigned int fnv1a(const unsigned char* data, std::size_t length)
+    {
+        unsigned int hash = 2166136261u;
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            hash ^= data[i];
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    // gigabytesPerSecond() hashes consecutive keys of the given length from
+    // the buffer, feeding each result into the next key's first byte so
+    // that the hashes can't all be computed at once, and returns the rate.
+    template <typename HashFunction>
+    double gigabytesPerSecond(
+        HashFunction hash, std::vector<unsigned char>& buffer, std::size_t length,
+        std::size_t total, unsigned long long& sum)
+    {
+        std::size_t keys = buffer.size() / length;
+        std::size_t rounds = total / length;
+        auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < rounds; ++i)
+        {
+            unsigned char* key = buffer.data() + (i % keys) * length;
+            std::uint64_t h = hash(key, length);
+            key[0] ^= static_cast<unsigned char>(h);
+            sum += h;
+        }
+
+        return static_cast<double>(rounds * length) / elapsedNs(start);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    std::size_t total = argc > 1 ? std::atoll(argv[1]) : 1000000000;
+
+#if defined(__SSE4_2__)
+    std::printf("crc32c() is using the CRC32 instruction\n");
+#else
+    std::printf("crc32c() is using a lookup table\n");
+#endif
+
+    std::vector<unsigned char> buffer(64 * 1024);
+
+    for (std::size_t i = 0; i < buffer.size(); ++i)
+    {
+        buffer[i] = static_cast<unsigned char>(mix64(i));
+    }
+
+    unsigned long long sum = 0;
+
+    std::printf("%8s %12s %12s %12s   (GB/s)\n", "bytes", "FNV-1a", "hashBytes", "crc32c");
+
+    for (std::size_t length = 8; length <= 4096; length *= 2)
+    {
+        double fnv = gigabytesPerSecond(
+            [](const unsigned char* p, std::size_t n) { return fnv1a(p, n); },
+            buffer, length, total / 4, sum);
+
+        double bytes = gigabytesPerSecond(
+            [](const unsigned char* p, std::size_t n) { return hashBytes(p, n); },
+            buffer, length, total, sum);
+
+        double crc = gigabytesPerSecond(
+            [](const unsigned char* p, std::size_t n) { return crc32c(p, n); },
+            buffer, length, total / 2, sum);
+
+        std::printf("%8zu %12.2f %12.2f %12.2f\n", length, fnv, bytes, crc);
+    }
+
+    std::size_t integers = total / 8;
+    IntegerHash integerHash;
+    unsigned int h = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < integers; ++i)
+    {
+        h = integerHash(i ^ h);
+    }
+
+    std::printf("IntegerHash: %.2f ns/key\n", elapsedNs(start) / integers);
+    std::printf("(checksum %llu)\n", sum + h);
+    return 0;
+}
@@ -0,0 +1,121 @@
+// HyperLogLog_Bench.cpp
+//
+// Compares HyperLogLogs of several precisions against a HashSet holding
+// the same distinct IDs: for a range of cardinalities, the memory each
+// uses and the relative error of each HyperLogLog's estimate against the
+// HashSet's exact size.  Then it times adding elements to a HyperLogLog
+// and merging two dense ones.
+//
+// Usage: HyperLogLog_Bench [max cardinality]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+#include "HyperLogLog.hpp"
+
+
+namespace
+{
+    typedef HyperLogLog<unsigned int, IntegerHash> Sketch;
+
+    constexpr unsigned int PRECISIONS[] = {10, 12, 14, 16};
+
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int maxCardinality = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+    HashSet<unsigned int, IntegerHash> exact{IntegerHash{}};
+    std::vector<Sketch> sketches;
+
+    for (unsigned int precision : PRECISIONS)
+    {
+        sketches.emplace_back(precision, IntegerHash{});
+    }
+
+    std::printf("%-12s %14s", "distinct", "HashSet");
+
+    for (unsigned int precision : PRECISIONS)
+    {
+        std::printf("        p = %-2u", precision);
+    }
+
+    std::printf("\n");
+
+    unsigned int next = 0;
+
+    for (unsigned int cardinality = 100; cardinality <= maxCardinality; cardinality *= 10)
+    {
+        for (; next < cardinality; ++next)
+        {
+            unsigned int id = static_cast<unsigned int>(mix64(next));
+            exact.add(id);
+
+            for (Sketch& sketch : sketches)
+            {
+                sketch.add(id);
+            }
+        }
+
+        double exactBytes = exact.diagnostics().bytesPerValue * exact.size();
+        std::printf("%-12u %11.0f KB", exact.size(), exactBytes / 1024.0);
+
+        for (const Sketch& sketch : sketches)
+        {
+            double error = (sketch.estimate() - exact.size()) / exact.size();
+            std::printf("  %5.1f KB %+5.2f%%", sketch.sizeInBytes() / 1024.0, error * 100.0);
+        }
+
+        std::printf("\n");
+    }
+
+    std::printf("standard error ");
+
+    for (unsigned int precision : PRECISIONS)
+    {
+        std::printf("             %4.2f%%", Sketch::standardError(precision) * 100.0);
+    }
+
+    std::printf("\n");
+
+    Sketch timed{14, IntegerHash{}};
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < maxCardinality; ++i)
+    {
+        timed.add(i);
+    }
+
+    std::printf("add (p = 14):         %6.2f ns/element\n", elapsedNs(start) / maxCardinality);
+
+    Sketch other{14, IntegerHash{}};
+
+    for (unsigned int i = 0; i < 100000; ++i)
+    {
+        other.add(i + maxCardinality);
+    }
+
+    constexpr unsigned int MERGES = 10000;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = 0; i < MERGES; ++i)
+    {
+        timed.merge(other);
+    }
+
+    std::printf("merge (p = 14, dense): %6.2f us/merge   (estimate %.0f)\n",
+        elapsedNs(start) / MERGES / 1000.0, timed.estimate());
+
+    return 0;
+}
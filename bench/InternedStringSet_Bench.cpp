@@ -0,0 +1,176 @@
+// InternedStringSet_Bench.cpp
+//
+// Compares an InternedStringSet against a HashSet<std::string> holding the
+// same short identifiers (8 to 20 characters, 14 on average): the memory
+// each uses per string, as measured by counting every byte either one
+// allocates, how long it takes to add them all, and how fast each answers
+// lookups, both hits and misses.  The HashSet uses StringHash, the same
+// hash function the InternedStringSet uses.
+//
+// Usage: InternedStringSet_Bench [strings] [lookups]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+#include "InternedStringSet.hpp"
+
+
+namespace
+{
+    std::size_t allocatedBytes = 0;
+}
+
+
+// Every allocation in the program is counted, so that the memory used by a
+// set can be measured as the difference before and after building it.  Each
+// block records its own size just before the memory handed out, so that it
+// can be subtracted again when the block is freed.
+
+void* operator new(std::size_t size)
+{
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    if (void* p = std::malloc(size + HEADER))
+    {
+        allocatedBytes += size;
+        *static_cast<std::size_t*>(p) = size;
+        return static_cast<char*>(p) + HEADER;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void operator delete(void* p) noexcept
+{
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    if (p != nullptr)
+    {
+        void* block = static_cast<char*>(p) - HEADER;
+        allocatedBytes -= *static_cast<std::size_t*>(block);
+        std::free(block);
+    }
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+
+namespace
+{
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    std::string identifier(std::uint64_t i)
+    {
+        static const char CHARACTERS[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+        std::uint64_t bits = mix64(i);
+        std::string s(8 + bits % 13, ' ');
+        bits = mix64(bits);
+
+        for (char& c : s)
+        {
+            c = CHARACTERS[bits % 37];
+            bits = bits / 37 == 0 ? mix64(bits + 1) : bits / 37;
+        }
+
+        return s;
+    }
+
+
+    template <typename Lookup>
+    void timeLookups(const char* name, const std::vector<std::string>& probes, Lookup lookup)
+    {
+        auto start = std::chrono::steady_clock::now();
+        unsigned int found = 0;
+
+        for (const std::string& probe : probes)
+        {
+            found += lookup(probe) ? 1 : 0;
+        }
+
+        double ns = elapsedNs(start) / probes.size();
+        std::printf("  %-18s %6.1f ns/lookup   (%u found)\n", name, ns, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int strings = argc > 1 ? std::atoi(argv[1]) : 2000000;
+    unsigned int lookups = argc > 2 ? std::atoi(argv[2]) : 5000000;
+
+    std::vector<std::string> present;
+    std::vector<std::string> hits;
+    std::vector<std::string> misses;
+    std::size_t characters = 0;
+
+    for (unsigned int i = 0; i < strings; ++i)
+    {
+        present.push_back(identifier(i));
+        characters += present.back().size();
+    }
+
+    for (unsigned int i = 0; i < lookups; ++i)
+    {
+        hits.push_back(present[mix64(i) % strings]);
+        misses.push_back(identifier(strings + i) + "!");
+    }
+
+    std::printf("%u strings, %.1f characters each on average\n",
+        strings, static_cast<double>(characters) / strings);
+
+    std::size_t before = allocatedBytes;
+    auto start = std::chrono::steady_clock::now();
+
+    HashSet<std::string, StringHash, std::equal_to<>> hashSet{StringHash{}};
+
+    for (const std::string& s : present)
+    {
+        hashSet.add(s);
+    }
+
+    double hashSetBuildNs = elapsedNs(start);
+    std::size_t hashSetBytes = allocatedBytes - before;
+
+    before = allocatedBytes;
+    start = std::chrono::steady_clock::now();
+
+    InternedStringSet interned;
+
+    for (const std::string& s : present)
+    {
+        interned.intern(s);
+    }
+
+    double internedBuildNs = elapsedNs(start);
+    std::size_t internedBytes = allocatedBytes - before;
+
+    std::printf("  %-18s %6.1f bytes/string   built in %6.1f ms\n", "HashSet<string>",
+        static_cast<double>(hashSetBytes) / strings, hashSetBuildNs / 1e6);
+    std::printf("  %-18s %6.1f bytes/string   built in %6.1f ms   (%u distinct)\n", "InternedStringSet",
+        static_cast<double>(internedBytes) / strings, internedBuildNs / 1e6, interned.size());
+
+    std::printf("hits\n");
+    timeLookups("HashSet<string>", hits, [&](const std::string& s) { return hashSet.contains(s); });
+    timeLookups("InternedStringSet", hits, [&](const std::string& s) { return interned.find(s) != InternedStringSet::NOT_FOUND; });
+
+    std::printf("misses\n");
+    timeLookups("HashSet<string>", misses, [&](const std::string& s) { return hashSet.contains(s); });
+    timeLookups("InternedStringSet", misses, [&](const std::string& s) { return interned.find(s) != InternedStringSet::NOT_FOUND; });
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+// PersistentAVLSet_Bench.cpp
+//
+// Compares two ways of giving readers a consistent view of a set that a
+// writer keeps changing: deep-copying an AVLSet under a mutex, and taking
+// a snapshot() of a PersistentAVLSet.  First it times one view of each
+// kind, and one add() into each kind of set, with no other threads
+// running.  Then it runs a writer adding elements while reader threads
+// repeatedly take a view and look up an element in it, and reports how
+// long the writer took and how many views the readers managed.
+//
+// Usage: PersistentAVLSet_Bench [elements] [reader threads]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AVLSet.hpp"
+#include "Hashing.hpp"
+#include "PersistentAVLSet.hpp"
+
+
+namespace
+{
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    unsigned int elementAt(unsigned int i)
+    {
+        return static_cast<unsigned int>(mix64(i));
+    }
+
+
+    // run() has a writer add the given elements to a set while readers take
+    // views of it with takeView(), which returns whether an element was
+    // found in the view it took.
+    template <typename Add, typename TakeView>
+    void run(const char* name, unsigned int first, unsigned int last, unsigned int readers, Add add, TakeView takeView)
+    {
+        std::atomic<bool> done{false};
+        std::atomic<unsigned long long> views{0};
+        std::vector<std::thread> threads;
+
+        for (unsigned int r = 0; r < readers; ++r)
+        {
+            threads.emplace_back(
+                [&, r]
+                {
+                    unsigned long long taken = 0;
+
+                    for (unsigned int i = r; !done.load(std::memory_order_relaxed); ++i)
+                    {
+                        takeView(elementAt(i % first));
+                        ++taken;
+                    }
+
+                    views += taken;
+                });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned int i = first; i < last; ++i)
+        {
+            add(elementAt(i));
+        }
+
+        double writerMs = elapsedMs(start);
+        done = true;
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::printf("  %-22s writer %10.2f ms   %10llu views\n", name, writerMs, views.load());
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int elements = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned int readers = argc > 2 ? std::atoi(argv[2]) : 2;
+    unsigned int added = elements / 10 > 0 ? elements / 10 : 1;
+
+    AVLSet<unsigned int> locked;
+    PersistentAVLSet<unsigned int> persistent;
+
+    for (unsigned int i = 0; i < elements; ++i)
+    {
+        locked.add(elementAt(i));
+        persistent.add(elementAt(i));
+    }
+
+    std::printf("%u elements (%u hardware threads)\n", elements, std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+    AVLSet<unsigned int> copy{locked};
+    double copyMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    PersistentAVLSet<unsigned int> snapshot = persistent.snapshot();
+    double snapshotMs = elapsedMs(start);
+
+    std::printf("  one view:   deep copy %12.4f ms   snapshot() %12.6f ms\n", copyMs, snapshotMs);
+
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = elements; i < elements + added; ++i)
+    {
+        locked.add(elementAt(i));
+    }
+
+    double lockedNs = elapsedMs(start) * 1e6 / added;
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned int i = elements; i < elements + added; ++i)
+    {
+        persistent.add(elementAt(i));
+    }
+
+    double persistentNs = elapsedMs(start) * 1e6 / added;
+
+    std::printf("  one add():  AVLSet    %12.1f ns   PersistentAVLSet %8.1f ns\n", lockedNs, persistentNs);
+    std::printf("adding %u more elements while %u readers take views\n", added, readers);
+
+    std::mutex mutex;
+
+    run("AVLSet, deep copy", elements + added, elements + 2 * added, readers,
+        [&](unsigned int element)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            locked.add(element);
+        },
+        [&](unsigned int element)
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            AVLSet<unsigned int> view{locked};
+            lock.unlock();
+            return view.contains(element);
+        });
+
+    run("PersistentAVLSet", elements + added, elements + 2 * added, readers,
+        [&](unsigned int element) { persistent.add(element); },
+        [&](unsigned int element) { return persistent.snapshot().contains(element); });
+
+    return 0;
+}
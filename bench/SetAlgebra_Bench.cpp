@@ -0,0 +1,120 @@
+// SetAlgebra_Bench.cpp
+//
+// Times setIntersection() against the obvious alternative: looping over
+// one set and calling contains() on the other.  The loop is shown both
+// ways, over the smaller set and over a.  The large set has a fixed size,
+// and the small one is a range of sizes from equal to a thousand times
+// smaller, for pairs of AVLSets and pairs of HashSets.  It then times
+// setUnion() of two large AVLSets on increasing numbers of threads.
+//
+// Usage: SetAlgebra_Bench [large set size] [max threads]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Hashing.hpp"
+#include "SetAlgebra.hpp"
+
+
+namespace
+{
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    // naiveIntersection() loops over a and looks each element up in b.
+    template <typename A, typename B>
+    std::vector<unsigned int> naiveIntersection(const A& a, const B& b)
+    {
+        std::vector<unsigned int> result;
+
+        SetTraits<A>::forEach(a,
+            [&](unsigned int element)
+            {
+                if (b.contains(element))
+                {
+                    result.push_back(element);
+                }
+            });
+
+        return result;
+    }
+
+
+    template <typename SetType>
+    void compare(const char* kind, unsigned int largeSize, unsigned int ratio, SetType& large, SetType& small)
+    {
+        for (unsigned int i = 0; i < largeSize / ratio; ++i)
+        {
+            small.add(static_cast<unsigned int>(mix64(i) % (largeSize * 2)));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::size_t found = naiveIntersection(large, small).size();
+        double largeLoopMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        found += naiveIntersection(small, large).size();
+        double smallLoopMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        found += setIntersection(large, small).size();
+        double adaptiveMs = elapsedMs(start);
+
+        std::printf("  %-8s 1:%-5u %9.2f ms %9.2f ms %9.2f ms   (%zu found)\n",
+            kind, ratio, largeLoopMs, smallLoopMs, adaptiveMs, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int largeSize = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned int maxThreads = argc > 2 ? std::atoi(argv[2]) : 8;
+
+    AVLSet<unsigned int> largeTree;
+    HashSet<unsigned int, IntegerHash> largeHash{IntegerHash{}};
+
+    for (unsigned int i = 0; i < largeSize; ++i)
+    {
+        largeTree.add(i * 2);
+        largeHash.add(i * 2);
+    }
+
+    std::printf("intersection with a set of %u elements\n", largeSize);
+    std::printf("  %-8s %-7s %12s %12s %12s\n", "", "ratio", "loop over a", "loop smaller", "adaptive");
+
+    for (unsigned int ratio : {1, 4, 16, 100, 1000})
+    {
+        AVLSet<unsigned int> smallTree;
+        compare("AVLSet", largeSize, ratio, largeTree, smallTree);
+    }
+
+    for (unsigned int ratio : {1, 16, 1000})
+    {
+        HashSet<unsigned int, IntegerHash> smallHash{IntegerHash{}};
+        compare("HashSet", largeSize, ratio, largeHash, smallHash);
+    }
+
+    AVLSet<unsigned int> otherTree;
+
+    for (unsigned int i = 0; i < largeSize; ++i)
+    {
+        otherTree.add(i * 3);
+    }
+
+    std::printf("union of two AVLSets of %u elements (%u hardware threads)\n",
+        largeSize, std::thread::hardware_concurrency());
+
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::size_t size = setUnion(largeTree, otherTree, threads).size();
+        std::printf("  %u threads  %9.2f ms   (%zu elements)\n", threads, elapsedMs(start), size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+// SmallHashSet_Bench.cpp
+//
+// Builds a large number of small sets of tags (1 to 7 tags each, 4 on
+// average), once as HashSets and once as SmallHashSets, and compares the
+// memory each kind uses per set (counting the set objects themselves and
+// every byte they allocate), how long it takes to build them all, and how
+// fast lookups into randomly chosen sets are, both hits and misses.
+//
+// Usage: SmallHashSet_Bench [sets] [lookups]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <vector>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+#include "SmallHashSet.hpp"
+
+
+namespace
+{
+    std::size_t allocatedBytes = 0;
+}
+
+
+// Every allocation in the program is counted, so that the memory used by
+// the sets can be measured as the difference before and after building
+// them.  Each block records its own size just before the memory handed
+// out, so that it can be subtracted again when the block is freed.
+
+void* operator new(std::size_t size)
+{
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    if (void* p = std::malloc(size + HEADER))
+    {
+        allocatedBytes += size;
+        *static_cast<std::size_t*>(p) = size;
+        return static_cast<char*>(p) + HEADER;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void operator delete(void* p) noexcept
+{
+    constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+    if (p != nullptr)
+    {
+        void* block = static_cast<char*>(p) - HEADER;
+        allocatedBytes -= *static_cast<std::size_t*>(block);
+        std::free(block);
+    }
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+
+namespace
+{
+    typedef HashSet<unsigned int, IntegerHash> LargeTagSet;
+    typedef SmallHashSet<unsigned int, 8, IntegerHash> SmallTagSet;
+
+
+    double elapsedNs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+
+    // tagsOf() returns the tags of the set with the given number.
+    std::vector<unsigned int> tagsOf(unsigned int set)
+    {
+        std::uint64_t bits = mix64(set);
+        std::vector<unsigned int> tags(1 + bits % 7);
+
+        for (unsigned int& tag : tags)
+        {
+            bits = mix64(bits);
+            tag = static_cast<unsigned int>(bits % 1000) * 2;
+        }
+
+        return tags;
+    }
+
+
+    template <typename SetType>
+    void run(const char* name, unsigned int setCount, unsigned int lookups)
+    {
+        std::size_t before = allocatedBytes;
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<SetType> sets(setCount, SetType{IntegerHash{}});
+
+        for (unsigned int i = 0; i < setCount; ++i)
+        {
+            for (unsigned int tag : tagsOf(i))
+            {
+                sets[i].add(tag);
+            }
+        }
+
+        double buildNs = elapsedNs(start);
+        std::size_t bytes = allocatedBytes - before;
+
+        std::vector<unsigned int> setIndexes(lookups);
+        std::vector<unsigned int> tags(lookups);
+
+        for (unsigned int i = 0; i < lookups; ++i)
+        {
+            setIndexes[i] = static_cast<unsigned int>(mix64(i) % setCount);
+            tags[i] = static_cast<unsigned int>(mix64(i + setCount) % 1000) * 2;
+        }
+
+        unsigned int found = 0;
+        start = std::chrono::steady_clock::now();
+
+        for (unsigned int i = 0; i < lookups; ++i)
+        {
+            found += sets[setIndexes[i]].contains(tags[i]) ? 1 : 0;
+        }
+
+        double hitNs = elapsedNs(start) / lookups;
+        start = std::chrono::steady_clock::now();
+
+        for (unsigned int i = 0; i < lookups; ++i)
+        {
+            found += sets[setIndexes[i]].contains(tags[i] | 1) ? 1 : 0;
+        }
+
+        double missNs = elapsedNs(start) / lookups;
+
+        std::printf("  %-14s %6.1f bytes/set   built in %6.1f ms   %5.1f ns/lookup   %5.1f ns/miss   (%u found)\n",
+            name, static_cast<double>(bytes) / setCount, buildNs / 1e6, hitNs, missNs, found);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned int sets = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    unsigned int lookups = argc > 2 ? std::atoi(argv[2]) : 10000000;
+
+    std::printf("%u sets of 1 to 7 tags (lookups mostly miss; the misses are guaranteed to)\n", sets);
+
+    run<LargeTagSet>("HashSet", sets, lookups);
+    run<SmallTagSet>("SmallHashSet", sets, lookups);
+
+    return 0;
+}
@@ -12,19 +12,112 @@
 // in your data structure.  Instead, you'll need to implement your AVL tree
 // using your own dynamically-allocated nodes, with pointers connecting them,
 // and with your own balancing algorithms used.
+//
+// Each node also records the size of its subtree, kept up to date through
+// rotations the same way heights are, which makes the tree an "order
+// statistic tree": rank(), select(), and countInRange() answer questions
+// about the elements' positions in sorted order in O(log n) time, rather
+// than by walking through the elements in order.
+//
+// Each node also points to its parent, so an AVLSet can be walked in
+// sorted order, in either direction, with an Iterator, starting anywhere:
+// at begin() or end(), or at lowerBound() or upperBound() of a given
+// element.  range() combines the two, so that visiting the k elements
+// between two bounds takes O(log n + k) time rather than O(n).  Since
+// nodes never move once they've been created, adding elements doesn't
+// invalidate any Iterators.
+//
+// The traversals -- preorder(), inorder(), and postorder() -- come in two
+// forms.  The ones taking a std::function are kept for compatibility; the
+// templated ones take any callable and call it directly, so it can be
+// inlined, and stop early if it returns false.  Both walk the tree with
+// an explicit stack rather than recursion.  Since an AVL tree's height is
+// at most about 1.44 log2 n, a stack of fixed size (MAX_HEIGHT) always
+// suffices, so no traversal allocates any memory.
+//
+// fromSorted() builds an AVLSet from sorted elements in O(n) time, rather
+// than adding them one at a time in O(n log n) time: it allocates all of
+// the nodes in one contiguous block, in sorted order, and links them into
+// a perfectly balanced tree, so that walking through the elements in
+// order also walks through memory in order.  fromUnsorted() sorts the
+// elements first (on several threads, if asked) and then does the same.
+//
+// Whole sets can be combined with the "join-based" algorithms of Blelloch,
+// Ferizovic, and Sun ("Just Join for Parallel Ordered Sets", 2016), which
+// are built on two primitives: join(), which combines two sets and an
+// element that lies between them, and split(), which divides a set at an
+// element.  uniteWith(), intersectWith(), and subtract() use them to
+// combine a set of size n with one of size m <= n in O(m log(n / m + 1))
+// time, reusing the nodes of both rather than allocating new ones, and
+// can divide the work among several threads: the two halves produced by
+// each split are independent, so they're handled simultaneously until
+// the threads are used up.  addBatch() adds many elements at once by
+// building a set of them with fromUnsorted() and uniting with it.
 
 #ifndef AVLSET_HPP
 #define AVLSET_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "IteratorException.hpp"
+#include "Parallel.hpp"
 #include "Set.hpp"
 
 
 
+// AVLSetExceptions are thrown when an AVLSet is asked for an element at a
+// position it doesn't have.
+
+class AVLSetException
+{
+public:
+    AVLSetException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline AVLSetException::AVLSetException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string AVLSetException::reason() const
+{
+    return reason_;
+}
+
+
+
 template <typename T>
 class AVLSet : public Set<T>
 {
 public:
+    class Iterator;
+    class Range;
+
+
+public:
+    // The greatest height an AVLSet can reach.  An AVL tree of height h
+    // has at least F(h + 3) - 1 nodes, where F(i) is the ith Fibonacci
+    // number, so no tree with fewer than 2^32 elements is taller than 44.
+    static constexpr int MAX_HEIGHT = 44;
+
+
     // Initializes an AVLSet to be empty.
     AVLSet();
 
@@ -45,6 +138,60 @@ public:
     AVLSet& operator=(AVLSet&& s) noexcept;
 
 
+    // fromSorted() returns an AVLSet containing the elements in the range
+    // [first, last), which must be in ascending order, though they may
+    // contain duplicates.  It runs in O(n) time, allocating the nodes in
+    // one block, and throws an AVLSetException if the elements aren't in
+    // order.  The iterators must be forward iterators.
+    template <typename ForwardIterator>
+    static AVLSet fromSorted(ForwardIterator first, ForwardIterator last);
+
+
+    // fromUnsorted() returns an AVLSet containing the elements in the
+    // range [first, last), in any order.  It copies them, sorts them using
+    // the given number of threads (or one, if it's 0), removes duplicates,
+    // and then builds the set as fromSorted() does, so it runs in
+    // O(n log n) time, but with far less work per element than adding
+    // them one at a time.
+    template <typename InputIterator>
+    static AVLSet fromUnsorted(InputIterator first, InputIterator last, unsigned int threads = 1);
+
+
+    // join() returns a set containing the elements of left, the given
+    // element, and the elements of right.  Every element of left must be
+    // less than the given element, and every element of right greater,
+    // or an AVLSetException is thrown.  It takes O(|h(left) - h(right)| +
+    // log n) time, where h is a set's height, and reuses both sets' nodes.
+    static AVLSet join(AVLSet left, const T& element, AVLSet right);
+
+
+    // split() divides a set at the given element, returning a Split with
+    // the elements less than it, whether it was in the set, and the
+    // elements greater than it.  It takes O(log n) time and reuses the
+    // set's nodes.
+    struct Split;
+    static Split split(AVLSet s, const T& element);
+
+
+    // uniteWith() adds every element of another set to this one,
+    // intersectWith() removes every element that isn't in another set,
+    // and subtract() removes every element that is.  Each takes
+    // O(m log(n / m + 1)) time, where m and n are the smaller and larger
+    // of the two sets' sizes, using the given number of threads (or one,
+    // if it's 0).  The other set's nodes are moved into (or freed by) this
+    // one, so pass it with std::move() unless it's still needed.
+    // Comparing elements must not throw.
+    void uniteWith(AVLSet other, unsigned int threads = 1);
+    void intersectWith(AVLSet other, unsigned int threads = 1);
+    void subtract(AVLSet other, unsigned int threads = 1);
+
+
+    // addBatch() adds each of the n given elements, in any order, by
+    // building a set of them with fromUnsorted() and uniting this set with
+    // it, using the given number of threads for both.
+    void addBatch(const T* elements, std::size_t n, unsigned int threads = 1);
+
+
     // isImplemented() should be modified to return true if you've
     // decided to implement an AVLSet, false otherwise.
     virtual bool isImplemented() const noexcept override;
@@ -70,6 +217,49 @@ public:
     int height() const;
 
 
+    // rank() returns the number of elements in the set that are less than
+    // the given one, which is the position the given element has (or
+    // would have) in sorted order, counting from 0.  This function always
+    // runs in O(log n) time.
+    unsigned int rank(const T& element) const;
+
+
+    // select() returns the element at the given position in sorted order,
+    // counting from 0, so that select(rank(x)) is x for every x in the set.
+    // It throws an AVLSetException if there is no such position.  This
+    // function always runs in O(log n) time.
+    const T& select(unsigned int index) const;
+
+
+    // countInRange() returns the number of elements x in the set for which
+    // lo <= x <= hi, which is zero if hi < lo.  This function always runs
+    // in O(log n) time.
+    unsigned int countInRange(const T& lo, const T& hi) const;
+
+
+    // begin() returns an Iterator referring to the smallest element, or
+    // end() if the set is empty.  end() returns an Iterator referring to
+    // the position just past the largest element.
+    Iterator begin() const noexcept;
+    Iterator end() const noexcept;
+
+
+    // lowerBound() returns an Iterator referring to the smallest element
+    // that is not less than the given one, and upperBound() one referring
+    // to the smallest element that is greater than it; either is end() if
+    // there's no such element.  These functions always run in O(log n)
+    // time.
+    Iterator lowerBound(const T& element) const;
+    Iterator upperBound(const T& element) const;
+
+
+    // range() returns the elements x for which lo <= x <= hi, which can be
+    // walked through in sorted order with a range-based for loop.  Finding
+    // where they begin and end takes O(log n) time, and each step from
+    // one to the next takes O(1) time on average.
+    Range range(const T& lo, const T& hi) const;
+
+
     // preorder() visits all of the elements in the AVL tree in preorder,
     // calling the given "visit" function and passing it each element.
     void preorder(std::function<void(const T&)> visit) const;
@@ -85,13 +275,250 @@ public:
     void postorder(std::function<void(const T&)> visit) const;
 
 
+    // These versions of preorder(), inorder(), and postorder() accept any
+    // callable taking a const T&.  If it returns bool, the traversal stops
+    // as soon as it returns false.  They return true if every element was
+    // visited, false if the traversal stopped early.
+    template <typename Visit>
+    bool preorder(Visit visit) const;
+
+    template <typename Visit>
+    bool inorder(Visit visit) const;
+
+    template <typename Visit>
+    bool postorder(Visit visit) const;
+
+
+private:
+    struct Node
+    {
+        T key;
+        Node* left;
+        Node* right;
+        Node* parent;
+        int height;
+        unsigned int size;
+    };
+
+
+public:
+    // An Iterator refers either to one of the elements of an AVLSet or to
+    // the position just past the largest one, and can be moved forward or
+    // backward in sorted order.  The elements can't be changed through it,
+    // since that could break the order they're kept in.  Moving forward
+    // from end(), moving backward from begin(), or getting the element at
+    // end() throws an IteratorException.
+    class Iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        // Initializes an Iterator that doesn't refer to any AVLSet.
+        Iterator() noexcept;
+
+        const T& operator*() const;
+        const T* operator->() const;
+
+        Iterator& operator++();
+        Iterator operator++(int);
+        Iterator& operator--();
+        Iterator operator--(int);
+
+        bool operator==(const Iterator& other) const noexcept;
+        bool operator!=(const Iterator& other) const noexcept;
+
+    private:
+        Iterator(const AVLSet* set, const Node* node) noexcept;
+
+        const AVLSet* set;
+        const Node* node;
+
+        friend class AVLSet;
+    };
+
+
+    // A Range is a pair of Iterators, first and last, referring to the
+    // elements from first up to (but not including) last.
+    class Range
+    {
+    public:
+        Range(Iterator first, Iterator last) noexcept;
+
+        Iterator begin() const noexcept;
+        Iterator end() const noexcept;
+
+    private:
+        Iterator first;
+        Iterator last;
+    };
+
+
+private:
+    // heightOf() returns the height of a subtree, which is -1 for an
+    // empty one.
+    static int heightOf(const Node* node) noexcept;
+
+    // sizeOf() returns the number of elements in a subtree.
+    static unsigned int sizeOf(const Node* node) noexcept;
+
+    // update() recomputes a node's height and subtree size from its
+    // children's.
+    static void update(Node* node) noexcept;
+
+    // leftmost() and rightmost() return the smallest and largest elements'
+    // nodes in a non-empty subtree.
+    static const Node* leftmost(const Node* node) noexcept;
+    static const Node* rightmost(const Node* node) noexcept;
+
+    // countBelow() returns the number of elements less than the given one,
+    // or less than or equal to it if inclusive is true.
+    unsigned int countBelow(const T& element, bool inclusive) const;
+
+    // rotateLeft() and rotateRight() perform a single rotation around the
+    // given node, returning the subtree's new root.
+    static Node* rotateLeft(Node* node) noexcept;
+    static Node* rotateRight(Node* node) noexcept;
+
+    // rebalance() restores the AVL property at a node whose subtrees'
+    // heights differ by at most 2, returning the subtree's new root.
+    static Node* rebalance(Node* node) noexcept;
+
+    // insert() adds the element to the given subtree, if it isn't already
+    // there, returning the subtree's new root.
+    Node* insert(Node* node, const T& element);
+
+    static Node* copy(const Node* node, Node* parent);
+
+    // A NodeBlock is the memory for nodes that fromSorted() allocated
+    // together.  Since split() can divide a tree's nodes between two sets,
+    // every set that might hold any of a block's nodes shares it, and the
+    // memory is freed once none of them does.  The nodes themselves are
+    // destroyed by whichever set holds them.
+    struct NodeBlock
+    {
+        explicit NodeBlock(std::size_t size);
+        ~NodeBlock() noexcept;
+
+        NodeBlock(const NodeBlock&) = delete;
+        NodeBlock& operator=(const NodeBlock&) = delete;
+
+        bool holds(const Node* node) const noexcept;
+
+        Node* nodes;
+        std::size_t size;
+    };
+
+    typedef std::vector<std::shared_ptr<NodeBlock>> BlockList;
+
+    // destroy() destroys every node in a subtree, and release() destroys
+    // one node; each deletes the nodes that aren't in any of the given
+    // blocks.
+    static void destroy(Node* node, const BlockList& blocks = BlockList{}) noexcept;
+    static void release(Node* node, const BlockList& blocks) noexcept;
+
+    // combineBlocks() returns the blocks in either of two lists.
+    static BlockList combineBlocks(const BlockList& a, const BlockList& b);
+
+    // attach() makes left and right a node's children, returning it.
+    static Node* attach(Node* node, Node* left, Node* right) noexcept;
+
+    // joinNodes() links a subtree whose elements are all less than the
+    // middle node's, the middle node, and one whose elements are all
+    // greater, returning the new subtree's root.  joinRight() handles the
+    // case where the left subtree is taller, descending its right spine
+    // to a subtree of about the right one's height; joinLeft() is its
+    // mirror image.  joinWithoutMiddle() joins two subtrees by using the
+    // left one's largest element as the middle.
+    static Node* joinNodes(Node* left, Node* middle, Node* right) noexcept;
+    static Node* joinRight(Node* left, Node* middle, Node* right) noexcept;
+    static Node* joinLeft(Node* left, Node* middle, Node* right) noexcept;
+    static Node* joinWithoutMiddle(Node* left, Node* right) noexcept;
+
+    // splitLast() removes the largest element's node from a non-empty
+    // subtree, storing it in last and returning what's left.
+    static Node* splitLast(Node* node, Node*& last) noexcept;
+
+    // splitNodes() divides a subtree into the elements less than and
+    // greater than the given one, returning the node holding the given
+    // element (detached from both) if there is one, nullptr otherwise.
+    static Node* splitNodes(Node* node, const T& element, Node*& less, Node*& greater);
+
+    // uniteNodes(), intersectNodes(), and subtractNodes() combine two
+    // subtrees as uniteWith(), intersectWith(), and subtract() do,
+    // releasing any nodes that aren't part of the result.
+    static Node* uniteNodes(Node* a, Node* b, const BlockList& blocks, unsigned int threads);
+    static Node* intersectNodes(Node* a, Node* b, const BlockList& blocks, unsigned int threads);
+    static Node* subtractNodes(Node* a, Node* b, const BlockList& blocks, unsigned int threads);
+
+    // forkJoin() calls left(leftThreads) and right(rightThreads),
+    // simultaneously on two threads if more than one thread is available
+    // and there are enough elements to make it worthwhile, one after the
+    // other otherwise.
+    template <typename Left, typename Right>
+    static void forkJoin(unsigned int threads, std::size_t elements, Left left, Right right);
+
+    // finish() makes the set's bookkeeping match its (new) root.
+    void finish() noexcept;
+
+    // link() links the block's nodes in [begin, end), which are in sorted
+    // order, into a perfectly balanced subtree, returning its root.
+    static Node* link(Node* nodes, std::size_t begin, std::size_t end, Node* parent) noexcept;
+
+    // sortInParallel() sorts the elements, splitting them into one run per
+    // thread, sorting the runs simultaneously, and then merging pairs of
+    // runs (also simultaneously) until one is left.
+    static void sortInParallel(std::vector<T>& elements, unsigned int threads);
+
+    // The fewest elements worth giving a thread of their own when sorting
+    // or combining sets.
+    static constexpr std::size_t MIN_ELEMENTS_PER_THREAD = 1 << 14;
+
+    // visitOne() calls a visitor on an element, returning false if the
+    // traversal should stop there.
+    template <typename Visit>
+    static bool visitOne(Visit& visit, const T& element);
+
+    // walkPreorder(), walkInorder(), and walkPostorder() traverse a tree
+    // iteratively, returning false if the visitor stopped them early.
+    template <typename Visit>
+    static bool walkPreorder(const Node* root, Visit& visit);
+
+    template <typename Visit>
+    static bool walkInorder(const Node* root, Visit& visit);
+
+    template <typename Visit>
+    static bool walkPostorder(const Node* root, Visit& visit);
+
+
 private:
+    Node* root;
+    unsigned int count;
+
+    // The blocks that any of the set's nodes might be in.  Nodes added
+    // with add() are allocated individually, as usual.
+    BlockList blocks;
+};
+
 
+
+// A Split is the result of split().
+
+template <typename T>
+struct AVLSet<T>::Split
+{
+    AVLSet<T> less;
+    bool found;
+    AVLSet<T> greater;
 };
 
 
 template <typename T>
 AVLSet<T>::AVLSet()
+    : root{nullptr}, count{0}
 {
 }
 
@@ -99,24 +526,38 @@ AVLSet<T>::AVLSet()
 template <typename T>
 AVLSet<T>::~AVLSet() noexcept
 {
+    destroy(root, blocks);
 }
 
 
 template <typename T>
 AVLSet<T>::AVLSet(const AVLSet& s)
+    : root{copy(s.root, nullptr)}, count{s.count}
 {
 }
 
 
 template <typename T>
 AVLSet<T>::AVLSet(AVLSet&& s) noexcept
+    : root{s.root}, count{s.count}, blocks{std::move(s.blocks)}
 {
+    s.root = nullptr;
+    s.count = 0;
 }
 
 
 template <typename T>
 AVLSet<T>& AVLSet<T>::operator=(const AVLSet& s)
 {
+    if (this != &s)
+    {
+        Node* newRoot = copy(s.root, nullptr);
+        destroy(root, blocks);
+        root = newRoot;
+        count = s.count;
+        blocks.clear();
+    }
+
     return *this;
 }
 
@@ -124,26 +565,211 @@ AVLSet<T>& AVLSet<T>::operator=(const AVLSet& s)
 template <typename T>
 AVLSet<T>& AVLSet<T>::operator=(AVLSet&& s) noexcept
 {
+    std::swap(root, s.root);
+    std::swap(count, s.count);
+    std::swap(blocks, s.blocks);
     return *this;
 }
 
 
+template <typename T>
+template <typename ForwardIterator>
+AVLSet<T> AVLSet<T>::fromSorted(ForwardIterator first, ForwardIterator last)
+{
+    // The first pass checks the order and counts the distinct elements,
+    // so the block can be allocated at exactly the right size.
+    std::size_t distinct = 0;
+
+    for (ForwardIterator i = first, previous = first; i != last; previous = i, ++i)
+    {
+        if (i == first || *previous < *i)
+        {
+            ++distinct;
+        }
+        else if (*i < *previous)
+        {
+            throw AVLSetException{"fromSorted() requires elements in ascending order"};
+        }
+    }
+
+    if (distinct > std::numeric_limits<unsigned int>::max())
+    {
+        throw AVLSetException{"too many elements for an AVLSet"};
+    }
+
+    AVLSet s;
+
+    if (distinct == 0)
+    {
+        return s;
+    }
+
+    std::shared_ptr<NodeBlock> block = std::make_shared<NodeBlock>(distinct);
+    Node* nodes = block->nodes;
+    std::size_t constructed = 0;
+
+    try
+    {
+        for (ForwardIterator i = first; i != last; ++i)
+        {
+            if (constructed == 0 || nodes[constructed - 1].key < *i)
+            {
+                new (&nodes[constructed]) Node{*i, nullptr, nullptr, nullptr, 0, 1};
+                ++constructed;
+            }
+        }
+    }
+    catch (...)
+    {
+        for (std::size_t i = 0; i < constructed; ++i)
+        {
+            nodes[i].~Node();
+        }
+
+        throw;
+    }
+
+    s.root = link(nodes, 0, distinct, nullptr);
+    s.count = static_cast<unsigned int>(distinct);
+    s.blocks.push_back(std::move(block));
+    return s;
+}
+
+
+template <typename T>
+template <typename InputIterator>
+AVLSet<T> AVLSet<T>::fromUnsorted(InputIterator first, InputIterator last, unsigned int threads)
+{
+    std::vector<T> elements(first, last);
+    sortInParallel(elements, threads);
+
+    auto equivalent = [](const T& a, const T& b) { return !(a < b) && !(b < a); };
+    elements.erase(std::unique(elements.begin(), elements.end(), equivalent), elements.end());
+
+    return fromSorted(std::make_move_iterator(elements.begin()), std::make_move_iterator(elements.end()));
+}
+
+
+template <typename T>
+AVLSet<T> AVLSet<T>::join(AVLSet left, const T& element, AVLSet right)
+{
+    if ((left.root != nullptr && !(rightmost(left.root)->key < element))
+        || (right.root != nullptr && !(element < leftmost(right.root)->key)))
+    {
+        throw AVLSetException{"join() requires left < element < right"};
+    }
+
+    AVLSet joined;
+    joined.blocks = combineBlocks(left.blocks, right.blocks);
+
+    Node* middle = new Node{element, nullptr, nullptr, nullptr, 0, 1};
+    joined.root = joinNodes(left.root, middle, right.root);
+    joined.finish();
+
+    left.root = nullptr;
+    right.root = nullptr;
+    return joined;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Split AVLSet<T>::split(AVLSet s, const T& element)
+{
+    Split result{AVLSet{}, false, AVLSet{}};
+    result.less.blocks = s.blocks;
+    result.greater.blocks = s.blocks;
+
+    Node* found = splitNodes(s.root, element, result.less.root, result.greater.root);
+    s.root = nullptr;
+
+    if (found != nullptr)
+    {
+        result.found = true;
+        release(found, s.blocks);
+    }
+
+    result.less.finish();
+    result.greater.finish();
+    return result;
+}
+
+
+template <typename T>
+void AVLSet<T>::uniteWith(AVLSet other, unsigned int threads)
+{
+    BlockList combined = combineBlocks(blocks, other.blocks);
+    root = uniteNodes(root, other.root, combined, threads != 0 ? threads : 1);
+    other.root = nullptr;
+    blocks = std::move(combined);
+    finish();
+}
+
+
+template <typename T>
+void AVLSet<T>::intersectWith(AVLSet other, unsigned int threads)
+{
+    BlockList combined = combineBlocks(blocks, other.blocks);
+    root = intersectNodes(root, other.root, combined, threads != 0 ? threads : 1);
+    other.root = nullptr;
+    blocks = std::move(combined);
+    finish();
+}
+
+
+template <typename T>
+void AVLSet<T>::subtract(AVLSet other, unsigned int threads)
+{
+    BlockList combined = combineBlocks(blocks, other.blocks);
+    root = subtractNodes(root, other.root, combined, threads != 0 ? threads : 1);
+    other.root = nullptr;
+    blocks = std::move(combined);
+    finish();
+}
+
+
+template <typename T>
+void AVLSet<T>::addBatch(const T* elements, std::size_t n, unsigned int threads)
+{
+    uniteWith(fromUnsorted(elements, elements + n, threads), threads);
+}
+
+
 template <typename T>
 bool AVLSet<T>::isImplemented() const noexcept
 {
-    return false;
+    return true;
 }
 
 
 template <typename T>
 void AVLSet<T>::add(const T& element)
 {
+    root = insert(root, element);
+    root->parent = nullptr;
 }
 
 
 template <typename T>
 bool AVLSet<T>::contains(const T& element) const
 {
+    const Node* node = root;
+
+    while (node != nullptr)
+    {
+        if (element < node->key)
+        {
+            node = node->left;
+        }
+        else if (node->key < element)
+        {
+            node = node->right;
+        }
+        else
+        {
+            return true;
+        }
+    }
+
     return false;
 }
 
@@ -151,32 +777,1062 @@ bool AVLSet<T>::contains(const T& element) const
 template <typename T>
 unsigned int AVLSet<T>::size() const noexcept
 {
-    return 0;
+    return count;
 }
 
 
 template <typename T>
 int AVLSet<T>::height() const
 {
-    return -1;
+    return heightOf(root);
+}
+
+
+template <typename T>
+unsigned int AVLSet<T>::rank(const T& element) const
+{
+    return countBelow(element, false);
+}
+
+
+template <typename T>
+const T& AVLSet<T>::select(unsigned int index) const
+{
+    if (index >= count)
+    {
+        throw AVLSetException{"select() index out of range"};
+    }
+
+    const Node* node = root;
+
+    while (true)
+    {
+        unsigned int leftSize = sizeOf(node->left);
+
+        if (index < leftSize)
+        {
+            node = node->left;
+        }
+        else if (index > leftSize)
+        {
+            index -= leftSize + 1;
+            node = node->right;
+        }
+        else
+        {
+            return node->key;
+        }
+    }
+}
+
+
+template <typename T>
+unsigned int AVLSet<T>::countInRange(const T& lo, const T& hi) const
+{
+    if (hi < lo)
+    {
+        return 0;
+    }
+
+    return countBelow(hi, true) - countBelow(lo, false);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::begin() const noexcept
+{
+    return Iterator{this, root != nullptr ? leftmost(root) : nullptr};
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::end() const noexcept
+{
+    return Iterator{this, nullptr};
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::lowerBound(const T& element) const
+{
+    const Node* bound = nullptr;
+    const Node* node = root;
+
+    while (node != nullptr)
+    {
+        if (node->key < element)
+        {
+            node = node->right;
+        }
+        else
+        {
+            bound = node;
+            node = node->left;
+        }
+    }
+
+    return Iterator{this, bound};
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::upperBound(const T& element) const
+{
+    const Node* bound = nullptr;
+    const Node* node = root;
+
+    while (node != nullptr)
+    {
+        if (element < node->key)
+        {
+            bound = node;
+            node = node->left;
+        }
+        else
+        {
+            node = node->right;
+        }
+    }
+
+    return Iterator{this, bound};
+}
+
+
+template <typename T>
+typename AVLSet<T>::Range AVLSet<T>::range(const T& lo, const T& hi) const
+{
+    if (hi < lo)
+    {
+        return Range{end(), end()};
+    }
+
+    return Range{lowerBound(lo), upperBound(hi)};
 }
 
 
 template <typename T>
 void AVLSet<T>::preorder(std::function<void(const T&)> visit) const
 {
+    walkPreorder(root, visit);
 }
 
 
 template <typename T>
 void AVLSet<T>::inorder(std::function<void(const T&)> visit) const
 {
+    walkInorder(root, visit);
 }
 
 
 template <typename T>
 void AVLSet<T>::postorder(std::function<void(const T&)> visit) const
 {
+    walkPostorder(root, visit);
+}
+
+
+template <typename T>
+template <typename Visit>
+bool AVLSet<T>::preorder(Visit visit) const
+{
+    return walkPreorder(root, visit);
+}
+
+
+template <typename T>
+template <typename Visit>
+bool AVLSet<T>::inorder(Visit visit) const
+{
+    return walkInorder(root, visit);
+}
+
+
+template <typename T>
+template <typename Visit>
+bool AVLSet<T>::postorder(Visit visit) const
+{
+    return walkPostorder(root, visit);
+}
+
+
+template <typename T>
+int AVLSet<T>::heightOf(const Node* node) noexcept
+{
+    return node != nullptr ? node->height : -1;
+}
+
+
+template <typename T>
+unsigned int AVLSet<T>::sizeOf(const Node* node) noexcept
+{
+    return node != nullptr ? node->size : 0;
+}
+
+
+template <typename T>
+void AVLSet<T>::update(Node* node) noexcept
+{
+    node->height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+    node->size = 1 + sizeOf(node->left) + sizeOf(node->right);
+}
+
+
+template <typename T>
+const typename AVLSet<T>::Node* AVLSet<T>::leftmost(const Node* node) noexcept
+{
+    while (node->left != nullptr)
+    {
+        node = node->left;
+    }
+
+    return node;
+}
+
+
+template <typename T>
+const typename AVLSet<T>::Node* AVLSet<T>::rightmost(const Node* node) noexcept
+{
+    while (node->right != nullptr)
+    {
+        node = node->right;
+    }
+
+    return node;
+}
+
+
+template <typename T>
+unsigned int AVLSet<T>::countBelow(const T& element, bool inclusive) const
+{
+    unsigned int below = 0;
+    const Node* node = root;
+
+    while (node != nullptr)
+    {
+        if (element < node->key)
+        {
+            node = node->left;
+        }
+        else if (node->key < element)
+        {
+            below += sizeOf(node->left) + 1;
+            node = node->right;
+        }
+        else
+        {
+            return below + sizeOf(node->left) + (inclusive ? 1 : 0);
+        }
+    }
+
+    return below;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::rotateLeft(Node* node) noexcept
+{
+    Node* newRoot = node->right;
+    node->right = newRoot->left;
+    newRoot->left = node;
+    newRoot->parent = node->parent;
+    node->parent = newRoot;
+
+    if (node->right != nullptr)
+    {
+        node->right->parent = node;
+    }
+
+    update(node);
+    update(newRoot);
+    return newRoot;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::rotateRight(Node* node) noexcept
+{
+    Node* newRoot = node->left;
+    node->left = newRoot->right;
+    newRoot->right = node;
+    newRoot->parent = node->parent;
+    node->parent = newRoot;
+
+    if (node->left != nullptr)
+    {
+        node->left->parent = node;
+    }
+
+    update(node);
+    update(newRoot);
+    return newRoot;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::rebalance(Node* node) noexcept
+{
+    update(node);
+
+    int balance = heightOf(node->left) - heightOf(node->right);
+
+    if (balance > 1)
+    {
+        // LR case: rotate the left child first, making it an LL case.
+        if (heightOf(node->left->left) < heightOf(node->left->right))
+        {
+            node->left = rotateLeft(node->left);
+        }
+
+        return rotateRight(node);
+    }
+    else if (balance < -1)
+    {
+        // RL case: rotate the right child first, making it an RR case.
+        if (heightOf(node->right->right) < heightOf(node->right->left))
+        {
+            node->right = rotateRight(node->right);
+        }
+
+        return rotateLeft(node);
+    }
+
+    return node;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::insert(Node* node, const T& element)
+{
+    if (node == nullptr)
+    {
+        Node* newNode = new Node{element, nullptr, nullptr, nullptr, 0, 1};
+        ++count;
+        return newNode;
+    }
+
+    if (element < node->key)
+    {
+        node->left = insert(node->left, element);
+        node->left->parent = node;
+    }
+    else if (node->key < element)
+    {
+        node->right = insert(node->right, element);
+        node->right->parent = node;
+    }
+    else
+    {
+        return node;
+    }
+
+    return rebalance(node);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::copy(const Node* node, Node* parent)
+{
+    if (node == nullptr)
+    {
+        return nullptr;
+    }
+
+    Node* newNode = new Node{node->key, nullptr, nullptr, parent, node->height, node->size};
+
+    try
+    {
+        newNode->left = copy(node->left, newNode);
+        newNode->right = copy(node->right, newNode);
+    }
+    catch (...)
+    {
+        destroy(newNode);
+        throw;
+    }
+
+    return newNode;
+}
+
+
+template <typename T>
+void AVLSet<T>::destroy(Node* node, const BlockList& blocks) noexcept
+{
+    if (node != nullptr)
+    {
+        destroy(node->left, blocks);
+        destroy(node->right, blocks);
+        release(node, blocks);
+    }
+}
+
+
+template <typename T>
+void AVLSet<T>::release(Node* node, const BlockList& blocks) noexcept
+{
+    for (const std::shared_ptr<NodeBlock>& block : blocks)
+    {
+        if (block->holds(node))
+        {
+            node->~Node();
+            return;
+        }
+    }
+
+    delete node;
+}
+
+
+template <typename T>
+typename AVLSet<T>::BlockList AVLSet<T>::combineBlocks(const BlockList& a, const BlockList& b)
+{
+    BlockList combined = a;
+
+    for (const std::shared_ptr<NodeBlock>& block : b)
+    {
+        if (std::find(combined.begin(), combined.end(), block) == combined.end())
+        {
+            combined.push_back(block);
+        }
+    }
+
+    return combined;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::attach(Node* node, Node* left, Node* right) noexcept
+{
+    node->left = left;
+    node->right = right;
+
+    if (left != nullptr)
+    {
+        left->parent = node;
+    }
+
+    if (right != nullptr)
+    {
+        right->parent = node;
+    }
+
+    update(node);
+    return node;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::joinNodes(Node* left, Node* middle, Node* right) noexcept
+{
+    if (heightOf(left) > heightOf(right) + 1)
+    {
+        return joinRight(left, middle, right);
+    }
+    else if (heightOf(right) > heightOf(left) + 1)
+    {
+        return joinLeft(left, middle, right);
+    }
+    else
+    {
+        return attach(middle, left, right);
+    }
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::joinRight(Node* left, Node* middle, Node* right) noexcept
+{
+    if (heightOf(left) <= heightOf(right) + 1)
+    {
+        return attach(middle, left, right);
+    }
+
+    // Joining into the right subtree makes it at most one taller than it
+    // was, so the usual rotations are enough to restore balance here.
+    attach(left, left->left, joinRight(left->right, middle, right));
+    return rebalance(left);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::joinLeft(Node* left, Node* middle, Node* right) noexcept
+{
+    if (heightOf(right) <= heightOf(left) + 1)
+    {
+        return attach(middle, left, right);
+    }
+
+    attach(right, joinLeft(left, middle, right->left), right->right);
+    return rebalance(right);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::joinWithoutMiddle(Node* left, Node* right) noexcept
+{
+    if (left == nullptr)
+    {
+        return right;
+    }
+
+    Node* last;
+    Node* rest = splitLast(left, last);
+    return joinNodes(rest, last, right);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::splitLast(Node* node, Node*& last) noexcept
+{
+    if (node->right == nullptr)
+    {
+        last = node;
+        return node->left;
+    }
+
+    Node* left = node->left;
+    Node* right = splitLast(node->right, last);
+    return joinNodes(left, node, right);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::splitNodes(Node* node, const T& element, Node*& less, Node*& greater)
+{
+    if (node == nullptr)
+    {
+        less = nullptr;
+        greater = nullptr;
+        return nullptr;
+    }
+
+    Node* left = node->left;
+    Node* right = node->right;
+
+    if (element < node->key)
+    {
+        Node* found = splitNodes(left, element, less, greater);
+        greater = joinNodes(greater, node, right);
+        return found;
+    }
+    else if (node->key < element)
+    {
+        Node* found = splitNodes(right, element, less, greater);
+        less = joinNodes(left, node, less);
+        return found;
+    }
+    else
+    {
+        less = left;
+        greater = right;
+        return node;
+    }
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::uniteNodes(Node* a, Node* b, const BlockList& blocks, unsigned int threads)
+{
+    if (a == nullptr)
+    {
+        return b;
+    }
+    else if (b == nullptr)
+    {
+        return a;
+    }
+
+    Node* less;
+    Node* greater;
+    Node* duplicate = splitNodes(b, a->key, less, greater);
+
+    if (duplicate != nullptr)
+    {
+        release(duplicate, blocks);
+    }
+
+    Node* aLeft = a->left;
+    Node* aRight = a->right;
+    Node* left;
+    Node* right;
+
+    forkJoin(threads, std::size_t{sizeOf(a)} + sizeOf(less) + sizeOf(greater),
+        [&](unsigned int t) { left = uniteNodes(aLeft, less, blocks, t); },
+        [&](unsigned int t) { right = uniteNodes(aRight, greater, blocks, t); });
+
+    return joinNodes(left, a, right);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::intersectNodes(Node* a, Node* b, const BlockList& blocks, unsigned int threads)
+{
+    if (a == nullptr || b == nullptr)
+    {
+        destroy(a, blocks);
+        destroy(b, blocks);
+        return nullptr;
+    }
+
+    Node* less;
+    Node* greater;
+    Node* duplicate = splitNodes(b, a->key, less, greater);
+
+    Node* aLeft = a->left;
+    Node* aRight = a->right;
+    Node* left;
+    Node* right;
+
+    forkJoin(threads, std::size_t{sizeOf(a)} + sizeOf(less) + sizeOf(greater),
+        [&](unsigned int t) { left = intersectNodes(aLeft, less, blocks, t); },
+        [&](unsigned int t) { right = intersectNodes(aRight, greater, blocks, t); });
+
+    if (duplicate != nullptr)
+    {
+        release(duplicate, blocks);
+        return joinNodes(left, a, right);
+    }
+
+    release(a, blocks);
+    return joinWithoutMiddle(left, right);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::subtractNodes(Node* a, Node* b, const BlockList& blocks, unsigned int threads)
+{
+    if (a == nullptr || b == nullptr)
+    {
+        destroy(b, blocks);
+        return a;
+    }
+
+    Node* less;
+    Node* greater;
+    Node* duplicate = splitNodes(a, b->key, less, greater);
+
+    if (duplicate != nullptr)
+    {
+        release(duplicate, blocks);
+    }
+
+    Node* bLeft = b->left;
+    Node* bRight = b->right;
+    release(b, blocks);
+
+    Node* left;
+    Node* right;
+
+    forkJoin(threads, std::size_t{sizeOf(less)} + sizeOf(greater) + sizeOf(bLeft) + sizeOf(bRight),
+        [&](unsigned int t) { left = subtractNodes(less, bLeft, blocks, t); },
+        [&](unsigned int t) { right = subtractNodes(greater, bRight, blocks, t); });
+
+    return joinWithoutMiddle(left, right);
+}
+
+
+template <typename T>
+template <typename Left, typename Right>
+void AVLSet<T>::forkJoin(unsigned int threads, std::size_t elements, Left left, Right right)
+{
+    if (threads <= 1 || elements < MIN_ELEMENTS_PER_THREAD)
+    {
+        left(1);
+        right(1);
+        return;
+    }
+
+    unsigned int leftThreads = threads / 2;
+    std::thread forked;
+
+    try
+    {
+        forked = std::thread{left, leftThreads};
+    }
+    catch (...)
+    {
+        // If no thread can be started, the work is simply done here.
+        left(leftThreads);
+    }
+
+    right(threads - leftThreads);
+
+    if (forked.joinable())
+    {
+        forked.join();
+    }
+}
+
+
+template <typename T>
+void AVLSet<T>::finish() noexcept
+{
+    if (root != nullptr)
+    {
+        root->parent = nullptr;
+    }
+
+    count = sizeOf(root);
+}
+
+
+template <typename T>
+typename AVLSet<T>::Node* AVLSet<T>::link(Node* nodes, std::size_t begin, std::size_t end, Node* parent) noexcept
+{
+    if (begin == end)
+    {
+        return nullptr;
+    }
+
+    std::size_t middle = begin + (end - begin) / 2;
+    Node* node = &nodes[middle];
+    node->parent = parent;
+    node->left = link(nodes, begin, middle, node);
+    node->right = link(nodes, middle + 1, end, node);
+    update(node);
+    return node;
+}
+
+
+template <typename T>
+void AVLSet<T>::sortInParallel(std::vector<T>& elements, unsigned int threads)
+{
+    std::size_t n = elements.size();
+    threads = threads != 0 ? threads : 1;
+    threads = static_cast<unsigned int>(std::min<std::size_t>(threads, n / MIN_ELEMENTS_PER_THREAD));
+
+    if (threads <= 1)
+    {
+        std::sort(elements.begin(), elements.end());
+        return;
+    }
+
+    auto runBegin = [&elements, n, threads](std::size_t run)
+    {
+        return elements.begin() + static_cast<std::ptrdiff_t>(n * run / threads);
+    };
+
+    runOnThreads(threads, [&](unsigned int t) { std::sort(runBegin(t), runBegin(t + 1)); });
+
+    // Each round merges runs [t, t + width) with [t + width, t + 2 * width).
+    for (unsigned int width = 1; width < threads; width *= 2)
+    {
+        unsigned int merges = (threads + 2 * width - 1) / (2 * width);
+
+        runOnThreads(merges,
+            [&](unsigned int m)
+            {
+                std::size_t first = std::size_t{m} * 2 * width;
+                std::size_t middle = std::min<std::size_t>(first + width, threads);
+                std::size_t last = std::min<std::size_t>(first + 2 * width, threads);
+                std::inplace_merge(runBegin(first), runBegin(middle), runBegin(last));
+            });
+    }
+}
+
+
+template <typename T>
+template <typename Visit>
+bool AVLSet<T>::visitOne(Visit& visit, const T& element)
+{
+    if constexpr (std::is_void<decltype(visit(element))>::value)
+    {
+        visit(element);
+        return true;
+    }
+    else
+    {
+        return static_cast<bool>(visit(element));
+    }
+}
+
+
+template <typename T>
+template <typename Visit>
+bool AVLSet<T>::walkPreorder(const Node* root, Visit& visit)
+{
+    // A node's right child waits on the stack while its left subtree is
+    // visited, so the stack never holds more than one node per level.
+    const Node* stack[MAX_HEIGHT + 1];
+    int depth = 0;
+
+    if (root != nullptr)
+    {
+        stack[depth++] = root;
+    }
+
+    while (depth > 0)
+    {
+        const Node* node = stack[--depth];
+
+        if (!visitOne(visit, node->key))
+        {
+            return false;
+        }
+
+        if (node->right != nullptr)
+        {
+            stack[depth++] = node->right;
+        }
+
+        if (node->left != nullptr)
+        {
+            stack[depth++] = node->left;
+        }
+    }
+
+    return true;
+}
+
+
+template <typename T>
+template <typename Visit>
+bool AVLSet<T>::walkInorder(const Node* root, Visit& visit)
+{
+    // The stack holds the ancestors whose left subtrees are being visited.
+    const Node* stack[MAX_HEIGHT + 1];
+    int depth = 0;
+    const Node* node = root;
+
+    while (node != nullptr || depth > 0)
+    {
+        while (node != nullptr)
+        {
+            stack[depth++] = node;
+            node = node->left;
+        }
+
+        node = stack[--depth];
+
+        if (!visitOne(visit, node->key))
+        {
+            return false;
+        }
+
+        node = node->right;
+    }
+
+    return true;
+}
+
+
+template <typename T>
+template <typename Visit>
+bool AVLSet<T>::walkPostorder(const Node* root, Visit& visit)
+{
+    // The stack holds the path from the root to the current node.  A node
+    // is visited once its right subtree is finished, which is when the
+    // last node visited is its right child (or it has none).
+    const Node* stack[MAX_HEIGHT + 1];
+    int depth = 0;
+    const Node* node = root;
+    const Node* lastVisited = nullptr;
+
+    while (node != nullptr || depth > 0)
+    {
+        while (node != nullptr)
+        {
+            stack[depth++] = node;
+            node = node->left;
+        }
+
+        const Node* top = stack[depth - 1];
+
+        if (top->right != nullptr && top->right != lastVisited)
+        {
+            node = top->right;
+        }
+        else
+        {
+            if (!visitOne(visit, top->key))
+            {
+                return false;
+            }
+
+            lastVisited = top;
+            --depth;
+        }
+    }
+
+    return true;
+}
+
+
+
+template <typename T>
+AVLSet<T>::NodeBlock::NodeBlock(std::size_t size)
+    : nodes{std::allocator<Node>{}.allocate(size)}, size{size}
+{
+}
+
+
+template <typename T>
+AVLSet<T>::NodeBlock::~NodeBlock() noexcept
+{
+    std::allocator<Node>{}.deallocate(nodes, size);
+}
+
+
+template <typename T>
+bool AVLSet<T>::NodeBlock::holds(const Node* node) const noexcept
+{
+    std::less<const Node*> before;
+    return !before(node, nodes) && before(node, nodes + size);
+}
+
+
+template <typename T>
+AVLSet<T>::Iterator::Iterator() noexcept
+    : set{nullptr}, node{nullptr}
+{
+}
+
+
+template <typename T>
+AVLSet<T>::Iterator::Iterator(const AVLSet* set, const Node* node) noexcept
+    : set{set}, node{node}
+{
+}
+
+
+template <typename T>
+const T& AVLSet<T>::Iterator::operator*() const
+{
+    if (node == nullptr)
+    {
+        throw IteratorException{};
+    }
+
+    return node->key;
+}
+
+
+template <typename T>
+const T* AVLSet<T>::Iterator::operator->() const
+{
+    return &**this;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator& AVLSet<T>::Iterator::operator++()
+{
+    if (node == nullptr)
+    {
+        throw IteratorException{};
+    }
+
+    // The next element is the smallest one in the right subtree, if there
+    // is one; otherwise, it's the nearest ancestor whose left subtree
+    // this node is in.
+    if (node->right != nullptr)
+    {
+        node = leftmost(node->right);
+    }
+    else
+    {
+        const Node* child = node;
+        node = node->parent;
+
+        while (node != nullptr && child == node->right)
+        {
+            child = node;
+            node = node->parent;
+        }
+    }
+
+    return *this;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::Iterator::operator++(int)
+{
+    Iterator old = *this;
+    ++*this;
+    return old;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator& AVLSet<T>::Iterator::operator--()
+{
+    if (node == nullptr)
+    {
+        if (set == nullptr || set->root == nullptr)
+        {
+            throw IteratorException{};
+        }
+
+        node = rightmost(set->root);
+    }
+    else if (node->left != nullptr)
+    {
+        node = rightmost(node->left);
+    }
+    else
+    {
+        const Node* child = node;
+        const Node* ancestor = node->parent;
+
+        while (ancestor != nullptr && child == ancestor->left)
+        {
+            child = ancestor;
+            ancestor = ancestor->parent;
+        }
+
+        if (ancestor == nullptr)
+        {
+            throw IteratorException{};
+        }
+
+        node = ancestor;
+    }
+
+    return *this;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::Iterator::operator--(int)
+{
+    Iterator old = *this;
+    --*this;
+    return old;
+}
+
+
+template <typename T>
+bool AVLSet<T>::Iterator::operator==(const Iterator& other) const noexcept
+{
+    return set == other.set && node == other.node;
+}
+
+
+template <typename T>
+bool AVLSet<T>::Iterator::operator!=(const Iterator& other) const noexcept
+{
+    return !(*this == other);
+}
+
+
+template <typename T>
+AVLSet<T>::Range::Range(Iterator first, Iterator last) noexcept
+    : first{first}, last{last}
+{
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::Range::begin() const noexcept
+{
+    return first;
+}
+
+
+template <typename T>
+typename AVLSet<T>::Iterator AVLSet<T>::Range::end() const noexcept
+{
+    return last;
 }
 
 
@@ -0,0 +1,788 @@
+// ArenaAVLSet.hpp
+//
+// An ArenaAVLSet is an implementation of a Set that is an AVL tree, like
+// AVLSet, but with its nodes stored in an "arena" rather than allocated
+// one at a time, so that a node costs little more than its element:
+//
+// * The nodes live in chunks of CHUNK_SIZE nodes each, allocated as the
+//   tree grows.  Chunks never move once allocated, and a node is named by
+//   its 32-bit index (chunk number times CHUNK_SIZE plus position within
+//   the chunk) rather than by a 64-bit pointer.
+//
+// * Each node holds its element and the indices of its two children, and
+//   nothing else.  Instead of a height, the node keeps its balance factor
+//   (the height of its right subtree minus that of its left, which in an
+//   AVL tree is always -1, 0, or +1), packed into the two high bits of its
+//   left child's index.  That leaves 30 bits for indices, so an
+//   ArenaAVLSet holds at most MAX_SIZE elements.
+//
+// * Removed nodes are linked into a free list, and add() reuses them
+//   before taking new ones from the last chunk.
+//
+// For an ArenaAVLSet<std::uint32_t>, a node is 12 bytes, where an AVLSet
+// node is 40 bytes plus the allocator's own overhead.  The trade-offs are
+// that an ArenaAVLSet has no parent links (so no iterators), and that its
+// chunks stay allocated until the set is cleared or destroyed, even if
+// most of their nodes are on the free list.
+
+#ifndef ARENAAVLSET_HPP
+#define ARENAAVLSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Set.hpp"
+
+
+
+// ArenaAVLSetExceptions are thrown when an ArenaAVLSet would need more
+// than MAX_SIZE nodes.
+
+class ArenaAVLSetException
+{
+public:
+    ArenaAVLSetException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline ArenaAVLSetException::ArenaAVLSetException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string ArenaAVLSetException::reason() const
+{
+    return reason_;
+}
+
+
+
+template <typename T>
+class ArenaAVLSet : public Set<T>
+{
+public:
+    // The number of nodes in each chunk of the arena.
+    static constexpr std::uint32_t CHUNK_SIZE = 4096;
+
+    // The most elements an ArenaAVLSet can hold: every 30-bit index except
+    // the one reserved to mean "no node".
+    static constexpr std::uint32_t MAX_SIZE = (std::uint32_t{1} << 30) - 1;
+
+
+    // Initializes an ArenaAVLSet to be empty.
+    ArenaAVLSet();
+
+    // Cleans up the ArenaAVLSet so that it leaks no memory.
+    virtual ~ArenaAVLSet() noexcept;
+
+    // Initializes a new ArenaAVLSet to be a copy of an existing one.
+    // The copy has the same shape and the same indices, so it takes O(n)
+    // time and no comparisons.
+    ArenaAVLSet(const ArenaAVLSet& s);
+
+    // Initializes a new ArenaAVLSet whose contents are moved from an
+    // expiring one.
+    ArenaAVLSet(ArenaAVLSet&& s) noexcept;
+
+    // Assigns an existing ArenaAVLSet into another.
+    ArenaAVLSet& operator=(const ArenaAVLSet& s);
+
+    // Assigns an expiring ArenaAVLSet into another.
+    ArenaAVLSet& operator=(ArenaAVLSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  It takes O(log n) time, reusing a
+    // removed node if there is one, and throws an ArenaAVLSetException if
+    // the set already holds MAX_SIZE elements.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  It takes O(log n) time.
+    virtual bool contains(const T& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // remove() removes an element from the set, returning true if it was
+    // there and false otherwise.  Its node goes onto the free list.  It
+    // takes O(log n) time.
+    bool remove(const T& element);
+
+
+    // clear() removes every element and frees every chunk.
+    void clear() noexcept;
+
+
+    // height() returns the height of the AVL tree, which is -1 when it's
+    // empty.  Since the nodes store balance factors rather than heights,
+    // this follows the taller child down from the root, in O(log n) time.
+    int height() const noexcept;
+
+
+    // inorder() visits all of the elements in ascending order, calling the
+    // given function on each.  If it returns bool, the traversal stops as
+    // soon as it returns false.  It returns true if every element was
+    // visited, false if the traversal stopped early.
+    template <typename Visit>
+    bool inorder(Visit visit) const;
+
+
+    // bytesUsed() returns the number of bytes of memory the set's chunks
+    // and its table of chunks occupy.
+    std::size_t bytesUsed() const noexcept;
+
+
+private:
+    struct Node
+    {
+        T key;
+        std::uint32_t left;
+        std::uint32_t right;
+    };
+
+    // The low 30 bits of a node's left field are its left child's index,
+    // and the high 2 bits are its balance factor plus one.  A free node
+    // has FREE_MARK there instead, and its right field links it to the
+    // next free node.
+    static constexpr std::uint32_t NONE = MAX_SIZE;
+    static constexpr std::uint32_t INDEX_MASK = (std::uint32_t{1} << 30) - 1;
+    static constexpr int BALANCE_SHIFT = 30;
+    static constexpr std::uint32_t FREE_MARK = std::uint32_t{3} << BALANCE_SHIFT;
+    static constexpr std::uint32_t CHUNK_SHIFT = 12;
+
+    static_assert(CHUNK_SIZE == std::uint32_t{1} << CHUNK_SHIFT, "CHUNK_SIZE must be 2^CHUNK_SHIFT");
+
+    Node& node(std::uint32_t index) noexcept;
+    const Node& node(std::uint32_t index) const noexcept;
+
+    std::uint32_t leftOf(std::uint32_t index) const noexcept;
+    std::uint32_t rightOf(std::uint32_t index) const noexcept;
+    int balanceOf(std::uint32_t index) const noexcept;
+
+    void setLeft(std::uint32_t index, std::uint32_t left) noexcept;
+    void setRight(std::uint32_t index, std::uint32_t right) noexcept;
+    void setBalance(std::uint32_t index, int balance) noexcept;
+
+    // allocate() returns the index of an unused node holding a copy of the
+    // given element, with no children and a balance factor of 0, and
+    // release() destroys a node's element and puts it on the free list.
+    std::uint32_t allocate(const T& element);
+    void release(std::uint32_t index) noexcept;
+
+    // rotateLeft() and rotateRight() perform a single rotation around the
+    // given node, returning the subtree's new root.  They leave balance
+    // factors alone.
+    std::uint32_t rotateLeft(std::uint32_t index) noexcept;
+    std::uint32_t rotateRight(std::uint32_t index) noexcept;
+
+    // rebalance() restores the AVL property at a node whose balance factor
+    // has become -2 or +2, which is passed in because it doesn't fit in
+    // the node's two bits, and returns the subtree's new root with every
+    // affected balance factor set.
+    std::uint32_t rebalance(std::uint32_t index, int balance) noexcept;
+
+    // insert() adds the element to the given subtree, if it isn't already
+    // there, returning the subtree's new root and setting grew to whether
+    // its height increased.
+    std::uint32_t insert(std::uint32_t index, const T& element, bool& grew);
+
+    // erase() removes the element from the given subtree, if it's there,
+    // returning the subtree's new root, setting removed to whether it was
+    // there, and setting shrank to whether the subtree's height decreased.
+    std::uint32_t erase(std::uint32_t index, const T& element, bool& removed, bool& shrank);
+
+    // eraseMinimum() detaches the smallest element's node from a non-empty
+    // subtree, storing its index in minimum and returning the new root.
+    std::uint32_t eraseMinimum(std::uint32_t index, std::uint32_t& minimum, bool& shrank) noexcept;
+
+    // leftShrank() and rightShrank() update a node's balance factor after
+    // one of its subtrees got shorter, returning the subtree's new root and
+    // setting shrank to whether the whole subtree got shorter.
+    std::uint32_t leftShrank(std::uint32_t index, bool& shrank) noexcept;
+    std::uint32_t rightShrank(std::uint32_t index, bool& shrank) noexcept;
+
+    // destroyAll() destroys every element and frees every chunk.
+    void destroyAll() noexcept;
+
+
+private:
+    std::vector<Node*> chunks;
+    std::uint32_t used;
+    std::uint32_t freeList;
+    std::uint32_t root;
+    unsigned int count;
+};
+
+
+
+template <typename T>
+ArenaAVLSet<T>::ArenaAVLSet()
+    : used{0}, freeList{NONE}, root{NONE}, count{0}
+{
+}
+
+
+template <typename T>
+ArenaAVLSet<T>::~ArenaAVLSet() noexcept
+{
+    destroyAll();
+}
+
+
+template <typename T>
+ArenaAVLSet<T>::ArenaAVLSet(const ArenaAVLSet& s)
+    : used{0}, freeList{s.freeList}, root{s.root}, count{s.count}
+{
+    chunks.reserve(s.chunks.size());
+
+    try
+    {
+        for (std::size_t c = 0; c < s.chunks.size(); ++c)
+        {
+            chunks.push_back(std::allocator<Node>{}.allocate(CHUNK_SIZE));
+        }
+
+        // Every node, free or not, keeps its index, so the links are
+        // copied as they are; only the live nodes' elements are copied.
+        for (; used < s.used; ++used)
+        {
+            const Node& source = s.node(used);
+
+            if (source.left == FREE_MARK)
+            {
+                Node* target = &node(used);
+                target->left = FREE_MARK;
+                target->right = source.right;
+            }
+            else
+            {
+                new (&node(used)) Node{source.key, source.left, source.right};
+            }
+        }
+    }
+    catch (...)
+    {
+        destroyAll();
+        throw;
+    }
+}
+
+
+template <typename T>
+ArenaAVLSet<T>::ArenaAVLSet(ArenaAVLSet&& s) noexcept
+    : chunks{std::move(s.chunks)}, used{s.used}, freeList{s.freeList}, root{s.root}, count{s.count}
+{
+    s.chunks.clear();
+    s.used = 0;
+    s.freeList = NONE;
+    s.root = NONE;
+    s.count = 0;
+}
+
+
+template <typename T>
+ArenaAVLSet<T>& ArenaAVLSet<T>::operator=(const ArenaAVLSet& s)
+{
+    if (this != &s)
+    {
+        ArenaAVLSet copy{s};
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename T>
+ArenaAVLSet<T>& ArenaAVLSet<T>::operator=(ArenaAVLSet&& s) noexcept
+{
+    std::swap(chunks, s.chunks);
+    std::swap(used, s.used);
+    std::swap(freeList, s.freeList);
+    std::swap(root, s.root);
+    std::swap(count, s.count);
+    return *this;
+}
+
+
+template <typename T>
+bool ArenaAVLSet<T>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T>
+void ArenaAVLSet<T>::add(const T& element)
+{
+    bool grew;
+    root = insert(root, element, grew);
+}
+
+
+template <typename T>
+bool ArenaAVLSet<T>::contains(const T& element) const
+{
+    std::uint32_t index = root;
+
+    while (index != NONE)
+    {
+        const Node& current = node(index);
+
+        if (element < current.key)
+        {
+            index = current.left & INDEX_MASK;
+        }
+        else if (current.key < element)
+        {
+            index = current.right;
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename T>
+unsigned int ArenaAVLSet<T>::size() const noexcept
+{
+    return count;
+}
+
+
+template <typename T>
+bool ArenaAVLSet<T>::remove(const T& element)
+{
+    bool removed = false;
+    bool shrank;
+    root = erase(root, element, removed, shrank);
+    return removed;
+}
+
+
+template <typename T>
+void ArenaAVLSet<T>::clear() noexcept
+{
+    destroyAll();
+}
+
+
+template <typename T>
+int ArenaAVLSet<T>::height() const noexcept
+{
+    int height = -1;
+
+    for (std::uint32_t index = root; index != NONE; ++height)
+    {
+        index = balanceOf(index) > 0 ? rightOf(index) : leftOf(index);
+    }
+
+    return height;
+}
+
+
+template <typename T>
+template <typename Visit>
+bool ArenaAVLSet<T>::inorder(Visit visit) const
+{
+    // An AVL tree with fewer than 2^30 nodes is no taller than 42, so the
+    // path from the root always fits.
+    std::uint32_t stack[48];
+    int depth = 0;
+    std::uint32_t index = root;
+
+    while (index != NONE || depth > 0)
+    {
+        while (index != NONE)
+        {
+            stack[depth++] = index;
+            index = leftOf(index);
+        }
+
+        index = stack[--depth];
+
+        if constexpr (std::is_void<decltype(visit(node(index).key))>::value)
+        {
+            visit(node(index).key);
+        }
+        else if (!visit(node(index).key))
+        {
+            return false;
+        }
+
+        index = rightOf(index);
+    }
+
+    return true;
+}
+
+
+template <typename T>
+std::size_t ArenaAVLSet<T>::bytesUsed() const noexcept
+{
+    return chunks.size() * (CHUNK_SIZE * sizeof(Node)) + chunks.capacity() * sizeof(Node*);
+}
+
+
+template <typename T>
+typename ArenaAVLSet<T>::Node& ArenaAVLSet<T>::node(std::uint32_t index) noexcept
+{
+    return chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)];
+}
+
+
+template <typename T>
+const typename ArenaAVLSet<T>::Node& ArenaAVLSet<T>::node(std::uint32_t index) const noexcept
+{
+    return chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)];
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::leftOf(std::uint32_t index) const noexcept
+{
+    return node(index).left & INDEX_MASK;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::rightOf(std::uint32_t index) const noexcept
+{
+    return node(index).right;
+}
+
+
+template <typename T>
+int ArenaAVLSet<T>::balanceOf(std::uint32_t index) const noexcept
+{
+    return static_cast<int>(node(index).left >> BALANCE_SHIFT) - 1;
+}
+
+
+template <typename T>
+void ArenaAVLSet<T>::setLeft(std::uint32_t index, std::uint32_t left) noexcept
+{
+    Node& n = node(index);
+    n.left = (n.left & ~INDEX_MASK) | left;
+}
+
+
+template <typename T>
+void ArenaAVLSet<T>::setRight(std::uint32_t index, std::uint32_t right) noexcept
+{
+    node(index).right = right;
+}
+
+
+template <typename T>
+void ArenaAVLSet<T>::setBalance(std::uint32_t index, int balance) noexcept
+{
+    Node& n = node(index);
+    n.left = (n.left & INDEX_MASK) | (static_cast<std::uint32_t>(balance + 1) << BALANCE_SHIFT);
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::allocate(const T& element)
+{
+    std::uint32_t index;
+
+    if (freeList != NONE)
+    {
+        index = freeList;
+        std::uint32_t next = node(index).right;
+        new (&node(index)) Node{element, NONE | (std::uint32_t{1} << BALANCE_SHIFT), NONE};
+        freeList = next;
+    }
+    else
+    {
+        if (used == MAX_SIZE)
+        {
+            throw ArenaAVLSetException{"an ArenaAVLSet can't hold more than MAX_SIZE elements"};
+        }
+
+        if (used == chunks.size() * CHUNK_SIZE)
+        {
+            chunks.reserve(chunks.size() + 1);
+            chunks.push_back(std::allocator<Node>{}.allocate(CHUNK_SIZE));
+        }
+
+        index = used;
+        new (&node(index)) Node{element, NONE | (std::uint32_t{1} << BALANCE_SHIFT), NONE};
+        ++used;
+    }
+
+    ++count;
+    return index;
+}
+
+
+template <typename T>
+void ArenaAVLSet<T>::release(std::uint32_t index) noexcept
+{
+    Node& n = node(index);
+    n.key.~T();
+    n.left = FREE_MARK;
+    n.right = freeList;
+    freeList = index;
+    --count;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::rotateLeft(std::uint32_t index) noexcept
+{
+    std::uint32_t newRoot = rightOf(index);
+    setRight(index, leftOf(newRoot));
+    setLeft(newRoot, index);
+    return newRoot;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::rotateRight(std::uint32_t index) noexcept
+{
+    std::uint32_t newRoot = leftOf(index);
+    setLeft(index, rightOf(newRoot));
+    setRight(newRoot, index);
+    return newRoot;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::rebalance(std::uint32_t index, int balance) noexcept
+{
+    // The new balance factors are worked out case by case, rather than
+    // by rotating one step at a time, since a double rotation's middle
+    // step can leave a node two out of balance, which couldn't be stored.
+    int side = balance < 0 ? -1 : 1;
+    std::uint32_t child = side < 0 ? leftOf(index) : rightOf(index);
+    int childBalance = balanceOf(child);
+
+    if (childBalance != -side)
+    {
+        // LL or RR case.  The child is balanced only after a removal, in
+        // which case the subtree stays as tall as it was.
+        std::uint32_t newRoot = side < 0 ? rotateRight(index) : rotateLeft(index);
+        setBalance(index, childBalance == 0 ? side : 0);
+        setBalance(newRoot, childBalance == 0 ? -side : 0);
+        return newRoot;
+    }
+
+    // LR or RL case: the grandchild on the inside becomes the new root.
+    std::uint32_t grandchild = side < 0 ? rightOf(child) : leftOf(child);
+    int grandchildBalance = balanceOf(grandchild);
+
+    if (side < 0)
+    {
+        setLeft(index, rotateLeft(child));
+        rotateRight(index);
+    }
+    else
+    {
+        setRight(index, rotateRight(child));
+        rotateLeft(index);
+    }
+
+    setBalance(index, grandchildBalance == side ? -side : 0);
+    setBalance(child, grandchildBalance == -side ? side : 0);
+    setBalance(grandchild, 0);
+    return grandchild;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::insert(std::uint32_t index, const T& element, bool& grew)
+{
+    if (index == NONE)
+    {
+        grew = true;
+        return allocate(element);
+    }
+
+    int balance;
+
+    if (element < node(index).key)
+    {
+        setLeft(index, insert(leftOf(index), element, grew));
+        balance = balanceOf(index) - (grew ? 1 : 0);
+    }
+    else if (node(index).key < element)
+    {
+        setRight(index, insert(rightOf(index), element, grew));
+        balance = balanceOf(index) + (grew ? 1 : 0);
+    }
+    else
+    {
+        grew = false;
+        return index;
+    }
+
+    if (!grew)
+    {
+        return index;
+    }
+
+    // The subtree grew only if it was balanced before and leans now; a
+    // rotation always brings it back to its old height.
+    if (balance == -2 || balance == 2)
+    {
+        grew = false;
+        return rebalance(index, balance);
+    }
+
+    setBalance(index, balance);
+    grew = balance != 0;
+    return index;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::erase(std::uint32_t index, const T& element, bool& removed, bool& shrank)
+{
+    if (index == NONE)
+    {
+        removed = false;
+        shrank = false;
+        return NONE;
+    }
+
+    if (element < node(index).key)
+    {
+        setLeft(index, erase(leftOf(index), element, removed, shrank));
+        return shrank ? leftShrank(index, shrank) : index;
+    }
+    else if (node(index).key < element)
+    {
+        setRight(index, erase(rightOf(index), element, removed, shrank));
+        return shrank ? rightShrank(index, shrank) : index;
+    }
+
+    removed = true;
+    std::uint32_t left = leftOf(index);
+    std::uint32_t right = rightOf(index);
+
+    if (left == NONE || right == NONE)
+    {
+        release(index);
+        shrank = true;
+        return left != NONE ? left : right;
+    }
+
+    // The node's successor, the smallest element in its right subtree,
+    // takes its place; the nodes move, rather than the elements.
+    std::uint32_t successor;
+    right = eraseMinimum(right, successor, shrank);
+
+    node(successor).left = node(index).left;
+    setRight(successor, right);
+    release(index);
+
+    return shrank ? rightShrank(successor, shrank) : successor;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::eraseMinimum(std::uint32_t index, std::uint32_t& minimum, bool& shrank) noexcept
+{
+    if (leftOf(index) == NONE)
+    {
+        minimum = index;
+        shrank = true;
+        return rightOf(index);
+    }
+
+    setLeft(index, eraseMinimum(leftOf(index), minimum, shrank));
+    return shrank ? leftShrank(index, shrank) : index;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::leftShrank(std::uint32_t index, bool& shrank) noexcept
+{
+    int balance = balanceOf(index) + 1;
+
+    if (balance == 2)
+    {
+        // Rotating shortens the subtree unless the right child was
+        // balanced, in which case the new root leans left afterward.
+        std::uint32_t newRoot = rebalance(index, balance);
+        shrank = balanceOf(newRoot) == 0;
+        return newRoot;
+    }
+
+    setBalance(index, balance);
+    shrank = balance == 0;
+    return index;
+}
+
+
+template <typename T>
+std::uint32_t ArenaAVLSet<T>::rightShrank(std::uint32_t index, bool& shrank) noexcept
+{
+    int balance = balanceOf(index) - 1;
+
+    if (balance == -2)
+    {
+        std::uint32_t newRoot = rebalance(index, balance);
+        shrank = balanceOf(newRoot) == 0;
+        return newRoot;
+    }
+
+    setBalance(index, balance);
+    shrank = balance == 0;
+    return index;
+}
+
+
+template <typename T>
+void ArenaAVLSet<T>::destroyAll() noexcept
+{
+    if (!std::is_trivially_destructible<T>::value)
+    {
+        for (std::uint32_t index = 0; index < used; ++index)
+        {
+            if (node(index).left != FREE_MARK)
+            {
+                node(index).key.~T();
+            }
+        }
+    }
+
+    for (Node* chunk : chunks)
+    {
+        std::allocator<Node>{}.deallocate(chunk, CHUNK_SIZE);
+    }
+
+    std::vector<Node*>{}.swap(chunks);
+    used = 0;
+    freeList = NONE;
+    root = NONE;
+    count = 0;
+}
+
+
+
+#endif // ARENAAVLSET_HPP
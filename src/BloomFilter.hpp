@@ -0,0 +1,285 @@
+// BloomFilter.hpp
+//
+// A BloomFilter answers the question "might this element have been added?"
+// using a small, fixed amount of memory.  Its answers are never false
+// negatives: if an element was added, mayContain() always returns true.
+// But they can be false positives, with a rate that's chosen when the
+// filter is constructed, in exchange for memory.
+//
+// This is a "split block" Bloom filter.  The filter is an array of 256-bit
+// blocks, each made up of eight 32-bit words.  An element's hash chooses
+// one block, and then sets (or tests) exactly one bit in each of the
+// block's eight words.  Every probe touches a single cache line, and the
+// eight bit positions are computed and tested independently, which maps
+// directly onto one 256-bit SIMD operation: when compiled with AVX2, that's
+// how probes are done, and otherwise the compiler is left to vectorize a
+// simple loop.
+//
+// BloomFilters don't hash elements themselves; they're given 64-bit hashes
+// whose bits are all well-mixed (e.g., from mix64() in Hashing.hpp).
+
+#ifndef BLOOMFILTER_HPP
+#define BLOOMFILTER_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+
+// BloomFilterExceptions are thrown when a BloomFilter is asked for a false
+// positive rate it can't provide.
+
+class BloomFilterException
+{
+public:
+    BloomFilterException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline BloomFilterException::BloomFilterException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string BloomFilterException::reason() const
+{
+    return reason_;
+}
+
+
+
+class BloomFilter
+{
+public:
+    // The most blocks a BloomFilter can have, since a block is chosen by
+    // 32 bits of the hash.
+    static constexpr std::size_t MAX_BLOCKS = std::size_t{1} << 32;
+
+
+    // Initializes an empty BloomFilter sized so that, once the expected
+    // number of elements has been added, the false positive rate is no
+    // more than the given one.  Adding more elements than expected is
+    // allowed, but the rate climbs as the filter fills.  It throws a
+    // BloomFilterException if the rate isn't strictly between 0 and 1, or
+    // if reaching it would take more than MAX_BLOCKS blocks.
+    BloomFilter(unsigned int expectedElements, double falsePositiveRate);
+
+
+    // add() records the element with the given hash.  It always succeeds,
+    // so it always returns true.
+    bool add(std::uint64_t hash) noexcept;
+
+
+    // mayContain() returns false if the element with the given hash was
+    // definitely never added, true if it might have been.
+    bool mayContain(std::uint64_t hash) const noexcept;
+
+
+    // clear() forgets every element that has been added.
+    void clear() noexcept;
+
+
+    // sizeInBits() returns the amount of memory used by the filter's bits.
+    std::size_t sizeInBits() const noexcept;
+
+
+    // falsePositiveRate() returns the expected false positive rate once
+    // the given number of elements have been added.
+    double falsePositiveRate(unsigned int elements) const;
+
+
+private:
+    struct alignas(32) Block
+    {
+        std::uint32_t words[8];
+    };
+
+    // blockFor() chooses the block for a hash using its high 32 bits;
+    // the low 32 bits choose the bits within the block.
+    std::size_t blockFor(std::uint64_t hash) const noexcept;
+
+    // rateFor() returns the expected false positive rate of a filter with
+    // the given number of blocks after the given number of elements.
+    static double rateFor(double elements, std::size_t blocks);
+
+
+private:
+    std::vector<Block> blocks;
+};
+
+
+
+namespace BloomFilterSalts
+{
+    // Each word's bit is chosen by multiplying the hash by a different odd
+    // constant and keeping the top 5 bits of the product.
+    alignas(32) constexpr std::uint32_t SALTS[8] =
+    {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+    };
+}
+
+
+inline BloomFilter::BloomFilter(unsigned int expectedElements, double falsePositiveRate)
+{
+    // This is written so that NaN is rejected, too.
+    if (!(falsePositiveRate > 0.0 && falsePositiveRate < 1.0))
+    {
+        throw BloomFilterException{"false positive rate must be between 0 and 1"};
+    }
+
+    // The rate falls as blocks are added, so find enough blocks by
+    // doubling and then narrow it down by binary search.
+    std::size_t high = 1;
+
+    while (rateFor(expectedElements, high) > falsePositiveRate)
+    {
+        if (high == MAX_BLOCKS)
+        {
+            throw BloomFilterException{"false positive rate is too low for the expected number of elements"};
+        }
+
+        high *= 2;
+    }
+
+    std::size_t low = high / 2 + 1;
+
+    while (low < high)
+    {
+        std::size_t middle = low + (high - low) / 2;
+
+        if (rateFor(expectedElements, middle) > falsePositiveRate)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    blocks.assign(high, Block{});
+}
+
+
+inline bool BloomFilter::add(std::uint64_t hash) noexcept
+{
+    Block& block = blocks[blockFor(hash)];
+    std::uint32_t key = static_cast<std::uint32_t>(hash);
+
+#if defined(__AVX2__)
+    __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i*>(BloomFilterSalts::SALTS));
+    __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salts), 27);
+    __m256i bits = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+    __m256i* words = reinterpret_cast<__m256i*>(block.words);
+    _mm256_store_si256(words, _mm256_or_si256(_mm256_load_si256(words), bits));
+#else
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        block.words[i] |= std::uint32_t{1} << ((key * BloomFilterSalts::SALTS[i]) >> 27);
+    }
+#endif
+
+    return true;
+}
+
+
+inline bool BloomFilter::mayContain(std::uint64_t hash) const noexcept
+{
+    const Block& block = blocks[blockFor(hash)];
+    std::uint32_t key = static_cast<std::uint32_t>(hash);
+
+#if defined(__AVX2__)
+    __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i*>(BloomFilterSalts::SALTS));
+    __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salts), 27);
+    __m256i bits = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+    __m256i words = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.words));
+
+    // testc is true when every bit set in "bits" is also set in "words".
+    return _mm256_testc_si256(words, bits) != 0;
+#else
+    std::uint32_t missing = 0;
+
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        std::uint32_t bit = std::uint32_t{1} << ((key * BloomFilterSalts::SALTS[i]) >> 27);
+        missing |= bit & ~block.words[i];
+    }
+
+    return missing == 0;
+#endif
+}
+
+
+inline void BloomFilter::clear() noexcept
+{
+    for (Block& block : blocks)
+    {
+        block = Block{};
+    }
+}
+
+
+inline std::size_t BloomFilter::sizeInBits() const noexcept
+{
+    return blocks.size() * sizeof(Block) * 8;
+}
+
+
+inline double BloomFilter::falsePositiveRate(unsigned int elements) const
+{
+    return rateFor(elements, blocks.size());
+}
+
+
+inline std::size_t BloomFilter::blockFor(std::uint64_t hash) const noexcept
+{
+    // Multiplying and keeping the high half maps the 32-bit value onto
+    // [0, blocks) without a division.
+    return static_cast<std::size_t>(((hash >> 32) * blocks.size()) >> 32);
+}
+
+
+inline double BloomFilter::rateFor(double elements, std::size_t blocks)
+{
+    // The number of elements that land in a block is Poisson-distributed.
+    // A block holding j elements has each of a word's 32 bits set with
+    // probability 1 - (31/32)^j, and a false positive needs all eight of
+    // the probed bits set.  Summing over j gives the expected rate.
+    // (The Poisson probabilities are computed in log space, since e^-lambda
+    // underflows when the filter is far too small.)
+    double lambda = elements / static_cast<double>(blocks);
+    double spread = 12.0 * std::sqrt(lambda) + 20.0;
+    double first = lambda > spread ? std::floor(lambda - spread) : 0.0;
+    double rate = 0.0;
+
+    for (double j = first; j <= lambda + spread; j += 1.0)
+    {
+        double probability = lambda > 0.0
+            ? std::exp(j * std::log(lambda) - lambda - std::lgamma(j + 1.0))
+            : (j == 0.0 ? 1.0 : 0.0);
+
+        rate += probability * std::pow(1.0 - std::pow(31.0 / 32.0, j), 8);
+    }
+
+    return rate;
+}
+
+
+
+#endif // BLOOMFILTER_HPP
+
@@ -0,0 +1,724 @@
+// CompactHashSet.hpp
+//
+// A CompactHashSet is an implementation of a Set laid out the way Python
+// lays out its dictionaries.  Rather than a linked list per cell, there are
+// two arrays:
+//
+// * The entries array holds the elements (each with its hash) densely, in
+//   the order they were added.  Iterating over the set is a linear scan of
+//   this array, so elements come out in insertion order.
+//
+// * The index array is an open-addressed hash table whose cells hold only
+//   positions in the entries array.  Its capacity is a power of two, and
+//   its cells are as small as the entries array allows: one byte while
+//   there are fewer than 254 entries, two while there are fewer than 65534,
+//   and four beyond that.  Collisions are resolved by probing a sequence
+//   of cells that mixes in more of the hash's bits as it goes (the same
+//   "perturbed" sequence Python uses), so poor low bits don't cause long
+//   runs of probes.
+//
+// The entries array has room for two thirds as many entries as the index
+// array has cells, which keeps the index array no more than two thirds
+// full.  When the entries array fills up, both arrays are rebuilt, with
+// the index array's capacity the smallest power of two that's at least
+// three times the number of elements.
+//
+// Removing an element marks its entry as removed and its cell in the index
+// array as a "dummy", which lookups probe past; the entry's space (and the
+// element itself) is reclaimed the next time the arrays are rebuilt.
+//
+// Compared with HashSet, a CompactHashSet uses far less memory for small
+// sets, has no per-element allocations at all, and, when its elements are
+// trivially copyable, copies itself with two calls to std::memcpy.
+
+#ifndef COMPACTHASHSET_HPP
+#define COMPACTHASHSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Hashing.hpp"
+#include "Set.hpp"
+
+
+
+template <typename T,
+          typename Hash = DefaultHash<T>,
+          typename KeyEqual = std::equal_to<T>>
+class CompactHashSet : public Set<T>
+{
+private:
+    struct Entry
+    {
+        T value;
+        unsigned int hash;
+        bool removed;
+    };
+
+public:
+    // The capacity of the index array before anything has been added.
+    static constexpr unsigned int DEFAULT_CAPACITY = 8;
+
+    typedef Hash HashFunction;
+
+
+    // A ConstIterator visits the elements of a CompactHashSet in the order
+    // they were added.  Adding elements to the set invalidates it; removing
+    // elements doesn't, though the removed ones are skipped.
+    class ConstIterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        const T& operator*() const noexcept;
+        const T* operator->() const noexcept;
+
+        ConstIterator& operator++() noexcept;
+        ConstIterator operator++(int) noexcept;
+
+        bool operator==(const ConstIterator& i) const noexcept;
+        bool operator!=(const ConstIterator& i) const noexcept;
+
+    private:
+        ConstIterator(const Entry* entry, const Entry* end) noexcept;
+
+        // skipRemoved() moves forward past any removed entries.
+        void skipRemoved() noexcept;
+
+        const Entry* entry;
+        const Entry* end;
+
+        friend class CompactHashSet;
+    };
+
+
+public:
+    // Initializes a CompactHashSet to be empty, so that it will use the
+    // given hash function whenever it needs to hash an element.  If none
+    // is given, DefaultHash<T> (see Hashing.hpp) is used.
+    CompactHashSet(HashFunction hashFunction = DefaultHash<T>{}, KeyEqual keyEqual = KeyEqual{});
+
+    // Cleans up the CompactHashSet so that it leaks no memory.
+    virtual ~CompactHashSet() noexcept;
+
+    // Initializes a new CompactHashSet to be a copy of an existing one.
+    // When T is trivially copyable, this is two calls to std::memcpy.
+    CompactHashSet(const CompactHashSet& s);
+
+    // Initializes a new CompactHashSet whose contents are moved from an
+    // expiring one, which is left empty and without any arrays.
+    CompactHashSet(CompactHashSet&& s) noexcept;
+
+    // Assigns an existing CompactHashSet into another.
+    CompactHashSet& operator=(const CompactHashSet& s);
+
+    // Assigns an expiring CompactHashSet into another.
+    CompactHashSet& operator=(CompactHashSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the end of the set's insertion order.  If
+    // the element is already in the set, this function has no effect.
+    // When the entries array is full, both arrays are rebuilt, which takes
+    // linear time; otherwise, it runs in constant time.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.
+    virtual bool contains(const T& element) const override;
+
+
+    // remove() removes an element from the set, returning true if it was
+    // there and false otherwise.
+    bool remove(const T& element);
+
+
+    // clear() removes every element from the set, keeping the capacity of
+    // both arrays.
+    void clear() noexcept;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // begin() and end() iterate over the elements in insertion order.
+    ConstIterator begin() const noexcept;
+    ConstIterator end() const noexcept;
+
+
+    // capacity() returns the number of cells in the index array.
+    unsigned int capacity() const noexcept;
+
+
+    // indexWidth() returns the size, in bytes, of each cell in the index
+    // array.
+    unsigned int indexWidth() const noexcept;
+
+
+    // sizeInBytes() returns the memory used by the two arrays.
+    std::size_t sizeInBytes() const noexcept;
+
+
+private:
+    // Cells of the index array hold an entry's position, or one of these.
+    // (They're stored in however many bytes the cell has, and widened when
+    // read.)
+    static constexpr std::uint32_t EMPTY = 0xFFFFFFFF;
+    static constexpr std::uint32_t DUMMY = 0xFFFFFFFE;
+
+    // widthFor() returns the cell width needed for the given number of
+    // entries.
+    static unsigned int widthFor(unsigned int entries) noexcept;
+
+    std::uint32_t cellAt(unsigned int cell) const noexcept;
+    void setCellAt(unsigned int cell, std::uint32_t value) noexcept;
+
+    // findCell() returns the cell of the index array that refers to an
+    // element equal to the given one, or EMPTY if there is none.
+    unsigned int findCell(const T& element, unsigned int hash) const;
+
+    // insertCell() returns the first cell, along the given hash's probe
+    // sequence, that's either empty or a dummy.
+    unsigned int insertCell(unsigned int hash) const noexcept;
+
+    // rebuild() moves the elements into new arrays, dropping removed
+    // entries, with an index array of the given capacity.
+    void rebuild(unsigned int newCapacity);
+
+    void destroy() noexcept;
+
+
+private:
+    HashFunction hashFunction;
+    KeyEqual keyEqual;
+    unsigned char* cells;
+    Entry* entries;
+    unsigned int cellCount;
+    unsigned int entryCapacity;
+    unsigned int entryCount;
+    unsigned int elementCount;
+};
+
+
+
+template <typename T, typename Hash, typename KeyEqual>
+const T& CompactHashSet<T, Hash, KeyEqual>::ConstIterator::operator*() const noexcept
+{
+    return entry->value;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+const T* CompactHashSet<T, Hash, KeyEqual>::ConstIterator::operator->() const noexcept
+{
+    return &entry->value;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+typename CompactHashSet<T, Hash, KeyEqual>::ConstIterator&
+CompactHashSet<T, Hash, KeyEqual>::ConstIterator::operator++() noexcept
+{
+    ++entry;
+    skipRemoved();
+    return *this;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+typename CompactHashSet<T, Hash, KeyEqual>::ConstIterator
+CompactHashSet<T, Hash, KeyEqual>::ConstIterator::operator++(int) noexcept
+{
+    ConstIterator old = *this;
+    ++*this;
+    return old;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool CompactHashSet<T, Hash, KeyEqual>::ConstIterator::operator==(const ConstIterator& i) const noexcept
+{
+    return entry == i.entry;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool CompactHashSet<T, Hash, KeyEqual>::ConstIterator::operator!=(const ConstIterator& i) const noexcept
+{
+    return entry != i.entry;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+CompactHashSet<T, Hash, KeyEqual>::ConstIterator::ConstIterator(const Entry* entry, const Entry* end) noexcept
+    : entry{entry}, end{end}
+{
+    skipRemoved();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void CompactHashSet<T, Hash, KeyEqual>::ConstIterator::skipRemoved() noexcept
+{
+    while (entry != end && entry->removed)
+    {
+        ++entry;
+    }
+}
+
+
+
+template <typename T, typename Hash, typename KeyEqual>
+CompactHashSet<T, Hash, KeyEqual>::CompactHashSet(HashFunction hashFunction, KeyEqual keyEqual)
+    : hashFunction{hashFunction}, keyEqual{keyEqual}, cells{nullptr}, entries{nullptr},
+      cellCount{0}, entryCapacity{0}, entryCount{0}, elementCount{0}
+{
+    rebuild(DEFAULT_CAPACITY);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+CompactHashSet<T, Hash, KeyEqual>::~CompactHashSet() noexcept
+{
+    destroy();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+CompactHashSet<T, Hash, KeyEqual>::CompactHashSet(const CompactHashSet& s)
+    : hashFunction{s.hashFunction}, keyEqual{s.keyEqual}, cells{nullptr}, entries{nullptr},
+      cellCount{0}, entryCapacity{0}, entryCount{0}, elementCount{0}
+{
+    if (s.cells == nullptr)
+    {
+        return;
+    }
+
+    std::size_t cellBytes = static_cast<std::size_t>(s.cellCount) * widthFor(s.entryCapacity);
+    cells = new unsigned char[cellBytes];
+    std::memcpy(cells, s.cells, cellBytes);
+
+    try
+    {
+        entries = static_cast<Entry*>(::operator new(sizeof(Entry) * s.entryCapacity));
+
+        if constexpr (std::is_trivially_copyable<T>::value)
+        {
+            std::memcpy(static_cast<void*>(entries), s.entries, sizeof(Entry) * s.entryCount);
+            entryCount = s.entryCount;
+        }
+        else
+        {
+            // Removed entries are copied too, so that the positions in the
+            // copied index array still refer to the right entries.
+            for (; entryCount < s.entryCount; ++entryCount)
+            {
+                new (&entries[entryCount]) Entry(s.entries[entryCount]);
+            }
+        }
+    }
+    catch (...)
+    {
+        destroy();
+        throw;
+    }
+
+    cellCount = s.cellCount;
+    entryCapacity = s.entryCapacity;
+    elementCount = s.elementCount;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+CompactHashSet<T, Hash, KeyEqual>::CompactHashSet(CompactHashSet&& s) noexcept
+    : hashFunction{s.hashFunction}, keyEqual{s.keyEqual}, cells{s.cells}, entries{s.entries},
+      cellCount{s.cellCount}, entryCapacity{s.entryCapacity}, entryCount{s.entryCount},
+      elementCount{s.elementCount}
+{
+    s.cells = nullptr;
+    s.entries = nullptr;
+    s.cellCount = 0;
+    s.entryCapacity = 0;
+    s.entryCount = 0;
+    s.elementCount = 0;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+CompactHashSet<T, Hash, KeyEqual>& CompactHashSet<T, Hash, KeyEqual>::operator=(const CompactHashSet& s)
+{
+    if (this != &s)
+    {
+        CompactHashSet copy{s};
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+CompactHashSet<T, Hash, KeyEqual>& CompactHashSet<T, Hash, KeyEqual>::operator=(CompactHashSet&& s) noexcept
+{
+    std::swap(hashFunction, s.hashFunction);
+    std::swap(keyEqual, s.keyEqual);
+    std::swap(cells, s.cells);
+    std::swap(entries, s.entries);
+    std::swap(cellCount, s.cellCount);
+    std::swap(entryCapacity, s.entryCapacity);
+    std::swap(entryCount, s.entryCount);
+    std::swap(elementCount, s.elementCount);
+    return *this;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool CompactHashSet<T, Hash, KeyEqual>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void CompactHashSet<T, Hash, KeyEqual>::add(const T& element)
+{
+    unsigned int hash = hashFunction(element);
+
+    if (findCell(element, hash) != EMPTY)
+    {
+        return;
+    }
+
+    if (entryCount == entryCapacity)
+    {
+        // The new index array is at least three times the number of
+        // elements, so the rebuilt entries array is at most half full.
+        unsigned int newCapacity = DEFAULT_CAPACITY;
+
+        while (newCapacity < (elementCount + 1) * 3)
+        {
+            newCapacity *= 2;
+        }
+
+        // The element may be one of this set's own entries (a removed one,
+        // say), which rebuild() moves and destroys, so it's copied first.
+        T copy{element};
+        rebuild(newCapacity);
+        new (&entries[entryCount]) Entry{std::move(copy), hash, false};
+    }
+    else
+    {
+        new (&entries[entryCount]) Entry{element, hash, false};
+    }
+
+    setCellAt(insertCell(hash), entryCount);
+    ++entryCount;
+    ++elementCount;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool CompactHashSet<T, Hash, KeyEqual>::contains(const T& element) const
+{
+    return findCell(element, hashFunction(element)) != EMPTY;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool CompactHashSet<T, Hash, KeyEqual>::remove(const T& element)
+{
+    unsigned int cell = findCell(element, hashFunction(element));
+
+    if (cell == EMPTY)
+    {
+        return false;
+    }
+
+    entries[cellAt(cell)].removed = true;
+    setCellAt(cell, DUMMY);
+    --elementCount;
+    return true;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void CompactHashSet<T, Hash, KeyEqual>::clear() noexcept
+{
+    if (cells == nullptr)
+    {
+        return;
+    }
+
+    for (unsigned int i = 0; i < entryCount; ++i)
+    {
+        entries[i].~Entry();
+    }
+
+    std::memset(cells, 0xFF, static_cast<std::size_t>(cellCount) * widthFor(entryCapacity));
+    entryCount = 0;
+    elementCount = 0;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int CompactHashSet<T, Hash, KeyEqual>::size() const noexcept
+{
+    return elementCount;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+typename CompactHashSet<T, Hash, KeyEqual>::ConstIterator CompactHashSet<T, Hash, KeyEqual>::begin() const noexcept
+{
+    return ConstIterator{entries, entries + entryCount};
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+typename CompactHashSet<T, Hash, KeyEqual>::ConstIterator CompactHashSet<T, Hash, KeyEqual>::end() const noexcept
+{
+    return ConstIterator{entries + entryCount, entries + entryCount};
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int CompactHashSet<T, Hash, KeyEqual>::capacity() const noexcept
+{
+    return cellCount;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int CompactHashSet<T, Hash, KeyEqual>::indexWidth() const noexcept
+{
+    return widthFor(entryCapacity);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::size_t CompactHashSet<T, Hash, KeyEqual>::sizeInBytes() const noexcept
+{
+    return static_cast<std::size_t>(cellCount) * widthFor(entryCapacity)
+        + static_cast<std::size_t>(entryCapacity) * sizeof(Entry);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int CompactHashSet<T, Hash, KeyEqual>::widthFor(unsigned int entries) noexcept
+{
+    // The two largest values of each width are reserved for EMPTY and
+    // DUMMY.
+    if (entries <= 0xFD)
+    {
+        return 1;
+    }
+    else if (entries <= 0xFFFD)
+    {
+        return 2;
+    }
+    else
+    {
+        return 4;
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::uint32_t CompactHashSet<T, Hash, KeyEqual>::cellAt(unsigned int cell) const noexcept
+{
+    switch (widthFor(entryCapacity))
+    {
+    case 1:
+    {
+        std::uint8_t value = cells[cell];
+        return value >= 0xFE ? value - 0xFEu + DUMMY : value;
+    }
+
+    case 2:
+    {
+        std::uint16_t value;
+        std::memcpy(&value, cells + static_cast<std::size_t>(cell) * 2, 2);
+        return value >= 0xFFFE ? value - 0xFFFEu + DUMMY : value;
+    }
+
+    default:
+    {
+        std::uint32_t value;
+        std::memcpy(&value, cells + static_cast<std::size_t>(cell) * 4, 4);
+        return value;
+    }
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void CompactHashSet<T, Hash, KeyEqual>::setCellAt(unsigned int cell, std::uint32_t value) noexcept
+{
+    switch (widthFor(entryCapacity))
+    {
+    case 1:
+    {
+        cells[cell] = static_cast<std::uint8_t>(value);
+        break;
+    }
+
+    case 2:
+    {
+        std::uint16_t narrow = static_cast<std::uint16_t>(value);
+        std::memcpy(cells + static_cast<std::size_t>(cell) * 2, &narrow, 2);
+        break;
+    }
+
+    default:
+    {
+        std::memcpy(cells + static_cast<std::size_t>(cell) * 4, &value, 4);
+        break;
+    }
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int CompactHashSet<T, Hash, KeyEqual>::findCell(const T& element, unsigned int hash) const
+{
+    if (cells == nullptr)
+    {
+        return EMPTY;
+    }
+
+    unsigned int mask = cellCount - 1;
+    unsigned int cell = hash & mask;
+    unsigned int perturb = hash;
+
+    while (true)
+    {
+        std::uint32_t position = cellAt(cell);
+
+        if (position == EMPTY)
+        {
+            return EMPTY;
+        }
+
+        if (position != DUMMY && entries[position].hash == hash && keyEqual(entries[position].value, element))
+        {
+            return cell;
+        }
+
+        perturb >>= 5;
+        cell = (cell * 5 + perturb + 1) & mask;
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int CompactHashSet<T, Hash, KeyEqual>::insertCell(unsigned int hash) const noexcept
+{
+    unsigned int mask = cellCount - 1;
+    unsigned int cell = hash & mask;
+    unsigned int perturb = hash;
+
+    while (true)
+    {
+        std::uint32_t position = cellAt(cell);
+
+        if (position == EMPTY || position == DUMMY)
+        {
+            return cell;
+        }
+
+        perturb >>= 5;
+        cell = (cell * 5 + perturb + 1) & mask;
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void CompactHashSet<T, Hash, KeyEqual>::rebuild(unsigned int newCapacity)
+{
+    unsigned int newEntryCapacity = newCapacity * 2 / 3;
+    std::size_t newCellBytes = static_cast<std::size_t>(newCapacity) * widthFor(newEntryCapacity);
+
+    unsigned char* newCells = new unsigned char[newCellBytes];
+    Entry* newEntries;
+
+    try
+    {
+        newEntries = static_cast<Entry*>(::operator new(sizeof(Entry) * newEntryCapacity));
+    }
+    catch (...)
+    {
+        delete[] newCells;
+        throw;
+    }
+
+    std::memset(newCells, 0xFF, newCellBytes);
+
+    // Only the live entries move, keeping their order.  Moving an element
+    // is assumed not to throw.
+    unsigned int newEntryCount = 0;
+
+    for (unsigned int i = 0; i < entryCount; ++i)
+    {
+        if (!entries[i].removed)
+        {
+            new (&newEntries[newEntryCount++]) Entry{std::move(entries[i])};
+        }
+
+        entries[i].~Entry();
+    }
+
+    delete[] cells;
+    ::operator delete(entries);
+
+    cells = newCells;
+    entries = newEntries;
+    cellCount = newCapacity;
+    entryCapacity = newEntryCapacity;
+    entryCount = newEntryCount;
+
+    for (unsigned int i = 0; i < entryCount; ++i)
+    {
+        setCellAt(insertCell(entries[i].hash), i);
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void CompactHashSet<T, Hash, KeyEqual>::destroy() noexcept
+{
+    if (entries != nullptr)
+    {
+        for (unsigned int i = 0; i < entryCount; ++i)
+        {
+            entries[i].~Entry();
+        }
+
+        ::operator delete(entries);
+    }
+
+    delete[] cells;
+
+    cells = nullptr;
+    entries = nullptr;
+    cellCount = 0;
+    entryCapacity = 0;
+    entryCount = 0;
+    elementCount = 0;
+}
+
+
+
+#endif // COMPACTHASHSET_HPP
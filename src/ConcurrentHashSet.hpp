@@ -0,0 +1,337 @@
+// ConcurrentHashSet.hpp
+//
+// A ConcurrentHashSet is an implementation of a Set that can be shared by
+// many threads at once without any external locking.  Like HashSet, it's a
+// separately-chained hash table, but it's arranged so that the common
+// operation -- contains() -- never takes a lock and never waits:
+//
+// * contains() pins the calling thread in the global EpochDomain, then
+//   walks a chain using only atomic loads.
+//
+// * add() and remove() lock one of LOCK_STRIPES mutexes, chosen by the low
+//   bits of the element's hash.  Because the capacity is always a power of
+//   two that's at least LOCK_STRIPES, every bucket belongs to exactly one
+//   stripe, no matter how many times the table has been resized, so writers
+//   to different stripes don't contend with one another.  A new node is
+//   fully built before it's published at the head of its chain, and a
+//   removed node is unlinked (leaving its own "next" pointer intact for any
+//   reader that's standing on it) and then retired rather than deleted.
+//
+// * Resizing locks every stripe, which stops the writers, but not the
+//   readers.  The new table is built from copies of the nodes, so the old
+//   chains remain intact for readers that are still walking them; the new
+//   table is then published with a single atomic store, and the old one is
+//   retired in its entirety.
+//
+// Memory that's retired is freed by the EpochDomain once no pinned reader
+// could still be looking at it.
+
+#ifndef CONCURRENTHASHSET_HPP
+#define CONCURRENTHASHSET_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include "EpochReclamation.hpp"
+#include "Hashing.hpp"
+#include "Set.hpp"
+
+
+
+template <typename T,
+          typename Hash = DefaultHash<T>,
+          typename KeyEqual = std::equal_to<T>>
+class ConcurrentHashSet : public Set<T>
+{
+public:
+    // The default capacity of the ConcurrentHashSet before anything has
+    // been added to it.  It's always a power of two.
+    static constexpr unsigned int DEFAULT_CAPACITY = 64;
+
+    // The number of mutexes that writers are spread across.  It's a power
+    // of two no larger than DEFAULT_CAPACITY.
+    static constexpr unsigned int LOCK_STRIPES = 64;
+
+    // A HashFunction is a function that takes a reference to a const T
+    // and returns an unsigned int.  Since buckets and stripes are chosen
+    // by the low bits of the hash, those bits should be well-distributed.
+    typedef Hash HashFunction;
+
+public:
+    // Initializes a ConcurrentHashSet to be empty, so that it will use the
+    // given hash function whenever it needs to hash an element.  If none
+    // is given, DefaultHash<T> (see Hashing.hpp) is used.
+    ConcurrentHashSet(HashFunction hashFunction = DefaultHash<T>{}, KeyEqual keyEqual = KeyEqual{});
+
+    // Cleans up the ConcurrentHashSet so that it leaks no memory.  No other
+    // thread may be using the set when it's destroyed.
+    virtual ~ConcurrentHashSet() noexcept;
+
+    // A ConcurrentHashSet is shared between threads by reference, so
+    // copying or moving one isn't supported.
+    ConcurrentHashSet(const ConcurrentHashSet& s) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet& s) = delete;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  It locks the element's stripe,
+    // and resizes the table (locking every stripe) when the ratio of size
+    // to capacity exceeds 0.8.  It's safe to call concurrently with any
+    // other member function except the destructor.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is in the set, false
+    // otherwise.  It takes no locks and never waits for a writer, even
+    // one that's resizing the table.
+    virtual bool contains(const T& element) const override;
+
+
+    // remove() removes an element from the set, returning true if it was
+    // there and false otherwise.  It locks the element's stripe.
+    bool remove(const T& element);
+
+
+    // size() returns the number of elements in the set.  While writers are
+    // active, it's a snapshot that may be out of date as soon as it's
+    // returned.
+    virtual unsigned int size() const noexcept override;
+
+
+    // capacity() returns the number of buckets in the current table.
+    unsigned int capacity() const noexcept;
+
+
+private:
+    struct Node
+    {
+        Node(const T& element, Node* next)
+            : element{element}, next{next}
+        {
+        }
+
+        T element;
+        std::atomic<Node*> next;
+    };
+
+    struct Table
+    {
+        Table(unsigned int capacity)
+            : capacity{capacity}, buckets{new std::atomic<Node*>[capacity]}
+        {
+            for (unsigned int i = 0; i < capacity; ++i)
+            {
+                buckets[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        // A Table owns the nodes in its chains, so destroying one (which
+        // only happens once no reader could be using it) deletes them.
+        ~Table() noexcept
+        {
+            for (unsigned int i = 0; i < capacity; ++i)
+            {
+                Node* node = buckets[i].load(std::memory_order_relaxed);
+
+                while (node != nullptr)
+                {
+                    Node* next = node->next.load(std::memory_order_relaxed);
+                    delete node;
+                    node = next;
+                }
+            }
+
+            delete[] buckets;
+        }
+
+        unsigned int capacity;
+        std::atomic<Node*>* buckets;
+    };
+
+    // resize() doubles the capacity of the table if it's still too full
+    // once every stripe has been locked.
+    void resize();
+
+
+private:
+    HashFunction hashFunction;
+    KeyEqual keyEqual;
+    std::atomic<Table*> table;
+    std::atomic<unsigned int> count;
+    std::mutex stripes[LOCK_STRIPES];
+};
+
+
+
+template <typename T, typename Hash, typename KeyEqual>
+ConcurrentHashSet<T, Hash, KeyEqual>::ConcurrentHashSet(HashFunction hashFunction, KeyEqual keyEqual)
+    : hashFunction{hashFunction}, keyEqual{keyEqual},
+      table{new Table{DEFAULT_CAPACITY}}, count{0}
+{
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+ConcurrentHashSet<T, Hash, KeyEqual>::~ConcurrentHashSet() noexcept
+{
+    delete table.load();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentHashSet<T, Hash, KeyEqual>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void ConcurrentHashSet<T, Hash, KeyEqual>::add(const T& element)
+{
+    unsigned int hash = hashFunction(element);
+    bool grow;
+
+    {
+        std::lock_guard<std::mutex> lock{stripes[hash & (LOCK_STRIPES - 1)]};
+
+        // While a stripe is locked, no resize can happen, so the table
+        // can't change out from under us.
+        Table* t = table.load(std::memory_order_relaxed);
+        std::atomic<Node*>& bucket = t->buckets[hash & (t->capacity - 1)];
+        Node* head = bucket.load(std::memory_order_relaxed);
+
+        for (Node* node = head; node != nullptr; node = node->next.load(std::memory_order_relaxed))
+        {
+            if (keyEqual(node->element, element))
+            {
+                return;
+            }
+        }
+
+        bucket.store(new Node{element, head}, std::memory_order_release);
+
+        unsigned int newCount = count.fetch_add(1, std::memory_order_relaxed) + 1;
+        grow = static_cast<unsigned long long>(newCount) * 5 > static_cast<unsigned long long>(t->capacity) * 4;
+    }
+
+    if (grow)
+    {
+        resize();
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentHashSet<T, Hash, KeyEqual>::contains(const T& element) const
+{
+    unsigned int hash = hashFunction(element);
+    EpochDomain::Guard guard = EpochDomain::global().pin();
+
+    Table* t = table.load(std::memory_order_acquire);
+
+    for (Node* node = t->buckets[hash & (t->capacity - 1)].load(std::memory_order_acquire);
+         node != nullptr; node = node->next.load(std::memory_order_acquire))
+    {
+        if (keyEqual(node->element, element))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool ConcurrentHashSet<T, Hash, KeyEqual>::remove(const T& element)
+{
+    unsigned int hash = hashFunction(element);
+    std::lock_guard<std::mutex> lock{stripes[hash & (LOCK_STRIPES - 1)]};
+
+    Table* t = table.load(std::memory_order_relaxed);
+    std::atomic<Node*>* link = &t->buckets[hash & (t->capacity - 1)];
+
+    for (Node* node = link->load(std::memory_order_relaxed); node != nullptr;
+         node = link->load(std::memory_order_relaxed))
+    {
+        if (keyEqual(node->element, element))
+        {
+            // Readers standing on the node can still follow its next
+            // pointer, so only the link into it changes.
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            count.fetch_sub(1, std::memory_order_relaxed);
+            EpochDomain::global().retire(node);
+            return true;
+        }
+
+        link = &node->next;
+    }
+
+    return false;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int ConcurrentHashSet<T, Hash, KeyEqual>::size() const noexcept
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int ConcurrentHashSet<T, Hash, KeyEqual>::capacity() const noexcept
+{
+    return table.load(std::memory_order_acquire)->capacity;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void ConcurrentHashSet<T, Hash, KeyEqual>::resize()
+{
+    std::unique_lock<std::mutex> locks[LOCK_STRIPES];
+
+    for (unsigned int i = 0; i < LOCK_STRIPES; ++i)
+    {
+        locks[i] = std::unique_lock<std::mutex>{stripes[i]};
+    }
+
+    Table* oldTable = table.load(std::memory_order_relaxed);
+    unsigned int currentCount = count.load(std::memory_order_relaxed);
+
+    // Another writer may have resized the table while we waited.
+    if (static_cast<unsigned long long>(currentCount) * 5 <= static_cast<unsigned long long>(oldTable->capacity) * 4)
+    {
+        return;
+    }
+
+    Table* newTable = new Table{oldTable->capacity * 2};
+
+    try
+    {
+        for (unsigned int i = 0; i < oldTable->capacity; ++i)
+        {
+            for (Node* node = oldTable->buckets[i].load(std::memory_order_relaxed); node != nullptr;
+                 node = node->next.load(std::memory_order_relaxed))
+            {
+                std::atomic<Node*>& bucket = newTable->buckets[hashFunction(node->element) & (newTable->capacity - 1)];
+                bucket.store(new Node{node->element, bucket.load(std::memory_order_relaxed)}, std::memory_order_relaxed);
+            }
+        }
+    }
+    catch (...)
+    {
+        delete newTable;
+        throw;
+    }
+
+    table.store(newTable, std::memory_order_release);
+    EpochDomain::global().retire(oldTable);
+}
+
+
+
+#endif // CONCURRENTHASHSET_HPP
+
@@ -0,0 +1,417 @@
+// CuckooFilter.hpp
+//
+// A CuckooFilter answers the same question as a BloomFilter -- "might this
+// element have been added?" -- with no false negatives and a tunable rate
+// of false positives.  Unlike a BloomFilter, it also supports remove().
+//
+// The filter is a table of buckets, each holding BUCKET_SLOTS small
+// "fingerprints" (a few bits taken from the element's hash, never zero,
+// since zero marks an empty slot).  Every element has two candidate
+// buckets: one chosen by its hash, and an alternate found by XORing the
+// first with a hash of the fingerprint.  Because the alternate can be
+// computed from either bucket and the fingerprint alone, a fingerprint can
+// be moved to its other bucket without knowing the element it came from,
+// which is how add() makes room: it evicts ("kicks") a resident
+// fingerprint to its alternate bucket, and so on, up to MAX_KICKS times.
+// If that fails, the last fingerprint evicted is parked in a one-entry
+// stash, and the filter is considered full; further calls to add() fail.
+//
+// When fingerprints are 8 or 16 bits, a whole bucket fits in one 32- or
+// 64-bit word, so a bucket is searched with a handful of word-sized
+// operations rather than a loop over its slots.
+//
+// CuckooFilters don't hash elements themselves; they're given 64-bit hashes
+// whose bits are all well-mixed (e.g., from mix64() in Hashing.hpp).  Since
+// the filter stores fingerprints rather than elements, adding the same
+// element twice stores its fingerprint twice, and removing an element that
+// was never added can remove another element's fingerprint; callers that
+// need remove() should only add an element once and only remove elements
+// that were added.
+
+#ifndef CUCKOOFILTER_HPP
+#define CUCKOOFILTER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Hashing.hpp"
+
+
+
+// CuckooFilterExceptions are thrown when a CuckooFilter is given a false
+// positive rate that isn't a rate.
+
+class CuckooFilterException
+{
+public:
+    CuckooFilterException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline CuckooFilterException::CuckooFilterException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string CuckooFilterException::reason() const
+{
+    return reason_;
+}
+
+
+
+template <typename Fingerprint = std::uint16_t>
+class CuckooFilter
+{
+    static_assert(std::is_unsigned<Fingerprint>::value && sizeof(Fingerprint) <= 4,
+                  "fingerprints must be unsigned and no more than 32 bits");
+
+public:
+    // The number of fingerprints in each bucket.
+    static constexpr unsigned int BUCKET_SLOTS = 4;
+
+    // The fraction of slots the filter is sized to have filled once the
+    // expected number of elements has been added.
+    static constexpr double TARGET_LOAD = 0.95;
+
+    // The number of evictions add() will try before giving up.
+    static constexpr unsigned int MAX_KICKS = 500;
+
+public:
+    // Initializes an empty CuckooFilter with room for at least the given
+    // number of elements, using fingerprints long enough that the false
+    // positive rate is no more than the given one (or as close as the
+    // Fingerprint type allows).  It throws a CuckooFilterException if the
+    // rate isn't strictly between 0 and 1.
+    CuckooFilter(unsigned int expectedElements, double falsePositiveRate);
+
+
+    // add() records the element with the given hash, returning true if
+    // it was recorded and false if the filter is full.
+    bool add(std::uint64_t hash);
+
+
+    // mayContain() returns false if the element with the given hash is
+    // definitely not in the filter, true if it might be.
+    bool mayContain(std::uint64_t hash) const noexcept;
+
+
+    // remove() removes one copy of the fingerprint of the element with
+    // the given hash, returning true if one was found.
+    bool remove(std::uint64_t hash) noexcept;
+
+
+    // clear() removes every element from the filter.
+    void clear() noexcept;
+
+
+    // size() returns the number of fingerprints stored in the filter.
+    unsigned int size() const noexcept;
+
+
+    // sizeInBits() returns the amount of memory used by the filter's
+    // fingerprints, counting each one at its significant width.
+    std::size_t sizeInBits() const noexcept;
+
+
+    // fingerprintBits() returns the number of significant bits in each
+    // fingerprint.
+    unsigned int fingerprintBits() const noexcept;
+
+
+private:
+    Fingerprint fingerprintOf(std::uint64_t hash) const noexcept;
+    std::size_t alternateOf(std::size_t bucket, Fingerprint fingerprint) const noexcept;
+
+    // findIn() returns true if the given bucket holds the given
+    // fingerprint.
+    bool findIn(std::size_t bucket, Fingerprint fingerprint) const noexcept;
+
+    // slotOf() returns the index (within the bucket) of a slot holding the
+    // given fingerprint, or BUCKET_SLOTS if there isn't one.
+    unsigned int slotOf(std::size_t bucket, Fingerprint fingerprint) const noexcept;
+
+    // insertInto() stores the fingerprint in an empty slot of the given
+    // bucket, returning false if there isn't one.
+    bool insertInto(std::size_t bucket, Fingerprint fingerprint) noexcept;
+
+
+private:
+    std::vector<Fingerprint> slots;
+    std::size_t bucketMask;
+    unsigned int bits;
+    Fingerprint fingerprintMask;
+    unsigned int count;
+
+    // The one fingerprint that couldn't be placed, if any (0 if not).
+    Fingerprint stashed;
+    std::size_t stashedBucket;
+
+    // State for choosing which fingerprint to evict.
+    std::uint64_t kickState;
+};
+
+
+
+template <typename Fingerprint>
+CuckooFilter<Fingerprint>::CuckooFilter(unsigned int expectedElements, double falsePositiveRate)
+    : bucketMask{0}, bits{0}, fingerprintMask{0}, count{0},
+      stashed{0}, stashedBucket{0}, kickState{0x9E3779B97F4A7C15ull}
+{
+    // This is written so that NaN is rejected, too.
+    if (!(falsePositiveRate > 0.0 && falsePositiveRate < 1.0))
+    {
+        throw CuckooFilterException{"false positive rate must be between 0 and 1"};
+    }
+
+    // A lookup compares against 2 * BUCKET_SLOTS fingerprints, each of
+    // which matches by accident with probability 2^-bits.
+    double wanted = std::ceil(std::log2(2.0 * BUCKET_SLOTS / falsePositiveRate));
+    unsigned int widest = sizeof(Fingerprint) * 8;
+
+    bits = wanted < 1.0 ? 1 : (wanted > widest ? widest : static_cast<unsigned int>(wanted));
+    fingerprintMask = static_cast<Fingerprint>(bits == widest ? ~Fingerprint{0} : (Fingerprint{1} << bits) - 1);
+
+    double needed = std::ceil(expectedElements / (BUCKET_SLOTS * TARGET_LOAD));
+    std::size_t buckets = 1;
+
+    while (buckets < needed)
+    {
+        buckets *= 2;
+    }
+
+    bucketMask = buckets - 1;
+    slots.assign(buckets * BUCKET_SLOTS, Fingerprint{0});
+}
+
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::add(std::uint64_t hash)
+{
+    if (stashed != 0)
+    {
+        return false;
+    }
+
+    Fingerprint fingerprint = fingerprintOf(hash);
+    std::size_t bucket = static_cast<std::size_t>(hash) & bucketMask;
+    std::size_t alternate = alternateOf(bucket, fingerprint);
+
+    if (insertInto(bucket, fingerprint) || insertInto(alternate, fingerprint))
+    {
+        ++count;
+        return true;
+    }
+
+    for (unsigned int kick = 0; kick < MAX_KICKS; ++kick)
+    {
+        kickState ^= kickState << 13;
+        kickState ^= kickState >> 7;
+        kickState ^= kickState << 17;
+
+        Fingerprint& victim = slots[alternate * BUCKET_SLOTS + (kickState & (BUCKET_SLOTS - 1))];
+        Fingerprint evicted = victim;
+        victim = fingerprint;
+
+        fingerprint = evicted;
+        alternate = alternateOf(alternate, fingerprint);
+
+        if (insertInto(alternate, fingerprint))
+        {
+            ++count;
+            return true;
+        }
+    }
+
+    // The element itself was placed; it's the last fingerprint evicted
+    // that has nowhere to go.
+    stashed = fingerprint;
+    stashedBucket = alternate;
+    ++count;
+    return true;
+}
+
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::mayContain(std::uint64_t hash) const noexcept
+{
+    Fingerprint fingerprint = fingerprintOf(hash);
+    std::size_t bucket = static_cast<std::size_t>(hash) & bucketMask;
+    std::size_t alternate = alternateOf(bucket, fingerprint);
+
+    if (stashed == fingerprint && (stashedBucket == bucket || stashedBucket == alternate))
+    {
+        return true;
+    }
+
+    return findIn(bucket, fingerprint) || findIn(alternate, fingerprint);
+}
+
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::remove(std::uint64_t hash) noexcept
+{
+    Fingerprint fingerprint = fingerprintOf(hash);
+    std::size_t bucket = static_cast<std::size_t>(hash) & bucketMask;
+    std::size_t alternate = alternateOf(bucket, fingerprint);
+
+    if (stashed == fingerprint && (stashedBucket == bucket || stashedBucket == alternate))
+    {
+        stashed = 0;
+        --count;
+        return true;
+    }
+
+    for (std::size_t candidate : {bucket, alternate})
+    {
+        unsigned int slot = slotOf(candidate, fingerprint);
+
+        if (slot != BUCKET_SLOTS)
+        {
+            slots[candidate * BUCKET_SLOTS + slot] = 0;
+            --count;
+
+            // A slot has opened up, so the stashed fingerprint may now
+            // have somewhere to go.
+            if (stashed != 0 && insertInto(stashedBucket, stashed))
+            {
+                stashed = 0;
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename Fingerprint>
+void CuckooFilter<Fingerprint>::clear() noexcept
+{
+    std::fill(slots.begin(), slots.end(), Fingerprint{0});
+    stashed = 0;
+    count = 0;
+}
+
+
+template <typename Fingerprint>
+unsigned int CuckooFilter<Fingerprint>::size() const noexcept
+{
+    return count;
+}
+
+
+template <typename Fingerprint>
+std::size_t CuckooFilter<Fingerprint>::sizeInBits() const noexcept
+{
+    return slots.size() * bits;
+}
+
+
+template <typename Fingerprint>
+unsigned int CuckooFilter<Fingerprint>::fingerprintBits() const noexcept
+{
+    return bits;
+}
+
+
+template <typename Fingerprint>
+Fingerprint CuckooFilter<Fingerprint>::fingerprintOf(std::uint64_t hash) const noexcept
+{
+    // The fingerprint comes from the high bits, which don't choose the
+    // bucket, and is never 0, which marks an empty slot.
+    Fingerprint fingerprint = static_cast<Fingerprint>((hash >> 32) & fingerprintMask);
+    return fingerprint == 0 ? Fingerprint{1} : fingerprint;
+}
+
+
+template <typename Fingerprint>
+std::size_t CuckooFilter<Fingerprint>::alternateOf(std::size_t bucket, Fingerprint fingerprint) const noexcept
+{
+    // XOR is its own inverse, so the alternate of the alternate is the
+    // original bucket.
+    return (bucket ^ static_cast<std::size_t>(mix64(fingerprint))) & bucketMask;
+}
+
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::findIn(std::size_t bucket, Fingerprint fingerprint) const noexcept
+{
+    const Fingerprint* first = &slots[bucket * BUCKET_SLOTS];
+
+    if constexpr (sizeof(Fingerprint) == 1 || sizeof(Fingerprint) == 2)
+    {
+        // The bucket is one word.  XORing it with the fingerprint repeated
+        // in every lane leaves a zero lane wherever there's a match, and
+        // the classic "has a zero lane" test finds one without a loop.
+        using Word = std::conditional_t<sizeof(Fingerprint) == 1, std::uint32_t, std::uint64_t>;
+        constexpr Word LOW = ~Word{0} / static_cast<Fingerprint>(~Fingerprint{0});
+        constexpr Word HIGH = LOW << (sizeof(Fingerprint) * 8 - 1);
+
+        Word word;
+        std::memcpy(&word, first, sizeof(Word));
+
+        Word lanes = word ^ (LOW * fingerprint);
+        return ((lanes - LOW) & ~lanes & HIGH) != 0;
+    }
+    else
+    {
+        for (unsigned int i = 0; i < BUCKET_SLOTS; ++i)
+        {
+            if (first[i] == fingerprint)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+
+template <typename Fingerprint>
+unsigned int CuckooFilter<Fingerprint>::slotOf(std::size_t bucket, Fingerprint fingerprint) const noexcept
+{
+    const Fingerprint* first = &slots[bucket * BUCKET_SLOTS];
+
+    for (unsigned int i = 0; i < BUCKET_SLOTS; ++i)
+    {
+        if (first[i] == fingerprint)
+        {
+            return i;
+        }
+    }
+
+    return BUCKET_SLOTS;
+}
+
+
+template <typename Fingerprint>
+bool CuckooFilter<Fingerprint>::insertInto(std::size_t bucket, Fingerprint fingerprint) noexcept
+{
+    unsigned int slot = slotOf(bucket, 0);
+
+    if (slot == BUCKET_SLOTS)
+    {
+        return false;
+    }
+
+    slots[bucket * BUCKET_SLOTS + slot] = fingerprint;
+    return true;
+}
+
+
+
+#endif // CUCKOOFILTER_HPP
@@ -0,0 +1,822 @@
+// CuckooHashSet.hpp
+//
+// A CuckooHashSet is an implementation of a Set that guarantees every
+// lookup examines a small, fixed number of places, no matter how full the
+// set is or how unlucky its elements' hashes are.  That makes it a good
+// choice where the worst-case latency of a lookup matters more than the
+// average, and where memory is tight enough that the table needs to run
+// very full.
+//
+// The table is an array of buckets, each with SLOTS slots.  Every element
+// has two candidate buckets, both derived from its hash, and it's always
+// stored in one of the two (or, rarely, in a small "stash" on the side).
+// So a lookup checks two buckets and the stash, and that's all.  Each slot
+// also has a one-byte "tag" (eight bits of the hash, never zero, since
+// zero marks an empty slot), and the tags of a bucket are compared against
+// the one being looked for all at once -- with a single SSE2 comparison
+// where the processor supports it -- so the elements themselves are only
+// compared when their tags match.
+//
+// When both of a new element's buckets are full, room is made by moving
+// elements to their other buckets.  A breadth-first search, starting from
+// the new element's two buckets, looks for the shortest chain of such
+// moves that ends in an empty slot (up to MAX_PATH_LENGTH moves, examining
+// at most MAX_SEARCHED_BUCKETS buckets); the moves are then made, from the
+// end of the chain backward, and the new element takes the first slot
+// freed.  Slots remember their element's hash, so moving an element never
+// requires hashing it again.  If no chain is found, the element goes into
+// the stash, which has room for STASH_SIZE elements; only when the stash
+// is full does the table double in size.  With eight slots per bucket,
+// that doesn't happen until the table is about 98% full.
+//
+// Doubling can't help elements whose hashes are outright equal, since
+// they'll always share the same two buckets.  So if the stash fills up
+// while the table is less than MIN_GROWTH_LOAD full, the stash grows
+// instead.  Lookups are then only bounded by the size of the stash, which
+// only a hash function that gives many elements the same hash makes
+// large.
+
+#ifndef CUCKOOHASHSET_HPP
+#define CUCKOOHASHSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+#include "Hashing.hpp"
+#include "Set.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+template <typename T,
+          typename Hash = DefaultHash<T>,
+          typename KeyEqual = std::equal_to<T>,
+          unsigned int SLOTS = 8>
+class CuckooHashSet : public Set<T>
+{
+    static_assert(SLOTS >= 2 && SLOTS <= 8, "buckets must have between 2 and 8 slots");
+
+public:
+    // The number of buckets before anything has been added.
+    static constexpr std::size_t DEFAULT_BUCKETS = 2;
+
+    // The longest chain of moves add() will make to free a slot.
+    static constexpr unsigned int MAX_PATH_LENGTH = 5;
+
+    // The most buckets add() will examine looking for such a chain.
+    static constexpr unsigned int MAX_SEARCHED_BUCKETS = 512;
+
+    // The number of elements the stash can hold.
+    static constexpr unsigned int STASH_SIZE = 4;
+
+    // The table doesn't grow when it's less full than this; the stash
+    // does instead.
+    static constexpr double MIN_GROWTH_LOAD = 0.5;
+
+    typedef Hash HashFunction;
+
+public:
+    // Initializes a CuckooHashSet to be empty, so that it will use the
+    // given hash function whenever it needs to hash an element.  If none
+    // is given, DefaultHash<T> (see Hashing.hpp) is used.
+    CuckooHashSet(HashFunction hashFunction = DefaultHash<T>{}, KeyEqual keyEqual = KeyEqual{});
+
+    // Cleans up the CuckooHashSet so that it leaks no memory.
+    virtual ~CuckooHashSet() noexcept;
+
+    // Initializes a new CuckooHashSet to be a copy of an existing one.
+    CuckooHashSet(const CuckooHashSet& s);
+
+    // Initializes a new CuckooHashSet whose contents are moved from an
+    // expiring one, which is left empty.
+    CuckooHashSet(CuckooHashSet&& s) noexcept;
+
+    // Assigns an existing CuckooHashSet into another.
+    CuckooHashSet& operator=(const CuckooHashSet& s);
+
+    // Assigns an expiring CuckooHashSet into another.
+    CuckooHashSet& operator=(CuckooHashSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  It may move other elements to
+    // make room, and doubles the table (which takes linear time) when no
+    // room can be made.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  It examines two buckets and the stash, at most.
+    virtual bool contains(const T& element) const override;
+
+
+    // remove() removes an element from the set, returning true if it was
+    // there and false otherwise.
+    bool remove(const T& element);
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // capacity() returns the number of slots in the table.
+    std::size_t capacity() const noexcept;
+
+
+    // loadFactor() returns the fraction of the table's slots that are in
+    // use.
+    double loadFactor() const noexcept;
+
+
+    // stashSize() returns the number of elements in the stash.
+    unsigned int stashSize() const noexcept;
+
+
+    // sizeInBytes() returns the memory used by the table and the stash.
+    std::size_t sizeInBytes() const noexcept;
+
+
+private:
+    struct Bucket
+    {
+        // The tags come first, padded to eight bytes so that they can be
+        // compared as one unit; the padding is never matched.
+        alignas(8) std::uint8_t tags[8];
+        alignas(T) unsigned char storage[SLOTS * sizeof(T)];
+        unsigned int hashes[SLOTS];
+    };
+
+    // A Step is one bucket reached by add()'s search, along with how it
+    // was reached: by moving the element in the given slot of the parent
+    // step's bucket.
+    struct Step
+    {
+        std::size_t bucket;
+        int parent;
+        unsigned int slot;
+        unsigned int depth;
+    };
+
+    static constexpr unsigned int ALL_SLOTS = (1u << SLOTS) - 1;
+
+    static std::uint8_t tagOf(unsigned int hash) noexcept;
+    std::size_t firstBucketOf(unsigned int hash) const noexcept;
+    std::size_t secondBucketOf(unsigned int hash) const noexcept;
+
+    // otherBucketOf() returns the candidate bucket, for the given hash,
+    // that isn't the given one.
+    std::size_t otherBucketOf(unsigned int hash, std::size_t bucket) const noexcept;
+
+    // matching() returns a mask with a bit set for each slot of the given
+    // bucket whose tag is the given one.
+    static unsigned int matching(const Bucket& bucket, std::uint8_t tag) noexcept;
+
+    // lowestSlotOf() returns the lowest slot whose bit is set in the given
+    // (non-zero) mask.
+    static unsigned int lowestSlotOf(unsigned int mask) noexcept;
+
+    static T* slotOf(Bucket& bucket, unsigned int slot) noexcept;
+    static const T* slotOf(const Bucket& bucket, unsigned int slot) noexcept;
+
+    // findIn() returns the slot of the given bucket holding the given
+    // element, or SLOTS if there isn't one.
+    unsigned int findIn(const Bucket& bucket, const T& element, unsigned int hash) const;
+
+    // findInStash() returns the index of the given element in the stash,
+    // or the stash's size if it isn't there.
+    std::size_t findInStash(const T& element, unsigned int hash) const;
+
+    // place() stores a new element in one of its buckets, moving other
+    // elements if need be, and returns true; or, if there's no room to be
+    // made, returns false without touching the element.
+    template <typename Arg>
+    bool place(Arg&& element, unsigned int hash);
+
+    // insertNew() stores a new element in the table, or in the stash, or
+    // (as a last resort) in a larger table.
+    template <typename Arg>
+    void insertNew(Arg&& element, unsigned int hash);
+
+    void moveSlot(std::size_t fromBucket, unsigned int fromSlot, std::size_t toBucket, unsigned int toSlot) noexcept;
+
+    // rehash() moves every element into a table with the given number of
+    // buckets.  If it can't allocate the new table, the set is unchanged;
+    // if it can, but then can't grow again to empty an overfull stash,
+    // every element is still in the set.
+    void rehash(std::size_t newBucketCount);
+
+    // refillFromStash() moves elements out of the stash and into the given
+    // bucket, as long as there's room.
+    void refillFromStash(std::size_t bucket) noexcept;
+
+    void destroy() noexcept;
+
+
+private:
+    HashFunction hashFunction;
+    KeyEqual keyEqual;
+    Bucket* buckets;
+    std::size_t bucketCount;
+    unsigned int elementCount;
+    std::vector<T> stash;
+    std::vector<unsigned int> stashHashes;
+};
+
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+CuckooHashSet<T, Hash, KeyEqual, SLOTS>::CuckooHashSet(HashFunction hashFunction, KeyEqual keyEqual)
+    : hashFunction{hashFunction}, keyEqual{keyEqual},
+      buckets{new Bucket[DEFAULT_BUCKETS]()}, bucketCount{DEFAULT_BUCKETS}, elementCount{0}
+{
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+CuckooHashSet<T, Hash, KeyEqual, SLOTS>::~CuckooHashSet() noexcept
+{
+    destroy();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+CuckooHashSet<T, Hash, KeyEqual, SLOTS>::CuckooHashSet(const CuckooHashSet& s)
+    : hashFunction{s.hashFunction}, keyEqual{s.keyEqual},
+      buckets{nullptr}, bucketCount{0}, elementCount{0},
+      stash{s.stash}, stashHashes{s.stashHashes}
+{
+    // A moved-from set has no buckets at all, and neither does its copy.
+    if (s.buckets == nullptr)
+    {
+        return;
+    }
+
+    buckets = new Bucket[s.bucketCount]();
+    bucketCount = s.bucketCount;
+
+    // Every element is copied into the same bucket and slot, so the copy
+    // is laid out exactly like the original.
+    try
+    {
+        for (std::size_t b = 0; b < bucketCount; ++b)
+        {
+            for (unsigned int slot = 0; slot < SLOTS; ++slot)
+            {
+                if (s.buckets[b].tags[slot] != 0)
+                {
+                    new (slotOf(buckets[b], slot)) T(*slotOf(s.buckets[b], slot));
+                    buckets[b].tags[slot] = s.buckets[b].tags[slot];
+                    buckets[b].hashes[slot] = s.buckets[b].hashes[slot];
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        destroy();
+        throw;
+    }
+
+    elementCount = s.elementCount;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+CuckooHashSet<T, Hash, KeyEqual, SLOTS>::CuckooHashSet(CuckooHashSet&& s) noexcept
+    : hashFunction{s.hashFunction}, keyEqual{s.keyEqual},
+      buckets{nullptr}, bucketCount{0}, elementCount{0}
+{
+    std::swap(buckets, s.buckets);
+    std::swap(bucketCount, s.bucketCount);
+    std::swap(elementCount, s.elementCount);
+    stash.swap(s.stash);
+    stashHashes.swap(s.stashHashes);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+CuckooHashSet<T, Hash, KeyEqual, SLOTS>& CuckooHashSet<T, Hash, KeyEqual, SLOTS>::operator=(const CuckooHashSet& s)
+{
+    if (this != &s)
+    {
+        CuckooHashSet copy{s};
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+CuckooHashSet<T, Hash, KeyEqual, SLOTS>& CuckooHashSet<T, Hash, KeyEqual, SLOTS>::operator=(CuckooHashSet&& s) noexcept
+{
+    std::swap(hashFunction, s.hashFunction);
+    std::swap(keyEqual, s.keyEqual);
+    std::swap(buckets, s.buckets);
+    std::swap(bucketCount, s.bucketCount);
+    std::swap(elementCount, s.elementCount);
+    stash.swap(s.stash);
+    stashHashes.swap(s.stashHashes);
+    return *this;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+bool CuckooHashSet<T, Hash, KeyEqual, SLOTS>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+void CuckooHashSet<T, Hash, KeyEqual, SLOTS>::add(const T& element)
+{
+    if (buckets == nullptr)
+    {
+        rehash(DEFAULT_BUCKETS);
+    }
+
+    unsigned int hash = hashFunction(element);
+
+    if (findIn(buckets[firstBucketOf(hash)], element, hash) != SLOTS
+        || findIn(buckets[secondBucketOf(hash)], element, hash) != SLOTS
+        || findInStash(element, hash) != stash.size())
+    {
+        return;
+    }
+
+    insertNew(element, hash);
+    ++elementCount;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+bool CuckooHashSet<T, Hash, KeyEqual, SLOTS>::contains(const T& element) const
+{
+    if (buckets == nullptr)
+    {
+        return false;
+    }
+
+    unsigned int hash = hashFunction(element);
+
+    return findIn(buckets[firstBucketOf(hash)], element, hash) != SLOTS
+        || findIn(buckets[secondBucketOf(hash)], element, hash) != SLOTS
+        || (!stash.empty() && findInStash(element, hash) != stash.size());
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+bool CuckooHashSet<T, Hash, KeyEqual, SLOTS>::remove(const T& element)
+{
+    if (buckets == nullptr)
+    {
+        return false;
+    }
+
+    unsigned int hash = hashFunction(element);
+
+    for (std::size_t b : {firstBucketOf(hash), secondBucketOf(hash)})
+    {
+        unsigned int slot = findIn(buckets[b], element, hash);
+
+        if (slot != SLOTS)
+        {
+            slotOf(buckets[b], slot)->~T();
+            buckets[b].tags[slot] = 0;
+            --elementCount;
+            refillFromStash(b);
+            return true;
+        }
+    }
+
+    std::size_t index = findInStash(element, hash);
+
+    if (index != stash.size())
+    {
+        stash.erase(stash.begin() + index);
+        stashHashes.erase(stashHashes.begin() + index);
+        --elementCount;
+        return true;
+    }
+
+    return false;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+unsigned int CuckooHashSet<T, Hash, KeyEqual, SLOTS>::size() const noexcept
+{
+    return elementCount;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+std::size_t CuckooHashSet<T, Hash, KeyEqual, SLOTS>::capacity() const noexcept
+{
+    return bucketCount * SLOTS;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+double CuckooHashSet<T, Hash, KeyEqual, SLOTS>::loadFactor() const noexcept
+{
+    return bucketCount == 0 ? 0.0 : static_cast<double>(elementCount - stash.size()) / capacity();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+unsigned int CuckooHashSet<T, Hash, KeyEqual, SLOTS>::stashSize() const noexcept
+{
+    return static_cast<unsigned int>(stash.size());
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+std::size_t CuckooHashSet<T, Hash, KeyEqual, SLOTS>::sizeInBytes() const noexcept
+{
+    return bucketCount * sizeof(Bucket)
+        + stash.capacity() * sizeof(T) + stashHashes.capacity() * sizeof(unsigned int);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+std::uint8_t CuckooHashSet<T, Hash, KeyEqual, SLOTS>::tagOf(unsigned int hash) noexcept
+{
+    std::uint8_t tag = static_cast<std::uint8_t>(mix64(hash) >> 56);
+    return tag == 0 ? 1 : tag;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+std::size_t CuckooHashSet<T, Hash, KeyEqual, SLOTS>::firstBucketOf(unsigned int hash) const noexcept
+{
+    return static_cast<std::size_t>(mix64(hash)) & (bucketCount - 1);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+std::size_t CuckooHashSet<T, Hash, KeyEqual, SLOTS>::secondBucketOf(unsigned int hash) const noexcept
+{
+    // The second bucket comes from different bits than the first, and is
+    // never the same bucket.
+    std::uint64_t scrambled = mix64(hash);
+    std::size_t first = static_cast<std::size_t>(scrambled) & (bucketCount - 1);
+    std::size_t second = static_cast<std::size_t>(scrambled >> 28) & (bucketCount - 1);
+    return second == first ? first ^ 1 : second;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+std::size_t CuckooHashSet<T, Hash, KeyEqual, SLOTS>::otherBucketOf(unsigned int hash, std::size_t bucket) const noexcept
+{
+    std::size_t first = firstBucketOf(hash);
+    return bucket == first ? secondBucketOf(hash) : first;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+unsigned int CuckooHashSet<T, Hash, KeyEqual, SLOTS>::matching(const Bucket& bucket, std::uint8_t tag) noexcept
+{
+#if defined(__SSE2__)
+    __m128i tags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bucket.tags));
+    __m128i equal = _mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(tag)));
+    return static_cast<unsigned int>(_mm_movemask_epi8(equal)) & ALL_SLOTS;
+#else
+    unsigned int mask = 0;
+
+    for (unsigned int slot = 0; slot < SLOTS; ++slot)
+    {
+        mask |= static_cast<unsigned int>(bucket.tags[slot] == tag) << slot;
+    }
+
+    return mask;
+#endif
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+unsigned int CuckooHashSet<T, Hash, KeyEqual, SLOTS>::lowestSlotOf(unsigned int mask) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#else
+    unsigned int slot = 0;
+
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        ++slot;
+    }
+
+    return slot;
+#endif
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+T* CuckooHashSet<T, Hash, KeyEqual, SLOTS>::slotOf(Bucket& bucket, unsigned int slot) noexcept
+{
+    return std::launder(reinterpret_cast<T*>(bucket.storage + slot * sizeof(T)));
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+const T* CuckooHashSet<T, Hash, KeyEqual, SLOTS>::slotOf(const Bucket& bucket, unsigned int slot) noexcept
+{
+    return std::launder(reinterpret_cast<const T*>(bucket.storage + slot * sizeof(T)));
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+unsigned int CuckooHashSet<T, Hash, KeyEqual, SLOTS>::findIn(const Bucket& bucket, const T& element, unsigned int hash) const
+{
+    for (unsigned int candidates = matching(bucket, tagOf(hash)); candidates != 0; candidates &= candidates - 1)
+    {
+        unsigned int slot = lowestSlotOf(candidates);
+
+        if (bucket.hashes[slot] == hash && keyEqual(*slotOf(bucket, slot), element))
+        {
+            return slot;
+        }
+    }
+
+    return SLOTS;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+std::size_t CuckooHashSet<T, Hash, KeyEqual, SLOTS>::findInStash(const T& element, unsigned int hash) const
+{
+    for (std::size_t i = 0; i < stash.size(); ++i)
+    {
+        if (stashHashes[i] == hash && keyEqual(stash[i], element))
+        {
+            return i;
+        }
+    }
+
+    return stash.size();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+template <typename Arg>
+bool CuckooHashSet<T, Hash, KeyEqual, SLOTS>::place(Arg&& element, unsigned int hash)
+{
+    Step steps[MAX_SEARCHED_BUCKETS];
+    unsigned int stepCount = 0;
+
+    steps[stepCount++] = Step{firstBucketOf(hash), -1, 0, 0};
+    steps[stepCount++] = Step{secondBucketOf(hash), -1, 0, 0};
+
+    for (unsigned int current = 0; current < stepCount; ++current)
+    {
+        const Bucket& bucket = buckets[steps[current].bucket];
+        unsigned int empty = matching(bucket, 0);
+
+        if (empty != 0)
+        {
+            // Make the moves from the end of the chain backward, each one
+            // filling the slot the previous one emptied.
+            std::size_t toBucket = steps[current].bucket;
+            unsigned int toSlot = lowestSlotOf(empty);
+
+            for (int step = current; steps[step].parent >= 0; step = steps[step].parent)
+            {
+                std::size_t fromBucket = steps[steps[step].parent].bucket;
+                unsigned int fromSlot = steps[step].slot;
+                moveSlot(fromBucket, fromSlot, toBucket, toSlot);
+                toBucket = fromBucket;
+                toSlot = fromSlot;
+            }
+
+            new (slotOf(buckets[toBucket], toSlot)) T(std::forward<Arg>(element));
+            buckets[toBucket].tags[toSlot] = tagOf(hash);
+            buckets[toBucket].hashes[toSlot] = hash;
+            return true;
+        }
+
+        if (steps[current].depth == MAX_PATH_LENGTH)
+        {
+            continue;
+        }
+
+        for (unsigned int slot = 0; slot < SLOTS && stepCount < MAX_SEARCHED_BUCKETS; ++slot)
+        {
+            std::size_t next = otherBucketOf(bucket.hashes[slot], steps[current].bucket);
+
+            // A chain that visits the same bucket twice could move an
+            // element out of a slot that an earlier move filled, so those
+            // aren't considered.
+            bool revisits = false;
+
+            for (int step = current; step >= 0 && !revisits; step = steps[step].parent)
+            {
+                revisits = steps[step].bucket == next;
+            }
+
+            if (!revisits)
+            {
+                steps[stepCount++] = Step{next, static_cast<int>(current), slot, steps[current].depth + 1};
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+template <typename Arg>
+void CuckooHashSet<T, Hash, KeyEqual, SLOTS>::insertNew(Arg&& element, unsigned int hash)
+{
+    // place() only uses the element when it succeeds, so it can be passed
+    // along again after a failure.
+    while (!place(std::forward<Arg>(element), hash))
+    {
+        if (stash.size() < STASH_SIZE || loadFactor() < MIN_GROWTH_LOAD)
+        {
+            // The hash goes in first, so that it can be taken back out if
+            // there's no room for the element.
+            stashHashes.push_back(hash);
+
+            try
+            {
+                stash.push_back(std::forward<Arg>(element));
+            }
+            catch (...)
+            {
+                stashHashes.pop_back();
+                throw;
+            }
+
+            return;
+        }
+
+        rehash(bucketCount * 2);
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+void CuckooHashSet<T, Hash, KeyEqual, SLOTS>::moveSlot(
+    std::size_t fromBucket, unsigned int fromSlot, std::size_t toBucket, unsigned int toSlot) noexcept
+{
+    T* from = slotOf(buckets[fromBucket], fromSlot);
+    new (slotOf(buckets[toBucket], toSlot)) T(std::move(*from));
+    from->~T();
+
+    buckets[toBucket].tags[toSlot] = buckets[fromBucket].tags[fromSlot];
+    buckets[toBucket].hashes[toSlot] = buckets[fromBucket].hashes[fromSlot];
+    buckets[fromBucket].tags[fromSlot] = 0;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+void CuckooHashSet<T, Hash, KeyEqual, SLOTS>::rehash(std::size_t newBucketCount)
+{
+    // Everything that could fail is allocated before any element moves, so
+    // that a failure leaves the set as it was; moving an element is
+    // assumed not to throw.  The new stash has room for every element,
+    // since the ones that fit neither in the new table nor in the first
+    // STASH_SIZE slots of the stash wait there.
+    Bucket* newBuckets = new Bucket[newBucketCount]();
+    std::vector<T> oldStash;
+    std::vector<unsigned int> oldStashHashes;
+
+    try
+    {
+        oldStash.reserve(elementCount);
+        oldStashHashes.reserve(elementCount);
+    }
+    catch (...)
+    {
+        delete[] newBuckets;
+        throw;
+    }
+
+    Bucket* oldBuckets = buckets;
+    std::size_t oldBucketCount = bucketCount;
+
+    buckets = newBuckets;
+    bucketCount = newBucketCount;
+
+    // Swapping leaves the roomy, empty vectors as the stash.
+    oldStash.swap(stash);
+    oldStashHashes.swap(stashHashes);
+
+    auto reinsert = [&](T&& element, unsigned int hash)
+    {
+        if (!place(std::move(element), hash))
+        {
+            stash.push_back(std::move(element));
+            stashHashes.push_back(hash);
+        }
+    };
+
+    for (std::size_t b = 0; b < oldBucketCount; ++b)
+    {
+        for (unsigned int slot = 0; slot < SLOTS; ++slot)
+        {
+            if (oldBuckets[b].tags[slot] != 0)
+            {
+                T* element = slotOf(oldBuckets[b], slot);
+                reinsert(std::move(*element), oldBuckets[b].hashes[slot]);
+                element->~T();
+            }
+        }
+    }
+
+    delete[] oldBuckets;
+
+    for (std::size_t i = 0; i < oldStash.size(); ++i)
+    {
+        reinsert(std::move(oldStash[i]), oldStashHashes[i]);
+    }
+
+    // Every element is in the set again.  If too many of them ended up in
+    // the stash, the table grows again, following insertNew()'s rule; if
+    // that fails, they're still found in the stash.
+    if (stash.size() > STASH_SIZE && loadFactor() >= MIN_GROWTH_LOAD)
+    {
+        rehash(bucketCount * 2);
+    }
+
+    // Giving back the stash's unused room is only an optimization.
+    try
+    {
+        stash.shrink_to_fit();
+        stashHashes.shrink_to_fit();
+    }
+    catch (...)
+    {
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+void CuckooHashSet<T, Hash, KeyEqual, SLOTS>::refillFromStash(std::size_t bucket) noexcept
+{
+    for (std::size_t i = 0; i < stash.size(); )
+    {
+        unsigned int empty = matching(buckets[bucket], 0);
+        unsigned int hash = stashHashes[i];
+
+        if (empty != 0 && (firstBucketOf(hash) == bucket || secondBucketOf(hash) == bucket))
+        {
+            unsigned int slot = lowestSlotOf(empty);
+            new (slotOf(buckets[bucket], slot)) T(std::move(stash[i]));
+            buckets[bucket].tags[slot] = tagOf(hash);
+            buckets[bucket].hashes[slot] = hash;
+
+            stash.erase(stash.begin() + i);
+            stashHashes.erase(stashHashes.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, unsigned int SLOTS>
+void CuckooHashSet<T, Hash, KeyEqual, SLOTS>::destroy() noexcept
+{
+    if (buckets != nullptr)
+    {
+        for (std::size_t b = 0; b < bucketCount; ++b)
+        {
+            for (unsigned int slot = 0; slot < SLOTS; ++slot)
+            {
+                if (buckets[b].tags[slot] != 0)
+                {
+                    slotOf(buckets[b], slot)->~T();
+                }
+            }
+        }
+
+        delete[] buckets;
+    }
+
+    buckets = nullptr;
+    bucketCount = 0;
+    elementCount = 0;
+    stash.clear();
+    stashHashes.clear();
+}
+
+
+
+#endif // CUCKOOHASHSET_HPP
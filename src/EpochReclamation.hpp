@@ -0,0 +1,340 @@
+// EpochReclamation.hpp
+//
+// Epoch-based memory reclamation for data structures whose readers don't
+// take locks.  When a writer unlinks a node that readers may still be
+// looking at, it can't delete the node right away; instead, it "retires"
+// the node, and the node is deleted only once every thread that might have
+// seen it has moved on.
+//
+// The scheme works like this.  There is a global epoch counter.  Before a
+// thread reads a shared structure, it "pins" itself by announcing the
+// current global epoch; when it's done, it unpins.  The global epoch can
+// only advance from e to e + 1 when every pinned thread has announced e.
+// Anything retired while the global epoch was e can therefore be deleted
+// once the global epoch reaches e + 2, since no thread can still be pinned
+// at an epoch in which it could have reached that object.
+//
+// There's one EpochDomain for the whole program, so that every structure
+// shares the same thread registrations.  Pinning costs one store and a
+// fence; retiring takes a lock, but only writers retire things.
+
+#ifndef EPOCHRECLAMATION_HPP
+#define EPOCHRECLAMATION_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+
+
+class EpochDomain
+{
+public:
+    // A Guard pins the calling thread for as long as it exists.  Guards
+    // can be nested; the thread stays pinned until the outermost one is
+    // destroyed.
+    class Guard
+    {
+    public:
+        Guard(EpochDomain& domain);
+        ~Guard() noexcept;
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        EpochDomain& domain;
+    };
+
+
+public:
+    // global() returns the one EpochDomain shared by the whole program.
+    static EpochDomain& global();
+
+    // Frees everything that is still retired.  By the time the domain is
+    // destroyed (at program exit), no thread is reading anything.
+    ~EpochDomain() noexcept;
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+
+    // pin() returns a Guard that pins the calling thread.
+    Guard pin();
+
+
+    // retire() arranges for the given object to be deleted (by calling
+    // the given deleter on it) once no pinned thread could still be using
+    // it.  The object must already be unreachable from the shared
+    // structure when it's retired.
+    void retire(void* object, void (*deleter)(void*));
+
+
+    // retire() with a typed pointer deletes the object with delete.
+    template <typename T>
+    void retire(T* object);
+
+
+    // epoch() returns the current global epoch.  It's mainly useful for
+    // testing.
+    std::uint64_t epoch() const noexcept;
+
+
+    // collect() tries to advance the global epoch (twice, if possible) and
+    // frees whatever that makes safe to free.  retire() does this on its
+    // own every so often; calling it explicitly is mainly useful for
+    // testing.
+    void collect();
+
+
+private:
+    // A ThreadRecord is the announcement slot of one thread.  Records are
+    // never freed; when a thread exits, its record is released so that
+    // a later thread can reuse it.
+    struct ThreadRecord
+    {
+        std::atomic<std::uint64_t> epoch{0};   // 0 when not pinned
+        std::atomic<bool> inUse{false};
+        unsigned int nesting{0};                // touched only by the owner
+        ThreadRecord* next{nullptr};
+    };
+
+    struct Retired
+    {
+        void* object;
+        void (*deleter)(void*);
+        Retired* next;
+    };
+
+    // A RecordHandle owns the calling thread's ThreadRecord for as long as
+    // the thread runs.
+    struct RecordHandle
+    {
+        RecordHandle(EpochDomain& domain);
+        ~RecordHandle() noexcept;
+
+        ThreadRecord* record;
+    };
+
+    // Retired objects are kept in three lists, indexed by the epoch during
+    // which they were retired, modulo 3.
+    static constexpr unsigned int LISTS = 3;
+
+    // After this many retirements, retire() tries to advance the epoch.
+    static constexpr unsigned int COLLECT_INTERVAL = 64;
+
+
+private:
+    EpochDomain() = default;
+
+    ThreadRecord* localRecord();
+    ThreadRecord* acquireRecord();
+
+    // tryAdvance() advances the global epoch if every pinned thread has
+    // announced it, then frees the list that became safe.  The caller
+    // must hold retireMutex.
+    bool tryAdvance();
+
+    static void freeList(Retired* list) noexcept;
+
+
+private:
+    std::atomic<std::uint64_t> globalEpoch{1};
+    std::atomic<ThreadRecord*> records{nullptr};
+
+    std::mutex retireMutex;
+    Retired* retired[LISTS]{nullptr, nullptr, nullptr};
+    unsigned int sinceCollect{0};
+};
+
+
+
+inline EpochDomain::Guard::Guard(EpochDomain& domain)
+    : domain{domain}
+{
+    ThreadRecord* record = domain.localRecord();
+
+    if (record->nesting++ == 0)
+    {
+        record->epoch.store(domain.globalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        // The announcement must be visible before any of the reads that
+        // it protects are performed.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+
+inline EpochDomain::Guard::~Guard() noexcept
+{
+    ThreadRecord* record = domain.localRecord();
+
+    if (--record->nesting == 0)
+    {
+        record->epoch.store(0, std::memory_order_release);
+    }
+}
+
+
+inline EpochDomain& EpochDomain::global()
+{
+    static EpochDomain domain;
+    return domain;
+}
+
+
+inline EpochDomain::~EpochDomain() noexcept
+{
+    for (unsigned int i = 0; i < LISTS; ++i)
+    {
+        freeList(retired[i]);
+    }
+
+    ThreadRecord* record = records.load();
+
+    while (record != nullptr)
+    {
+        ThreadRecord* next = record->next;
+        delete record;
+        record = next;
+    }
+}
+
+
+inline EpochDomain::Guard EpochDomain::pin()
+{
+    return Guard{*this};
+}
+
+
+inline void EpochDomain::retire(void* object, void (*deleter)(void*))
+{
+    std::lock_guard<std::mutex> lock{retireMutex};
+
+    std::uint64_t epoch = globalEpoch.load(std::memory_order_relaxed);
+    Retired*& list = retired[epoch % LISTS];
+    list = new Retired{object, deleter, list};
+
+    if (++sinceCollect >= COLLECT_INTERVAL)
+    {
+        sinceCollect = 0;
+        tryAdvance();
+    }
+}
+
+
+template <typename T>
+void EpochDomain::retire(T* object)
+{
+    retire(object, [](void* p) { delete static_cast<T*>(p); });
+}
+
+
+inline std::uint64_t EpochDomain::epoch() const noexcept
+{
+    return globalEpoch.load();
+}
+
+
+inline void EpochDomain::collect()
+{
+    std::lock_guard<std::mutex> lock{retireMutex};
+
+    if (tryAdvance())
+    {
+        tryAdvance();
+    }
+}
+
+
+inline EpochDomain::ThreadRecord* EpochDomain::localRecord()
+{
+    thread_local RecordHandle handle{*this};
+    return handle.record;
+}
+
+
+inline EpochDomain::ThreadRecord* EpochDomain::acquireRecord()
+{
+    for (ThreadRecord* record = records.load(std::memory_order_acquire);
+         record != nullptr; record = record->next)
+    {
+        bool expected = false;
+
+        if (!record->inUse.load(std::memory_order_relaxed)
+            && record->inUse.compare_exchange_strong(expected, true))
+        {
+            return record;
+        }
+    }
+
+    ThreadRecord* record = new ThreadRecord;
+    record->inUse.store(true, std::memory_order_relaxed);
+    record->next = records.load(std::memory_order_relaxed);
+
+    while (!records.compare_exchange_weak(record->next, record,
+               std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+
+    return record;
+}
+
+
+inline bool EpochDomain::tryAdvance()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::uint64_t epoch = globalEpoch.load(std::memory_order_relaxed);
+
+    for (ThreadRecord* record = records.load(std::memory_order_acquire);
+         record != nullptr; record = record->next)
+    {
+        std::uint64_t announced = record->epoch.load(std::memory_order_acquire);
+
+        if (announced != 0 && announced != epoch)
+        {
+            return false;
+        }
+    }
+
+    globalEpoch.store(epoch + 1, std::memory_order_release);
+
+    // The list for epoch + 1 is the one that held epoch - 2's retirements,
+    // which nobody can be using anymore.
+    Retired*& list = retired[(epoch + 1) % LISTS];
+    freeList(list);
+    list = nullptr;
+
+    return true;
+}
+
+
+inline void EpochDomain::freeList(Retired* list) noexcept
+{
+    while (list != nullptr)
+    {
+        Retired* next = list->next;
+        list->deleter(list->object);
+        delete list;
+        list = next;
+    }
+}
+
+
+inline EpochDomain::RecordHandle::RecordHandle(EpochDomain& domain)
+    : record{domain.acquireRecord()}
+{
+}
+
+
+inline EpochDomain::RecordHandle::~RecordHandle() noexcept
+{
+    record->epoch.store(0, std::memory_order_release);
+    record->inUse.store(false, std::memory_order_release);
+}
+
+
+
+#endif // EPOCHRECLAMATION_HPP
+
@@ -0,0 +1,179 @@
+// FilteredSet.hpp
+//
+// A FilteredSet is a Set that puts a filter (a BloomFilter or CuckooFilter)
+// in front of another Set -- a HashSet, AVLSet, or SkipListSet -- so that
+// most lookups of elements that aren't in the set are answered by the
+// filter alone, without touching the underlying set at all.  That's a good
+// trade when most lookups miss: a miss in the filter costs one or two
+// cache lines, while a miss in the set costs a chain walk, a descent
+// through a tree, or a descent through the levels of a skip list.  A hit,
+// or one of the filter's false positives, still goes to the set.
+//
+// The filter is sized when the FilteredSet is constructed, for an expected
+// number of elements and a target false positive rate.  Adding more
+// elements than expected is allowed; the false positive rate of a
+// BloomFilter climbs gradually, while a CuckooFilter eventually fills up.
+// If the filter can't record an element, the FilteredSet stops consulting
+// it (every lookup goes straight to the set), so it never gives a wrong
+// answer.
+
+#ifndef FILTEREDSET_HPP
+#define FILTEREDSET_HPP
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "BloomFilter.hpp"
+#include "Hashing.hpp"
+#include "HashSet.hpp"
+#include "Set.hpp"
+
+
+
+template <typename T, typename SetType = HashSet<T>, typename Filter = BloomFilter>
+class FilteredSet : public Set<T>
+{
+public:
+    // A HashFunction is a function that takes a reference to a const T
+    // and returns an unsigned int.  It needn't be the same one the
+    // underlying set uses (trees and skip lists don't use one at all).
+    typedef FunctionHash<T> HashFunction;
+
+public:
+    // Initializes a FilteredSet in front of the given set, with a filter
+    // sized for the given number of elements and false positive rate.
+    // If the given set isn't empty, the filter can't know what's in it,
+    // so it's bypassed from the start.  Invalid rates are reported by the
+    // filter: a BloomFilter throws a BloomFilterException for them, and a
+    // CuckooFilter a CuckooFilterException.
+    FilteredSet(
+        HashFunction hashFunction, unsigned int expectedElements,
+        double falsePositiveRate, SetType set = SetType{});
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  Elements the filter rules out are rejected without
+    // consulting the set.
+    virtual bool contains(const T& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // set() and filter() give read-only access to the two halves of the
+    // FilteredSet, mainly so they can be measured.
+    const SetType& set() const noexcept;
+    const Filter& filter() const noexcept;
+
+
+    // isFiltering() returns true if lookups are still being checked
+    // against the filter, or false if it has been bypassed.
+    bool isFiltering() const noexcept;
+
+
+private:
+    std::uint64_t hashOf(const T& element) const;
+
+
+private:
+    HashFunction hashFunction;
+    SetType elements;
+    Filter elementFilter;
+    bool filtering;
+};
+
+
+
+template <typename T, typename SetType, typename Filter>
+FilteredSet<T, SetType, Filter>::FilteredSet(
+    HashFunction hashFunction, unsigned int expectedElements,
+    double falsePositiveRate, SetType set)
+    : hashFunction{std::move(hashFunction)}, elements{std::move(set)},
+      elementFilter{expectedElements, falsePositiveRate},
+      filtering{elements.size() == 0}
+{
+}
+
+
+template <typename T, typename SetType, typename Filter>
+bool FilteredSet<T, SetType, Filter>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T, typename SetType, typename Filter>
+void FilteredSet<T, SetType, Filter>::add(const T& element)
+{
+    unsigned int sizeBefore = elements.size();
+    elements.add(element);
+
+    // Only elements that are actually new go into the filter, so that a
+    // CuckooFilter never holds the same element twice.
+    if (filtering && elements.size() != sizeBefore && !elementFilter.add(hashOf(element)))
+    {
+        filtering = false;
+    }
+}
+
+
+template <typename T, typename SetType, typename Filter>
+bool FilteredSet<T, SetType, Filter>::contains(const T& element) const
+{
+    if (filtering && !elementFilter.mayContain(hashOf(element)))
+    {
+        return false;
+    }
+
+    return elements.contains(element);
+}
+
+
+template <typename T, typename SetType, typename Filter>
+unsigned int FilteredSet<T, SetType, Filter>::size() const noexcept
+{
+    return elements.size();
+}
+
+
+template <typename T, typename SetType, typename Filter>
+const SetType& FilteredSet<T, SetType, Filter>::set() const noexcept
+{
+    return elements;
+}
+
+
+template <typename T, typename SetType, typename Filter>
+const Filter& FilteredSet<T, SetType, Filter>::filter() const noexcept
+{
+    return elementFilter;
+}
+
+
+template <typename T, typename SetType, typename Filter>
+bool FilteredSet<T, SetType, Filter>::isFiltering() const noexcept
+{
+    return filtering;
+}
+
+
+template <typename T, typename SetType, typename Filter>
+std::uint64_t FilteredSet<T, SetType, Filter>::hashOf(const T& element) const
+{
+    // The filters need 64 well-mixed bits; the hash function gives 32
+    // bits of varying quality.
+    return mix64(hashFunction(element));
+}
+
+
+
+#endif // FILTEREDSET_HPP
@@ -0,0 +1,806 @@
+// FrozenHashSet.hpp
+//
+// A FrozenHashSet is an immutable set, built once (usually by calling
+// freeze() on a HashSet) and then only ever searched.  Since its contents
+// never change, it can use a "minimal perfect hash function": a function
+// that maps each of its n elements to a different index in [0, n), so the
+// elements can be stored in an array of exactly n cells with no chains and
+// no empty cells.  A lookup hashes the key, reads one small "pilot" value,
+// computes the key's index, and compares the key against the one element
+// stored there.  Every lookup, hit or miss, probes the elements exactly
+// once.
+//
+// The perfect hash function is built with "hash and displace" (in the
+// style of CHD and PTHash):
+//
+// * Each element's hash is scrambled with a seed, and the result chooses
+//   one of about n / AVERAGE_BUCKET_SIZE buckets.
+//
+// * Each bucket gets a pilot, a 16-bit number, and an element's index is a
+//   hash of its scrambled hash combined with its bucket's pilot.  The
+//   buckets are processed from largest to smallest, and each one is given
+//   the first pilot that sends all of its elements to indices that are
+//   still free.  (If some bucket has no such pilot, the build starts over
+//   with a different seed.)
+//
+// * To make the search for pilots easy, the indices actually range over a
+//   few more than n positions.  Afterward, the positions past n that were
+//   used are remapped, through a small table, to the positions below n
+//   that weren't.
+//
+// The pilots cost 16 / AVERAGE_BUCKET_SIZE bits per element, and the
+// remapping table a little less than one more.  Everything -- a header,
+// the pilots, the remapping table, and the elements -- lives in one
+// contiguous block of memory that contains no pointers, so when the
+// elements are trivially copyable, the block is position-independent.
+//
+// Since the perfect hash function is computed from the elements' hashes,
+// two different elements with the same hash can't both be given positions
+// by it.  With 32-bit hashes, some such pairs are all but certain once a
+// set has a few hundred thousand elements, so only the first element with
+// each hash is placed by the perfect hash function; the rest go into an
+// "overflow" table, sorted by hash, that follows the other elements in the
+// block.  A lookup searches the overflow table (by binary search on the
+// hashes) only when the one element it probed isn't a match, and only if
+// there's an overflow table at all.  A hash function that gives many
+// elements the same hash makes the overflow table large, and such lookups
+// correspondingly slower.
+
+#ifndef FROZENHASHSET_HPP
+#define FROZENHASHSET_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Hashing.hpp"
+
+
+
+// FrozenHashSetExceptions are thrown when a FrozenHashSet can't be built.
+
+class FrozenHashSetException
+{
+public:
+    FrozenHashSetException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline FrozenHashSetException::FrozenHashSetException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string FrozenHashSetException::reason() const
+{
+    return reason_;
+}
+
+
+
+template <typename T,
+          typename Hash = DefaultHash<T>,
+          typename KeyEqual = std::equal_to<T>>
+class FrozenHashSet
+{
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "over-aligned element types aren't supported");
+
+public:
+    // The average number of elements per bucket.  Larger buckets mean
+    // fewer pilots (and fewer bits per element), but a slower build.
+    static constexpr unsigned int AVERAGE_BUCKET_SIZE = 4;
+
+    // The number of extra positions, per 100 elements, that indices range
+    // over while pilots are being searched for.
+    static constexpr unsigned int EXTRA_POSITIONS_PERCENT = 1;
+
+    // The number of seeds that are tried before the build gives up.
+    static constexpr unsigned int MAX_SEEDS = 64;
+
+    typedef Hash HashFunction;
+
+public:
+    // Initializes a FrozenHashSet containing the elements in the range
+    // [first, last), using the given hash function and equality comparator
+    // on them.  Equal elements in the range are only stored once.  Throws a
+    // FrozenHashSetException if no perfect hash function can be found.
+    // If no hash function is given, DefaultHash<T> (see Hashing.hpp) is
+    // used.
+    template <typename Iterator>
+    FrozenHashSet(
+        Iterator first, Iterator last,
+        HashFunction hashFunction = DefaultHash<T>{}, KeyEqual keyEqual = KeyEqual{});
+
+    // Cleans up the FrozenHashSet so that it leaks no memory.
+    ~FrozenHashSet() noexcept;
+
+    // Initializes a new FrozenHashSet to be a copy of an existing one.
+    FrozenHashSet(const FrozenHashSet& s);
+
+    // Initializes a new FrozenHashSet whose contents are moved from an
+    // expiring one, which is left empty.
+    FrozenHashSet(FrozenHashSet&& s) noexcept;
+
+    // Assigns an existing FrozenHashSet into another.
+    FrozenHashSet& operator=(const FrozenHashSet& s);
+
+    // Assigns an expiring FrozenHashSet into another.
+    FrozenHashSet& operator=(FrozenHashSet&& s) noexcept;
+
+
+    // contains() returns true if the given element is in the set, false
+    // otherwise.  It compares the key against exactly one element.
+    bool contains(const T& element) const;
+
+    // This overload of contains() accepts any key type that the hash
+    // function and the equality comparator both understand.  It's only
+    // available when both of them are transparent.
+    template <typename K, typename H = Hash, typename E = KeyEqual,
+              typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    bool contains(const K& key) const;
+
+
+    // find() returns a pointer to the element in the set that is equal to
+    // the given one, or nullptr if there is no such element.
+    const T* find(const T& element) const;
+
+    // This overload of find() accepts any key type that the hash function
+    // and the equality comparator both understand.  It's only available
+    // when both of them are transparent.
+    template <typename K, typename H = Hash, typename E = KeyEqual,
+              typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    const T* find(const K& key) const;
+
+
+    // size() returns the number of elements in the set.
+    unsigned int size() const noexcept;
+
+
+    // hashSizeInBits() returns the memory used by the perfect hash
+    // function itself (the pilots, the remapping table, and the overflow
+    // table's hashes), which is everything except the elements and a
+    // fixed-size header.
+    std::size_t hashSizeInBits() const noexcept;
+
+
+    // sizeInBytes() returns the size of the block of memory that holds
+    // the whole set.
+    std::size_t sizeInBytes() const noexcept;
+
+
+private:
+    // The block begins with a Header, followed by the pilots, the
+    // remapping table, the overflow table's hashes, and (at the next
+    // multiple of alignof(T)) the elements: first the size elements placed
+    // by the perfect hash function, then the overflow elements.
+    struct Header
+    {
+        std::uint64_t seed;
+        std::uint32_t size;
+        std::uint32_t overflow;
+        std::uint32_t buckets;
+        std::uint32_t positions;
+        std::uint32_t pilotsOffset;
+        std::uint32_t remapOffset;
+        std::uint32_t overflowOffset;
+        std::uint32_t elementsOffset;
+    };
+
+    template <typename K>
+    const T* lookup(const K& key) const;
+
+    // indexOf() computes the index of the element with the given hash.
+    std::uint32_t indexOf(unsigned int hash) const noexcept;
+
+    static std::uint64_t scramble(unsigned int hash, std::uint64_t seed) noexcept;
+    static std::uint32_t bucketOf(std::uint64_t scrambled, std::uint32_t buckets) noexcept;
+    static std::uint32_t positionOf(std::uint64_t scrambled, std::uint16_t pilot, std::uint32_t positions) noexcept;
+
+    const Header& header() const noexcept;
+    const std::uint16_t* pilots() const noexcept;
+    const std::uint32_t* remap() const noexcept;
+    const unsigned int* overflowHashes() const noexcept;
+    T* elements() const noexcept;
+
+    // elementCount() returns the number of elements in the block, both
+    // those placed by the perfect hash function and those in overflow.
+    std::uint32_t elementCount() const noexcept;
+
+    // build() searches for a perfect hash function for the given elements
+    // (which are distinct and have distinct hashes), then allocates and
+    // fills in the block, with the given overflow elements (sorted by their
+    // hashes) at the end.
+    void build(
+        const std::vector<const T*>& items, const std::vector<unsigned int>& hashes,
+        const std::vector<const T*>& overflowItems, const std::vector<unsigned int>& overflowHashes);
+
+    // allocate() allocates a block with room for the given header's
+    // contents, and copies the header into it.
+    void allocate(const Header& h);
+
+    void destroy() noexcept;
+
+
+private:
+    HashFunction hashFunction;
+    KeyEqual keyEqual;
+    unsigned char* block;
+    std::size_t blockSize;
+};
+
+
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename Iterator>
+FrozenHashSet<T, Hash, KeyEqual>::FrozenHashSet(
+    Iterator first, Iterator last, HashFunction hashFunction, KeyEqual keyEqual)
+    : hashFunction{hashFunction}, keyEqual{keyEqual}, block{nullptr}, blockSize{0}
+{
+    std::vector<std::pair<unsigned int, const T*>> sorted;
+
+    for (; first != last; ++first)
+    {
+        const T& element = *first;
+        sorted.emplace_back(this->hashFunction(element), &element);
+    }
+
+    std::sort(sorted.begin(), sorted.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<const T*> items;
+    std::vector<unsigned int> hashes;
+    std::vector<const T*> overflowItems;
+    std::vector<unsigned int> overflowHashes;
+
+    for (std::size_t i = 0; i < sorted.size(); )
+    {
+        // Equal elements have equal hashes, so they're in the same run of
+        // elements with one hash.  The first element of each run is placed
+        // by the perfect hash function, and the others that aren't equal
+        // to any before them go into overflow.
+        std::size_t runStart = i;
+        items.push_back(sorted[i].second);
+        hashes.push_back(sorted[i].first);
+
+        std::size_t overflowStart = overflowItems.size();
+
+        for (++i; i < sorted.size() && sorted[i].first == sorted[runStart].first; ++i)
+        {
+            const T& element = *sorted[i].second;
+            bool duplicate = this->keyEqual(*sorted[runStart].second, element);
+
+            for (std::size_t j = overflowStart; j < overflowItems.size() && !duplicate; ++j)
+            {
+                duplicate = this->keyEqual(*overflowItems[j], element);
+            }
+
+            if (!duplicate)
+            {
+                overflowItems.push_back(&element);
+                overflowHashes.push_back(sorted[i].first);
+            }
+        }
+    }
+
+    build(items, hashes, overflowItems, overflowHashes);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+FrozenHashSet<T, Hash, KeyEqual>::~FrozenHashSet() noexcept
+{
+    destroy();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+FrozenHashSet<T, Hash, KeyEqual>::FrozenHashSet(const FrozenHashSet& s)
+    : hashFunction{s.hashFunction}, keyEqual{s.keyEqual}, block{nullptr}, blockSize{0}
+{
+    if (s.block == nullptr)
+    {
+        return;
+    }
+
+    allocate(s.header());
+
+    // Everything up to the elements is plain data.
+    std::memcpy(block, s.block, s.header().elementsOffset);
+
+    T* target = elements();
+    const T* source = s.elements();
+    std::uint32_t constructed = 0;
+
+    try
+    {
+        for (; constructed < s.elementCount(); ++constructed)
+        {
+            new (&target[constructed]) T(source[constructed]);
+        }
+    }
+    catch (...)
+    {
+        for (std::uint32_t i = 0; i < constructed; ++i)
+        {
+            target[i].~T();
+        }
+
+        ::operator delete(block);
+        block = nullptr;
+        throw;
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+FrozenHashSet<T, Hash, KeyEqual>::FrozenHashSet(FrozenHashSet&& s) noexcept
+    : hashFunction{s.hashFunction}, keyEqual{s.keyEqual}, block{s.block}, blockSize{s.blockSize}
+{
+    s.block = nullptr;
+    s.blockSize = 0;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+FrozenHashSet<T, Hash, KeyEqual>& FrozenHashSet<T, Hash, KeyEqual>::operator=(const FrozenHashSet& s)
+{
+    if (this != &s)
+    {
+        FrozenHashSet copy{s};
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+FrozenHashSet<T, Hash, KeyEqual>& FrozenHashSet<T, Hash, KeyEqual>::operator=(FrozenHashSet&& s) noexcept
+{
+    std::swap(hashFunction, s.hashFunction);
+    std::swap(keyEqual, s.keyEqual);
+    std::swap(block, s.block);
+    std::swap(blockSize, s.blockSize);
+    return *this;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+bool FrozenHashSet<T, Hash, KeyEqual>::contains(const T& element) const
+{
+    return lookup(element) != nullptr;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K, typename H, typename E, typename, typename>
+bool FrozenHashSet<T, Hash, KeyEqual>::contains(const K& key) const
+{
+    return lookup(key) != nullptr;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+const T* FrozenHashSet<T, Hash, KeyEqual>::find(const T& element) const
+{
+    return lookup(element);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K, typename H, typename E, typename, typename>
+const T* FrozenHashSet<T, Hash, KeyEqual>::find(const K& key) const
+{
+    return lookup(key);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+unsigned int FrozenHashSet<T, Hash, KeyEqual>::size() const noexcept
+{
+    return block != nullptr ? elementCount() : 0;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::size_t FrozenHashSet<T, Hash, KeyEqual>::hashSizeInBits() const noexcept
+{
+    if (block == nullptr)
+    {
+        return 0;
+    }
+
+    const Header& h = header();
+    return (static_cast<std::size_t>(h.buckets) * sizeof(std::uint16_t)
+        + static_cast<std::size_t>(h.positions - h.size) * sizeof(std::uint32_t)
+        + static_cast<std::size_t>(h.overflow) * sizeof(unsigned int)) * 8;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::size_t FrozenHashSet<T, Hash, KeyEqual>::sizeInBytes() const noexcept
+{
+    return blockSize;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K>
+const T* FrozenHashSet<T, Hash, KeyEqual>::lookup(const K& key) const
+{
+    if (block == nullptr || header().size == 0)
+    {
+        return nullptr;
+    }
+
+    unsigned int hash = hashFunction(key);
+    const T* candidate = &elements()[indexOf(hash)];
+
+    if (keyEqual(*candidate, key))
+    {
+        return candidate;
+    }
+
+    const Header& h = header();
+
+    if (h.overflow == 0)
+    {
+        return nullptr;
+    }
+
+    const unsigned int* overflowBegin = overflowHashes();
+    const unsigned int* overflowEnd = overflowBegin + h.overflow;
+
+    for (const unsigned int* i = std::lower_bound(overflowBegin, overflowEnd, hash);
+         i != overflowEnd && *i == hash; ++i)
+    {
+        candidate = &elements()[h.size + (i - overflowBegin)];
+
+        if (keyEqual(*candidate, key))
+        {
+            return candidate;
+        }
+    }
+
+    return nullptr;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::uint32_t FrozenHashSet<T, Hash, KeyEqual>::indexOf(unsigned int hash) const noexcept
+{
+    const Header& h = header();
+    std::uint64_t scrambled = scramble(hash, h.seed);
+    std::uint32_t position = positionOf(scrambled, pilots()[bucketOf(scrambled, h.buckets)], h.positions);
+
+    return position < h.size ? position : remap()[position - h.size];
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::uint64_t FrozenHashSet<T, Hash, KeyEqual>::scramble(unsigned int hash, std::uint64_t seed) noexcept
+{
+    return mix64(hash ^ seed);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::uint32_t FrozenHashSet<T, Hash, KeyEqual>::bucketOf(std::uint64_t scrambled, std::uint32_t buckets) noexcept
+{
+    // Multiplying and keeping the high half maps the low 32 bits onto
+    // [0, buckets) without a division.
+    return static_cast<std::uint32_t>(((scrambled & 0xFFFFFFFFull) * buckets) >> 32);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::uint32_t FrozenHashSet<T, Hash, KeyEqual>::positionOf(
+    std::uint64_t scrambled, std::uint16_t pilot, std::uint32_t positions) noexcept
+{
+    std::uint64_t mixed = mix64(scrambled ^ (pilot * 0x9E3779B97F4A7C15ull));
+    return static_cast<std::uint32_t>(((mixed >> 32) * positions) >> 32);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+const typename FrozenHashSet<T, Hash, KeyEqual>::Header& FrozenHashSet<T, Hash, KeyEqual>::header() const noexcept
+{
+    return *reinterpret_cast<const Header*>(block);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+const std::uint16_t* FrozenHashSet<T, Hash, KeyEqual>::pilots() const noexcept
+{
+    return reinterpret_cast<const std::uint16_t*>(block + header().pilotsOffset);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+const std::uint32_t* FrozenHashSet<T, Hash, KeyEqual>::remap() const noexcept
+{
+    return reinterpret_cast<const std::uint32_t*>(block + header().remapOffset);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+const unsigned int* FrozenHashSet<T, Hash, KeyEqual>::overflowHashes() const noexcept
+{
+    return reinterpret_cast<const unsigned int*>(block + header().overflowOffset);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+T* FrozenHashSet<T, Hash, KeyEqual>::elements() const noexcept
+{
+    return reinterpret_cast<T*>(block + header().elementsOffset);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+std::uint32_t FrozenHashSet<T, Hash, KeyEqual>::elementCount() const noexcept
+{
+    return header().size + header().overflow;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void FrozenHashSet<T, Hash, KeyEqual>::build(
+    const std::vector<const T*>& items, const std::vector<unsigned int>& hashes,
+    const std::vector<const T*>& overflowItems, const std::vector<unsigned int>& overflowHashes)
+{
+    std::uint32_t n = static_cast<std::uint32_t>(items.size());
+    std::uint32_t overflow = static_cast<std::uint32_t>(overflowItems.size());
+
+    Header h{};
+    h.size = n;
+    h.overflow = overflow;
+    h.buckets = n / AVERAGE_BUCKET_SIZE + 1;
+    h.positions = n + n * EXTRA_POSITIONS_PERCENT / 100 + 1;
+
+    std::vector<std::uint64_t> scrambled(n);
+    std::vector<std::uint32_t> bucketStart(h.buckets + 1);
+    std::vector<std::uint32_t> members(n);
+    std::vector<std::uint32_t> order(h.buckets);
+    std::vector<std::uint16_t> pilotValues(h.buckets);
+    std::vector<bool> taken(h.positions);
+    std::vector<std::uint32_t> positions(n);
+
+    bool found = false;
+
+    for (unsigned int attempt = 0; attempt < MAX_SEEDS && !found; ++attempt)
+    {
+        h.seed = mix64(0x5EED0000ull + attempt);
+
+        // Group the elements by bucket, with a counting sort.
+        std::fill(bucketStart.begin(), bucketStart.end(), 0);
+
+        for (std::uint32_t i = 0; i < n; ++i)
+        {
+            scrambled[i] = scramble(hashes[i], h.seed);
+            ++bucketStart[bucketOf(scrambled[i], h.buckets) + 1];
+        }
+
+        for (std::uint32_t b = 0; b < h.buckets; ++b)
+        {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+
+        {
+            std::vector<std::uint32_t> next(bucketStart.begin(), bucketStart.end() - 1);
+
+            for (std::uint32_t i = 0; i < n; ++i)
+            {
+                members[next[bucketOf(scrambled[i], h.buckets)]++] = i;
+            }
+        }
+
+        // The largest buckets are the hardest to place, so they go first,
+        // while most positions are still free.
+        for (std::uint32_t b = 0; b < h.buckets; ++b)
+        {
+            order[b] = b;
+        }
+
+        std::stable_sort(order.begin(), order.end(),
+            [&](std::uint32_t a, std::uint32_t b)
+            {
+                return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+            });
+
+        std::fill(taken.begin(), taken.end(), false);
+        std::fill(pilotValues.begin(), pilotValues.end(), 0);
+        found = true;
+
+        for (std::uint32_t b : order)
+        {
+            std::uint32_t begin = bucketStart[b];
+            std::uint32_t end = bucketStart[b + 1];
+
+            if (begin == end)
+            {
+                break;
+            }
+
+            bool placed = false;
+
+            for (std::uint32_t pilot = 0; pilot <= 0xFFFF && !placed; ++pilot)
+            {
+                placed = true;
+
+                for (std::uint32_t k = begin; k < end && placed; ++k)
+                {
+                    std::uint32_t p = positionOf(scrambled[members[k]], static_cast<std::uint16_t>(pilot), h.positions);
+
+                    if (taken[p])
+                    {
+                        placed = false;
+                    }
+                    else
+                    {
+                        // Two elements of the same bucket can collide with
+                        // each other, too.
+                        for (std::uint32_t j = begin; j < k; ++j)
+                        {
+                            if (positions[members[j]] == p)
+                            {
+                                placed = false;
+                            }
+                        }
+                    }
+
+                    positions[members[k]] = p;
+                }
+
+                if (placed)
+                {
+                    pilotValues[b] = static_cast<std::uint16_t>(pilot);
+
+                    for (std::uint32_t k = begin; k < end; ++k)
+                    {
+                        taken[positions[members[k]]] = true;
+                    }
+                }
+            }
+
+            if (!placed)
+            {
+                found = false;
+                break;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        throw FrozenHashSetException{"no perfect hash function was found"};
+    }
+
+    std::size_t pilotsOffset = sizeof(Header);
+    std::size_t remapOffset = pilotsOffset + h.buckets * sizeof(std::uint16_t);
+    remapOffset = (remapOffset + alignof(std::uint32_t) - 1) / alignof(std::uint32_t) * alignof(std::uint32_t);
+    std::size_t overflowOffset = remapOffset + (h.positions - n) * sizeof(std::uint32_t);
+    std::size_t elementsOffset = overflowOffset + overflow * sizeof(unsigned int);
+    elementsOffset = (elementsOffset + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    h.pilotsOffset = static_cast<std::uint32_t>(pilotsOffset);
+    h.remapOffset = static_cast<std::uint32_t>(remapOffset);
+    h.overflowOffset = static_cast<std::uint32_t>(overflowOffset);
+    h.elementsOffset = static_cast<std::uint32_t>(elementsOffset);
+
+    allocate(h);
+
+    std::memcpy(block + pilotsOffset, pilotValues.data(), h.buckets * sizeof(std::uint16_t));
+
+    if (overflow > 0)
+    {
+        std::memcpy(block + overflowOffset, overflowHashes.data(), overflow * sizeof(unsigned int));
+    }
+
+    // Each position past the end that some element landed on is sent to a
+    // position before the end that none did.  There are exactly as many
+    // of one as of the other.
+    std::uint32_t* remapTable = reinterpret_cast<std::uint32_t*>(block + remapOffset);
+    std::uint32_t freePosition = 0;
+
+    for (std::uint32_t p = n; p < h.positions; ++p)
+    {
+        remapTable[p - n] = 0;
+
+        if (taken[p])
+        {
+            while (taken[freePosition])
+            {
+                ++freePosition;
+            }
+
+            remapTable[p - n] = freePosition++;
+        }
+    }
+
+    T* target = elements();
+    std::vector<bool> constructed(n + overflow, false);
+
+    try
+    {
+        for (std::uint32_t i = 0; i < n; ++i)
+        {
+            std::uint32_t index = positions[i] < n ? positions[i] : remapTable[positions[i] - n];
+            new (&target[index]) T(*items[i]);
+            constructed[index] = true;
+        }
+
+        for (std::uint32_t i = 0; i < overflow; ++i)
+        {
+            new (&target[n + i]) T(*overflowItems[i]);
+            constructed[n + i] = true;
+        }
+    }
+    catch (...)
+    {
+        for (std::uint32_t i = 0; i < n + overflow; ++i)
+        {
+            if (constructed[i])
+            {
+                target[i].~T();
+            }
+        }
+
+        ::operator delete(block);
+        block = nullptr;
+        blockSize = 0;
+        throw;
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void FrozenHashSet<T, Hash, KeyEqual>::allocate(const Header& h)
+{
+    blockSize = h.elementsOffset + (static_cast<std::size_t>(h.size) + h.overflow) * sizeof(T);
+    block = static_cast<unsigned char*>(::operator new(blockSize));
+    std::memcpy(block, &h, sizeof(Header));
+}
+
+
+template <typename T, typename Hash, typename KeyEqual>
+void FrozenHashSet<T, Hash, KeyEqual>::destroy() noexcept
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    if constexpr (!std::is_trivially_destructible<T>::value)
+    {
+        T* items = elements();
+
+        for (std::uint32_t i = 0; i < elementCount(); ++i)
+        {
+            items[i].~T();
+        }
+    }
+
+    ::operator delete(block);
+    block = nullptr;
+    blockSize = 0;
+}
+
+
+
+#endif // FROZENHASHSET_HPP
@@ -0,0 +1,263 @@
+// HashMap.hpp
+//
+// A HashMap associates keys with values.  It's built on the same HashTable
+// as HashSet -- a separately-chained hash table that doubles its capacity
+// when the ratio of size to capacity would exceed 0.8 -- so it has the
+// same hashing, caching, and heterogeneous lookup behavior.  Each node of
+// the table stores a std::pair<const K, V>.
+//
+// Values are constructed in place inside their nodes by try_emplace() and
+// insert_or_assign(), and nodes are relinked rather than copied when the
+// table is resized, so a value is never copied or moved once it's in the
+// map.  A pointer returned from find() or try_emplace() remains valid until
+// its key is erased or the map is destroyed.
+
+#ifndef HASHMAP_HPP
+#define HASHMAP_HPP
+
+#include <functional>
+#include <tuple>
+#include <utility>
+#include "HashTable.hpp"
+
+
+
+template <typename K,
+          typename V,
+          typename Hash = DefaultHash<K>,
+          typename KeyEqual = std::equal_to<K>,
+          bool CacheHash = HashCachingPolicy<K>::value>
+class HashMap
+{
+public:
+    // A HashFunction is a function that takes a reference to a const K
+    // and returns an unsigned int.  If it (along with KeyEqual) declares
+    // is_transparent, heterogeneous lookup is enabled.
+    typedef Hash HashFunction;
+
+public:
+    // Initializes a HashMap to be empty, so that it will use the given
+    // hash function whenever it needs to hash a key.  If none is given,
+    // DefaultHash<K> (see Hashing.hpp) is used.
+    HashMap(HashFunction hashFunction = DefaultHash<K>{}, KeyEqual keyEqual = KeyEqual{});
+
+    // The HashTable takes care of copying, moving, and cleaning up.
+    HashMap(const HashMap& m) = default;
+    HashMap(HashMap&& m) noexcept = default;
+    HashMap& operator=(const HashMap& m) = default;
+    HashMap& operator=(HashMap&& m) noexcept = default;
+
+
+    // insert_or_assign() associates the given value with the given key.
+    // If the key is already in the map, the value is assigned over its
+    // existing one; otherwise, a new value is constructed in place from it.
+    // It returns a pointer to the value in the map, along with true if the
+    // key was inserted and false if it was assigned.
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign(const K& key, M&& value);
+
+    template <typename M>
+    std::pair<V*, bool> insert_or_assign(K&& key, M&& value);
+
+
+    // try_emplace() constructs a value in place from the given arguments
+    // and associates it with the given key, but only if the key isn't
+    // already in the map; if it is, the arguments are left untouched.  It
+    // returns a pointer to the value associated with the key, along with
+    // true if the value was just constructed and false otherwise.
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace(const K& key, Args&&... args);
+
+    template <typename... Args>
+    std::pair<V*, bool> try_emplace(K&& key, Args&&... args);
+
+
+    // find() returns a pointer to the value associated with the given key,
+    // or nullptr if the key isn't in the map.
+    V* find(const K& key);
+    const V* find(const K& key) const;
+
+    // These overloads of find() accept any key type that the hash function
+    // and the equality comparator both understand.  They're only available
+    // when both of them are transparent.
+    template <typename Q, typename H = Hash, typename E = KeyEqual,
+              typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    V* find(const Q& key);
+
+    template <typename Q, typename H = Hash, typename E = KeyEqual,
+              typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    const V* find(const Q& key) const;
+
+
+    // contains() returns true if the given key is in the map, false
+    // otherwise.
+    bool contains(const K& key) const;
+
+
+    // erase() removes the given key (and its value) from the map, returning
+    // true if it was there and false otherwise.  The table shrinks when the
+    // ratio of size to capacity falls below 0.2.
+    bool erase(const K& key);
+
+
+    // clear() removes every key (and its value) from the map.
+    void clear() noexcept;
+
+
+    // size() returns the number of keys in the map.
+    unsigned int size() const noexcept;
+
+
+private:
+    typedef std::pair<const K, V> Entry;
+
+    struct KeyOf
+    {
+        const K& operator()(const Entry& entry) const noexcept
+        {
+            return entry.first;
+        }
+    };
+
+    typedef HashTable<Entry, KeyOf, Hash, KeyEqual, CacheHash> Table;
+
+
+private:
+    Table table;
+};
+
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+HashMap<K, V, Hash, KeyEqual, CacheHash>::HashMap(HashFunction hashFunction, KeyEqual keyEqual)
+    : table{hashFunction, keyEqual}
+{
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename M>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, CacheHash>::insert_or_assign(const K& key, M&& value)
+{
+    std::pair<Entry*, bool> result = table.emplace(
+        key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<M>(value)));
+
+    if (!result.second)
+    {
+        result.first->second = std::forward<M>(value);
+    }
+
+    return {&result.first->second, result.second};
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename M>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, CacheHash>::insert_or_assign(K&& key, M&& value)
+{
+    // The key is only moved from if a new entry is constructed, which
+    // happens after the lookup that uses it.
+    std::pair<Entry*, bool> result = table.emplace(
+        key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<M>(value)));
+
+    if (!result.second)
+    {
+        result.first->second = std::forward<M>(value);
+    }
+
+    return {&result.first->second, result.second};
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, CacheHash>::try_emplace(const K& key, Args&&... args)
+{
+    std::pair<Entry*, bool> result = table.emplace(
+        key, std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+
+    return {&result.first->second, result.second};
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename... Args>
+std::pair<V*, bool> HashMap<K, V, Hash, KeyEqual, CacheHash>::try_emplace(K&& key, Args&&... args)
+{
+    std::pair<Entry*, bool> result = table.emplace(
+        key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+
+    return {&result.first->second, result.second};
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+V* HashMap<K, V, Hash, KeyEqual, CacheHash>::find(const K& key)
+{
+    Entry* entry = table.find(key);
+    return entry != nullptr ? &entry->second : nullptr;
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+const V* HashMap<K, V, Hash, KeyEqual, CacheHash>::find(const K& key) const
+{
+    const Entry* entry = table.find(key);
+    return entry != nullptr ? &entry->second : nullptr;
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename Q, typename H, typename E, typename, typename>
+V* HashMap<K, V, Hash, KeyEqual, CacheHash>::find(const Q& key)
+{
+    Entry* entry = table.find(key);
+    return entry != nullptr ? &entry->second : nullptr;
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename Q, typename H, typename E, typename, typename>
+const V* HashMap<K, V, Hash, KeyEqual, CacheHash>::find(const Q& key) const
+{
+    const Entry* entry = table.find(key);
+    return entry != nullptr ? &entry->second : nullptr;
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashMap<K, V, Hash, KeyEqual, CacheHash>::contains(const K& key) const
+{
+    return table.find(key) != nullptr;
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashMap<K, V, Hash, KeyEqual, CacheHash>::erase(const K& key)
+{
+    return table.erase(key);
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+void HashMap<K, V, Hash, KeyEqual, CacheHash>::clear() noexcept
+{
+    table.clear();
+}
+
+
+template <typename K, typename V, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashMap<K, V, Hash, KeyEqual, CacheHash>::size() const noexcept
+{
+    return table.size();
+}
+
+
+
+#endif // HASHMAP_HPP
+
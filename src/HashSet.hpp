@@ -19,16 +19,61 @@
 // in your data structure.  Instead, you'll need to use a dynamically-
 // allocated array and your own linked list implemenation; the linked list
 // doesn't have to be its own class, though you can do that, if you'd like.
+//
+// Lookups can be heterogeneous: when the hash function and the equality
+// comparator both declare a nested "is_transparent" type, contains() and
+// find() accept any key type that both of them understand, so that (for
+// example) a HashSet<std::string> can be searched with a std::string_view
+// without constructing a temporary std::string.  StringHash, in
+// Hashing.hpp, is a transparent hash function for string keys that can be
+// used this way.  When no hash function is given at all, DefaultHash<T>
+// (also in Hashing.hpp) is used, which covers integers, enums, pointers,
+// and strings; it's also the default Hash type, so a HashSet of some
+// other type must name a Hash type of its own, such as FunctionHash<T>.
+//
+// The table itself is a HashTable (which HashMap shares), whose values
+// are the elements themselves.  If a pathologically long chain ever forms,
+// because of a poor hash function or keys chosen to collide, the table
+// starts scrambling hashes with a secret random seed (see HashTable.hpp);
+// elementsAtIndex() and isElementAtIndex() report the cells that elements
+// are actually in, so after that happens, they no longer follow directly
+// from the hash function.  diagnostics() reports how evenly the elements
+// are spread.
+//
+// When T is trivially copyable, a HashSet can be saved to a file with
+// save() and loaded back with load().  The file holds the array's
+// capacity, the hash seed (if any), and the elements grouped by cell, each
+// cell's elements in one contiguous run, so a loaded HashSet doesn't
+// rehash or allocate anything: it maps the file into memory and answers
+// lookups directly from it, finding each element in the same cell it was
+// in when it was saved.  The first change to a loaded HashSet "promotes"
+// it, copying its elements into an ordinary table (with the same seed);
+// until then, the file must be left as it is.  A loaded HashSet must be
+// given the same hash function as the one that was saved.
 
 #ifndef HASHSET_HPP
 #define HASHSET_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "FrozenHashSet.hpp"
+#include "HashTable.hpp"
+#include "Hashing.hpp"
 #include "Set.hpp"
+#include "Snapshot.hpp"
 
 
 
-template <typename T>
+template <typename T,
+          typename Hash = DefaultHash<T>,
+          typename KeyEqual = std::equal_to<T>,
+          bool CacheHash = HashCachingPolicy<T>::value>
 class HashSet : public Set<T>
 {
 public:
@@ -37,13 +82,18 @@ public:
     static constexpr unsigned int DEFAULT_CAPACITY = 10;
 
     // A HashFunction is a function that takes a reference to a const T
-    // and returns an unsigned int.
-    typedef std::function<unsigned int(const T&)> HashFunction;
+    // and returns an unsigned int.  By default, it's DefaultHash<T>, which
+    // the compiler can inline; to pass a lambda or a plain function
+    // instead, use FunctionHash<T> (see Hashing.hpp) or the function
+    // object's own type.  If it (along with KeyEqual) declares
+    // is_transparent, heterogeneous lookup is enabled.
+    typedef Hash HashFunction;
 
 public:
     // Initializes a HashSet to be empty, so that it will use the given
-    // hash function whenever it needs to hash an element.
-    HashSet(HashFunction hashFunction);
+    // hash function whenever it needs to hash an element.  If none is
+    // given, DefaultHash<T> (see Hashing.hpp) is used.
+    HashSet(HashFunction hashFunction = DefaultHash<T>{}, KeyEqual keyEqual = KeyEqual{});
 
     // Cleans up the HashSet so that it leaks no memory.
     virtual ~HashSet() noexcept;
@@ -82,11 +132,81 @@ public:
     // to the number of elements, assuming a good hash function).
     virtual bool contains(const T& element) const override;
 
+    // This overload of contains() accepts any key type that the hash
+    // function and the equality comparator both understand.  It's only
+    // available when both of them are transparent.
+    template <typename K, typename H = Hash, typename E = KeyEqual,
+              typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    bool contains(const K& key) const;
+
+
+    // containsBatch() sets out[i] to contains(keys[i]) for each of the n
+    // keys.  Rather than looking the keys up one at a time, it hashes a
+    // group of them, prefetches their cells and then their chains, and only
+    // then compares, so that the cache misses of a whole group overlap.
+    // For a set much larger than the cache, that's substantially faster
+    // than calling contains() in a loop.
+    void containsBatch(const T* keys, std::size_t n, bool* out) const;
+
+
+    // addBatch() adds each of the n given elements, just as calling add()
+    // on each of them in order would, but with the cache misses of each
+    // group of elements overlapped the same way containsBatch() does.
+    void addBatch(const T* elements, std::size_t n);
+
+
+    // build() adds every element in the range [first, last), using the
+    // given number of threads (or one, if it's 0).  Rather than growing
+    // the array step by step, it grows it once, to fit the whole range;
+    // then each thread fills its own contiguous share of the array's
+    // cells, so no locks are needed, and duplicates (which always land in
+    // the same cell) are caught by whichever thread owns that cell.  The
+    // iterators must be random access iterators.  No other member function
+    // may be called on the set while build() is running.
+    template <typename RandomAccessIterator>
+    void build(RandomAccessIterator first, RandomAccessIterator last, unsigned int threads);
+
+
+    // remove() removes an element from the set, returning true if it was
+    // there and false otherwise.  The element's node is unlinked from its
+    // chain, so nothing is left behind for later lookups to step over.
+    // This function triggers a resizing of the array, halving it, when the
+    // ratio of size to capacity falls below 0.2, but never shrinks it below
+    // DEFAULT_CAPACITY.
+    bool remove(const T& element);
+
+
+    // clear() removes every element from the set, leaving the capacity of
+    // the array as it was, so a set that's cleared and refilled (say, once
+    // per window of a stream) doesn't grow its way back up every time.
+    void clear() noexcept;
+
+
+    // find() returns a pointer to the element in the set that is equal to
+    // the given one, or nullptr if there is no such element.  The pointer
+    // remains valid until the element's HashSet is modified or destroyed.
+    const T* find(const T& element) const;
+
+    // This overload of find() accepts any key type that the hash function
+    // and the equality comparator both understand.  It's only available
+    // when both of them are transparent.
+    template <typename K, typename H = Hash, typename E = KeyEqual,
+              typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    const T* find(const K& key) const;
+
 
     // size() returns the number of elements in the set.
     virtual unsigned int size() const noexcept override;
 
 
+    // forEach() calls visit(element) on every element in the set, in no
+    // particular order.
+    template <typename Visit>
+    void forEach(Visit visit) const;
+
+
     // elementsAtIndex() returns the number of elements that hashed to a
     // particular index in the array.  If the index is out of the boundaries
     // of the array, this function returns 0.
@@ -99,91 +219,586 @@ public:
     bool isElementAtIndex(const T& element, unsigned int index) const;
 
 
+    // freeze() returns an immutable FrozenHashSet containing the same
+    // elements, using the same hash function and equality comparator,
+    // whose lookups each compare against exactly one element, unless it
+    // shares its hash with another element.  It throws a
+    // FrozenHashSetException if no perfect hash function can be found.
+    FrozenHashSet<T, Hash, KeyEqual> freeze() const;
+
+
+    // diagnostics() returns a report of how the elements are spread across
+    // the array: a histogram of chain lengths, the longest chain, how many
+    // collisions there are compared to how many a uniformly random hash
+    // function would produce, the memory used per element, and whether the
+    // table has had to start scrambling hashes.  It runs in linear time.
+    HashTableDiagnostics diagnostics() const;
+
+
+    // save() writes the set to the file at the given path, replacing it
+    // atomically.  The file begins with a versioned header recording the
+    // size and alignment of T, the size, the capacity, and the seed, and
+    // ends with the elements; a CRC-32C checksum covers all of it.  It
+    // throws a SnapshotException if the file can't be written.  T must be
+    // trivially copyable, and the file can only be loaded on a machine with
+    // the same byte order.
+    void save(const std::string& path) const;
+
+
+    // load() replaces the set's contents with those saved in the file at
+    // the given path, which is mapped into memory rather than read, so it
+    // takes the same time no matter how large the file is, except that
+    // the checksum is verified (unless verifyChecksum is false), which
+    // reads the whole file once.  It throws a SnapshotException, leaving
+    // the set as it was, if the file can't be read or isn't a valid
+    // snapshot of a HashSet of this type.
+    void load(const std::string& path, bool verifyChecksum = true);
+
+
+    // isMapped() returns true if the set was loaded from a file and is
+    // still answering lookups directly from it, false otherwise.
+    bool isMapped() const noexcept;
+
+
+private:
+    struct KeyOf
+    {
+        const T& operator()(const T& element) const noexcept
+        {
+            return element;
+        }
+    };
+
+    typedef HashTable<T, KeyOf, Hash, KeyEqual, CacheHash> Table;
+
+    // A snapshot file begins with a SnapshotHeader.  The cells follow it:
+    // capacity + 1 offsets into the elements, with cell i's elements at
+    // [cells[i], cells[i + 1]).  The elements come last, at the next
+    // multiple of eight (or of T's alignment, if that's stricter).  The
+    // checksum is of the header, with the checksum itself taken as zero,
+    // followed by everything after the header.
+    struct SnapshotHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t elementSize;
+        std::uint32_t elementAlignment;
+        std::uint32_t size;
+        std::uint32_t capacity;
+        std::uint64_t seed;
+        std::uint32_t seeded;
+        std::uint32_t checksum;
+        std::uint64_t cellsOffset;
+        std::uint64_t elementsOffset;
+        std::uint64_t fileSize;
+    };
+
+    static constexpr char SNAPSHOT_MAGIC[8] = {'H', 'A', 'S', 'H', 'S', 'E', 'T', '\0'};
+    static constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    // A Snapshot is a mapped snapshot file whose contents have been
+    // validated.  Copies of a loaded HashSet share it.
+    struct Snapshot
+    {
+        Snapshot(const std::string& path, bool verifyChecksum);
+
+        MappedFile file;
+        const std::uint32_t* cells;
+        const T* elements;
+        unsigned int size;
+        unsigned int capacity;
+        bool seeded;
+        std::uint64_t seed;
+    };
+
+    // lookup() finds the element equal to the given key, wherever the
+    // elements are.
+    template <typename K>
+    const T* lookup(const K& key) const;
+
+    // promote() copies the elements of a loaded set into the table, so
+    // that it can be changed.  It does nothing if the set isn't mapped.
+    void promote();
+
+
 private:
-    HashFunction hashFunction;
+    Table table;
+    std::shared_ptr<const Snapshot> snapshot;
 };
 
 
 
-template <typename T>
-HashSet<T>::HashSet(HashFunction hashFunction)
-    : hashFunction{hashFunction}
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashSet<T, Hash, KeyEqual, CacheHash>::HashSet(HashFunction hashFunction, KeyEqual keyEqual)
+    : table{hashFunction, keyEqual}
 {
 }
 
 
-template <typename T>
-HashSet<T>::~HashSet() noexcept
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashSet<T, Hash, KeyEqual, CacheHash>::~HashSet() noexcept
 {
 }
 
 
-template <typename T>
-HashSet<T>::HashSet(const HashSet& s)
-    : hashFunction{nullptr}
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashSet<T, Hash, KeyEqual, CacheHash>::HashSet(const HashSet& s)
+    : table{s.table}, snapshot{s.snapshot}
 {
 }
 
 
-template <typename T>
-HashSet<T>::HashSet(HashSet&& s) noexcept
-    : hashFunction{nullptr}
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashSet<T, Hash, KeyEqual, CacheHash>::HashSet(HashSet&& s) noexcept
+    : table{std::move(s.table)}, snapshot{std::move(s.snapshot)}
 {
 }
 
 
-template <typename T>
-HashSet<T>& HashSet<T>::operator=(const HashSet& s)
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashSet<T, Hash, KeyEqual, CacheHash>& HashSet<T, Hash, KeyEqual, CacheHash>::operator=(const HashSet& s)
 {
+    table = s.table;
+    snapshot = s.snapshot;
     return *this;
 }
 
 
-template <typename T>
-HashSet<T>& HashSet<T>::operator=(HashSet&& s) noexcept
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashSet<T, Hash, KeyEqual, CacheHash>& HashSet<T, Hash, KeyEqual, CacheHash>::operator=(HashSet&& s) noexcept
 {
+    table = std::move(s.table);
+    snapshot = std::move(s.snapshot);
     return *this;
 }
 
 
-template <typename T>
-bool HashSet<T>::isImplemented() const noexcept
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashSet<T, Hash, KeyEqual, CacheHash>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+void HashSet<T, Hash, KeyEqual, CacheHash>::add(const T& element)
+{
+    promote();
+    table.emplace(element, element);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashSet<T, Hash, KeyEqual, CacheHash>::contains(const T& element) const
+{
+    return lookup(element) != nullptr;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K, typename H, typename E, typename, typename>
+bool HashSet<T, Hash, KeyEqual, CacheHash>::contains(const K& key) const
+{
+    return lookup(key) != nullptr;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+void HashSet<T, Hash, KeyEqual, CacheHash>::containsBatch(const T* keys, std::size_t n, bool* out) const
+{
+    if (snapshot)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            out[i] = lookup(keys[i]) != nullptr;
+        }
+
+        return;
+    }
+
+    table.findBatch(keys, n,
+        [out](std::size_t i, const T* found)
+        {
+            out[i] = found != nullptr;
+        });
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+void HashSet<T, Hash, KeyEqual, CacheHash>::addBatch(const T* elements, std::size_t n)
+{
+    promote();
+    table.emplaceBatch(elements, n);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename RandomAccessIterator>
+void HashSet<T, Hash, KeyEqual, CacheHash>::build(
+    RandomAccessIterator first, RandomAccessIterator last, unsigned int threads)
 {
-    return false;
+    promote();
+    table.emplaceParallel(first, last, threads);
 }
 
 
-template <typename T>
-void HashSet<T>::add(const T& element)
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashSet<T, Hash, KeyEqual, CacheHash>::remove(const T& element)
 {
+    promote();
+    return table.erase(element);
 }
 
 
-template <typename T>
-bool HashSet<T>::contains(const T& element) const
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+void HashSet<T, Hash, KeyEqual, CacheHash>::clear() noexcept
 {
-    return false;
+    snapshot.reset();
+    table.clear();
 }
 
 
-template <typename T>
-unsigned int HashSet<T>::size() const noexcept
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+const T* HashSet<T, Hash, KeyEqual, CacheHash>::find(const T& element) const
 {
-    return 0;
+    return lookup(element);
 }
 
 
-template <typename T>
-unsigned int HashSet<T>::elementsAtIndex(unsigned int index) const
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K, typename H, typename E, typename, typename>
+const T* HashSet<T, Hash, KeyEqual, CacheHash>::find(const K& key) const
 {
-    return 0;
+    return lookup(key);
 }
 
 
-template <typename T>
-bool HashSet<T>::isElementAtIndex(const T& element, unsigned int index) const
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashSet<T, Hash, KeyEqual, CacheHash>::size() const noexcept
 {
-    return false;
+    return snapshot ? snapshot->size : table.size();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename Visit>
+void HashSet<T, Hash, KeyEqual, CacheHash>::forEach(Visit visit) const
+{
+    if (snapshot)
+    {
+        for (unsigned int i = 0; i < snapshot->size; ++i)
+        {
+            visit(snapshot->elements[i]);
+        }
+
+        return;
+    }
+
+    table.forEach(visit);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashSet<T, Hash, KeyEqual, CacheHash>::elementsAtIndex(unsigned int index) const
+{
+    if (snapshot)
+    {
+        return index < snapshot->capacity ? snapshot->cells[index + 1] - snapshot->cells[index] : 0;
+    }
+
+    return table.bucketSize(index);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashSet<T, Hash, KeyEqual, CacheHash>::isElementAtIndex(const T& element, unsigned int index) const
+{
+    if (snapshot)
+    {
+        if (index >= snapshot->capacity)
+        {
+            return false;
+        }
+
+        for (std::uint32_t i = snapshot->cells[index]; i < snapshot->cells[index + 1]; ++i)
+        {
+            if (table.getKeyEqual()(snapshot->elements[i], element))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    return table.bucketContains(element, index);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+FrozenHashSet<T, Hash, KeyEqual> HashSet<T, Hash, KeyEqual, CacheHash>::freeze() const
+{
+    std::vector<std::reference_wrapper<const T>> elements;
+    elements.reserve(size());
+
+    forEach([&](const T& element) { elements.push_back(std::cref(element)); });
+
+    return FrozenHashSet<T, Hash, KeyEqual>{
+        elements.begin(), elements.end(), table.getHashFunction(), table.getKeyEqual()};
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashTableDiagnostics HashSet<T, Hash, KeyEqual, CacheHash>::diagnostics() const
+{
+    if (snapshot)
+    {
+        // A loaded set is reported on as it would be once promoted.
+        HashSet promoted{*this};
+        promoted.promote();
+        return promoted.table.diagnostics();
+    }
+
+    return table.diagnostics();
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+void HashSet<T, Hash, KeyEqual, CacheHash>::save(const std::string& path) const
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only sets of trivially copyable elements can be saved");
+
+    // A loaded set's cells and elements are written just as they are;
+    // otherwise, they're gathered from the table, cell by cell.
+    std::vector<std::uint32_t> cellStorage;
+    std::vector<T> elementStorage;
+    const std::uint32_t* cells;
+    const T* elements;
+    unsigned int capacity;
+    bool seeded;
+    std::uint64_t seed;
+
+    if (snapshot)
+    {
+        cells = snapshot->cells;
+        elements = snapshot->elements;
+        capacity = snapshot->capacity;
+        seeded = snapshot->seeded;
+        seed = snapshot->seed;
+    }
+    else
+    {
+        capacity = table.capacity();
+        seeded = table.isSeeded();
+        seed = table.getSeed();
+
+        cellStorage.assign(static_cast<std::size_t>(capacity) + 1, 0);
+        elementStorage.reserve(table.size());
+
+        table.forEachByCell(
+            [&](unsigned int cell, const T& element)
+            {
+                elementStorage.push_back(element);
+                ++cellStorage[cell + 1];
+            });
+
+        for (unsigned int i = 0; i < capacity; ++i)
+        {
+            cellStorage[i + 1] += cellStorage[i];
+        }
+
+        cells = cellStorage.data();
+        elements = elementStorage.data();
+    }
+
+    std::size_t alignment = alignof(T) > 8 ? alignof(T) : 8;
+    std::size_t cellsSize = (static_cast<std::size_t>(capacity) + 1) * sizeof(std::uint32_t);
+    std::size_t elementsOffset = (sizeof(SnapshotHeader) + cellsSize + alignment - 1) / alignment * alignment;
+    std::size_t elementsSize = static_cast<std::size_t>(size()) * sizeof(T);
+    static const unsigned char PADDING[64] = {};
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.elementSize = sizeof(T);
+    header.elementAlignment = alignof(T);
+    header.size = size();
+    header.capacity = capacity;
+    header.seed = seeded ? seed : 0;
+    header.seeded = seeded ? 1 : 0;
+    header.checksum = 0;
+    header.cellsOffset = sizeof(SnapshotHeader);
+    header.elementsOffset = elementsOffset;
+    header.fileSize = elementsOffset + elementsSize;
+
+    std::vector<FilePiece> pieces{
+        {&header, sizeof(header)},
+        {cells, cellsSize},
+        {PADDING, elementsOffset - sizeof(SnapshotHeader) - cellsSize},
+        {elements, elementsSize}};
+
+    std::uint32_t checksum = 0;
+
+    for (const FilePiece& piece : pieces)
+    {
+        checksum = crc32c(piece.data, piece.size, checksum);
+    }
+
+    header.checksum = checksum;
+    writeFileAtomically(path, pieces);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+void HashSet<T, Hash, KeyEqual, CacheHash>::load(const std::string& path, bool verifyChecksum)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only sets of trivially copyable elements can be loaded");
+
+    std::shared_ptr<const Snapshot> loaded = std::make_shared<const Snapshot>(path, verifyChecksum);
+    table.clear();
+    snapshot = std::move(loaded);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashSet<T, Hash, KeyEqual, CacheHash>::isMapped() const noexcept
+{
+    return snapshot != nullptr;
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+HashSet<T, Hash, KeyEqual, CacheHash>::Snapshot::Snapshot(const std::string& path, bool verifyChecksum)
+    : file{path}
+{
+    SnapshotHeader header;
+
+    if (file.size() < sizeof(header))
+    {
+        throw SnapshotException{path + " is not a HashSet snapshot"};
+    }
+
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw SnapshotException{path + " is not a HashSet snapshot"};
+    }
+    else if (header.version != SNAPSHOT_VERSION)
+    {
+        throw SnapshotException{path + " is a snapshot of an unsupported version"};
+    }
+    else if (header.byteOrder != BYTE_ORDER_MARK)
+    {
+        throw SnapshotException{path + " was saved with a different byte order"};
+    }
+    else if (header.elementSize != sizeof(T) || header.elementAlignment != alignof(T))
+    {
+        throw SnapshotException{path + " holds elements of a different type"};
+    }
+
+    std::uint64_t cellsEnd = header.cellsOffset + (static_cast<std::uint64_t>(header.capacity) + 1) * sizeof(std::uint32_t);
+
+    if (header.fileSize != file.size()
+        || header.capacity == 0
+        || header.cellsOffset != sizeof(SnapshotHeader)
+        || header.elementsOffset < cellsEnd
+        || header.elementsOffset % alignof(T) != 0
+        || header.elementsOffset + static_cast<std::uint64_t>(header.size) * sizeof(T) != header.fileSize)
+    {
+        throw SnapshotException{path + " is truncated or corrupt"};
+    }
+
+    if (verifyChecksum)
+    {
+        std::uint32_t expected = header.checksum;
+        header.checksum = 0;
+
+        std::uint32_t checksum = crc32c(&header, sizeof(header));
+        checksum = crc32c(file.data() + sizeof(header), file.size() - sizeof(header), checksum);
+
+        if (checksum != expected)
+        {
+            throw SnapshotException{path + " is corrupt (its checksum doesn't match)"};
+        }
+    }
+
+    cells = reinterpret_cast<const std::uint32_t*>(file.data() + header.cellsOffset);
+    elements = reinterpret_cast<const T*>(file.data() + header.elementsOffset);
+    size = header.size;
+    capacity = header.capacity;
+    seeded = header.seeded != 0;
+    seed = header.seed;
+
+    // Lookups trust the cells to stay within the elements, so that's
+    // checked whether or not the checksum is.
+    bool valid = cells[0] == 0 && cells[capacity] == size;
+
+    for (unsigned int i = 0; i < capacity && valid; ++i)
+    {
+        valid = cells[i] <= cells[i + 1];
+    }
+
+    if (!valid)
+    {
+        throw SnapshotException{path + " is truncated or corrupt"};
+    }
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K>
+const T* HashSet<T, Hash, KeyEqual, CacheHash>::lookup(const K& key) const
+{
+    if (snapshot)
+    {
+        unsigned int hash = table.getHashFunction()(key);
+        unsigned int cell = Table::cellOf(hash, snapshot->capacity, snapshot->seeded, snapshot->seed);
+
+        for (std::uint32_t i = snapshot->cells[cell]; i < snapshot->cells[cell + 1]; ++i)
+        {
+            if (table.getKeyEqual()(snapshot->elements[i], key))
+            {
+                return &snapshot->elements[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    return table.find(key);
+}
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+void HashSet<T, Hash, KeyEqual, CacheHash>::promote()
+{
+    if (!snapshot)
+    {
+        return;
+    }
+
+    // The new table is built on the side, so if building it fails, the
+    // set is still the loaded one.
+    Table promoted{table.getHashFunction(), table.getKeyEqual()};
+
+    if (snapshot->seeded)
+    {
+        promoted.restoreSeed(snapshot->seed);
+    }
+
+    promoted.reserve(snapshot->size);
+
+    for (unsigned int i = 0; i < snapshot->size; ++i)
+    {
+        promoted.emplace(snapshot->elements[i], snapshot->elements[i]);
+    }
+
+    table = std::move(promoted);
+    snapshot.reset();
 }
 
 
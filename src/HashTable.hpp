@@ -0,0 +1,1187 @@
+// HashTable.hpp
+//
+// A HashTable is the separately-chained hash table that HashSet and HashMap
+// are both built on.  It's implemented as a dynamically-allocated array of
+// linked lists, whose nodes each hold one "value".  A value contains its
+// own key, which the KeyOf function object extracts: for a HashSet, the
+// value *is* the key; for a HashMap, the value is a key/value pair whose
+// first member is the key.  Everything else -- hashing, chaining, resizing
+// when the ratio of size to capacity would exceed 0.8, cached hashes, and
+// heterogeneous lookup -- is written once, here.
+//
+// Erasing a value simply unlinks its node from its chain, so removals
+// leave nothing behind that later lookups have to skip over.  When erasing
+// leaves the ratio of size to capacity below 0.2, the array is halved
+// (though never below DEFAULT_CAPACITY); the gap between 0.2 and 0.8 keeps
+// a table whose size hovers around either threshold from resizing back
+// and forth.
+//
+// A table also defends itself against pathological chains, whether they
+// come from a poor hash function or from keys chosen by an adversary to
+// collide.  Normally, a key's cell is its hash modulo the capacity; but if
+// adding a value ever produces a chain of MAX_CHAIN_LENGTH or more, the
+// table picks a random seed and, from then on, scrambles each hash with
+// that seed (using mix64() from Hashing.hpp) before taking the modulo,
+// rehashing everything once to match.  Keys that collide only because of
+// how their hashes fall modulo the capacity -- the usual way to attack a
+// table whose hash function is known -- are scattered again, and since
+// the seed is secret, the attacker can't simply choose new ones.  (Keys
+// whose hashes are outright equal will still collide; only a better hash
+// function can help with those.)  diagnostics() reports whether this has
+// happened, along with a picture of how evenly the values are spread.
+//
+// Values are constructed in place inside their nodes, and nodes are
+// relinked (rather than copied) when the table is resized, so a value is
+// never copied or moved after it has been constructed.  A pointer to a
+// value remains valid until that value is erased or the table destroyed.
+//
+// Lookups and insertions can also be batched.  A batch is processed in
+// groups of BATCH_GROUP_SIZE keys, and each group goes through the table in
+// stages: first every key is hashed and its cell in the array prefetched,
+// then every cell is read and the first node of its chain prefetched, and
+// only then is each chain actually walked.  Since the memory accesses of
+// a whole group are in flight at once, a large table (one that doesn't fit
+// in the cache) pays for roughly one cache miss per group, rather than two
+// for every key.
+//
+// HashTable isn't meant to be used directly; it has no notion of what a
+// "set" or a "map" is, and its interface is designed for those classes'
+// convenience, not for general use.
+
+#ifndef HASHTABLE_HPP
+#define HASHTABLE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <new>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Hashing.hpp"
+#include "Parallel.hpp"
+
+
+
+// prefetchForRead() hints to the processor that the memory at the given
+// address is about to be read, so that it can start loading it into the
+// cache.  It's only a hint; where the compiler offers no way to give it,
+// it does nothing.
+
+inline void prefetchForRead(const void* address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    (void)address;
+#endif
+}
+
+
+
+// HashCachingPolicy<K>::value decides whether a hash table keyed by K
+// stores each key's hash in its node by default.  Arithmetic, enumeration,
+// and pointer types are cheap enough to rehash and compare that caching
+// isn't worth the memory; everything else caches.  It can be specialized
+// for a type, or overridden for one table with its CacheHash argument.
+
+template <typename K>
+struct HashCachingPolicy
+    : std::integral_constant<bool,
+        !(std::is_arithmetic<K>::value || std::is_enum<K>::value || std::is_pointer<K>::value)>
+{
+};
+
+
+
+// A CachedHash is the part of a node that remembers its key's hash.
+// The specialization for false stores nothing, and since it's an empty
+// base class, it costs nothing either; it simply reports that any hash
+// might match.
+
+template <bool CacheHash>
+struct CachedHash
+{
+    CachedHash(unsigned int hash) noexcept
+        : hash{hash}
+    {
+    }
+
+    bool mayMatch(unsigned int h) const noexcept
+    {
+        return hash == h;
+    }
+
+    unsigned int hash;
+};
+
+
+template <>
+struct CachedHash<false>
+{
+    CachedHash(unsigned int) noexcept
+    {
+    }
+
+    bool mayMatch(unsigned int) const noexcept
+    {
+        return true;
+    }
+};
+
+
+
+// A HashTableDiagnostics is a snapshot of how evenly a hash table's values
+// are spread across its array, as returned by diagnostics().
+
+struct HashTableDiagnostics
+{
+    // The number of values and the number of cells in the array.
+    unsigned int size;
+    unsigned int capacity;
+
+    // chainLengths[k] is the number of cells whose chains have exactly k
+    // values in them, for every k up to the longest chain.
+    std::vector<unsigned int> chainLengths;
+    unsigned int longestChain;
+
+    // A value "collides" if it shares its cell with a value added before
+    // it, so the number of collisions is the number of values minus the
+    // number of non-empty cells.  The expected number is what a hash
+    // function that spread values uniformly at random would produce.
+    unsigned int collisions;
+    double expectedCollisions;
+
+    // The memory used by the array and the nodes, divided by the number of
+    // values (not counting the allocator's own bookkeeping).
+    double bytesPerValue;
+
+    // True if the table has detected a pathological chain and started
+    // scrambling hashes with a random seed.
+    bool seeded;
+};
+
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+class HashTable
+{
+public:
+    // The default capacity of a HashTable before anything has been
+    // added to it.
+    static constexpr unsigned int DEFAULT_CAPACITY = 10;
+
+    // The number of keys whose memory accesses are overlapped by findBatch()
+    // and emplaceBatch().  It's large enough to hide the latency of main
+    // memory, but small enough that the group's state stays in registers
+    // and the L1 cache.
+    static constexpr std::size_t BATCH_GROUP_SIZE = 16;
+
+    // A chain this long is taken as a sign of a poor hash function or of
+    // deliberately colliding keys.  With a good hash function and the
+    // ratio of size to capacity at most 0.8, the chance of any given chain
+    // being this long is less than one in a trillion.
+    static constexpr unsigned int MAX_CHAIN_LENGTH = 16;
+
+public:
+    // Initializes a HashTable to be empty, so that it will use the given
+    // hash function and equality comparator on keys.
+    HashTable(Hash hashFunction, KeyEqual keyEqual);
+
+    // Cleans up the HashTable so that it leaks no memory.
+    ~HashTable() noexcept;
+
+    // Initializes a new HashTable to be a copy of an existing one.
+    HashTable(const HashTable& t);
+
+    // Initializes a new HashTable whose contents are moved from an
+    // expiring one, which is left empty and without an array.
+    HashTable(HashTable&& t) noexcept;
+
+    // Assigns an existing HashTable into another.
+    HashTable& operator=(const HashTable& t);
+
+    // Assigns an expiring HashTable into another.
+    HashTable& operator=(HashTable&& t) noexcept;
+
+
+    // find() returns a pointer to the value whose key is equal to the given
+    // one, or nullptr if there is no such value.
+    template <typename K>
+    Value* find(const K& key) const;
+
+
+    // emplace() looks for a value whose key is equal to the given one.  If
+    // there is one, it's returned (along with false); otherwise, a new value
+    // is constructed in place from the given arguments and returned (along
+    // with true).  The arguments are only used if a value is constructed,
+    // and the new value's key must be equal to the given one.
+    template <typename K, typename... Args>
+    std::pair<Value*, bool> emplace(const K& key, Args&&... args);
+
+
+    // findBatch() looks up n keys, calling visit(i, value) for each key,
+    // where i is the key's index and value is what find(keys[i]) would have
+    // returned.  The keys are visited in order.
+    template <typename K, typename Visit>
+    void findBatch(const K* keys, std::size_t n, Visit visit) const;
+
+
+    // emplaceBatch() adds n values, as though emplace(keys[i], keys[i])
+    // were called for each i in order, so the keys must be values.
+    template <typename K>
+    void emplaceBatch(const K* keys, std::size_t n);
+
+
+    // emplaceParallel() adds every value in the range [first, last), as
+    // though emplace(*i, *i) were called for each i in order, but using
+    // the given number of threads.  The array is grown once, up front, to
+    // fit them all; then the array is divided into one contiguous range of
+    // cells per thread, the values are sorted by which range their cells
+    // fall in, and each thread fills its own range of cells, so that no
+    // two threads ever touch the same chain and no locks are needed.
+    template <typename RandomAccessIterator>
+    void emplaceParallel(RandomAccessIterator first, RandomAccessIterator last, unsigned int threads);
+
+
+    // reserve() grows the array, if necessary, so that the table can hold
+    // the given number of values without being resized.
+    void reserve(unsigned int values);
+
+
+    // erase() removes the value whose key is equal to the given one,
+    // returning true if there was one and false otherwise.  It halves the
+    // array when the ratio of size to capacity falls below 0.2.
+    template <typename K>
+    bool erase(const K& key);
+
+
+    // clear() removes every value from the table.  The array keeps its
+    // capacity, since a table that's cleared is usually refilled.
+    void clear() noexcept;
+
+
+    // size() returns the number of values in the table.
+    unsigned int size() const noexcept;
+
+
+    // capacity() returns the number of cells in the array.
+    unsigned int capacity() const noexcept;
+
+
+    // bucketSize() returns the number of values whose keys hashed to the
+    // given index in the array, or 0 if the index is out of bounds.
+    unsigned int bucketSize(unsigned int index) const;
+
+
+    // bucketContains() returns true if a value whose key is equal to the
+    // given one hashed to the given index in the array, false otherwise
+    // (including when the index is out of bounds).
+    template <typename K>
+    bool bucketContains(const K& key, unsigned int index) const;
+
+
+    // forEach() calls visit(value) on every value in the table, in no
+    // particular order.
+    template <typename Visit>
+    void forEach(Visit visit) const;
+
+
+    // forEachByCell() calls visit(index, value) on every value in the
+    // table, where index is the cell of the array that the value is in.
+    // The cells are visited in order, and each chain from front to back.
+    template <typename Visit>
+    void forEachByCell(Visit visit) const;
+
+
+    // getHashFunction() and getKeyEqual() return the function objects the
+    // table was constructed with.
+    const Hash& getHashFunction() const noexcept;
+    const KeyEqual& getKeyEqual() const noexcept;
+
+
+    // isSeeded() returns true if the table has started scrambling hashes,
+    // and getSeed() returns the seed it scrambles them with.
+    bool isSeeded() const noexcept;
+    std::uint64_t getSeed() const noexcept;
+
+
+    // restoreSeed() makes the table scramble hashes with the given seed
+    // (as one that has been saved and loaded must, to find its values in
+    // the same cells), rehashing every value to match.
+    void restoreSeed(std::uint64_t newSeed);
+
+
+    // cellOf() returns the cell that a hash belongs in, in an array with
+    // the given capacity, for a table with the given seed (if it's
+    // seeded at all).
+    static unsigned int cellOf(unsigned int hash, unsigned int capacity, bool seeded, std::uint64_t seed) noexcept;
+
+
+    // diagnostics() reports how the values are spread across the array.
+    // It runs in linear time.
+    HashTableDiagnostics diagnostics() const;
+
+
+    // swap() exchanges the entire contents of two HashTables.
+    void swap(HashTable& t) noexcept;
+
+
+private:
+    struct Node : CachedHash<CacheHash>
+    {
+        template <typename... Args>
+        Node(unsigned int hash, Node* next, Args&&... args)
+            : CachedHash<CacheHash>{hash}, value(std::forward<Args>(args)...), next{next}
+        {
+        }
+
+        Value value;
+        Node* next;
+    };
+
+    // findNode() searches the chain that the given key (whose hash is
+    // given) belongs to, returning the node containing a value with an
+    // equal key, or nullptr if there is none.
+    template <typename K>
+    Node* findNode(const K& key, unsigned int hash) const;
+
+    // emplaceHashed() is emplace() for a key whose hash has already been
+    // computed.
+    template <typename K, typename... Args>
+    std::pair<Value*, bool> emplaceHashed(const K& key, unsigned int hash, Args&&... args);
+
+    // hashOf() returns the hash of a node's key, from the node itself
+    // if it's cached there.
+    unsigned int hashOf(const Node* node) const;
+
+    // indexOf() returns the cell that a hash belongs in, in an array with
+    // the given capacity, scrambling the hash first if the table is seeded.
+    unsigned int indexOf(unsigned int hash, unsigned int capacity) const noexcept;
+
+    // reseed() chooses a random seed and rehashes every value with it.
+    void reseed();
+
+    // resize() moves every node into a newly-allocated array with the given
+    // capacity, relinking the existing nodes rather than copying them.
+    void resize(unsigned int newCapacity);
+
+    // copyFrom() makes this (empty, unallocated) HashTable a deep copy of t.
+    void copyFrom(const HashTable& t);
+
+    // destroy() deletes every node and the array, leaving the HashTable
+    // with no array at all.
+    void destroy() noexcept;
+
+
+private:
+    Hash hashFunction;
+    KeyEqual keyEqual;
+    KeyOf keyOf;
+    Node** buckets;
+    unsigned int bucketCount;
+    unsigned int elementCount;
+    bool seeded;
+    std::uint64_t seed;
+};
+
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::HashTable(Hash hashFunction, KeyEqual keyEqual)
+    : hashFunction{hashFunction}, keyEqual{keyEqual}, keyOf{},
+      buckets{new Node*[DEFAULT_CAPACITY]()}, bucketCount{DEFAULT_CAPACITY}, elementCount{0},
+      seeded{false}, seed{0}
+{
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::~HashTable() noexcept
+{
+    destroy();
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::HashTable(const HashTable& t)
+    : hashFunction{t.hashFunction}, keyEqual{t.keyEqual}, keyOf{},
+      buckets{nullptr}, bucketCount{0}, elementCount{0}, seeded{t.seeded}, seed{t.seed}
+{
+    copyFrom(t);
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::HashTable(HashTable&& t) noexcept
+    : hashFunction{t.hashFunction}, keyEqual{t.keyEqual}, keyOf{},
+      buckets{nullptr}, bucketCount{0}, elementCount{0}, seeded{false}, seed{0}
+{
+    swap(t);
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>&
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::operator=(const HashTable& t)
+{
+    if (this != &t)
+    {
+        HashTable copy{t};
+        swap(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>&
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::operator=(HashTable&& t) noexcept
+{
+    swap(t);
+    return *this;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K>
+Value* HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::find(const K& key) const
+{
+    Node* node = findNode(key, hashFunction(key));
+    return node != nullptr ? &node->value : nullptr;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K, typename... Args>
+std::pair<Value*, bool> HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::emplace(const K& key, Args&&... args)
+{
+    return emplaceHashed(key, hashFunction(key), std::forward<Args>(args)...);
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K, typename Visit>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::findBatch(const K* keys, std::size_t n, Visit visit) const
+{
+    unsigned int hashes[BATCH_GROUP_SIZE];
+    Node* heads[BATCH_GROUP_SIZE];
+
+    for (std::size_t first = 0; first < n; first += BATCH_GROUP_SIZE)
+    {
+        std::size_t group = n - first < BATCH_GROUP_SIZE ? n - first : BATCH_GROUP_SIZE;
+
+        if (bucketCount == 0)
+        {
+            for (std::size_t i = 0; i < group; ++i)
+            {
+                visit(first + i, static_cast<Value*>(nullptr));
+            }
+
+            continue;
+        }
+
+        for (std::size_t i = 0; i < group; ++i)
+        {
+            hashes[i] = hashFunction(keys[first + i]);
+            prefetchForRead(&buckets[indexOf(hashes[i], bucketCount)]);
+        }
+
+        for (std::size_t i = 0; i < group; ++i)
+        {
+            heads[i] = buckets[indexOf(hashes[i], bucketCount)];
+            prefetchForRead(heads[i]);
+        }
+
+        for (std::size_t i = 0; i < group; ++i)
+        {
+            Value* found = nullptr;
+
+            for (Node* node = heads[i]; node != nullptr; node = node->next)
+            {
+                if (node->mayMatch(hashes[i]) && keyEqual(keyOf(node->value), keys[first + i]))
+                {
+                    found = &node->value;
+                    break;
+                }
+            }
+
+            visit(first + i, found);
+        }
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::emplaceBatch(const K* keys, std::size_t n)
+{
+    unsigned int hashes[BATCH_GROUP_SIZE];
+
+    for (std::size_t first = 0; first < n; first += BATCH_GROUP_SIZE)
+    {
+        std::size_t group = n - first < BATCH_GROUP_SIZE ? n - first : BATCH_GROUP_SIZE;
+
+        // Growing up front means the array can't change while the group's
+        // prefetched cells are being used.
+        reserve(elementCount + static_cast<unsigned int>(group));
+
+        for (std::size_t i = 0; i < group; ++i)
+        {
+            hashes[i] = hashFunction(keys[first + i]);
+            prefetchForRead(&buckets[indexOf(hashes[i], bucketCount)]);
+        }
+
+        for (std::size_t i = 0; i < group; ++i)
+        {
+            prefetchForRead(buckets[indexOf(hashes[i], bucketCount)]);
+        }
+
+        for (std::size_t i = 0; i < group; ++i)
+        {
+            emplaceHashed(keys[first + i], hashes[i], keys[first + i]);
+        }
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename RandomAccessIterator>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::emplaceParallel(
+    RandomAccessIterator first, RandomAccessIterator last, unsigned int threads)
+{
+    static_assert(
+        std::is_base_of<std::random_access_iterator_tag,
+            typename std::iterator_traits<RandomAccessIterator>::iterator_category>::value,
+        "emplaceParallel() requires random access iterators");
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+
+    if (n == 0)
+    {
+        return;
+    }
+
+    threads = threads != 0 ? threads : 1;
+    threads = n < threads ? static_cast<unsigned int>(n) : threads;
+
+    reserve(static_cast<unsigned int>(elementCount + n));
+
+    auto chunkBegin = [n, threads](unsigned int t)
+    {
+        return n * t / threads;
+    };
+
+    auto partitionOf = [this, threads](unsigned int hash)
+    {
+        return static_cast<unsigned int>(
+            static_cast<unsigned long long>(indexOf(hash, bucketCount)) * threads / bucketCount);
+    };
+
+    // First, each thread hashes its share of the input and counts how many
+    // of those values belong to each partition.
+    std::vector<unsigned int> hashes(n);
+    std::vector<std::size_t> counts(static_cast<std::size_t>(threads) * threads, 0);
+
+    runOnThreads(threads, [&](unsigned int t)
+    {
+        std::size_t* myCounts = &counts[static_cast<std::size_t>(t) * threads];
+
+        for (std::size_t i = chunkBegin(t); i < chunkBegin(t + 1); ++i)
+        {
+            hashes[i] = hashFunction(keyOf(first[i]));
+            ++myCounts[partitionOf(hashes[i])];
+        }
+    });
+
+    // Then each thread scatters its values' positions into the part of
+    // "order" where its share of each partition belongs.
+    std::vector<std::size_t> offsets(counts.size());
+    std::vector<std::size_t> partitionBegin(threads + 1, 0);
+    std::size_t offset = 0;
+
+    for (unsigned int p = 0; p < threads; ++p)
+    {
+        partitionBegin[p] = offset;
+
+        for (unsigned int t = 0; t < threads; ++t)
+        {
+            offsets[static_cast<std::size_t>(t) * threads + p] = offset;
+            offset += counts[static_cast<std::size_t>(t) * threads + p];
+        }
+    }
+
+    partitionBegin[threads] = offset;
+
+    std::vector<std::size_t> order(n);
+
+    runOnThreads(threads, [&](unsigned int t)
+    {
+        std::size_t* myOffsets = &offsets[static_cast<std::size_t>(t) * threads];
+
+        for (std::size_t i = chunkBegin(t); i < chunkBegin(t + 1); ++i)
+        {
+            order[myOffsets[partitionOf(hashes[i])]++] = i;
+        }
+    });
+
+    // Finally, each thread adds the values of one partition, whose cells no
+    // other thread touches.  Duplicates always share a cell, so they're
+    // found within the partition.
+    std::vector<unsigned int> added(threads, 0);
+    std::vector<unsigned int> longest(threads, 0);
+
+    auto fill = [&](unsigned int p)
+    {
+        for (std::size_t k = partitionBegin[p]; k < partitionBegin[p + 1]; ++k)
+        {
+            std::size_t i = order[k];
+            unsigned int hash = hashes[i];
+            Node*& head = buckets[indexOf(hash, bucketCount)];
+            unsigned int chainLength = 0;
+            bool found = false;
+
+            for (Node* node = head; node != nullptr && !found; node = node->next)
+            {
+                found = node->mayMatch(hash) && keyEqual(keyOf(node->value), keyOf(first[i]));
+                ++chainLength;
+            }
+
+            if (!found)
+            {
+                head = new Node{hash, head, first[i]};
+                ++added[p];
+                longest[p] = chainLength + 1 > longest[p] ? chainLength + 1 : longest[p];
+            }
+        }
+    };
+
+    // Whatever was added is counted, even if some thread failed partway.
+    try
+    {
+        runOnThreads(threads, fill);
+    }
+    catch (...)
+    {
+        for (unsigned int p = 0; p < threads; ++p)
+        {
+            elementCount += added[p];
+        }
+
+        throw;
+    }
+
+    for (unsigned int p = 0; p < threads; ++p)
+    {
+        elementCount += added[p];
+
+        if (longest[p] >= MAX_CHAIN_LENGTH && !seeded)
+        {
+            reseed();
+        }
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::reserve(unsigned int values)
+{
+    unsigned int newCapacity = bucketCount != 0 ? bucketCount : DEFAULT_CAPACITY;
+
+    while (static_cast<unsigned long long>(values) * 5 > static_cast<unsigned long long>(newCapacity) * 4)
+    {
+        newCapacity *= 2;
+    }
+
+    if (newCapacity != bucketCount)
+    {
+        resize(newCapacity);
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K, typename... Args>
+std::pair<Value*, bool> HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::emplaceHashed(
+    const K& key, unsigned int hash, Args&&... args)
+{
+    // This is findNode(), but it also measures the chain.
+    unsigned int chainLength = 0;
+
+    if (bucketCount != 0)
+    {
+        for (Node* node = buckets[indexOf(hash, bucketCount)]; node != nullptr; node = node->next)
+        {
+            if (node->mayMatch(hash) && keyEqual(keyOf(node->value), key))
+            {
+                return {&node->value, false};
+            }
+
+            ++chainLength;
+        }
+    }
+
+    if (bucketCount == 0)
+    {
+        resize(DEFAULT_CAPACITY);
+        chainLength = 0;
+    }
+    else if (static_cast<unsigned long long>(elementCount + 1) * 5 > static_cast<unsigned long long>(bucketCount) * 4)
+    {
+        resize(bucketCount * 2);
+        chainLength = 0;
+    }
+
+    unsigned int index = indexOf(hash, bucketCount);
+    Node* node = new Node{hash, buckets[index], std::forward<Args>(args)...};
+    buckets[index] = node;
+    ++elementCount;
+
+    // Reseeding only happens once; if the chains are still long after
+    // that, the hashes themselves are colliding, and reseeding again
+    // wouldn't help.
+    if (chainLength + 1 >= MAX_CHAIN_LENGTH && !seeded)
+    {
+        reseed();
+    }
+
+    return {&node->value, true};
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K>
+bool HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::erase(const K& key)
+{
+    if (bucketCount == 0)
+    {
+        return false;
+    }
+
+    unsigned int hash = hashFunction(key);
+
+    for (Node** link = &buckets[indexOf(hash, bucketCount)]; *link != nullptr; link = &(*link)->next)
+    {
+        Node* node = *link;
+
+        if (node->mayMatch(hash) && keyEqual(keyOf(node->value), key))
+        {
+            *link = node->next;
+            delete node;
+            --elementCount;
+
+            if (bucketCount > DEFAULT_CAPACITY
+                && static_cast<unsigned long long>(elementCount) * 5 < bucketCount)
+            {
+                // Shrinking is only an optimization; if there's no memory
+                // for the smaller array, the larger one will do.
+                try
+                {
+                    resize(bucketCount / 2 > DEFAULT_CAPACITY ? bucketCount / 2 : DEFAULT_CAPACITY);
+                }
+                catch (const std::bad_alloc&)
+                {
+                }
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::clear() noexcept
+{
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        Node* node = buckets[i];
+
+        while (node != nullptr)
+        {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+
+        buckets[i] = nullptr;
+    }
+
+    elementCount = 0;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::size() const noexcept
+{
+    return elementCount;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::capacity() const noexcept
+{
+    return bucketCount;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::bucketSize(unsigned int index) const
+{
+    if (index >= bucketCount)
+    {
+        return 0;
+    }
+
+    unsigned int values = 0;
+
+    for (Node* node = buckets[index]; node != nullptr; node = node->next)
+    {
+        ++values;
+    }
+
+    return values;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K>
+bool HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::bucketContains(const K& key, unsigned int index) const
+{
+    if (index >= bucketCount)
+    {
+        return false;
+    }
+
+    for (Node* node = buckets[index]; node != nullptr; node = node->next)
+    {
+        if (keyEqual(keyOf(node->value), key))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename Visit>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::forEach(Visit visit) const
+{
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        for (Node* node = buckets[i]; node != nullptr; node = node->next)
+        {
+            visit(static_cast<const Value&>(node->value));
+        }
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename Visit>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::forEachByCell(Visit visit) const
+{
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        for (Node* node = buckets[i]; node != nullptr; node = node->next)
+        {
+            visit(i, static_cast<const Value&>(node->value));
+        }
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+const Hash& HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::getHashFunction() const noexcept
+{
+    return hashFunction;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+const KeyEqual& HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::getKeyEqual() const noexcept
+{
+    return keyEqual;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+bool HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::isSeeded() const noexcept
+{
+    return seeded;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+std::uint64_t HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::getSeed() const noexcept
+{
+    return seed;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::restoreSeed(std::uint64_t newSeed)
+{
+    bool oldSeeded = seeded;
+    std::uint64_t oldSeed = seed;
+    seeded = true;
+    seed = newSeed;
+
+    try
+    {
+        if (bucketCount != 0)
+        {
+            resize(bucketCount);
+        }
+    }
+    catch (...)
+    {
+        seeded = oldSeeded;
+        seed = oldSeed;
+        throw;
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::cellOf(
+    unsigned int hash, unsigned int capacity, bool seeded, std::uint64_t seed) noexcept
+{
+    if (seeded)
+    {
+        return static_cast<unsigned int>(mix64(hash ^ seed) >> 32) % capacity;
+    }
+
+    return hash % capacity;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+HashTableDiagnostics HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::diagnostics() const
+{
+    HashTableDiagnostics d{};
+    d.size = elementCount;
+    d.capacity = bucketCount;
+    d.seeded = seeded;
+
+    unsigned int nonEmpty = 0;
+
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        unsigned int length = 0;
+
+        for (Node* node = buckets[i]; node != nullptr; node = node->next)
+        {
+            ++length;
+        }
+
+        if (length >= d.chainLengths.size())
+        {
+            d.chainLengths.resize(length + 1, 0);
+        }
+
+        ++d.chainLengths[length];
+        nonEmpty += length != 0 ? 1 : 0;
+    }
+
+    d.longestChain = d.chainLengths.empty() ? 0 : static_cast<unsigned int>(d.chainLengths.size() - 1);
+    d.collisions = elementCount - nonEmpty;
+
+    if (bucketCount != 0)
+    {
+        // Each cell is empty with probability (1 - 1/m)^n, so the expected
+        // number of non-empty cells is m times the complement of that.
+        double m = bucketCount;
+        double expectedNonEmpty = m * (1.0 - std::pow(1.0 - 1.0 / m, elementCount));
+        d.expectedCollisions = elementCount - expectedNonEmpty;
+    }
+
+    if (elementCount != 0)
+    {
+        d.bytesPerValue =
+            (static_cast<double>(bucketCount) * sizeof(Node*) + static_cast<double>(elementCount) * sizeof(Node))
+            / elementCount;
+    }
+
+    return d;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::swap(HashTable& t) noexcept
+{
+    std::swap(hashFunction, t.hashFunction);
+    std::swap(keyEqual, t.keyEqual);
+    std::swap(buckets, t.buckets);
+    std::swap(bucketCount, t.bucketCount);
+    std::swap(elementCount, t.elementCount);
+    std::swap(seeded, t.seeded);
+    std::swap(seed, t.seed);
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+template <typename K>
+typename HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::Node*
+HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::findNode(const K& key, unsigned int hash) const
+{
+    if (bucketCount == 0)
+    {
+        return nullptr;
+    }
+
+    for (Node* node = buckets[indexOf(hash, bucketCount)]; node != nullptr; node = node->next)
+    {
+        if (node->mayMatch(hash) && keyEqual(keyOf(node->value), key))
+        {
+            return node;
+        }
+    }
+
+    return nullptr;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::hashOf(const Node* node) const
+{
+    if constexpr (CacheHash)
+    {
+        return node->hash;
+    }
+    else
+    {
+        return hashFunction(keyOf(node->value));
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+unsigned int HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::indexOf(
+    unsigned int hash, unsigned int capacity) const noexcept
+{
+    return cellOf(hash, capacity, seeded, seed);
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::reseed()
+{
+    // Like shrinking, reseeding is a precaution rather than a necessity;
+    // if it can't be done, the table carries on as it was.  (resize()
+    // only throws before it has moved anything.)
+    try
+    {
+        std::random_device device;
+        seed = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+        seeded = true;
+
+        // Rehashing into an array of the same capacity moves every value
+        // to the cell the seeded hash chooses.
+        resize(bucketCount);
+    }
+    catch (const std::exception&)
+    {
+        seeded = false;
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::resize(unsigned int newCapacity)
+{
+    Node** newBuckets = new Node*[newCapacity]();
+
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        Node* node = buckets[i];
+
+        while (node != nullptr)
+        {
+            Node* next = node->next;
+            unsigned int index = indexOf(hashOf(node), newCapacity);
+            node->next = newBuckets[index];
+            newBuckets[index] = node;
+            node = next;
+        }
+    }
+
+    delete[] buckets;
+    buckets = newBuckets;
+    bucketCount = newCapacity;
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::copyFrom(const HashTable& t)
+{
+    if (t.bucketCount == 0)
+    {
+        return;
+    }
+
+    buckets = new Node*[t.bucketCount]();
+    bucketCount = t.bucketCount;
+
+    try
+    {
+        for (unsigned int i = 0; i < t.bucketCount; ++i)
+        {
+            Node** tail = &buckets[i];
+
+            for (Node* node = t.buckets[i]; node != nullptr; node = node->next)
+            {
+                unsigned int hash = 0;
+
+                if constexpr (CacheHash)
+                {
+                    hash = node->hash;
+                }
+
+                *tail = new Node{hash, nullptr, node->value};
+                tail = &(*tail)->next;
+                ++elementCount;
+            }
+        }
+    }
+    catch (...)
+    {
+        destroy();
+        throw;
+    }
+}
+
+
+template <typename Value, typename KeyOf, typename Hash, typename KeyEqual, bool CacheHash>
+void HashTable<Value, KeyOf, Hash, KeyEqual, CacheHash>::destroy() noexcept
+{
+    for (unsigned int i = 0; i < bucketCount; ++i)
+    {
+        Node* node = buckets[i];
+
+        while (node != nullptr)
+        {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    delete[] buckets;
+    buckets = nullptr;
+    bucketCount = 0;
+    elementCount = 0;
+}
+
+
+
+#endif // HASHTABLE_HPP
+
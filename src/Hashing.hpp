@@ -0,0 +1,392 @@
+// Hashing.hpp
+//
+// Hashing utilities shared by the hash-based data structures.  The hash
+// functions passed to HashSet and friends return unsigned ints, which is
+// enough to choose a bucket, but structures like filters want 64 bits that
+// are well-mixed in every position; mix64() provides that.
+//
+// There are also fast, well-distributed hash functions for the kinds of
+// keys that come up most often, so that callers needn't write their own:
+//
+// * hashBytes() hashes any run of bytes.  It's in the style of wyhash: it
+//   reads the input eight bytes at a time and combines it with a handful of
+//   "multiply to 128 bits, then fold the halves together" steps, which
+//   every 64-bit processor does in a few cycles.  Short keys (16 bytes or
+//   fewer) are handled without a loop at all.  StringHash uses it.
+//
+// * IntegerHash hashes integers (and enums and pointers) with one such
+//   folded multiplication followed by a multiply-shift, so that keys that
+//   differ only in their high bits, or that follow a stride, still spread
+//   across every bucket.
+//
+// * crc32c() computes the CRC-32C checksum of a run of bytes.  When
+//   compiled for a processor with SSE4.2, it uses the processor's CRC32
+//   instruction, eight bytes at a time; otherwise, it uses a lookup table.
+//   Crc32cHash is a hash function built on it.
+//
+// DefaultHash<T> picks one of these for integers, enums, pointers, and
+// strings; HashSet, HashMap, and the other hash-based sets use it when
+// they aren't given a hash function of their own.  It's their default Hash
+// type as well, so their calls to it are inlined.  FunctionHash<T> is the
+// std::function type for callers who want to pass a lambda or a plain
+// function instead.
+
+#ifndef HASHING_HPP
+#define HASHING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+
+
+// mix64() scrambles the bits of a 64-bit value so that every bit of the
+// result depends on every bit of the input (it's the finalizer from
+// SplitMix64).  It's a bijection, so distinct inputs never collide.
+
+inline std::uint64_t mix64(std::uint64_t x) noexcept
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+
+
+namespace HashingDetail
+{
+    // Odd constants with well-spread bits, used by hashBytes() and
+    // IntegerHash.
+    constexpr std::uint64_t P0 = 0xa0761d6478bd642full;
+    constexpr std::uint64_t P1 = 0xe7037ed1a0b428dbull;
+    constexpr std::uint64_t P2 = 0x8ebc6af09c88c6dbull;
+    constexpr std::uint64_t P3 = 0x589965cc75374cc3ull;
+
+
+    // multiply() replaces a and b with the low and high halves of their
+    // 128-bit product.
+    inline void multiply(std::uint64_t& a, std::uint64_t& b) noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        a = static_cast<std::uint64_t>(product);
+        b = static_cast<std::uint64_t>(product >> 64);
+#else
+        std::uint64_t aHigh = a >> 32, aLow = static_cast<std::uint32_t>(a);
+        std::uint64_t bHigh = b >> 32, bLow = static_cast<std::uint32_t>(b);
+        std::uint64_t high = aHigh * bHigh, middle0 = aHigh * bLow;
+        std::uint64_t middle1 = aLow * bHigh, low = aLow * bLow;
+        std::uint64_t carry = ((low >> 32) + static_cast<std::uint32_t>(middle0) + static_cast<std::uint32_t>(middle1)) >> 32;
+        a = low + (middle0 << 32) + (middle1 << 32);
+        b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+    }
+
+
+    // fold() multiplies a and b to 128 bits and XORs the halves together.
+    inline std::uint64_t fold(std::uint64_t a, std::uint64_t b) noexcept
+    {
+        multiply(a, b);
+        return a ^ b;
+    }
+
+
+    inline std::uint64_t read64(const unsigned char* p) noexcept
+    {
+        std::uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+
+    inline std::uint64_t read32(const unsigned char* p) noexcept
+    {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+
+    // CRC32C_TABLE[i] is the CRC-32C remainder of the byte i, used when
+    // the CRC32 instruction isn't available.
+    struct Crc32cTable
+    {
+        std::uint32_t entries[256];
+
+        constexpr Crc32cTable()
+            : entries{}
+        {
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+                std::uint32_t crc = i;
+
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+                }
+
+                entries[i] = crc;
+            }
+        }
+    };
+
+    constexpr Crc32cTable CRC32C_TABLE{};
+
+
+    // crc32cPortable() computes the same thing as crc32c(), always using
+    // the lookup table.
+    inline std::uint32_t crc32cPortable(const void* data, std::size_t length, std::uint32_t crc) noexcept
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            crc = (crc >> 8) ^ CRC32C_TABLE.entries[(crc ^ p[i]) & 0xFF];
+        }
+
+        return ~crc;
+    }
+}
+
+
+
+// hashBytes() returns a 64-bit hash of the given bytes.  Different seeds
+// give unrelated hash functions.
+
+inline std::uint64_t hashBytes(const void* data, std::size_t length, std::uint64_t seed = 0) noexcept
+{
+    using namespace HashingDetail;
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= fold(seed ^ P0, P1);
+
+    std::uint64_t a;
+    std::uint64_t b;
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            // Two pairs of (possibly overlapping) 4-byte reads cover every
+            // byte of a 4- to 16-byte key.
+            std::size_t step = (length >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + step);
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - step);
+        }
+        else if (length > 0)
+        {
+            a = (std::uint64_t{p[0]} << 16) | (std::uint64_t{p[length >> 1]} << 8) | p[length - 1];
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        std::size_t remaining = length;
+
+        if (remaining > 48)
+        {
+            // Three independent lanes keep the multiplier busy.
+            std::uint64_t lane1 = seed;
+            std::uint64_t lane2 = seed;
+
+            do
+            {
+                seed = fold(read64(p) ^ P1, read64(p + 8) ^ seed);
+                lane1 = fold(read64(p + 16) ^ P2, read64(p + 24) ^ lane1);
+                lane2 = fold(read64(p + 32) ^ P3, read64(p + 40) ^ lane2);
+                p += 48;
+                remaining -= 48;
+            }
+            while (remaining > 48);
+
+            seed ^= lane1 ^ lane2;
+        }
+
+        while (remaining > 16)
+        {
+            seed = fold(read64(p) ^ P1, read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        // The last 16 bytes are read whole, overlapping bytes already
+        // hashed if need be.
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+
+    a ^= P1;
+    b ^= seed;
+    multiply(a, b);
+    return fold(a ^ P0 ^ length, b ^ P1);
+}
+
+
+
+// crc32c() returns the CRC-32C (Castagnoli) checksum of the given bytes.
+// Passing the checksum of one run of bytes as the crc of the next gives
+// the checksum of the two runs together.
+
+inline std::uint32_t crc32c(const void* data, std::size_t length, std::uint32_t crc = 0) noexcept
+{
+#if defined(__SSE4_2__)
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t wide = ~crc;
+
+    for (; length >= 8; length -= 8, p += 8)
+    {
+        wide = _mm_crc32_u64(wide, HashingDetail::read64(p));
+    }
+
+    std::uint32_t narrow = static_cast<std::uint32_t>(wide);
+
+    for (; length > 0; --length, ++p)
+    {
+        narrow = _mm_crc32_u8(narrow, *p);
+    }
+
+    return ~narrow;
+#else
+    return HashingDetail::crc32cPortable(data, length, crc);
+#endif
+}
+
+
+
+// StringHash is a transparent hash function for string-like keys.  Because
+// it hashes the characters through a std::string_view, a std::string, a
+// std::string_view, and a const char* that contain the same characters all
+// hash to the same value, which is what heterogeneous lookup requires.
+
+struct StringHash
+{
+    typedef void is_transparent;
+
+    unsigned int operator()(std::string_view s) const noexcept;
+};
+
+
+inline unsigned int StringHash::operator()(std::string_view s) const noexcept
+{
+    return static_cast<unsigned int>(hashBytes(s.data(), s.size()));
+}
+
+
+
+// Crc32cHash is a transparent hash function for string-like keys, like
+// StringHash, but built on crc32c().  Where the CRC32 instruction is
+// available, it's the fastest way to hash long keys; but a CRC is linear,
+// so keys chosen to collide are easy to find.
+
+struct Crc32cHash
+{
+    typedef void is_transparent;
+
+    unsigned int operator()(std::string_view s) const noexcept;
+};
+
+
+inline unsigned int Crc32cHash::operator()(std::string_view s) const noexcept
+{
+    return crc32c(s.data(), s.size());
+}
+
+
+
+// IntegerHash is a hash function for integers, enums, and pointers.
+
+struct IntegerHash
+{
+    template <typename T>
+    unsigned int operator()(T key) const noexcept;
+};
+
+
+template <typename T>
+inline unsigned int IntegerHash::operator()(T key) const noexcept
+{
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "IntegerHash hashes integers, enums, and pointers");
+
+    std::uint64_t x;
+
+    if constexpr (std::is_pointer<T>::value)
+    {
+        x = reinterpret_cast<std::uintptr_t>(key);
+    }
+    else
+    {
+        x = static_cast<std::uint64_t>(key);
+    }
+
+    // The high half of the product depends on every bit of the key, and
+    // folding it into the low half lets the low bits do so, too.  One fold
+    // leaves some input bits with a lopsided influence on some output bits,
+    // so a multiply-shift finishes the job: the top 32 bits of a 64-bit
+    // product are the best-mixed ones.
+    std::uint64_t folded = HashingDetail::fold(x ^ HashingDetail::P0, HashingDetail::P1);
+    folded ^= folded >> 29;
+    return static_cast<unsigned int>((folded * HashingDetail::P2) >> 32);
+}
+
+
+
+// DefaultHash<T> is the hash function used for keys of type T when none is
+// given: IntegerHash for integers, enums, and pointers, and StringHash for
+// std::string and std::string_view.  There is no DefaultHash for other
+// types, so containers of them must name a Hash type of their own, such
+// as FunctionHash<T> below.
+
+template <typename T, typename Enable = void>
+struct DefaultHash;
+
+
+template <typename T>
+struct DefaultHash<T, std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>>
+    : IntegerHash
+{
+};
+
+
+template <>
+struct DefaultHash<std::string> : StringHash
+{
+};
+
+
+template <>
+struct DefaultHash<std::string_view> : StringHash
+{
+};
+
+
+
+// FunctionHash<T> can hold any function or function object that takes a
+// const T& and returns an unsigned int.  It's slower than a function
+// object type the compiler can see through, since every call goes through
+// a pointer, but one container type can be given a different one each
+// time it's constructed.
+
+template <typename T>
+using FunctionHash = std::function<unsigned int(const T&)>;
+
+
+
+#endif // HASHING_HPP
@@ -0,0 +1,741 @@
+// HyperLogLog.hpp
+//
+// A HyperLogLog estimates how many distinct elements have been added to it,
+// which is the one thing a HashSet of IDs is often kept around to answer,
+// using a small, fixed amount of memory rather than memory proportional to
+// the number of elements.  With a precision of p, it uses m = 2^p one-byte
+// "registers," and its estimates have a relative standard error of about
+// 1.04 / sqrt(m): 1.6% for p = 12 (4 KB), 0.8% for p = 14 (16 KB), and
+// 0.4% for p = 16 (64 KB), no matter how many elements there are.
+//
+// Elements are hashed with the same kind of hash function a HashSet uses
+// (DefaultHash<T>, unless another is given), and the result is spread out
+// to 64 bits with mix64().  The top p bits choose a register, which keeps
+// the largest "rank" (the position of the first 1 bit among the remaining
+// bits) of any element that chose it.  The estimate is computed from the
+// registers with Ertl's improved estimator, which is accurate across the
+// whole range of cardinalities without bias-correction tables.  (Since the
+// hash functions return 32 bits, elements whose hashes collide count once;
+// for well over a few hundred million distinct elements, 64-bit hashes
+// should be given to addHash() instead.)
+//
+// A HyperLogLog starts out "sparse": rather than allocating every register,
+// it keeps a sorted list of the registers that have been set, at a finer
+// precision of 25 bits, with a small unsorted buffer in front of it for new
+// additions.  At that precision, the number of distinct entries is nearly
+// an exact count, so small cardinalities are estimated very accurately.
+// Once the list would take more memory than the registers themselves, it
+// converts itself to the "dense" representation.
+//
+// HyperLogLogs with the same precision can be merged; the result is exactly
+// the sketch that adding both sets of elements to one HyperLogLog would
+// have produced.  A HyperLogLog is not safe to modify from more than one
+// thread at a time, so to count on several threads (or across shards),
+// give each its own HyperLogLog and merge them afterward.  Dense registers
+// are merged with SIMD byte-wise maximum instructions (32 bytes at a time
+// with AVX2, 16 with SSE2).  toBytes() and fromBytes() convert a
+// HyperLogLog to and from a compact, portable sequence of bytes.
+
+#ifndef HYPERLOGLOG_HPP
+#define HYPERLOGLOG_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+#include "Hashing.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+// HyperLogLogExceptions are thrown when a HyperLogLog is given an invalid
+// precision, when two with different precisions are merged, and when
+// fromBytes() is given bytes that aren't a valid HyperLogLog.
+
+class HyperLogLogException
+{
+public:
+    HyperLogLogException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline HyperLogLogException::HyperLogLogException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string HyperLogLogException::reason() const
+{
+    return reason_;
+}
+
+
+
+template <typename T, typename Hash = DefaultHash<T>>
+class HyperLogLog
+{
+public:
+    // The range of precisions allowed, and the one used by default.
+    static constexpr unsigned int MIN_PRECISION = 4;
+    static constexpr unsigned int MAX_PRECISION = 18;
+    static constexpr unsigned int DEFAULT_PRECISION = 14;
+
+    // The precision of the sparse representation's entries.
+    static constexpr unsigned int SPARSE_PRECISION = 25;
+
+    typedef Hash HashFunction;
+
+
+public:
+    // Initializes an empty, sparse HyperLogLog with 2^precision registers,
+    // which will use the given hash function to hash elements.  If none is
+    // given, DefaultHash<T> (see Hashing.hpp) is used.  It throws a
+    // HyperLogLogException if the precision is out of range.
+    HyperLogLog(unsigned int precision = DEFAULT_PRECISION, HashFunction hashFunction = DefaultHash<T>{});
+
+
+    // add() records an element.
+    void add(const T& element);
+
+
+    // addHash() records an element by its 64-bit hash, whose bits must all
+    // be well-mixed (e.g., from mix64() or hashBytes() in Hashing.hpp).
+    void addHash(std::uint64_t hash);
+
+
+    // estimate() returns the estimated number of distinct elements added.
+    double estimate() const;
+
+
+    // merge() adds every element recorded by another HyperLogLog to this
+    // one.  It throws a HyperLogLogException if the two have different
+    // precisions.
+    void merge(const HyperLogLog& other);
+
+
+    // clear() forgets every element, returning to the sparse
+    // representation.
+    void clear() noexcept;
+
+
+    // precision() returns the base-2 logarithm of the number of registers.
+    unsigned int precision() const noexcept;
+
+
+    // isSparse() returns true if the HyperLogLog is still using its sparse
+    // representation.
+    bool isSparse() const noexcept;
+
+
+    // sizeInBytes() returns the memory used by the registers, or by the
+    // sparse representation's entries.
+    std::size_t sizeInBytes() const noexcept;
+
+
+    // standardError() returns the relative standard error of the estimates
+    // of a dense HyperLogLog with the given precision.
+    static double standardError(unsigned int precision);
+
+
+    // toBytes() returns the HyperLogLog as a sequence of bytes: a four-byte
+    // header ("HLL" and a version number), a byte for the precision, a
+    // byte for the representation, and then either the number of sparse
+    // entries (four bytes) followed by the entries (four bytes each) or
+    // one byte for each register.  Every multi-byte value is
+    // little-endian.
+    std::vector<std::uint8_t> toBytes() const;
+
+
+    // fromBytes() returns the HyperLogLog that toBytes() returned the given
+    // bytes for, using the given hash function.  It throws a
+    // HyperLogLogException if the bytes aren't a valid HyperLogLog.
+    static HyperLogLog fromBytes(
+        const std::uint8_t* bytes, std::size_t size, HashFunction hashFunction = DefaultHash<T>{});
+
+
+private:
+    static constexpr std::uint8_t VERSION = 1;
+    static constexpr std::uint8_t SPARSE = 0;
+    static constexpr std::uint8_t DENSE = 1;
+    static constexpr std::size_t HEADER_SIZE = 6;
+
+    // New sparse entries are collected, unsorted, in a buffer of this size
+    // before being merged into the sorted list.
+    static constexpr std::size_t SPARSE_BUFFER_SIZE = 256;
+
+    // rankOf() returns one more than the number of leading zeros of the
+    // given bits, of which only the top "width" are meaningful.
+    static unsigned int rankOf(std::uint64_t bits, unsigned int width) noexcept;
+
+    // Each sparse entry holds a 25-bit register index and, below it, a
+    // 6-bit rank.  Sorting entries sorts them by index, then by rank.
+    static std::uint32_t sparseEntryOf(std::uint64_t hash) noexcept;
+    static std::uint32_t entryIndex(std::uint32_t entry) noexcept;
+    static std::uint32_t entryRank(std::uint32_t entry) noexcept;
+
+    // mergedSparse() merges two sorted lists of entries, keeping only the
+    // highest rank for each index.
+    static std::vector<std::uint32_t> mergedSparse(
+        const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b);
+
+    // sortedSparseEntries() returns the sorted list combined with the
+    // buffer, without modifying either.
+    std::vector<std::uint32_t> sortedSparseEntries() const;
+
+    // flushSparse() merges the buffer into the sorted list, and converts to
+    // the dense representation if the list has grown too large.
+    void flushSparse();
+
+    // convertToDense() moves every sparse entry into newly-allocated
+    // registers.
+    void convertToDense();
+
+    // addSparseEntry() records a sparse entry in the registers.
+    void addSparseEntry(std::uint32_t entry) noexcept;
+
+    // mergeRegisters() sets each register to the larger of its own value
+    // and the corresponding one of the given registers.
+    void mergeRegisters(const std::uint8_t* otherRegisters) noexcept;
+
+    double denseEstimate() const;
+
+
+private:
+    HashFunction hashFunction;
+    unsigned int precisionBits;
+    bool sparse;
+
+    std::vector<std::uint32_t> sparseEntries;
+    std::vector<std::uint32_t> sparseBuffer;
+    std::vector<std::uint8_t> registers;
+};
+
+
+
+template <typename T, typename Hash>
+HyperLogLog<T, Hash>::HyperLogLog(unsigned int precision, HashFunction hashFunction)
+    : hashFunction{hashFunction}, precisionBits{precision}, sparse{true}
+{
+    if (precision < MIN_PRECISION || precision > MAX_PRECISION)
+    {
+        throw HyperLogLogException{"precision must be between 4 and 18"};
+    }
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::add(const T& element)
+{
+    addHash(mix64(hashFunction(element)));
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::addHash(std::uint64_t hash)
+{
+    if (sparse)
+    {
+        sparseBuffer.push_back(sparseEntryOf(hash));
+
+        if (sparseBuffer.size() >= SPARSE_BUFFER_SIZE)
+        {
+            flushSparse();
+        }
+    }
+    else
+    {
+        std::uint8_t rank = static_cast<std::uint8_t>(rankOf(hash << precisionBits, 64 - precisionBits));
+        std::uint8_t& reg = registers[hash >> (64 - precisionBits)];
+        reg = std::max(reg, rank);
+    }
+}
+
+
+template <typename T, typename Hash>
+double HyperLogLog<T, Hash>::estimate() const
+{
+    if (!sparse)
+    {
+        return denseEstimate();
+    }
+
+    // Linear counting over the 2^25 sparse registers, of which the number
+    // of entries are non-zero.
+    double m = static_cast<double>(std::uint32_t{1} << SPARSE_PRECISION);
+    double n = static_cast<double>(sortedSparseEntries().size());
+    return m * std::log(m / (m - n));
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::merge(const HyperLogLog& other)
+{
+    if (other.precisionBits != precisionBits)
+    {
+        throw HyperLogLogException{"HyperLogLogs with different precisions can't be merged"};
+    }
+
+    // Merging a sketch with itself changes nothing, and the sparse case
+    // below would otherwise insert a vector's elements into itself.
+    if (&other == this)
+    {
+        return;
+    }
+
+    if (other.sparse)
+    {
+        if (sparse)
+        {
+            sparseBuffer.insert(sparseBuffer.end(), other.sparseEntries.begin(), other.sparseEntries.end());
+            sparseBuffer.insert(sparseBuffer.end(), other.sparseBuffer.begin(), other.sparseBuffer.end());
+            flushSparse();
+        }
+        else
+        {
+            for (std::uint32_t entry : other.sparseEntries)
+            {
+                addSparseEntry(entry);
+            }
+
+            for (std::uint32_t entry : other.sparseBuffer)
+            {
+                addSparseEntry(entry);
+            }
+        }
+    }
+    else
+    {
+        if (sparse)
+        {
+            convertToDense();
+        }
+
+        mergeRegisters(other.registers.data());
+    }
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::clear() noexcept
+{
+    sparse = true;
+    sparseEntries = std::vector<std::uint32_t>{};
+    sparseBuffer = std::vector<std::uint32_t>{};
+    registers = std::vector<std::uint8_t>{};
+}
+
+
+template <typename T, typename Hash>
+unsigned int HyperLogLog<T, Hash>::precision() const noexcept
+{
+    return precisionBits;
+}
+
+
+template <typename T, typename Hash>
+bool HyperLogLog<T, Hash>::isSparse() const noexcept
+{
+    return sparse;
+}
+
+
+template <typename T, typename Hash>
+std::size_t HyperLogLog<T, Hash>::sizeInBytes() const noexcept
+{
+    return (sparseEntries.capacity() + sparseBuffer.capacity()) * sizeof(std::uint32_t) + registers.capacity();
+}
+
+
+template <typename T, typename Hash>
+double HyperLogLog<T, Hash>::standardError(unsigned int precision)
+{
+    return 1.04 / std::sqrt(static_cast<double>(std::uint32_t{1} << precision));
+}
+
+
+template <typename T, typename Hash>
+std::vector<std::uint8_t> HyperLogLog<T, Hash>::toBytes() const
+{
+    std::vector<std::uint8_t> bytes{'H', 'L', 'L', VERSION, static_cast<std::uint8_t>(precisionBits)};
+
+    if (sparse)
+    {
+        std::vector<std::uint32_t> entries = sortedSparseEntries();
+        bytes.push_back(SPARSE);
+
+        auto put32 = [&](std::uint32_t value)
+        {
+            for (unsigned int shift = 0; shift < 32; shift += 8)
+            {
+                bytes.push_back(static_cast<std::uint8_t>(value >> shift));
+            }
+        };
+
+        put32(static_cast<std::uint32_t>(entries.size()));
+
+        for (std::uint32_t entry : entries)
+        {
+            put32(entry);
+        }
+    }
+    else
+    {
+        bytes.push_back(DENSE);
+        bytes.insert(bytes.end(), registers.begin(), registers.end());
+    }
+
+    return bytes;
+}
+
+
+template <typename T, typename Hash>
+HyperLogLog<T, Hash> HyperLogLog<T, Hash>::fromBytes(
+    const std::uint8_t* bytes, std::size_t size, HashFunction hashFunction)
+{
+    if (size < HEADER_SIZE || bytes[0] != 'H' || bytes[1] != 'L' || bytes[2] != 'L')
+    {
+        throw HyperLogLogException{"not a HyperLogLog"};
+    }
+    else if (bytes[3] != VERSION)
+    {
+        throw HyperLogLogException{"unsupported HyperLogLog version"};
+    }
+
+    unsigned int precision = bytes[4];
+
+    if (precision < MIN_PRECISION || precision > MAX_PRECISION)
+    {
+        throw HyperLogLogException{"invalid HyperLogLog precision"};
+    }
+
+    HyperLogLog sketch{precision, hashFunction};
+    std::size_t m = std::size_t{1} << precision;
+
+    if (bytes[5] == SPARSE)
+    {
+        auto get32 = [bytes](std::size_t offset)
+        {
+            std::uint32_t value = 0;
+
+            for (unsigned int i = 0; i < 4; ++i)
+            {
+                value |= static_cast<std::uint32_t>(bytes[offset + i]) << (i * 8);
+            }
+
+            return value;
+        };
+
+        if (size < HEADER_SIZE + 4)
+        {
+            throw HyperLogLogException{"truncated HyperLogLog"};
+        }
+
+        std::size_t count = get32(HEADER_SIZE);
+
+        if (size != HEADER_SIZE + 4 + count * 4)
+        {
+            throw HyperLogLogException{"truncated HyperLogLog"};
+        }
+
+        sketch.sparseEntries.reserve(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::uint32_t entry = get32(HEADER_SIZE + 4 + i * 4);
+
+            if (entry >> (SPARSE_PRECISION + 6) != 0 || entryRank(entry) == 0 || entryRank(entry) > 65 - SPARSE_PRECISION
+                || (i > 0 && entryIndex(entry) <= entryIndex(sketch.sparseEntries.back())))
+            {
+                throw HyperLogLogException{"invalid HyperLogLog sparse entry"};
+            }
+
+            sketch.sparseEntries.push_back(entry);
+        }
+    }
+    else if (bytes[5] == DENSE)
+    {
+        if (size != HEADER_SIZE + m)
+        {
+            throw HyperLogLogException{"truncated HyperLogLog"};
+        }
+
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            if (bytes[HEADER_SIZE + i] > 65 - precision)
+            {
+                throw HyperLogLogException{"invalid HyperLogLog register"};
+            }
+        }
+
+        sketch.sparse = false;
+        sketch.registers.assign(bytes + HEADER_SIZE, bytes + HEADER_SIZE + m);
+    }
+    else
+    {
+        throw HyperLogLogException{"invalid HyperLogLog representation"};
+    }
+
+    return sketch;
+}
+
+
+template <typename T, typename Hash>
+unsigned int HyperLogLog<T, Hash>::rankOf(std::uint64_t bits, unsigned int width) noexcept
+{
+    if (bits == 0)
+    {
+        return width + 1;
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned int>(__builtin_clzll(bits)) + 1;
+#else
+    unsigned int rank = 1;
+
+    while ((bits & (std::uint64_t{1} << 63)) == 0)
+    {
+        bits <<= 1;
+        ++rank;
+    }
+
+    return rank;
+#endif
+}
+
+
+template <typename T, typename Hash>
+std::uint32_t HyperLogLog<T, Hash>::sparseEntryOf(std::uint64_t hash) noexcept
+{
+    std::uint32_t index = static_cast<std::uint32_t>(hash >> (64 - SPARSE_PRECISION));
+    std::uint32_t rank = rankOf(hash << SPARSE_PRECISION, 64 - SPARSE_PRECISION);
+    return index << 6 | rank;
+}
+
+
+template <typename T, typename Hash>
+std::uint32_t HyperLogLog<T, Hash>::entryIndex(std::uint32_t entry) noexcept
+{
+    return entry >> 6;
+}
+
+
+template <typename T, typename Hash>
+std::uint32_t HyperLogLog<T, Hash>::entryRank(std::uint32_t entry) noexcept
+{
+    return entry & 63;
+}
+
+
+template <typename T, typename Hash>
+std::vector<std::uint32_t> HyperLogLog<T, Hash>::mergedSparse(
+    const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b)
+{
+    std::vector<std::uint32_t> merged;
+    merged.reserve(a.size() + b.size());
+    std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(merged));
+
+    // Entries with the same index are adjacent, with the highest rank last.
+    std::size_t kept = 0;
+
+    for (std::size_t i = 0; i < merged.size(); ++i)
+    {
+        if (i + 1 == merged.size() || entryIndex(merged[i + 1]) != entryIndex(merged[i]))
+        {
+            merged[kept++] = merged[i];
+        }
+    }
+
+    merged.resize(kept);
+    return merged;
+}
+
+
+template <typename T, typename Hash>
+std::vector<std::uint32_t> HyperLogLog<T, Hash>::sortedSparseEntries() const
+{
+    std::vector<std::uint32_t> buffer{sparseBuffer};
+    std::sort(buffer.begin(), buffer.end());
+    return mergedSparse(sparseEntries, buffer);
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::flushSparse()
+{
+    sparseEntries = sortedSparseEntries();
+    sparseBuffer.clear();
+
+    // Each entry takes four bytes and each register takes one, so the
+    // sparse representation is smaller until there are m / 4 entries.
+    if (sparseEntries.size() > (std::size_t{1} << precisionBits) / 4)
+    {
+        convertToDense();
+    }
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::convertToDense()
+{
+    registers.assign(std::size_t{1} << precisionBits, 0);
+    sparse = false;
+
+    for (std::uint32_t entry : sparseEntries)
+    {
+        addSparseEntry(entry);
+    }
+
+    for (std::uint32_t entry : sparseBuffer)
+    {
+        addSparseEntry(entry);
+    }
+
+    sparseEntries = std::vector<std::uint32_t>{};
+    sparseBuffer = std::vector<std::uint32_t>{};
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::addSparseEntry(std::uint32_t entry) noexcept
+{
+    // The dense index is the top p bits of the sparse index.  If any of the
+    // remaining 25 - p bits of the sparse index are set, they determine the
+    // rank; otherwise, the rank continues into the bits the sparse rank
+    // was computed from.
+    unsigned int extraBits = SPARSE_PRECISION - precisionBits;
+    std::uint32_t index = entryIndex(entry);
+    std::uint32_t extra = index & ((std::uint32_t{1} << extraBits) - 1);
+
+    std::uint8_t rank = extra != 0
+        ? static_cast<std::uint8_t>(rankOf(static_cast<std::uint64_t>(extra) << (64 - extraBits), extraBits))
+        : static_cast<std::uint8_t>(extraBits + entryRank(entry));
+
+    std::uint8_t& reg = registers[index >> extraBits];
+    reg = std::max(reg, rank);
+}
+
+
+template <typename T, typename Hash>
+void HyperLogLog<T, Hash>::mergeRegisters(const std::uint8_t* otherRegisters) noexcept
+{
+    std::size_t m = registers.size();
+    std::size_t i = 0;
+    std::uint8_t* mine = registers.data();
+
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mine + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(otherRegisters + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(mine + i), _mm256_max_epu8(a, b));
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= m; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mine + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(otherRegisters + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(mine + i), _mm_max_epu8(a, b));
+    }
+#endif
+
+    for (; i < m; ++i)
+    {
+        mine[i] = std::max(mine[i], otherRegisters[i]);
+    }
+}
+
+
+template <typename T, typename Hash>
+double HyperLogLog<T, Hash>::denseEstimate() const
+{
+    // This is the "improved raw estimator" from Otmar Ertl, "New
+    // cardinality estimation algorithms for HyperLogLog sketches" (2017).
+    // It works from a histogram of the register values, with corrections
+    // for the registers that are still zero (sigma) and those that have
+    // saturated (tau).
+    unsigned int q = 64 - precisionBits;
+    double m = static_cast<double>(registers.size());
+    std::vector<double> histogram(q + 2, 0.0);
+
+    for (std::uint8_t reg : registers)
+    {
+        histogram[reg] += 1.0;
+    }
+
+    auto sigma = [](double x)
+    {
+        if (x == 1.0)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        double y = 1.0;
+        double z = x;
+        double previous;
+
+        do
+        {
+            x *= x;
+            previous = z;
+            z += x * y;
+            y += y;
+        }
+        while (z != previous);
+
+        return z;
+    };
+
+    auto tau = [](double x)
+    {
+        if (x == 0.0 || x == 1.0)
+        {
+            return 0.0;
+        }
+
+        double y = 1.0;
+        double z = 1.0 - x;
+        double previous;
+
+        do
+        {
+            x = std::sqrt(x);
+            previous = z;
+            y *= 0.5;
+            z -= (1.0 - x) * (1.0 - x) * y;
+        }
+        while (z != previous);
+
+        return z / 3.0;
+    };
+
+    double z = m * tau(1.0 - histogram[q + 1] / m);
+
+    for (unsigned int k = q; k >= 1; --k)
+    {
+        z = 0.5 * (z + histogram[k]);
+    }
+
+    z += m * sigma(histogram[0] / m);
+
+    return m * m / (2.0 * std::log(2.0) * z);
+}
+
+
+
+#endif // HYPERLOGLOG_HPP
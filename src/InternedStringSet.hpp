@@ -0,0 +1,479 @@
+// InternedStringSet.hpp
+//
+// An InternedStringSet is a Set of strings built for holding a very large
+// number of short ones -- identifiers, say -- as cheaply as possible.  A
+// HashSet<std::string> spends far more memory on bookkeeping than on the
+// characters themselves: every element is a std::string (with its own heap
+// allocation, once it's too long for the small-string buffer) inside a
+// heap-allocated chain node, plus a cell in the array.
+//
+// Instead, an InternedStringSet copies each string's characters into an
+// "arena": a sequence of large chunks of memory that are only ever appended
+// to.  Each string is stored there as a record, which holds the string's
+// ID, then its length (in one byte, for strings shorter than 128
+// characters), then its characters.  Records are located by 32-bit
+// offsets, so the arena can hold up to 4 GB of them.
+//
+// The hash table is open-addressed, with linear probing; each cell is just
+// 8 bytes, holding a record's offset and the string's hash.  Since the hash
+// is right there, a lookup only reads a record when the hashes match, and
+// growing the table never has to look at the strings at all.
+//
+// Every string added to the set is given an ID, counting up from 0, which
+// never changes; view() turns an ID back into its characters.  Since the
+// arena's chunks never move, the std::string_views it returns remain valid
+// for as long as the set does.  There's no way to remove a string, which
+// is what makes both of these guarantees possible.
+
+#ifndef INTERNEDSTRINGSET_HPP
+#define INTERNEDSTRINGSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Hashing.hpp"
+#include "Set.hpp"
+
+
+
+// InternedStringSetExceptions are thrown when an InternedStringSet's arena
+// has no room left for another string.
+
+class InternedStringSetException
+{
+public:
+    InternedStringSetException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline InternedStringSetException::InternedStringSetException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string InternedStringSetException::reason() const
+{
+    return reason_;
+}
+
+
+
+class InternedStringSet : public Set<std::string>
+{
+public:
+    // An Id identifies one of the strings in the set.
+    typedef std::uint32_t Id;
+
+    // NOT_FOUND is the Id find() returns for strings that aren't in the set.
+    static constexpr Id NOT_FOUND = 0xFFFFFFFF;
+
+    // The size of each chunk of the arena, in bytes.  (Longer strings get
+    // a chunk of their own.)
+    static constexpr unsigned int CHUNK_BITS = 20;
+    static constexpr std::size_t CHUNK_SIZE = std::size_t{1} << CHUNK_BITS;
+
+    // The number of cells in the table before anything has been added.
+    static constexpr unsigned int DEFAULT_CAPACITY = 16;
+
+public:
+    // Initializes an InternedStringSet to be empty.
+    InternedStringSet();
+
+    // Initializes a new InternedStringSet to be a copy of an existing one,
+    // with the same Ids.
+    InternedStringSet(const InternedStringSet& s);
+
+    // Initializes a new InternedStringSet whose contents are moved from an
+    // expiring one, which is left empty.
+    InternedStringSet(InternedStringSet&& s) noexcept = default;
+
+    // Assigns an existing InternedStringSet into another.
+    InternedStringSet& operator=(const InternedStringSet& s);
+
+    // Assigns an expiring InternedStringSet into another.
+    InternedStringSet& operator=(InternedStringSet&& s) noexcept = default;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds a string to the set.  If the string is already in the
+    // set, this function has no effect.
+    virtual void add(const std::string& element) override;
+
+
+    // contains() returns true if the given string is already in the set,
+    // false otherwise.
+    virtual bool contains(const std::string& element) const override;
+
+
+    // intern() returns the Id of the given string, adding it to the set
+    // first if it isn't already there.  Throws an
+    // InternedStringSetException if the arena is full.
+    Id intern(std::string_view s);
+
+
+    // find() returns the Id of the given string, or NOT_FOUND if it isn't
+    // in the set.
+    Id find(std::string_view s) const noexcept;
+
+
+    // view() returns the characters of the string with the given Id, which
+    // must be one that intern() has returned.
+    std::string_view view(Id id) const noexcept;
+
+
+    // size() returns the number of strings in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // capacity() returns the number of cells in the table.
+    unsigned int capacity() const noexcept;
+
+
+    // sizeInBytes() returns the memory used by the arena (counting the
+    // unused ends of its chunks), the table, and the list of Ids.
+    std::size_t sizeInBytes() const noexcept;
+
+
+private:
+    struct Cell
+    {
+        std::uint32_t offset;
+        std::uint32_t hash;
+    };
+
+    struct Chunk
+    {
+        std::unique_ptr<char[]> bytes;
+        std::size_t size;
+    };
+
+    // Cells whose offset is EMPTY are empty.  (No record can start there,
+    // since a record is at least five bytes long.)
+    static constexpr std::uint32_t EMPTY = 0xFFFFFFFF;
+
+    static std::uint32_t hashOf(std::string_view s) noexcept;
+
+    // record() returns a pointer to the record at the given offset.
+    const char* record(std::uint32_t offset) const noexcept;
+
+    // readRecord() returns the characters of the record at the given
+    // offset, storing its Id into the given variable.
+    std::string_view readRecord(std::uint32_t offset, Id& id) const noexcept;
+
+    // findCell() returns the cell holding the given string, or the empty
+    // cell where it would go.
+    std::size_t findCell(std::string_view s, std::uint32_t hash) const noexcept;
+
+    // allocate() reserves the given number of bytes at the end of the
+    // arena, returning their offset.
+    std::uint32_t allocate(std::size_t bytes);
+
+    void grow();
+
+
+private:
+    std::vector<Cell> cells;
+    std::vector<Chunk> chunks;
+    std::vector<std::uint32_t> offsets;
+
+    // Where the next record goes: in chunk lastChunk, after lastUsed bytes.
+    std::size_t lastChunk;
+    std::size_t lastUsed;
+};
+
+
+
+inline InternedStringSet::InternedStringSet()
+    : cells(DEFAULT_CAPACITY, Cell{EMPTY, 0}), lastChunk{0}, lastUsed{0}
+{
+}
+
+
+inline InternedStringSet::InternedStringSet(const InternedStringSet& s)
+    : cells{s.cells}, offsets{s.offsets}, lastChunk{s.lastChunk}, lastUsed{s.lastUsed}
+{
+    chunks.reserve(s.chunks.size());
+
+    for (const Chunk& chunk : s.chunks)
+    {
+        if (chunk.bytes == nullptr)
+        {
+            chunks.push_back(Chunk{nullptr, 0});
+        }
+        else
+        {
+            chunks.push_back(Chunk{std::make_unique<char[]>(chunk.size), chunk.size});
+            std::memcpy(chunks.back().bytes.get(), chunk.bytes.get(), chunk.size);
+        }
+    }
+}
+
+
+inline InternedStringSet& InternedStringSet::operator=(const InternedStringSet& s)
+{
+    if (this != &s)
+    {
+        InternedStringSet copy{s};
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
+
+inline bool InternedStringSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+inline void InternedStringSet::add(const std::string& element)
+{
+    intern(element);
+}
+
+
+inline bool InternedStringSet::contains(const std::string& element) const
+{
+    return find(element) != NOT_FOUND;
+}
+
+
+inline InternedStringSet::Id InternedStringSet::intern(std::string_view s)
+{
+    // A set that's been moved from has no table at all.
+    if (cells.empty())
+    {
+        cells.assign(DEFAULT_CAPACITY, Cell{EMPTY, 0});
+    }
+
+    std::uint32_t hash = hashOf(s);
+    std::size_t cell = findCell(s, hash);
+
+    if (cells[cell].offset != EMPTY)
+    {
+        Id id;
+        readRecord(cells[cell].offset, id);
+        return id;
+    }
+
+    // The table is kept no more than three quarters full.
+    if ((offsets.size() + 1) * 4 > cells.size() * 3)
+    {
+        grow();
+        cell = findCell(s, hash);
+    }
+
+    unsigned char length[5];
+    std::size_t lengthBytes = 0;
+
+    for (std::size_t n = s.size(); ; n >>= 7)
+    {
+        length[lengthBytes++] = static_cast<unsigned char>((n & 0x7F) | (n >= 0x80 ? 0x80 : 0));
+
+        if (n < 0x80)
+        {
+            break;
+        }
+    }
+
+    Id id = static_cast<Id>(offsets.size());
+    std::uint32_t offset = allocate(sizeof(Id) + lengthBytes + s.size());
+    offsets.push_back(offset);
+
+    char* destination = const_cast<char*>(record(offset));
+    std::memcpy(destination, &id, sizeof(Id));
+    std::memcpy(destination + sizeof(Id), length, lengthBytes);
+    std::memcpy(destination + sizeof(Id) + lengthBytes, s.data(), s.size());
+
+    cells[cell] = Cell{offset, hash};
+    return id;
+}
+
+
+inline InternedStringSet::Id InternedStringSet::find(std::string_view s) const noexcept
+{
+    if (cells.empty())
+    {
+        return NOT_FOUND;
+    }
+
+    std::size_t cell = findCell(s, hashOf(s));
+
+    if (cells[cell].offset == EMPTY)
+    {
+        return NOT_FOUND;
+    }
+
+    Id id;
+    readRecord(cells[cell].offset, id);
+    return id;
+}
+
+
+inline std::string_view InternedStringSet::view(Id id) const noexcept
+{
+    Id ignored;
+    return readRecord(offsets[id], ignored);
+}
+
+
+inline unsigned int InternedStringSet::size() const noexcept
+{
+    return static_cast<unsigned int>(offsets.size());
+}
+
+
+inline unsigned int InternedStringSet::capacity() const noexcept
+{
+    return static_cast<unsigned int>(cells.size());
+}
+
+
+inline std::size_t InternedStringSet::sizeInBytes() const noexcept
+{
+    std::size_t bytes = cells.capacity() * sizeof(Cell) + offsets.capacity() * sizeof(std::uint32_t);
+
+    for (const Chunk& chunk : chunks)
+    {
+        bytes += chunk.size;
+    }
+
+    return bytes;
+}
+
+
+inline std::uint32_t InternedStringSet::hashOf(std::string_view s) noexcept
+{
+    return static_cast<std::uint32_t>(hashBytes(s.data(), s.size()));
+}
+
+
+inline const char* InternedStringSet::record(std::uint32_t offset) const noexcept
+{
+    return chunks[offset >> CHUNK_BITS].bytes.get() + (offset & (CHUNK_SIZE - 1));
+}
+
+
+inline std::string_view InternedStringSet::readRecord(std::uint32_t offset, Id& id) const noexcept
+{
+    const char* p = record(offset);
+    std::memcpy(&id, p, sizeof(Id));
+    p += sizeof(Id);
+
+    std::size_t length = 0;
+
+    for (unsigned int shift = 0; ; shift += 7)
+    {
+        unsigned char byte = static_cast<unsigned char>(*p++);
+        length |= static_cast<std::size_t>(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+        {
+            break;
+        }
+    }
+
+    return std::string_view{p, length};
+}
+
+
+inline std::size_t InternedStringSet::findCell(std::string_view s, std::uint32_t hash) const noexcept
+{
+    std::size_t mask = cells.size() - 1;
+
+    for (std::size_t cell = hash & mask; ; cell = (cell + 1) & mask)
+    {
+        const Cell& c = cells[cell];
+
+        if (c.offset == EMPTY)
+        {
+            return cell;
+        }
+
+        if (c.hash == hash)
+        {
+            Id id;
+
+            if (readRecord(c.offset, id) == s)
+            {
+                return cell;
+            }
+        }
+    }
+}
+
+
+inline std::uint32_t InternedStringSet::allocate(std::size_t bytes)
+{
+    if (chunks.empty() || lastUsed + bytes > chunks[lastChunk].size)
+    {
+        // Records never straddle chunks; a record too long for an ordinary
+        // chunk gets one of its own, which takes up as many chunks' worth
+        // of offsets as it needs (the rest are left empty).
+        std::size_t size = bytes > CHUNK_SIZE ? bytes : CHUNK_SIZE;
+        std::size_t spans = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+        if (((chunks.size() + spans) << CHUNK_BITS) > (std::uint64_t{1} << 32))
+        {
+            throw InternedStringSetException{"the arena is full"};
+        }
+
+        std::size_t index = chunks.size();
+        chunks.push_back(Chunk{std::make_unique<char[]>(size), size});
+
+        for (std::size_t i = 1; i < spans; ++i)
+        {
+            chunks.push_back(Chunk{nullptr, 0});
+        }
+
+        lastChunk = index;
+        lastUsed = 0;
+    }
+
+    std::uint32_t offset = static_cast<std::uint32_t>((lastChunk << CHUNK_BITS) + lastUsed);
+    lastUsed += bytes;
+    return offset;
+}
+
+
+inline void InternedStringSet::grow()
+{
+    std::vector<Cell> newCells(cells.size() * 2, Cell{EMPTY, 0});
+    std::size_t mask = newCells.size() - 1;
+
+    // The hashes are cached, so the strings themselves aren't touched.
+    for (const Cell& c : cells)
+    {
+        if (c.offset != EMPTY)
+        {
+            std::size_t cell = c.hash & mask;
+
+            while (newCells[cell].offset != EMPTY)
+            {
+                cell = (cell + 1) & mask;
+            }
+
+            newCells[cell] = c;
+        }
+    }
+
+    cells = std::move(newCells);
+}
+
+
+
+#endif // INTERNEDSTRINGSET_HPP
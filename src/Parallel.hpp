@@ -0,0 +1,80 @@
+// Parallel.hpp
+//
+// The one piece of thread management shared by the data structures that
+// can split their work across threads (HashTable's emplaceParallel(),
+// AVLSet's bulk loading and set operations, and the operations in
+// SetAlgebra.hpp).  Each of them divides its work into a fixed number of
+// pieces up front and hands them to runOnThreads(), rather than keeping a
+// pool of threads around.
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+
+
+// runOnThreads() calls work(t) for each t in [0, threads), each on its own
+// thread (except the last, which runs on this one), and waits for them
+// all.  If a thread can't be started, its piece runs on this thread
+// instead, so the work is always done.  If any piece throws, the first
+// exception is rethrown once they've all finished.  A threads of 0 is
+// treated as 1.
+template <typename Work>
+void runOnThreads(unsigned int threads, Work work)
+{
+    threads = threads != 0 ? threads : 1;
+
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> running;
+
+    // Reserving up front means that once a thread is started, nothing can
+    // throw before it's joined.
+    running.reserve(threads - 1);
+
+    auto guarded = [&](unsigned int t)
+    {
+        try
+        {
+            work(t);
+        }
+        catch (...)
+        {
+            errors[t] = std::current_exception();
+        }
+    };
+
+    for (unsigned int t = 0; t + 1 < threads; ++t)
+    {
+        try
+        {
+            running.emplace_back(guarded, t);
+        }
+        catch (const std::system_error&)
+        {
+            guarded(t);
+        }
+    }
+
+    guarded(threads - 1);
+
+    for (std::thread& thread : running)
+    {
+        thread.join();
+    }
+
+    for (std::exception_ptr& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+
+
+#endif // PARALLEL_HPP
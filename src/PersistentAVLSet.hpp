@@ -0,0 +1,510 @@
+// PersistentAVLSet.hpp
+//
+// A PersistentAVLSet is an implementation of a Set that is an AVL tree,
+// like AVLSet, but whose nodes are never changed once they've been built.
+// Instead, add() and remove() build new copies of the nodes along the path
+// from the root to the element (and of the few nodes that rotations
+// touch), pointing to the same, unchanged subtrees everywhere else, and
+// then make the new root the set's root.  This is "path copying": each
+// change costs O(log n) new nodes, and every earlier version of the tree
+// remains intact for as long as anything still refers to it.
+//
+// Nodes are shared between versions by std::shared_ptr, so a node is
+// destroyed when the last version that contains it is.  That makes
+// snapshot() -- and copying a PersistentAVLSet, which is the same thing --
+// take O(1) time: it just shares the root.  The snapshot and the original
+// are independent sets from then on; changing either doesn't affect the
+// other, and neither ever copies the nodes they share.
+//
+// The root is read and written with the atomic operations the standard
+// library provides for std::shared_ptr, so a snapshot can be taken on any
+// thread while one writer continues to add and remove elements, without
+// any other locking.  The snapshot can then be read -- with contains(),
+// size(), or inorder() -- for as long as it's needed, seeing a consistent
+// version of the set, while the writer goes on changing the original.
+// There must still be only one writer at a time for each set.
+//
+// The trade-offs, compared to AVLSet, are that every change allocates
+// O(log n) nodes and copies the elements in them, and that each node
+// carries a reference count.
+
+#ifndef PERSISTENTAVLSET_HPP
+#define PERSISTENTAVLSET_HPP
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "Set.hpp"
+
+
+
+template <typename T>
+class PersistentAVLSet : public Set<T>
+{
+public:
+    // Initializes a PersistentAVLSet to be empty.
+    PersistentAVLSet() noexcept;
+
+    // Cleans up the PersistentAVLSet, destroying any nodes that no other
+    // version of it still shares.
+    virtual ~PersistentAVLSet() noexcept = default;
+
+    // Initializes a new PersistentAVLSet to be a copy of an existing one.
+    // The copy shares all of its nodes, so this takes O(1) time.
+    PersistentAVLSet(const PersistentAVLSet& s) noexcept;
+
+    // Initializes a new PersistentAVLSet whose contents are moved from an
+    // expiring one.
+    PersistentAVLSet(PersistentAVLSet&& s) noexcept;
+
+    // Assigns an existing PersistentAVLSet into another, in O(1) time.
+    PersistentAVLSet& operator=(const PersistentAVLSet& s) noexcept;
+
+    // Assigns an expiring PersistentAVLSet into another.
+    PersistentAVLSet& operator=(PersistentAVLSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect and allocates nothing.  Otherwise,
+    // it builds O(log n) new nodes and publishes the new version.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  It takes O(log n) time.
+    virtual bool contains(const T& element) const override;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // remove() removes an element from the set, returning true if it was
+    // there and false otherwise.  Like add(), it builds O(log n) new nodes
+    // when it changes the set, and none when it doesn't.
+    bool remove(const T& element);
+
+
+    // clear() removes every element from the set.  Snapshots taken earlier
+    // are unaffected.
+    void clear() noexcept;
+
+
+    // height() returns the height of the AVL tree, which is -1 when it's
+    // empty.
+    int height() const noexcept;
+
+
+    // snapshot() returns the current version of the set, in O(1) time.  It
+    // can be called on any thread, even while another thread is adding or
+    // removing elements; the result never changes afterward, unless it's
+    // changed directly.
+    PersistentAVLSet snapshot() const noexcept;
+
+
+    // inorder() visits all of the elements in ascending order, calling the
+    // given function on each.  If it returns bool, the traversal stops as
+    // soon as it returns false.  It returns true if every element was
+    // visited, false if the traversal stopped early.
+    template <typename Visit>
+    bool inorder(Visit visit) const;
+
+
+private:
+    struct Node;
+    typedef std::shared_ptr<const Node> NodePtr;
+
+    struct Node
+    {
+        Node(const T& key, NodePtr left, NodePtr right);
+
+        T key;
+        NodePtr left;
+        NodePtr right;
+        int height;
+        unsigned int size;
+    };
+
+    // The largest possible height of an AVL tree with fewer than 2^32
+    // nodes, which bounds the stack inorder() needs.
+    static constexpr int MAX_HEIGHT = 44;
+
+    static int heightOf(const NodePtr& node) noexcept;
+    static unsigned int sizeOf(const NodePtr& node) noexcept;
+
+    // balance() builds a node with the given key and subtrees, whose
+    // heights may differ by up to 2, rotating as necessary to make the
+    // result an AVL tree.  The subtrees are shared, not copied, except for
+    // the nodes a rotation has to rebuild.
+    static NodePtr balance(const NodePtr& left, const T& key, const NodePtr& right);
+
+    // insert() returns a new version of the given subtree with the element
+    // added, or the same subtree if the element was already there.
+    static NodePtr insert(const NodePtr& node, const T& element);
+
+    // erase() returns a new version of the given subtree with the element
+    // removed, or the same subtree if the element wasn't there.
+    static NodePtr erase(const NodePtr& node, const T& element);
+
+    // eraseMinimum() returns a new version of a non-empty subtree with its
+    // smallest element removed.
+    static NodePtr eraseMinimum(const NodePtr& node);
+
+    // current() atomically loads the root, and publish() atomically
+    // replaces it.
+    NodePtr current() const noexcept;
+    void publish(NodePtr newRoot) noexcept;
+
+
+private:
+    NodePtr root;
+};
+
+
+
+template <typename T>
+PersistentAVLSet<T>::Node::Node(const T& key, NodePtr left, NodePtr right)
+    : key{key}, left{std::move(left)}, right{std::move(right)}
+{
+    int leftHeight = heightOf(this->left);
+    int rightHeight = heightOf(this->right);
+
+    height = 1 + (leftHeight > rightHeight ? leftHeight : rightHeight);
+    size = 1 + sizeOf(this->left) + sizeOf(this->right);
+}
+
+
+template <typename T>
+PersistentAVLSet<T>::PersistentAVLSet() noexcept
+{
+}
+
+
+template <typename T>
+PersistentAVLSet<T>::PersistentAVLSet(const PersistentAVLSet& s) noexcept
+    : root{s.current()}
+{
+}
+
+
+template <typename T>
+PersistentAVLSet<T>::PersistentAVLSet(PersistentAVLSet&& s) noexcept
+    : root{std::atomic_exchange(&s.root, NodePtr{})}
+{
+}
+
+
+template <typename T>
+PersistentAVLSet<T>& PersistentAVLSet<T>::operator=(const PersistentAVLSet& s) noexcept
+{
+    if (this != &s)
+    {
+        publish(s.current());
+    }
+
+    return *this;
+}
+
+
+template <typename T>
+PersistentAVLSet<T>& PersistentAVLSet<T>::operator=(PersistentAVLSet&& s) noexcept
+{
+    if (this != &s)
+    {
+        publish(std::atomic_exchange(&s.root, NodePtr{}));
+    }
+
+    return *this;
+}
+
+
+template <typename T>
+bool PersistentAVLSet<T>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T>
+void PersistentAVLSet<T>::add(const T& element)
+{
+    NodePtr oldRoot = current();
+    NodePtr newRoot = insert(oldRoot, element);
+
+    if (newRoot != oldRoot)
+    {
+        publish(std::move(newRoot));
+    }
+}
+
+
+template <typename T>
+bool PersistentAVLSet<T>::contains(const T& element) const
+{
+    NodePtr version = current();
+    const Node* node = version.get();
+
+    while (node != nullptr)
+    {
+        if (element < node->key)
+        {
+            node = node->left.get();
+        }
+        else if (node->key < element)
+        {
+            node = node->right.get();
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <typename T>
+unsigned int PersistentAVLSet<T>::size() const noexcept
+{
+    return sizeOf(current());
+}
+
+
+template <typename T>
+bool PersistentAVLSet<T>::remove(const T& element)
+{
+    NodePtr oldRoot = current();
+    NodePtr newRoot = erase(oldRoot, element);
+
+    if (newRoot == oldRoot)
+    {
+        return false;
+    }
+
+    publish(std::move(newRoot));
+    return true;
+}
+
+
+template <typename T>
+void PersistentAVLSet<T>::clear() noexcept
+{
+    publish(NodePtr{});
+}
+
+
+template <typename T>
+int PersistentAVLSet<T>::height() const noexcept
+{
+    return heightOf(current());
+}
+
+
+template <typename T>
+PersistentAVLSet<T> PersistentAVLSet<T>::snapshot() const noexcept
+{
+    return PersistentAVLSet{*this};
+}
+
+
+template <typename T>
+template <typename Visit>
+bool PersistentAVLSet<T>::inorder(Visit visit) const
+{
+    // Holding the root keeps the whole version alive, so the rest of the
+    // walk can follow plain pointers.
+    NodePtr version = current();
+    const Node* stack[MAX_HEIGHT + 1];
+    int depth = 0;
+    const Node* node = version.get();
+
+    while (node != nullptr || depth > 0)
+    {
+        while (node != nullptr)
+        {
+            stack[depth++] = node;
+            node = node->left.get();
+        }
+
+        node = stack[--depth];
+
+        if constexpr (std::is_void<decltype(visit(node->key))>::value)
+        {
+            visit(node->key);
+        }
+        else if (!visit(node->key))
+        {
+            return false;
+        }
+
+        node = node->right.get();
+    }
+
+    return true;
+}
+
+
+template <typename T>
+int PersistentAVLSet<T>::heightOf(const NodePtr& node) noexcept
+{
+    return node ? node->height : -1;
+}
+
+
+template <typename T>
+unsigned int PersistentAVLSet<T>::sizeOf(const NodePtr& node) noexcept
+{
+    return node ? node->size : 0;
+}
+
+
+template <typename T>
+typename PersistentAVLSet<T>::NodePtr PersistentAVLSet<T>::balance(
+    const NodePtr& left, const T& key, const NodePtr& right)
+{
+    int leftHeight = heightOf(left);
+    int rightHeight = heightOf(right);
+
+    if (leftHeight > rightHeight + 1)
+    {
+        if (heightOf(left->left) >= heightOf(left->right))
+        {
+            // LL case: a single rotation to the right.
+            return std::make_shared<const Node>(
+                left->key, left->left, std::make_shared<const Node>(key, left->right, right));
+        }
+        else
+        {
+            // LR case: the left child's right child becomes the root.
+            const NodePtr& middle = left->right;
+
+            return std::make_shared<const Node>(
+                middle->key,
+                std::make_shared<const Node>(left->key, left->left, middle->left),
+                std::make_shared<const Node>(key, middle->right, right));
+        }
+    }
+    else if (rightHeight > leftHeight + 1)
+    {
+        if (heightOf(right->right) >= heightOf(right->left))
+        {
+            // RR case: a single rotation to the left.
+            return std::make_shared<const Node>(
+                right->key, std::make_shared<const Node>(key, left, right->left), right->right);
+        }
+        else
+        {
+            // RL case: the right child's left child becomes the root.
+            const NodePtr& middle = right->left;
+
+            return std::make_shared<const Node>(
+                middle->key,
+                std::make_shared<const Node>(key, left, middle->left),
+                std::make_shared<const Node>(right->key, middle->right, right->right));
+        }
+    }
+
+    return std::make_shared<const Node>(key, left, right);
+}
+
+
+template <typename T>
+typename PersistentAVLSet<T>::NodePtr PersistentAVLSet<T>::insert(
+    const NodePtr& node, const T& element)
+{
+    if (!node)
+    {
+        return std::make_shared<const Node>(element, nullptr, nullptr);
+    }
+
+    if (element < node->key)
+    {
+        NodePtr left = insert(node->left, element);
+        return left == node->left ? node : balance(left, node->key, node->right);
+    }
+    else if (node->key < element)
+    {
+        NodePtr right = insert(node->right, element);
+        return right == node->right ? node : balance(node->left, node->key, right);
+    }
+    else
+    {
+        return node;
+    }
+}
+
+
+template <typename T>
+typename PersistentAVLSet<T>::NodePtr PersistentAVLSet<T>::erase(
+    const NodePtr& node, const T& element)
+{
+    if (!node)
+    {
+        return node;
+    }
+
+    if (element < node->key)
+    {
+        NodePtr left = erase(node->left, element);
+        return left == node->left ? node : balance(left, node->key, node->right);
+    }
+    else if (node->key < element)
+    {
+        NodePtr right = erase(node->right, element);
+        return right == node->right ? node : balance(node->left, node->key, right);
+    }
+    else if (!node->left)
+    {
+        return node->right;
+    }
+    else if (!node->right)
+    {
+        return node->left;
+    }
+
+    // The node's successor, the smallest element in its right subtree,
+    // takes its place.
+    const Node* successor = node->right.get();
+
+    while (successor->left)
+    {
+        successor = successor->left.get();
+    }
+
+    return balance(node->left, successor->key, eraseMinimum(node->right));
+}
+
+
+template <typename T>
+typename PersistentAVLSet<T>::NodePtr PersistentAVLSet<T>::eraseMinimum(
+    const NodePtr& node)
+{
+    if (!node->left)
+    {
+        return node->right;
+    }
+
+    return balance(eraseMinimum(node->left), node->key, node->right);
+}
+
+
+template <typename T>
+typename PersistentAVLSet<T>::NodePtr PersistentAVLSet<T>::current() const noexcept
+{
+    return std::atomic_load(&root);
+}
+
+
+template <typename T>
+void PersistentAVLSet<T>::publish(NodePtr newRoot) noexcept
+{
+    std::atomic_store(&root, std::move(newRoot));
+}
+
+
+
+#endif // PERSISTENTAVLSET_HPP
@@ -0,0 +1,49 @@
+// Set.hpp
+//
+// ICS 46 Winter 2018
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A Set is an abstract base class that describes the operations that every
+// kind of set in this project supports.  A set stores a collection of
+// unique elements; adding an element that's already present has no effect.
+// The derived classes (HashSet, AVLSet, SkipListSet) differ only in how
+// they organize their elements internally, so that the same code can be
+// written against any of them.
+
+#ifndef SET_HPP
+#define SET_HPP
+
+
+
+template <typename ElementType>
+class Set
+{
+public:
+    // The destructor is virtual, so that derived classes are cleaned up
+    // properly when destroyed through a pointer to Set.
+    virtual ~Set() noexcept = default;
+
+
+    // isImplemented() returns true if the derived set has been implemented,
+    // false otherwise.
+    virtual bool isImplemented() const noexcept = 0;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.
+    virtual void add(const ElementType& element) = 0;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.
+    virtual bool contains(const ElementType& element) const = 0;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept = 0;
+};
+
+
+
+#endif // SET_HPP
+
@@ -0,0 +1,500 @@
+// SetAlgebra.hpp
+//
+// setIntersection(), setUnion(), and setDifference() combine two sets,
+// each of which may be a HashSet, an AVLSet, or a SkipListSet (and the two
+// needn't be the same kind), returning the resulting elements in a
+// std::vector.  Rather than always looping over one set and calling
+// contains() on the other, each of them picks a strategy based on what
+// kinds of sets it's given and how their sizes compare:
+//
+// * When either set is a HashSet, the elements of one (the smaller one,
+//   except for setDifference(), where it's a) are each looked up
+//   ("probed") in the other, which is only walked if its elements are part
+//   of the result.  The same is done for two ordered sets when the other
+//   is more than PROBE_RATIO times as large, except by setUnion(), which
+//   has to walk both sets anyway.
+//
+// * When both sets are ordered (AVLSets or SkipListSets) and their sizes
+//   are within a factor of GALLOP_RATIO of each other, both are walked in
+//   ascending order and merged, the way std::set_intersection does.
+//
+// * When both are ordered and their sizes are further apart than that,
+//   the elements of the smaller are located in the larger by galloping:
+//   searching forward from the last position with steps of 1, 2, 4, 8,
+//   and so on, then binary searching within the last step.  Long runs of
+//   the larger set are skipped with logarithmically many comparisons.
+//
+// When both sets are ordered, the result is in ascending order; otherwise,
+// its order is unspecified.
+//
+// Each function takes an optional number of threads.  Given more than one,
+// and enough elements to be worth it (MIN_PARALLEL_SIZE in all), the work
+// is partitioned: probing splits the probed elements into equal shares,
+// and merging or galloping splits both sets at the same keys, chosen so
+// the larger set is divided evenly, so that each thread produces a
+// contiguous piece of the result.  The sets must not be modified while
+// any of these functions is running.
+
+#ifndef SETALGEBRA_HPP
+#define SETALGEBRA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include "AVLSet.hpp"
+#include "HashSet.hpp"
+#include "Parallel.hpp"
+#include "SkipListSet.hpp"
+
+
+
+// SetTraits describes, for each kind of set that the set algebra functions
+// accept, the type of its elements, whether it keeps them in order, and
+// how to visit them all (in ascending order, if it keeps them in order).
+
+template <typename SetType>
+struct SetTraits;
+
+
+template <typename T, typename Hash, typename KeyEqual, bool CacheHash>
+struct SetTraits<HashSet<T, Hash, KeyEqual, CacheHash>>
+{
+    typedef T ElementType;
+    static constexpr bool ORDERED = false;
+
+    template <typename Visit>
+    static void forEach(const HashSet<T, Hash, KeyEqual, CacheHash>& s, Visit visit)
+    {
+        s.forEach(visit);
+    }
+};
+
+
+template <typename T>
+struct SetTraits<AVLSet<T>>
+{
+    typedef T ElementType;
+    static constexpr bool ORDERED = true;
+
+    template <typename Visit>
+    static void forEach(const AVLSet<T>& s, Visit visit)
+    {
+        s.inorder(visit);
+    }
+};
+
+
+template <typename T>
+struct SetTraits<SkipListSet<T>>
+{
+    typedef T ElementType;
+    static constexpr bool ORDERED = true;
+
+    template <typename Visit>
+    static void forEach(const SkipListSet<T>& s, Visit visit)
+    {
+        s.forEach(visit);
+    }
+};
+
+
+
+namespace SetAlgebraDetail
+{
+    // When one ordered set is at least GALLOP_RATIO times as large as the
+    // other, the smaller one's elements gallop through the larger one's
+    // rather than being merged with them.
+    constexpr std::size_t GALLOP_RATIO = 8;
+
+    // When one ordered set is at least PROBE_RATIO times as large as the
+    // other, the smaller one's elements are looked up in the larger set
+    // itself, rather than walking all of it to gallop through.
+    constexpr std::size_t PROBE_RATIO = 32;
+
+    // Fewer elements than this, in the two sets together, are always
+    // combined on one thread.
+    constexpr std::size_t MIN_PARALLEL_SIZE = 1 << 14;
+
+
+    template <typename SetType>
+    using ElementOf = typename SetTraits<SetType>::ElementType;
+
+
+    // elementsOf() returns a set's elements in a std::vector, in ascending
+    // order if the set is ordered.
+    template <typename SetType>
+    std::vector<ElementOf<SetType>> elementsOf(const SetType& s)
+    {
+        std::vector<ElementOf<SetType>> elements;
+        elements.reserve(s.size());
+
+        SetTraits<SetType>::forEach(s,
+            [&](const ElementOf<SetType>& element)
+            {
+                elements.push_back(element);
+            });
+
+        return elements;
+    }
+
+
+    // gallop() returns the first position in the sorted range [first, last)
+    // whose element isn't less than the given key.  It compares against
+    // first, first + 1, first + 2, first + 4, and so on, until it passes
+    // the key, then binary searches the last step, so it takes O(log d)
+    // comparisons when the answer is d positions ahead.
+    template <typename T>
+    const T* gallop(const T* first, const T* last, const T& key)
+    {
+        if (first == last || !(*first < key))
+        {
+            return first;
+        }
+
+        std::size_t length = static_cast<std::size_t>(last - first);
+        std::size_t bound = 1;
+
+        while (bound < length && first[bound] < key)
+        {
+            bound *= 2;
+        }
+
+        return std::lower_bound(first + bound / 2 + 1, first + std::min(bound + 1, length), key);
+    }
+
+
+    // intersectSorted(), uniteSorted(), and subtractSorted() combine two
+    // sorted ranges, appending the result, in ascending order, to out.
+    // Each gallops when one range is much longer than the other, and
+    // merges otherwise.
+
+    template <typename T>
+    void intersectSorted(const T* a, const T* aEnd, const T* b, const T* bEnd, std::vector<T>& out)
+    {
+        if (aEnd - a > bEnd - b)
+        {
+            std::swap(a, b);
+            std::swap(aEnd, bEnd);
+        }
+
+        if (static_cast<std::size_t>(bEnd - b) < static_cast<std::size_t>(aEnd - a) * GALLOP_RATIO)
+        {
+            std::set_intersection(a, aEnd, b, bEnd, std::back_inserter(out));
+            return;
+        }
+
+        for (; a != aEnd; ++a)
+        {
+            b = gallop(b, bEnd, *a);
+
+            if (b == bEnd)
+            {
+                return;
+            }
+
+            if (!(*a < *b))
+            {
+                out.push_back(*a);
+                ++b;
+            }
+        }
+    }
+
+
+    template <typename T>
+    void uniteSorted(const T* a, const T* aEnd, const T* b, const T* bEnd, std::vector<T>& out)
+    {
+        if (aEnd - a > bEnd - b)
+        {
+            std::swap(a, b);
+            std::swap(aEnd, bEnd);
+        }
+
+        if (static_cast<std::size_t>(bEnd - b) < static_cast<std::size_t>(aEnd - a) * GALLOP_RATIO)
+        {
+            std::set_union(a, aEnd, b, bEnd, std::back_inserter(out));
+            return;
+        }
+
+        // Each element of the shorter range a is placed after the run of
+        // the longer range b that precedes it, which is copied wholesale.
+        for (; a != aEnd; ++a)
+        {
+            const T* next = gallop(b, bEnd, *a);
+            out.insert(out.end(), b, next);
+            b = next;
+
+            if (b != bEnd && !(*a < *b))
+            {
+                ++b;
+            }
+
+            out.push_back(*a);
+        }
+
+        out.insert(out.end(), b, bEnd);
+    }
+
+
+    template <typename T>
+    void subtractSorted(const T* a, const T* aEnd, const T* b, const T* bEnd, std::vector<T>& out)
+    {
+        std::size_t aLength = static_cast<std::size_t>(aEnd - a);
+        std::size_t bLength = static_cast<std::size_t>(bEnd - b);
+
+        if (bLength >= aLength * GALLOP_RATIO)
+        {
+            // Each element of a is searched for in the much longer b.
+            for (; a != aEnd; ++a)
+            {
+                b = gallop(b, bEnd, *a);
+
+                if (b == bEnd || *a < *b)
+                {
+                    out.push_back(*a);
+                }
+            }
+        }
+        else if (aLength >= bLength * GALLOP_RATIO)
+        {
+            // The runs of the much longer a between the elements of b are
+            // copied wholesale.
+            for (; b != bEnd; ++b)
+            {
+                const T* next = gallop(a, aEnd, *b);
+                out.insert(out.end(), a, next);
+                a = next;
+
+                if (a != aEnd && !(*b < *a))
+                {
+                    ++a;
+                }
+            }
+
+            out.insert(out.end(), a, aEnd);
+        }
+        else
+        {
+            std::set_difference(a, aEnd, b, bEnd, std::back_inserter(out));
+        }
+    }
+
+
+    // threadsFor() returns the number of threads to use, given the number
+    // requested and the total number of elements involved.
+    inline unsigned int threadsFor(unsigned int threads, std::size_t elements) noexcept
+    {
+        if (threads <= 1 || elements < MIN_PARALLEL_SIZE)
+        {
+            return 1;
+        }
+
+        return static_cast<unsigned int>(std::min<std::size_t>(threads, elements / (MIN_PARALLEL_SIZE / 4)));
+    }
+
+
+    // concatenate() joins the threads' pieces of a result, in order.
+    template <typename T>
+    std::vector<T> concatenate(std::vector<std::vector<T>>& pieces)
+    {
+        if (pieces.size() == 1)
+        {
+            return std::move(pieces[0]);
+        }
+
+        std::size_t total = 0;
+
+        for (const std::vector<T>& piece : pieces)
+        {
+            total += piece.size();
+        }
+
+        std::vector<T> result;
+        result.reserve(total);
+
+        for (std::vector<T>& piece : pieces)
+        {
+            result.insert(result.end(), std::make_move_iterator(piece.begin()), std::make_move_iterator(piece.end()));
+        }
+
+        return result;
+    }
+
+
+    // combineSorted() combines two sorted vectors with the given function
+    // (one of intersectSorted(), uniteSorted(), or subtractSorted()).  On
+    // more than one thread, both vectors are split at the same keys, taken
+    // at evenly spaced positions in the longer one, and each thread
+    // combines one pair of pieces.
+    template <typename T, typename Combine>
+    std::vector<T> combineSorted(const std::vector<T>& a, const std::vector<T>& b, unsigned int threads, Combine combine)
+    {
+        threads = threadsFor(threads, a.size() + b.size());
+
+        const std::vector<T>& longer = a.size() >= b.size() ? a : b;
+        std::vector<std::size_t> aSplits(threads + 1, a.size());
+        std::vector<std::size_t> bSplits(threads + 1, b.size());
+        aSplits[0] = 0;
+        bSplits[0] = 0;
+
+        for (unsigned int t = 1; t < threads; ++t)
+        {
+            const T& key = longer[longer.size() * t / threads];
+            aSplits[t] = static_cast<std::size_t>(std::lower_bound(a.begin(), a.end(), key) - a.begin());
+            bSplits[t] = static_cast<std::size_t>(std::lower_bound(b.begin(), b.end(), key) - b.begin());
+        }
+
+        std::vector<std::vector<T>> pieces(threads);
+
+        runOnThreads(threads,
+            [&](unsigned int t)
+            {
+                combine(a.data() + aSplits[t], a.data() + aSplits[t + 1],
+                        b.data() + bSplits[t], b.data() + bSplits[t + 1], pieces[t]);
+            });
+
+        return concatenate(pieces);
+    }
+
+
+    // probe() returns those elements of a that are (if keep is true) or
+    // aren't (if keep is false) in b, in the order a visits them.  On one
+    // thread, a's elements are looked up as they're visited; on more, they
+    // are first copied into a std::vector, and each thread probes an equal
+    // share of them.
+    template <typename A, typename B>
+    std::vector<ElementOf<A>> probe(const A& a, const B& b, bool keep, unsigned int threads)
+    {
+        threads = threadsFor(threads, a.size());
+
+        if (threads == 1)
+        {
+            std::vector<ElementOf<A>> result;
+
+            SetTraits<A>::forEach(a,
+                [&](const ElementOf<A>& element)
+                {
+                    if (b.contains(element) == keep)
+                    {
+                        result.push_back(element);
+                    }
+                });
+
+            return result;
+        }
+
+        std::vector<ElementOf<A>> elements = elementsOf(a);
+        std::vector<std::vector<ElementOf<A>>> pieces(threads);
+
+        runOnThreads(threads,
+            [&](unsigned int t)
+            {
+                std::size_t first = elements.size() * t / threads;
+                std::size_t last = elements.size() * (t + 1) / threads;
+
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    if (b.contains(elements[i]) == keep)
+                    {
+                        pieces[t].push_back(elements[i]);
+                    }
+                }
+            });
+
+        return concatenate(pieces);
+    }
+
+
+    // shouldProbe() returns true if the elements of a set of type A with
+    // the given size should be looked up in a set of type B with the given
+    // size, rather than walking both.
+    template <typename A, typename B>
+    bool shouldProbe(std::size_t probed, std::size_t searched) noexcept
+    {
+        return !SetTraits<A>::ORDERED || !SetTraits<B>::ORDERED || searched >= probed * PROBE_RATIO;
+    }
+
+
+    template <typename A, typename B>
+    void checkElementTypes() noexcept
+    {
+        static_assert(std::is_same<ElementOf<A>, ElementOf<B>>::value,
+            "both sets must have the same type of elements");
+    }
+}
+
+
+
+// setIntersection() returns the elements that are in both a and b.
+template <typename A, typename B>
+std::vector<typename SetTraits<A>::ElementType> setIntersection(const A& a, const B& b, unsigned int threads = 1)
+{
+    using namespace SetAlgebraDetail;
+    checkElementTypes<A, B>();
+
+    if (b.size() < a.size())
+    {
+        return setIntersection(b, a, threads);
+    }
+    else if (shouldProbe<A, B>(a.size(), b.size()))
+    {
+        return probe(a, b, true, threads);
+    }
+    else
+    {
+        return combineSorted(elementsOf(a), elementsOf(b), threads, intersectSorted<ElementOf<A>>);
+    }
+}
+
+
+// setUnion() returns the elements that are in a, b, or both.
+template <typename A, typename B>
+std::vector<typename SetTraits<A>::ElementType> setUnion(const A& a, const B& b, unsigned int threads = 1)
+{
+    using namespace SetAlgebraDetail;
+    checkElementTypes<A, B>();
+
+    if (b.size() < a.size())
+    {
+        return setUnion(b, a, threads);
+    }
+    else if (SetTraits<A>::ORDERED && SetTraits<B>::ORDERED)
+    {
+        // Every element of both sets is part of the result, so both are
+        // walked either way; merging keeps the result in order.
+        return combineSorted(elementsOf(a), elementsOf(b), threads, uniteSorted<ElementOf<A>>);
+    }
+    else
+    {
+        std::vector<ElementOf<A>> result = elementsOf(b);
+        std::vector<ElementOf<A>> extra = probe(a, b, false, threads);
+        result.insert(result.end(), extra.begin(), extra.end());
+        return result;
+    }
+}
+
+
+// setDifference() returns the elements that are in a but not in b.
+template <typename A, typename B>
+std::vector<typename SetTraits<A>::ElementType> setDifference(const A& a, const B& b, unsigned int threads = 1)
+{
+    using namespace SetAlgebraDetail;
+    checkElementTypes<A, B>();
+
+    // Every element of a must be examined; the question is only whether
+    // it's cheaper to look each one up in b or to walk b alongside it.
+    if (shouldProbe<A, B>(a.size(), b.size()))
+    {
+        return probe(a, b, false, threads);
+    }
+    else
+    {
+        return combineSorted(elementsOf(a), elementsOf(b), threads, subtractSorted<ElementOf<A>>);
+    }
+}
+
+
+
+#endif // SETALGEBRA_HPP
@@ -28,6 +28,8 @@
 
 #include <memory>
 #include <random>
+#include <utility>
+#include <vector>
 #include "Set.hpp"
 
 
@@ -63,6 +65,10 @@ public:
     bool operator==(const SkipListKey& other) const;
     bool operator<(const SkipListKey& other) const;
 
+    // value() returns the key itself, which is only meaningful for a
+    // normal key.
+    const T& value() const noexcept;
+
 private:
     SkipListKind kind;
     T key;
@@ -84,6 +90,13 @@ bool SkipListKey<T>::operator==(const SkipListKey& other) const
 }
 
 
+template <typename T>
+const T& SkipListKey<T>::value() const noexcept
+{
+    return key;
+}
+
+
 template <typename T>
 bool SkipListKey<T>::operator<(const SkipListKey& other) const
 {
@@ -216,7 +229,8 @@ public:
     // nodesOnLevel() returns the number of nodes on the given level
     // of the skip list.  Level 0 is the bottom level; level 1 is the
     // one above level 0; and so on.  If the given level doesn't exist,
-    // this function returns 0.
+    // this function returns 0.  The -INF and +INF nodes at either end
+    // of every level are included in the count.
     unsigned int nodesOnLevel(unsigned int level) const noexcept;
 
 
@@ -227,8 +241,39 @@ public:
     bool isElementOnLevel(const T& element, unsigned int level) const;
 
 
+    // forEach() calls visit(element) on every element in the set, in
+    // ascending order, by walking level 0.
+    template <typename Visit>
+    void forEach(Visit visit) const;
+
+
+private:
+    // Each node points to the node after it on the same level and to the
+    // node with the same key on the level below (or nullptr on level 0).
+    struct Node
+    {
+        SkipListKey<T> key;
+        Node* next;
+        Node* down;
+    };
+
+    // addLevel() adds a new, empty level (just -INF and +INF) on top.
+    void addLevel();
+
+    // findPredecessor() returns the last node on the given level whose
+    // key is less than the given one.
+    const Node* findPredecessor(const SkipListKey<T>& key, unsigned int level) const;
+
+    void copyFrom(const SkipListSet& s);
+    void destroy() noexcept;
+
+
 private:
     std::unique_ptr<SkipListLevelTester> levelTester;
+
+    // heads[i] is the -INF node on level i.
+    std::vector<Node*> heads;
+    unsigned int count;
 };
 
 
@@ -241,32 +286,53 @@ SkipListSet<T>::SkipListSet()
 
 template <typename T>
 SkipListSet<T>::SkipListSet(std::unique_ptr<SkipListLevelTester> levelTester)
-    : levelTester{std::move(levelTester)}
+    : levelTester{std::move(levelTester)}, count{0}
 {
+    addLevel();
 }
 
 
 template <typename T>
 SkipListSet<T>::~SkipListSet() noexcept
 {
+    destroy();
 }
 
 
 template <typename T>
 SkipListSet<T>::SkipListSet(const SkipListSet& s)
+    : levelTester{s.levelTester != nullptr ? s.levelTester->clone() : nullptr}, count{0}
 {
+    try
+    {
+        copyFrom(s);
+    }
+    catch (...)
+    {
+        destroy();
+        throw;
+    }
 }
 
 
 template <typename T>
 SkipListSet<T>::SkipListSet(SkipListSet&& s) noexcept
+    : levelTester{std::move(s.levelTester)}, heads{std::move(s.heads)}, count{s.count}
 {
+    s.heads.clear();
+    s.count = 0;
 }
 
 
 template <typename T>
 SkipListSet<T>& SkipListSet<T>::operator=(const SkipListSet& s)
 {
+    if (this != &s)
+    {
+        SkipListSet copy{s};
+        *this = std::move(copy);
+    }
+
     return *this;
 }
 
@@ -274,6 +340,9 @@ SkipListSet<T>& SkipListSet<T>::operator=(const SkipListSet& s)
 template <typename T>
 SkipListSet<T>& SkipListSet<T>::operator=(SkipListSet&& s) noexcept
 {
+    std::swap(levelTester, s.levelTester);
+    std::swap(heads, s.heads);
+    std::swap(count, s.count);
     return *this;
 }
 
@@ -281,48 +350,232 @@ SkipListSet<T>& SkipListSet<T>::operator=(SkipListSet&& s) noexcept
 template <typename T>
 bool SkipListSet<T>::isImplemented() const noexcept
 {
-    return false;
+    return true;
 }
 
 
 template <typename T>
 void SkipListSet<T>::add(const T& element)
 {
+    if (contains(element))
+    {
+        return;
+    }
+
+    // The coin flips decide how many levels the new key occupies; the
+    // skip list grows as many new levels as it needs to hold it.
+    // (A SkipListSet that has been moved from has no level tester, so its
+    // keys occupy only level 0.)
+    unsigned int topLevel = 0;
+
+    while (levelTester != nullptr && levelTester->shouldOccupyNextLevel())
+    {
+        ++topLevel;
+    }
+
+    while (heads.size() <= topLevel)
+    {
+        addLevel();
+    }
+
+    SkipListKey<T> key{SkipListKind::Normal, element};
+    Node* below = nullptr;
+
+    for (unsigned int level = 0; level <= topLevel; ++level)
+    {
+        Node* predecessor = const_cast<Node*>(findPredecessor(key, level));
+        Node* node = new Node{key, predecessor->next, below};
+        predecessor->next = node;
+        below = node;
+    }
+
+    ++count;
 }
 
 
 template <typename T>
 bool SkipListSet<T>::contains(const T& element) const
 {
-    return false;
+    if (heads.empty())
+    {
+        return false;
+    }
+
+    SkipListKey<T> key{SkipListKind::Normal, element};
+    const Node* node = findPredecessor(key, 0)->next;
+
+    return node->key == key;
 }
 
 
 template <typename T>
 unsigned int SkipListSet<T>::size() const noexcept
 {
-    return 0;
+    return count;
 }
 
 
 template <typename T>
 unsigned int SkipListSet<T>::levelCount() const noexcept
 {
-    return 0;
+    return static_cast<unsigned int>(heads.size());
 }
 
 
 template <typename T>
 unsigned int SkipListSet<T>::nodesOnLevel(unsigned int level) const noexcept
 {
-    return 0;
+    if (level >= heads.size())
+    {
+        return 0;
+    }
+
+    unsigned int nodes = 0;
+
+    for (const Node* node = heads[level]; node != nullptr; node = node->next)
+    {
+        ++nodes;
+    }
+
+    return nodes;
 }
 
 
 template <typename T>
 bool SkipListSet<T>::isElementOnLevel(const T& element, unsigned int level) const
 {
-    return false;
+    if (level >= heads.size())
+    {
+        return false;
+    }
+
+    SkipListKey<T> key{SkipListKind::Normal, element};
+    return findPredecessor(key, level)->next->key == key;
+}
+
+
+template <typename T>
+template <typename Visit>
+void SkipListSet<T>::forEach(Visit visit) const
+{
+    if (heads.empty())
+    {
+        return;
+    }
+
+    for (const Node* node = heads[0]->next; node->next != nullptr; node = node->next)
+    {
+        visit(node->key.value());
+    }
+}
+
+
+template <typename T>
+void SkipListSet<T>::addLevel()
+{
+    Node* tail = new Node{SkipListKey<T>{SkipListKind::PosInf, T{}}, nullptr, nullptr};
+    Node* head;
+
+    try
+    {
+        head = new Node{SkipListKey<T>{SkipListKind::NegInf, T{}}, tail, nullptr};
+        heads.push_back(head);
+    }
+    catch (...)
+    {
+        delete tail;
+        throw;
+    }
+
+    if (heads.size() > 1)
+    {
+        Node* belowHead = heads[heads.size() - 2];
+        Node* belowTail = belowHead;
+
+        while (belowTail->next != nullptr)
+        {
+            belowTail = belowTail->next;
+        }
+
+        head->down = belowHead;
+        tail->down = belowTail;
+    }
+}
+
+
+template <typename T>
+const typename SkipListSet<T>::Node* SkipListSet<T>::findPredecessor(const SkipListKey<T>& key, unsigned int level) const
+{
+    // Start at the top and move right as far as possible on each level
+    // before moving down, until the requested level is reached.
+    const Node* node = heads.back();
+
+    for (unsigned int current = static_cast<unsigned int>(heads.size()) - 1; ; --current)
+    {
+        while (node->next->key < key)
+        {
+            node = node->next;
+        }
+
+        if (current == level)
+        {
+            return node;
+        }
+
+        node = node->down;
+    }
+}
+
+
+template <typename T>
+void SkipListSet<T>::copyFrom(const SkipListSet& s)
+{
+    // Each level is rebuilt in order.  Every key on a level is also on the
+    // level below it, in the same order, so walking the level below
+    // alongside finds each new node's "down" node.
+    for (unsigned int level = 0; level < s.heads.size(); ++level)
+    {
+        addLevel();
+
+        Node* last = heads[level];
+        Node* below = level > 0 ? heads[level - 1]->next : nullptr;
+
+        for (const Node* node = s.heads[level]->next; node->next != nullptr; node = node->next)
+        {
+            if (below != nullptr)
+            {
+                while (!(below->key == node->key))
+                {
+                    below = below->next;
+                }
+            }
+
+            last->next = new Node{node->key, last->next, below};
+            last = last->next;
+        }
+    }
+
+    count = s.count;
+}
+
+
+template <typename T>
+void SkipListSet<T>::destroy() noexcept
+{
+    for (Node* head : heads)
+    {
+        Node* node = head;
+
+        while (node != nullptr)
+        {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    heads.clear();
+    count = 0;
 }
 
 
@@ -0,0 +1,528 @@
+// SmallHashSet.hpp
+//
+// A SmallHashSet is an implementation of a Set meant for the very common
+// case of a set that almost always holds only a handful of elements.  Up to
+// N elements are stored inside the SmallHashSet object itself, in an
+// unordered array that's searched linearly, so that a small set allocates
+// no memory at all and a lookup doesn't even hash the element.  When an
+// element is added to a set that already holds N elements, the elements are
+// moved into a HashSet allocated on the heap, and from then on every
+// operation is passed along to it.
+//
+// When T is a 4- or 8-byte integer compared with std::equal_to, the inline
+// array is searched with SSE2, comparing several elements per instruction;
+// otherwise, and on processors without SSE2, it's searched one element at
+// a time.
+//
+// Once a SmallHashSet has moved its elements into a HashSet, it keeps using
+// the HashSet even if elements are removed, so that a set whose size hovers
+// around N doesn't move its elements back and forth; clear() frees the
+// HashSet and returns to the inline array.
+
+#ifndef SMALLHASHSET_HPP
+#define SMALLHASHSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+#include "Set.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+template <typename T,
+          unsigned int N = 8,
+          typename Hash = DefaultHash<T>,
+          typename KeyEqual = std::equal_to<T>>
+class SmallHashSet : public Set<T>
+{
+    static_assert(N >= 1, "a SmallHashSet must have room for at least one element inline");
+
+public:
+    // The number of elements that can be stored inline.
+    static constexpr unsigned int INLINE_CAPACITY = N;
+
+    typedef Hash HashFunction;
+
+    // The HashSet that the elements are moved into once there are more
+    // than N of them.
+    typedef HashSet<T, Hash, KeyEqual> LargeSet;
+
+
+public:
+    // Initializes a SmallHashSet to be empty, so that it will use the given
+    // hash function once it outgrows its inline array.  If none is given,
+    // DefaultHash<T> (see Hashing.hpp) is used.
+    SmallHashSet(HashFunction hashFunction = DefaultHash<T>{}, KeyEqual keyEqual = KeyEqual{});
+
+    // Cleans up the SmallHashSet so that it leaks no memory.
+    virtual ~SmallHashSet() noexcept;
+
+    // Initializes a new SmallHashSet to be a copy of an existing one.
+    SmallHashSet(const SmallHashSet& s);
+
+    // Initializes a new SmallHashSet whose contents are moved from an
+    // expiring one, which is left empty.
+    SmallHashSet(SmallHashSet&& s) noexcept;
+
+    // Assigns an existing SmallHashSet into another.
+    SmallHashSet& operator=(const SmallHashSet& s);
+
+    // Assigns an expiring SmallHashSet into another.
+    SmallHashSet& operator=(SmallHashSet&& s) noexcept;
+
+
+    virtual bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  Adding an element to a set that
+    // already holds N elements inline moves all of them into a HashSet.
+    virtual void add(const T& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  While the elements are inline, this takes at most
+    // N comparisons and never calls the hash function.
+    virtual bool contains(const T& element) const override;
+
+
+    // remove() removes an element from the set, returning true if it was
+    // there and false otherwise.  (The last inline element takes the
+    // removed one's place, so the inline array stays dense.)
+    bool remove(const T& element);
+
+
+    // clear() removes every element from the set, freeing the HashSet if
+    // there is one, so the set goes back to storing elements inline.
+    void clear() noexcept;
+
+
+    // size() returns the number of elements in the set.
+    virtual unsigned int size() const noexcept override;
+
+
+    // isInline() returns true if the elements are stored in the inline
+    // array, or false if they've been moved into a HashSet.
+    bool isInline() const noexcept;
+
+
+private:
+    // The inline array can be searched with vector instructions when the
+    // elements are integers that are compared bit for bit.
+    static constexpr bool VECTOR_SEARCH =
+        std::is_integral<T>::value && (sizeof(T) == 4 || sizeof(T) == 8) &&
+        (std::is_same<KeyEqual, std::equal_to<T>>::value || std::is_same<KeyEqual, std::equal_to<>>::value);
+
+    // When it's searched with vector instructions, the inline array is
+    // padded out to a whole number of 16-byte vectors, so the last one can
+    // be loaded in full.  (The padding, and any slot not in use, holds
+    // zeroes or a stale element; either way, it's masked off.)
+    static constexpr std::size_t STORAGE_BYTES =
+        VECTOR_SEARCH ? (N * sizeof(T) + 15) / 16 * 16 : N * sizeof(T);
+
+    T* slot(unsigned int index) noexcept;
+    const T* slot(unsigned int index) const noexcept;
+
+    // indexOf() returns the position of the given element in the inline
+    // array, or count if it isn't there.
+    unsigned int indexOf(const T& element) const;
+
+    // vectorIndexOf() is indexOf() for elements that can be compared with
+    // vector instructions.
+    unsigned int vectorIndexOf(const T& element) const noexcept;
+
+    // moveToLargeSet() moves the inline elements into a newly-allocated
+    // HashSet.
+    void moveToLargeSet();
+
+    // copyFrom() copies another set's elements into this one, which must
+    // be empty and inline.
+    void copyFrom(const SmallHashSet& s);
+
+    // moveFrom() moves another set's elements into this one, which must be
+    // empty and inline, leaving the other set empty and inline.
+    void moveFrom(SmallHashSet& s) noexcept;
+
+    void destroy() noexcept;
+
+
+private:
+    union
+    {
+        alignas(T) unsigned char storage[STORAGE_BYTES];
+        LargeSet* large;
+    };
+
+    // The number of elements in the inline array, which is only meaningful
+    // while the elements are inline.
+    unsigned int count;
+    bool isLarge;
+
+    HashFunction hashFunction;
+    KeyEqual keyEqual;
+};
+
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+SmallHashSet<T, N, Hash, KeyEqual>::SmallHashSet(HashFunction hashFunction, KeyEqual keyEqual)
+    : count{0}, isLarge{false}, hashFunction{hashFunction}, keyEqual{keyEqual}
+{
+    if (VECTOR_SEARCH)
+    {
+        std::memset(storage, 0, STORAGE_BYTES);
+    }
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+SmallHashSet<T, N, Hash, KeyEqual>::~SmallHashSet() noexcept
+{
+    destroy();
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+SmallHashSet<T, N, Hash, KeyEqual>::SmallHashSet(const SmallHashSet& s)
+    : SmallHashSet{s.hashFunction, s.keyEqual}
+{
+    copyFrom(s);
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+SmallHashSet<T, N, Hash, KeyEqual>::SmallHashSet(SmallHashSet&& s) noexcept
+    : SmallHashSet{s.hashFunction, s.keyEqual}
+{
+    moveFrom(s);
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+SmallHashSet<T, N, Hash, KeyEqual>& SmallHashSet<T, N, Hash, KeyEqual>::operator=(const SmallHashSet& s)
+{
+    if (this != &s)
+    {
+        SmallHashSet copy{s};
+        clear();
+        hashFunction = copy.hashFunction;
+        keyEqual = copy.keyEqual;
+        moveFrom(copy);
+    }
+
+    return *this;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+SmallHashSet<T, N, Hash, KeyEqual>& SmallHashSet<T, N, Hash, KeyEqual>::operator=(SmallHashSet&& s) noexcept
+{
+    if (this != &s)
+    {
+        clear();
+        hashFunction = std::move(s.hashFunction);
+        keyEqual = std::move(s.keyEqual);
+        moveFrom(s);
+    }
+
+    return *this;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+bool SmallHashSet<T, N, Hash, KeyEqual>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+void SmallHashSet<T, N, Hash, KeyEqual>::add(const T& element)
+{
+    if (isLarge)
+    {
+        large->add(element);
+    }
+    else if (indexOf(element) == count)
+    {
+        if (count < N)
+        {
+            new (slot(count)) T(element);
+            ++count;
+        }
+        else
+        {
+            moveToLargeSet();
+            large->add(element);
+        }
+    }
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+bool SmallHashSet<T, N, Hash, KeyEqual>::contains(const T& element) const
+{
+    if (isLarge)
+    {
+        return large->contains(element);
+    }
+    else
+    {
+        return indexOf(element) != count;
+    }
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+bool SmallHashSet<T, N, Hash, KeyEqual>::remove(const T& element)
+{
+    if (isLarge)
+    {
+        return large->remove(element);
+    }
+
+    unsigned int index = indexOf(element);
+
+    if (index == count)
+    {
+        return false;
+    }
+
+    --count;
+
+    if (index != count)
+    {
+        *slot(index) = std::move(*slot(count));
+    }
+
+    slot(count)->~T();
+    return true;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+void SmallHashSet<T, N, Hash, KeyEqual>::clear() noexcept
+{
+    destroy();
+
+    count = 0;
+    isLarge = false;
+
+    if (VECTOR_SEARCH)
+    {
+        std::memset(storage, 0, STORAGE_BYTES);
+    }
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+unsigned int SmallHashSet<T, N, Hash, KeyEqual>::size() const noexcept
+{
+    return isLarge ? large->size() : count;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+bool SmallHashSet<T, N, Hash, KeyEqual>::isInline() const noexcept
+{
+    return !isLarge;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+T* SmallHashSet<T, N, Hash, KeyEqual>::slot(unsigned int index) noexcept
+{
+    return std::launder(reinterpret_cast<T*>(storage) + index);
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+const T* SmallHashSet<T, N, Hash, KeyEqual>::slot(unsigned int index) const noexcept
+{
+    return std::launder(reinterpret_cast<const T*>(storage) + index);
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+unsigned int SmallHashSet<T, N, Hash, KeyEqual>::indexOf(const T& element) const
+{
+    if constexpr (VECTOR_SEARCH)
+    {
+        return vectorIndexOf(element);
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (keyEqual(*slot(i), element))
+        {
+            return i;
+        }
+    }
+
+    return count;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+unsigned int SmallHashSet<T, N, Hash, KeyEqual>::vectorIndexOf(const T& element) const noexcept
+{
+#if defined(__SSE2__)
+    __m128i needle = sizeof(T) == 4
+        ? _mm_set1_epi32(static_cast<int>(element))
+        : _mm_set1_epi64x(static_cast<long long>(element));
+
+    for (unsigned int i = 0; i < count; i += 16 / sizeof(T))
+    {
+        __m128i elements = _mm_loadu_si128(reinterpret_cast<const __m128i*>(storage + i * sizeof(T)));
+        __m128i equal = _mm_cmpeq_epi32(elements, needle);
+
+        if (sizeof(T) == 8)
+        {
+            // Two 8-byte elements are equal only if both their halves are.
+            equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(equal));
+        unsigned int validBytes = (count - i) * sizeof(T);
+
+        if (validBytes < 16)
+        {
+            mask &= (1u << validBytes) - 1;
+        }
+
+        if (mask != 0)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            unsigned int lowestByte = static_cast<unsigned int>(__builtin_ctz(mask));
+#else
+            unsigned int lowestByte = 0;
+
+            while ((mask & (1u << lowestByte)) == 0)
+            {
+                ++lowestByte;
+            }
+#endif
+            return i + lowestByte / sizeof(T);
+        }
+    }
+
+    return count;
+#else
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (*slot(i) == element)
+        {
+            return i;
+        }
+    }
+
+    return count;
+#endif
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+void SmallHashSet<T, N, Hash, KeyEqual>::moveToLargeSet()
+{
+    LargeSet* set = new LargeSet{hashFunction, keyEqual};
+
+    try
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            set->add(*slot(i));
+        }
+    }
+    catch (...)
+    {
+        delete set;
+        throw;
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        slot(i)->~T();
+    }
+
+    count = 0;
+    large = set;
+    isLarge = true;
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+void SmallHashSet<T, N, Hash, KeyEqual>::copyFrom(const SmallHashSet& s)
+{
+    if (s.isLarge)
+    {
+        large = new LargeSet{*s.large};
+        isLarge = true;
+    }
+    else
+    {
+        for (unsigned int i = 0; i < s.count; ++i)
+        {
+            new (slot(i)) T(*s.slot(i));
+            ++count;
+        }
+    }
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+void SmallHashSet<T, N, Hash, KeyEqual>::moveFrom(SmallHashSet& s) noexcept
+{
+    if (s.isLarge)
+    {
+        large = s.large;
+        isLarge = true;
+        s.isLarge = false;
+
+        if (VECTOR_SEARCH)
+        {
+            std::memset(s.storage, 0, STORAGE_BYTES);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < s.count; ++i)
+        {
+            new (slot(i)) T(std::move(*s.slot(i)));
+            s.slot(i)->~T();
+        }
+
+        count = s.count;
+        s.count = 0;
+    }
+}
+
+
+template <typename T, unsigned int N, typename Hash, typename KeyEqual>
+void SmallHashSet<T, N, Hash, KeyEqual>::destroy() noexcept
+{
+    if (isLarge)
+    {
+        delete large;
+    }
+    else
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            slot(i)->~T();
+        }
+    }
+}
+
+
+
+#endif // SMALLHASHSET_HPP
@@ -0,0 +1,226 @@
+// Snapshot.hpp
+//
+// Support for saving data structures to files ("snapshots") and loading
+// them back.  A MappedFile makes a whole file readable in memory: on POSIX
+// systems, by mapping it with mmap(), so that loading costs nothing up
+// front and pages are read from disk (or the page cache) only as they're
+// touched; elsewhere, by reading it into memory.  writeFileAtomically()
+// writes a file under a temporary name and then renames it into place, so
+// that a crash partway through never leaves a truncated snapshot behind.
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_USE_MMAP 1
+#endif
+
+
+
+// SnapshotExceptions are thrown when a snapshot can't be written or read,
+// or when a file isn't a valid snapshot of the expected kind.
+
+class SnapshotException
+{
+public:
+    SnapshotException(const std::string& reason);
+
+    std::string reason() const;
+
+private:
+    std::string reason_;
+};
+
+
+inline SnapshotException::SnapshotException(const std::string& reason)
+    : reason_{reason}
+{
+}
+
+
+inline std::string SnapshotException::reason() const
+{
+    return reason_;
+}
+
+
+
+class MappedFile
+{
+public:
+    // Makes the contents of the file at the given path readable in memory.
+    // It throws a SnapshotException if the file can't be opened or read.
+    explicit MappedFile(const std::string& path);
+
+    // Unmaps (or frees) the file's contents.
+    ~MappedFile() noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+
+    // data() returns the address of the file's first byte, which is
+    // aligned at least as strictly as any fundamental type.
+    const unsigned char* data() const noexcept;
+
+
+    // size() returns the size of the file in bytes.
+    std::size_t size() const noexcept;
+
+
+private:
+    const unsigned char* bytes;
+    std::size_t length;
+
+#if !defined(SNAPSHOT_USE_MMAP)
+    std::vector<unsigned char> contents;
+#endif
+};
+
+
+
+inline MappedFile::MappedFile(const std::string& path)
+    : bytes{nullptr}, length{0}
+{
+#if defined(SNAPSHOT_USE_MMAP)
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        throw SnapshotException{"can't open " + path};
+    }
+
+    struct stat status;
+
+    if (::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw SnapshotException{"can't read " + path};
+    }
+
+    length = static_cast<std::size_t>(status.st_size);
+
+    if (length > 0)
+    {
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (address == MAP_FAILED)
+        {
+            ::close(fd);
+            throw SnapshotException{"can't map " + path};
+        }
+
+        bytes = static_cast<const unsigned char*>(address);
+    }
+
+    // The mapping stays valid after the file is closed.
+    ::close(fd);
+#else
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+
+    if (file == nullptr)
+    {
+        throw SnapshotException{"can't open " + path};
+    }
+
+    unsigned char buffer[65536];
+    std::size_t read;
+
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        contents.insert(contents.end(), buffer, buffer + read);
+    }
+
+    bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+
+    if (failed)
+    {
+        throw SnapshotException{"can't read " + path};
+    }
+
+    bytes = contents.data();
+    length = contents.size();
+#endif
+}
+
+
+inline MappedFile::~MappedFile() noexcept
+{
+#if defined(SNAPSHOT_USE_MMAP)
+    if (bytes != nullptr)
+    {
+        ::munmap(const_cast<unsigned char*>(bytes), length);
+    }
+#endif
+}
+
+
+inline const unsigned char* MappedFile::data() const noexcept
+{
+    return bytes;
+}
+
+
+inline std::size_t MappedFile::size() const noexcept
+{
+    return length;
+}
+
+
+
+// writeFileAtomically() replaces the file at the given path with the given
+// pieces of data, written one after another.  It writes them to a file
+// named path + ".tmp" and then renames that file over the original.  It
+// throws a SnapshotException if anything goes wrong, in which case the
+// original file is left untouched.
+
+struct FilePiece
+{
+    const void* data;
+    std::size_t size;
+};
+
+
+inline void writeFileAtomically(const std::string& path, const std::vector<FilePiece>& pieces)
+{
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        throw SnapshotException{"can't create " + temporaryPath};
+    }
+
+    bool failed = false;
+
+    for (const FilePiece& piece : pieces)
+    {
+        if (piece.size > 0 && std::fwrite(piece.data, 1, piece.size, file) != piece.size)
+        {
+            failed = true;
+            break;
+        }
+    }
+
+    failed = std::fclose(file) != 0 || failed;
+
+    if (failed || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        throw SnapshotException{"can't write " + path};
+    }
+}
+
+
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,590 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <vector>
+#include "AVLSet.hpp"
+
+namespace
+{
+    // checkStructure() checks everything about a set that can be seen from
+    // outside: that iterating forward and backward, select(), and rank()
+    // all agree with the given elements, and that the height is within
+    // the AVL bound of about 1.44 log2 n.
+    void checkStructure(const AVLSet<int>& s, const std::vector<int>& expected)
+    {
+        ASSERT_EQ(expected.size(), s.size());
+        EXPECT_EQ(expected, (std::vector<int>{s.begin(), s.end()}));
+
+        std::vector<int> backward;
+
+        for (AVLSet<int>::Iterator i = s.end(); i != s.begin(); )
+        {
+            backward.push_back(*--i);
+        }
+
+        EXPECT_EQ((std::vector<int>{expected.rbegin(), expected.rend()}), backward);
+
+        for (unsigned int i = 0; i < expected.size(); i += 7)
+        {
+            EXPECT_EQ(expected[i], s.select(i));
+            EXPECT_EQ(i, s.rank(expected[i]));
+        }
+
+        EXPECT_LE(s.height(), 1.4405 * std::log2(expected.size() + 2.0) - 0.3277);
+    }
+}
+
+
+TEST(AVLSet_Test, sizeIsZeroAndHeightIsNegativeOneWhenDefaultConstructed)
+{
+    AVLSet<int> s;
+
+    EXPECT_TRUE(s.isImplemented());
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(-1, s.height());
+    EXPECT_FALSE(s.contains(0));
+}
+
+TEST(AVLSet_Test, addedElementsAreContained)
+{
+    AVLSet<int> s;
+
+    for (int i = 0; i < 100; i += 2)
+    {
+        s.add(i);
+    }
+
+    s.add(10);
+    EXPECT_EQ(50, s.size());
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i % 2 == 0, s.contains(i));
+    }
+}
+
+TEST(AVLSet_Test, ascendingInsertionsStayBalanced)
+{
+    AVLSet<int> s;
+
+    for (int i = 1; i <= 7; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(2, s.height());
+
+    std::vector<int> preorder;
+    s.preorder([&preorder](const int& element) { preorder.push_back(element); });
+    EXPECT_EQ((std::vector<int>{4, 2, 1, 3, 6, 5, 7}), preorder);
+
+    for (int i = 8; i <= 1023; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(9, s.height());
+}
+
+TEST(AVLSet_Test, doubleRotationsProduceExpectedShape)
+{
+    AVLSet<int> lr;
+    lr.add(30);
+    lr.add(10);
+    lr.add(20);
+
+    AVLSet<int> rl;
+    rl.add(10);
+    rl.add(30);
+    rl.add(20);
+
+    std::vector<int> lrPreorder;
+    std::vector<int> rlPreorder;
+    lr.preorder([&lrPreorder](const int& element) { lrPreorder.push_back(element); });
+    rl.preorder([&rlPreorder](const int& element) { rlPreorder.push_back(element); });
+
+    EXPECT_EQ((std::vector<int>{20, 10, 30}), lrPreorder);
+    EXPECT_EQ((std::vector<int>{20, 10, 30}), rlPreorder);
+}
+
+TEST(AVLSet_Test, traversalsVisitInTheirOrders)
+{
+    AVLSet<int> s;
+
+    for (int element : {50, 30, 70, 20, 40, 60, 80})
+    {
+        s.add(element);
+    }
+
+    std::vector<int> inorder;
+    std::vector<int> postorder;
+    s.inorder([&inorder](const int& element) { inorder.push_back(element); });
+    s.postorder([&postorder](const int& element) { postorder.push_back(element); });
+
+    EXPECT_EQ((std::vector<int>{20, 30, 40, 50, 60, 70, 80}), inorder);
+    EXPECT_EQ((std::vector<int>{20, 40, 30, 60, 80, 70, 50}), postorder);
+}
+
+TEST(AVLSet_Test, canBeCopiedAndMoved)
+{
+    AVLSet<int> s1;
+
+    for (int i = 0; i < 20; ++i)
+    {
+        s1.add(i);
+    }
+
+    AVLSet<int> s2 = s1;
+    s2.add(100);
+
+    EXPECT_EQ(20, s1.size());
+    EXPECT_FALSE(s1.contains(100));
+    EXPECT_EQ(21, s2.size());
+    EXPECT_EQ(s1.height(), AVLSet<int>{s1}.height());
+
+    AVLSet<int> s3 = std::move(s2);
+    EXPECT_EQ(0, s2.size());
+    EXPECT_TRUE(s3.contains(100));
+
+    s1 = s3;
+    EXPECT_EQ(21, s1.size());
+
+    AVLSet<int> s4;
+    s4.add(-1);
+    s4 = std::move(s1);
+    EXPECT_TRUE(s4.contains(100));
+    EXPECT_FALSE(s4.contains(-1));
+}
+
+TEST(AVLSet_Test, rankAndSelectFollowSortedOrder)
+{
+    AVLSet<int> s;
+    std::vector<int> sorted;
+
+    // Scrambled insertions exercise every kind of rotation.
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add((i * 7919) % 1000 * 3);
+    }
+
+    s.inorder([&sorted](const int& element) { sorted.push_back(element); });
+    ASSERT_EQ(1000, sorted.size());
+
+    for (unsigned int i = 0; i < sorted.size(); ++i)
+    {
+        EXPECT_EQ(sorted[i], s.select(i));
+        EXPECT_EQ(i, s.rank(sorted[i]));
+        EXPECT_EQ(i + 1, s.rank(sorted[i] + 1));
+    }
+
+    EXPECT_EQ(0, s.rank(-1));
+    EXPECT_EQ(1000, s.rank(5000));
+
+    // Copies carry the subtree sizes with them.
+    AVLSet<int> copy{s};
+    EXPECT_EQ(sorted[500], copy.select(500));
+}
+
+TEST(AVLSet_Test, selectThrowsPastTheEnd)
+{
+    AVLSet<int> s;
+    EXPECT_THROW(s.select(0), AVLSetException);
+
+    s.add(1);
+    EXPECT_EQ(1, s.select(0));
+    EXPECT_THROW(s.select(1), AVLSetException);
+}
+
+TEST(AVLSet_Test, countInRangeIncludesBothEnds)
+{
+    AVLSet<int> s;
+
+    for (int i = 0; i < 100; i += 2)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(50, s.countInRange(0, 98));
+    EXPECT_EQ(50, s.countInRange(-10, 1000));
+    EXPECT_EQ(6, s.countInRange(10, 20));
+    EXPECT_EQ(5, s.countInRange(11, 20));
+    EXPECT_EQ(5, s.countInRange(10, 19));
+    EXPECT_EQ(1, s.countInRange(10, 10));
+    EXPECT_EQ(0, s.countInRange(11, 11));
+    EXPECT_EQ(0, s.countInRange(20, 10));
+    EXPECT_EQ(0, AVLSet<int>{}.countInRange(0, 10));
+}
+
+TEST(AVLSet_Test, iteratorsWalkInSortedOrderBothWays)
+{
+    AVLSet<int> s;
+    std::vector<int> expected;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        s.add((i * 7919) % 500);
+        expected.push_back(i);
+    }
+
+    std::vector<int> forward{s.begin(), s.end()};
+    EXPECT_EQ(expected, forward);
+
+    std::vector<int> backward;
+
+    for (AVLSet<int>::Iterator i = s.end(); i != s.begin(); )
+    {
+        backward.push_back(*--i);
+    }
+
+    EXPECT_EQ((std::vector<int>{expected.rbegin(), expected.rend()}), backward);
+
+    // Adding elements doesn't invalidate iterators, even when it rotates
+    // the nodes they refer to.
+    AVLSet<int>::Iterator i = s.lowerBound(250);
+
+    for (int j = 1000; j < 2000; ++j)
+    {
+        s.add(j);
+    }
+
+    EXPECT_EQ(250, *i);
+    EXPECT_EQ(251, *++i);
+    EXPECT_EQ(1500, std::distance(s.begin(), s.end()));
+}
+
+TEST(AVLSet_Test, iteratorsThrowPastEitherEnd)
+{
+    AVLSet<int> empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+    EXPECT_THROW(*empty.begin(), IteratorException);
+    EXPECT_THROW(--empty.end(), IteratorException);
+
+    AVLSet<int> s;
+    s.add(1);
+    s.add(2);
+
+    AVLSet<int>::Iterator i = s.begin();
+    EXPECT_THROW(--i, IteratorException);
+    EXPECT_EQ(1, *i);
+    ++i;
+    ++i;
+    EXPECT_TRUE(i == s.end());
+    EXPECT_THROW(++i, IteratorException);
+    EXPECT_EQ(2, *--i);
+}
+
+TEST(AVLSet_Test, boundsAndRangesFindTheElementsBetween)
+{
+    AVLSet<int> s;
+
+    for (int i = 0; i < 100; i += 2)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(10, *s.lowerBound(10));
+    EXPECT_EQ(12, *s.upperBound(10));
+    EXPECT_EQ(12, *s.lowerBound(11));
+    EXPECT_EQ(12, *s.upperBound(11));
+    EXPECT_EQ(0, *s.lowerBound(-5));
+    EXPECT_TRUE(s.lowerBound(99) == s.end());
+    EXPECT_TRUE(s.upperBound(98) == s.end());
+
+    std::vector<int> inRange;
+
+    for (int element : s.range(11, 20))
+    {
+        inRange.push_back(element);
+    }
+
+    EXPECT_EQ((std::vector<int>{12, 14, 16, 18, 20}), inRange);
+
+    AVLSet<int>::Range backwards = s.range(20, 10);
+    EXPECT_TRUE(backwards.begin() == backwards.end());
+
+    AVLSet<int>::Range between = s.range(13, 13);
+    EXPECT_TRUE(between.begin() == between.end());
+
+    // The count of a range matches countInRange().
+    for (int lo = -3; lo < 103; lo += 7)
+    {
+        AVLSet<int>::Range r = s.range(lo, lo + 17);
+        EXPECT_EQ(s.countInRange(lo, lo + 17), std::distance(r.begin(), r.end()));
+    }
+}
+
+TEST(AVLSet_Test, templatedTraversalsMatchTheStdFunctionOnes)
+{
+    AVLSet<int> s;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        s.add((i * 7919) % 300);
+    }
+
+    std::vector<int> expected;
+    std::vector<int> actual;
+    std::function<void(const int&)> collect = [&expected](const int& element) { expected.push_back(element); };
+    auto append = [&actual](const int& element) { actual.push_back(element); };
+
+    s.preorder(collect);
+    EXPECT_TRUE(s.preorder(append));
+    EXPECT_EQ(expected, actual);
+
+    expected.clear();
+    actual.clear();
+    s.inorder(collect);
+    EXPECT_TRUE(s.inorder(append));
+    EXPECT_EQ(expected, actual);
+
+    expected.clear();
+    actual.clear();
+    s.postorder(collect);
+    EXPECT_TRUE(s.postorder(append));
+    EXPECT_EQ(expected, actual);
+
+    EXPECT_TRUE(AVLSet<int>{}.inorder([](const int&) { return false; }));
+}
+
+TEST(AVLSet_Test, traversalsStopWhenTheVisitorReturnsFalse)
+{
+    AVLSet<int> s;
+
+    for (int i = 1; i <= 7; ++i)
+    {
+        s.add(i);
+    }
+
+    std::vector<int> visited;
+    auto untilFive = [&visited](const int& element)
+    {
+        visited.push_back(element);
+        return element != 5;
+    };
+
+    EXPECT_FALSE(s.inorder(untilFive));
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), visited);
+
+    visited.clear();
+    EXPECT_FALSE(s.preorder(untilFive));
+    EXPECT_EQ((std::vector<int>{4, 2, 1, 3, 6, 5}), visited);
+
+    visited.clear();
+    EXPECT_FALSE(s.postorder(untilFive));
+    EXPECT_EQ((std::vector<int>{1, 3, 2, 5}), visited);
+
+    // A visitor that never returns false sees every element.
+    AVLSet<int> large;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        large.add(i);
+    }
+
+    int count = 0;
+    EXPECT_TRUE(large.postorder([&count](const int&) { return ++count > 0; }));
+    EXPECT_EQ(100000, count);
+}
+
+TEST(AVLSet_Test, fromSortedBuildsAPerfectlyBalancedTree)
+{
+    std::vector<int> sorted;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        sorted.push_back(i / 2 * 3);
+    }
+
+    AVLSet<int> s = AVLSet<int>::fromSorted(sorted.begin(), sorted.end());
+
+    EXPECT_EQ(500, s.size());
+    EXPECT_EQ(8, s.height());
+    EXPECT_EQ(0, s.select(0));
+    EXPECT_EQ(1497, s.select(499));
+    EXPECT_EQ(100, s.rank(300));
+    EXPECT_TRUE(s.contains(300));
+    EXPECT_FALSE(s.contains(301));
+
+    // Elements added afterward are mixed in with the block's.
+    for (int i = 0; i < 500; ++i)
+    {
+        s.add(i * 3 + 1);
+    }
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_LE(s.height(), 11);
+
+    std::vector<int> inorder{s.begin(), s.end()};
+    EXPECT_TRUE(std::is_sorted(inorder.begin(), inorder.end()));
+
+    AVLSet<int> copy{s};
+    AVLSet<int> moved{std::move(s)};
+    copy = moved;
+    EXPECT_EQ(1000, copy.size());
+    EXPECT_EQ(inorder, (std::vector<int>{moved.begin(), moved.end()}));
+
+    std::vector<int> empty;
+    EXPECT_EQ(0, AVLSet<int>::fromSorted(empty.begin(), empty.end()).size());
+}
+
+TEST(AVLSet_Test, fromSortedRejectsUnsortedElements)
+{
+    std::vector<int> unsorted{1, 2, 4, 3};
+    EXPECT_THROW(AVLSet<int>::fromSorted(unsorted.begin(), unsorted.end()), AVLSetException);
+}
+
+TEST(AVLSet_Test, fromUnsortedSortsAndRemovesDuplicates)
+{
+    std::vector<int> elements;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        elements.push_back((i * 7919) % 60000);
+    }
+
+    for (unsigned int threads : {1u, 3u, 8u})
+    {
+        AVLSet<int> s = AVLSet<int>::fromUnsorted(elements.begin(), elements.end(), threads);
+
+        EXPECT_EQ(60000, s.size());
+        EXPECT_EQ(15, s.height());
+
+        int expected = 0;
+
+        for (int element : s)
+        {
+            ASSERT_EQ(expected++, element);
+        }
+    }
+}
+
+TEST(AVLSet_Test, joinAndSplitDivideAndRecombineSets)
+{
+    AVLSet<int> small;
+    AVLSet<int> large;
+    std::vector<int> expected;
+
+    for (int i = 0; i < 5; ++i)
+    {
+        small.add(i);
+        expected.push_back(i);
+    }
+
+    expected.push_back(10);
+
+    for (int i = 11; i < 2000; ++i)
+    {
+        large.add(i);
+        expected.push_back(i);
+    }
+
+    AVLSet<int> joined = AVLSet<int>::join(std::move(small), 10, std::move(large));
+    checkStructure(joined, expected);
+
+    AVLSet<int>::Split split = AVLSet<int>::split(std::move(joined), 700);
+    EXPECT_TRUE(split.found);
+    checkStructure(split.less, std::vector<int>{expected.begin(), expected.begin() + 695});
+    checkStructure(split.greater, std::vector<int>{expected.begin() + 696, expected.end()});
+
+    AVLSet<int>::Split missing = AVLSet<int>::split(std::move(split.less), 7);
+    EXPECT_FALSE(missing.found);
+    EXPECT_EQ(5, missing.less.size());
+    EXPECT_EQ(690, missing.greater.size());
+
+    AVLSet<int> a;
+    AVLSet<int> b;
+    a.add(1);
+    a.add(5);
+    b.add(3);
+    EXPECT_THROW(AVLSet<int>::join(a, 4, b), AVLSetException);
+    EXPECT_THROW(AVLSet<int>::join(a, 5, AVLSet<int>{}), AVLSetException);
+    EXPECT_EQ(3, AVLSet<int>::join(a, 6, AVLSet<int>{}).size());
+}
+
+TEST(AVLSet_Test, setOperationsMatchSortedVectorsWithAnyNumberOfThreads)
+{
+    for (unsigned int threads : {1u, 4u})
+    {
+        for (int bSize : {0, 10, 3000, 60000})
+        {
+            std::vector<int> aElements;
+            std::vector<int> bElements;
+
+            for (int i = 0; i < 50000; ++i)
+            {
+                aElements.push_back((i * 7919) % 100000);
+            }
+
+            for (int i = 0; i < bSize; ++i)
+            {
+                bElements.push_back(static_cast<int>((i * 104729LL) % 120000));
+            }
+
+            // One of each pair comes from fromUnsorted(), so the operations
+            // mix nodes from blocks with individually allocated ones.
+            AVLSet<int> a = AVLSet<int>::fromUnsorted(aElements.begin(), aElements.end());
+            AVLSet<int> b;
+
+            for (int element : bElements)
+            {
+                b.add(element);
+            }
+
+            std::vector<int> sortedA{a.begin(), a.end()};
+            std::vector<int> sortedB{b.begin(), b.end()};
+            std::vector<int> expected;
+
+            AVLSet<int> united = a;
+            united.uniteWith(b, threads);
+            std::set_union(sortedA.begin(), sortedA.end(), sortedB.begin(), sortedB.end(), std::back_inserter(expected));
+            checkStructure(united, expected);
+
+            AVLSet<int> intersected = a;
+            intersected.intersectWith(b, threads);
+            expected.clear();
+            std::set_intersection(sortedA.begin(), sortedA.end(), sortedB.begin(), sortedB.end(), std::back_inserter(expected));
+            checkStructure(intersected, expected);
+
+            AVLSet<int> bMinusA = b;
+            bMinusA.subtract(std::move(a), threads);
+            expected.clear();
+            std::set_difference(sortedB.begin(), sortedB.end(), sortedA.begin(), sortedA.end(), std::back_inserter(expected));
+            checkStructure(bMinusA, expected);
+
+            // The set that was moved from, and b, which was copied, are
+            // left valid.
+            EXPECT_EQ(sortedB, (std::vector<int>{b.begin(), b.end()}));
+        }
+    }
+}
+
+TEST(AVLSet_Test, addBatchAddsEveryElementOnce)
+{
+    AVLSet<int> s;
+    std::vector<int> batch;
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        s.add(i);
+    }
+
+    for (int i = 0; i < 40000; ++i)
+    {
+        batch.push_back((i * 7919) % 20000);
+    }
+
+    s.addBatch(batch.data(), batch.size(), 3);
+
+    std::vector<int> expected;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        expected.push_back(i);
+    }
+
+    checkStructure(s, expected);
+    s.addBatch(nullptr, 0);
+    EXPECT_EQ(20000, s.size());
+}
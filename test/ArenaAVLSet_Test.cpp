@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <set>
+#include <string>
+#include <vector>
+#include "ArenaAVLSet.hpp"
+#include "Hashing.hpp"
+
+namespace
+{
+    template <typename T>
+    std::vector<T> elementsOf(const ArenaAVLSet<T>& s)
+    {
+        std::vector<T> elements;
+        s.inorder([&elements](const T& element) { elements.push_back(element); });
+        return elements;
+    }
+
+
+    // checkStructure() checks that an in-order walk gives the expected
+    // elements and that the height is within the AVL bound.
+    template <typename T>
+    void checkStructure(const ArenaAVLSet<T>& s, const std::set<T>& expected)
+    {
+        ASSERT_EQ(expected.size(), s.size());
+        EXPECT_EQ((std::vector<T>{expected.begin(), expected.end()}), elementsOf(s));
+        EXPECT_LE(s.height(), 1.4405 * std::log2(expected.size() + 2.0) - 0.3277);
+    }
+}
+
+
+TEST(ArenaAVLSet_Test, containsElementsAfterAdding)
+{
+    ArenaAVLSet<int> s;
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(-1, s.height());
+    EXPECT_EQ(0, s.bytesUsed());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+        s.add(i);
+    }
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_EQ(9, s.height());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(-1));
+    EXPECT_FALSE(s.contains(1000));
+}
+
+
+TEST(ArenaAVLSet_Test, removedNodesAreReused)
+{
+    ArenaAVLSet<int> s;
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        s.add(i);
+    }
+
+    std::size_t bytes = s.bytesUsed();
+
+    for (int i = 0; i < 5000; i += 2)
+    {
+        EXPECT_TRUE(s.remove(i));
+        EXPECT_FALSE(s.remove(i));
+    }
+
+    EXPECT_EQ(2500, s.size());
+    EXPECT_FALSE(s.contains(0));
+    EXPECT_TRUE(s.contains(1));
+
+    for (int i = 5000; i < 7500; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(5000, s.size());
+    EXPECT_EQ(bytes, s.bytesUsed());
+
+    s.clear();
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(0, s.bytesUsed());
+    EXPECT_FALSE(s.contains(1));
+}
+
+
+TEST(ArenaAVLSet_Test, agreesWithStdSetUnderRandomAddsAndRemoves)
+{
+    ArenaAVLSet<int> s;
+    std::set<int> expected;
+
+    for (unsigned int i = 0; i < 40000; ++i)
+    {
+        int element = static_cast<int>(mix64(i) % 3000);
+
+        if (mix64(i + 1000000) % 3 == 0)
+        {
+            EXPECT_EQ(expected.erase(element) == 1, s.remove(element));
+        }
+        else
+        {
+            s.add(element);
+            expected.insert(element);
+        }
+
+        if (i % 5000 == 0)
+        {
+            checkStructure(s, expected);
+        }
+    }
+
+    checkStructure(s, expected);
+
+    for (int element = -1; element <= 3000; ++element)
+    {
+        EXPECT_EQ(expected.count(element) == 1, s.contains(element));
+    }
+}
+
+
+TEST(ArenaAVLSet_Test, inorderStopsEarlyWhenVisitReturnsFalse)
+{
+    ArenaAVLSet<int> s;
+
+    for (int i = 100; i > 0; --i)
+    {
+        s.add(i);
+    }
+
+    std::vector<int> visited;
+    bool finished = s.inorder(
+        [&visited](const int& element)
+        {
+            visited.push_back(element);
+            return element < 5;
+        });
+
+    EXPECT_FALSE(finished);
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), visited);
+    EXPECT_TRUE(s.inorder([](const int&) { return true; }));
+}
+
+
+TEST(ArenaAVLSet_Test, copiesAndMovesAreIndependent)
+{
+    ArenaAVLSet<std::string> s;
+    std::set<std::string> expected;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        s.add(std::to_string(i));
+        expected.insert(std::to_string(i));
+    }
+
+    for (int i = 0; i < 300; i += 3)
+    {
+        s.remove(std::to_string(i));
+        expected.erase(std::to_string(i));
+    }
+
+    ArenaAVLSet<std::string> copy{s};
+    checkStructure(copy, expected);
+
+    copy.add("new");
+    EXPECT_TRUE(copy.contains("new"));
+    EXPECT_FALSE(s.contains("new"));
+    checkStructure(s, expected);
+
+    ArenaAVLSet<std::string> moved{std::move(copy)};
+    EXPECT_EQ(0, copy.size());
+    EXPECT_TRUE(moved.contains("new"));
+
+    copy = s;
+    checkStructure(copy, expected);
+
+    s = std::move(moved);
+    EXPECT_TRUE(s.contains("new"));
+    EXPECT_EQ(expected.size() + 1, s.size());
+}
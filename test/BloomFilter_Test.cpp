@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include "BloomFilter.hpp"
+#include "Hashing.hpp"
+
+
+TEST(BloomFilter_Test, emptyFilterContainsNothing)
+{
+    BloomFilter f{1000, 0.01};
+
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        EXPECT_FALSE(f.mayContain(mix64(i)));
+    }
+}
+
+TEST(BloomFilter_Test, addedElementsAreNeverFalseNegatives)
+{
+    BloomFilter f{10000, 0.01};
+
+    for (std::uint64_t i = 0; i < 10000; ++i)
+    {
+        EXPECT_TRUE(f.add(mix64(i)));
+    }
+
+    for (std::uint64_t i = 0; i < 10000; ++i)
+    {
+        EXPECT_TRUE(f.mayContain(mix64(i)));
+    }
+}
+
+TEST(BloomFilter_Test, falsePositiveRateIsNearTheTarget)
+{
+    BloomFilter f{20000, 0.01};
+
+    for (std::uint64_t i = 0; i < 20000; ++i)
+    {
+        f.add(mix64(i));
+    }
+
+    unsigned int falsePositives = 0;
+
+    for (std::uint64_t i = 1000000; i < 1100000; ++i)
+    {
+        if (f.mayContain(mix64(i)))
+        {
+            ++falsePositives;
+        }
+    }
+
+    EXPECT_LE(f.falsePositiveRate(20000), 0.01);
+    EXPECT_LT(falsePositives, 1500u);
+}
+
+TEST(BloomFilter_Test, lowerRatesCostMoreBits)
+{
+    BloomFilter loose{10000, 0.05};
+    BloomFilter tight{10000, 0.001};
+
+    EXPECT_LT(loose.sizeInBits(), tight.sizeInBits());
+    EXPECT_EQ(0u, loose.sizeInBits() % 256);
+}
+
+TEST(BloomFilter_Test, tinyFilterForManyElementsIsSizedSensibly)
+{
+    BloomFilter f{1000000, 0.01};
+
+    // Somewhere around 10 bits per element; certainly not a single block.
+    EXPECT_GT(f.sizeInBits(), 8000000u);
+    EXPECT_LT(f.sizeInBits(), 16000000u);
+}
+
+TEST(BloomFilter_Test, clearForgetsEverything)
+{
+    BloomFilter f{100, 0.01};
+    f.add(mix64(1));
+    f.clear();
+
+    EXPECT_FALSE(f.mayContain(mix64(1)));
+}
+
+TEST(BloomFilter_Test, ratesOutsideZeroToOneAreRejected)
+{
+    EXPECT_THROW((BloomFilter{1000, 0.0}), BloomFilterException);
+    EXPECT_THROW((BloomFilter{1000, -0.5}), BloomFilterException);
+    EXPECT_THROW((BloomFilter{1000, 1.0}), BloomFilterException);
+    EXPECT_THROW((BloomFilter{1000, std::nan("")}), BloomFilterException);
+    EXPECT_THROW((BloomFilter{1000, 1e-300}), BloomFilterException);
+}
@@ -0,0 +1,294 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "CompactHashSet.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+
+    unsigned int zeroHash(const int&)
+    {
+        return 0;
+    }
+
+    unsigned int lengthHash(const std::string& element)
+    {
+        return static_cast<unsigned int>(element.size());
+    }
+
+
+    template <typename SetType>
+    std::vector<typename SetType::ConstIterator::value_type> elementsOf(const SetType& s)
+    {
+        return {s.begin(), s.end()};
+    }
+}
+
+
+TEST(CompactHashSet_Test, emptySetsHaveSizeZero)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(0));
+    EXPECT_TRUE(s.begin() == s.end());
+}
+
+TEST(CompactHashSet_Test, containsElementsAfterAdding)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i * 37);
+    }
+
+    EXPECT_EQ(1000, s.size());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i * 37));
+        EXPECT_FALSE(s.contains(i * 37 + 1));
+    }
+}
+
+TEST(CompactHashSet_Test, addingDuplicatesHasNoEffect)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+    s.add(5);
+    s.add(6);
+    s.add(5);
+
+    EXPECT_EQ(2, s.size());
+    EXPECT_EQ((std::vector<int>{5, 6}), elementsOf(s));
+}
+
+TEST(CompactHashSet_Test, iteratesInInsertionOrder)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+    std::vector<int> expected;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        int element = (i * 7919) % 1000;
+        s.add(element);
+        expected.push_back(element);
+    }
+
+    EXPECT_EQ(expected, elementsOf(s));
+}
+
+TEST(CompactHashSet_Test, collidingElementsAreAllFound)
+{
+    CompactHashSet<int, FunctionHash<int>> s{zeroHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(100));
+}
+
+TEST(CompactHashSet_Test, removedElementsAreGoneAndSkippedByIteration)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_TRUE(s.remove(3));
+    EXPECT_TRUE(s.remove(0));
+    EXPECT_FALSE(s.remove(3));
+    EXPECT_FALSE(s.remove(42));
+
+    EXPECT_EQ(8, s.size());
+    EXPECT_FALSE(s.contains(3));
+    EXPECT_FALSE(s.contains(0));
+    EXPECT_EQ((std::vector<int>{1, 2, 4, 5, 6, 7, 8, 9}), elementsOf(s));
+}
+
+TEST(CompactHashSet_Test, removedElementsCanBeAddedAgainAtTheEnd)
+{
+    CompactHashSet<int, FunctionHash<int>> s{zeroHash};
+    s.add(1);
+    s.add(2);
+    s.add(3);
+    s.remove(1);
+    s.add(1);
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_EQ((std::vector<int>{2, 3, 1}), elementsOf(s));
+}
+
+TEST(CompactHashSet_Test, addingItsOwnRemovedElementSurvivesGrowing)
+{
+    // For some number of elements, the add() lands exactly when the
+    // entries array is full, so the set grows while the element being
+    // added still refers to one of its old entries.
+    for (int count = 1; count <= 40; ++count)
+    {
+        CompactHashSet<std::string> s;
+
+        for (int i = 0; i < count; ++i)
+        {
+            s.add("a string long enough to be allocated, number " + std::to_string(i));
+        }
+
+        const std::string& first = *s.begin();
+        s.remove(first);
+        s.add(first);
+
+        EXPECT_EQ(count, s.size());
+        EXPECT_TRUE(s.contains("a string long enough to be allocated, number 0"));
+    }
+}
+
+TEST(CompactHashSet_Test, churnDoesNotGrowTheTable)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        s.add(i);
+
+        if (i >= 10)
+        {
+            s.remove(i - 10);
+        }
+    }
+
+    EXPECT_EQ(10, s.size());
+    EXPECT_LE(s.capacity(), 64);
+    EXPECT_EQ((std::vector<int>{99990, 99991, 99992, 99993, 99994, 99995, 99996, 99997, 99998, 99999}), elementsOf(s));
+}
+
+TEST(CompactHashSet_Test, indexCellsWidenAsTheSetGrows)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+    EXPECT_EQ(1, s.indexWidth());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(2, s.indexWidth());
+
+    for (int i = 1000; i < 100000; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(4, s.indexWidth());
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+}
+
+TEST(CompactHashSet_Test, smallSetsUseLittleMemory)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 5; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(8, s.capacity());
+    EXPECT_LE(s.sizeInBytes(), 8 + 5 * 12);
+}
+
+TEST(CompactHashSet_Test, clearRemovesEverything)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    unsigned int capacity = s.capacity();
+    s.clear();
+
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(capacity, s.capacity());
+    EXPECT_FALSE(s.contains(50));
+    EXPECT_TRUE(s.begin() == s.end());
+
+    s.add(50);
+    EXPECT_EQ((std::vector<int>{50}), elementsOf(s));
+}
+
+TEST(CompactHashSet_Test, copiesAreIndependent)
+{
+    CompactHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    s.remove(50);
+
+    CompactHashSet<int, FunctionHash<int>> copy{s};
+    copy.add(1000);
+    s.remove(0);
+
+    EXPECT_EQ(100, copy.size());
+    EXPECT_TRUE(copy.contains(0));
+    EXPECT_FALSE(copy.contains(50));
+    EXPECT_TRUE(copy.contains(1000));
+    EXPECT_FALSE(s.contains(1000));
+    EXPECT_EQ(1000, elementsOf(copy).back());
+}
+
+TEST(CompactHashSet_Test, copiesNonTriviallyCopyableElements)
+{
+    CompactHashSet<std::string, FunctionHash<std::string>> s{lengthHash};
+    s.add("alpha");
+    s.add("beta");
+    s.add("gamma");
+    s.remove("beta");
+
+    CompactHashSet<std::string, FunctionHash<std::string>> copy{s};
+    s.clear();
+
+    EXPECT_EQ((std::vector<std::string>{"alpha", "gamma"}), elementsOf(copy));
+    EXPECT_TRUE(copy.contains("gamma"));
+    EXPECT_FALSE(copy.contains("beta"));
+}
+
+TEST(CompactHashSet_Test, canBeMovedAndAssigned)
+{
+    CompactHashSet<std::string, FunctionHash<std::string>> s{lengthHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(std::to_string(i));
+    }
+
+    CompactHashSet<std::string, FunctionHash<std::string>> moved{std::move(s)};
+    EXPECT_EQ(100, moved.size());
+    EXPECT_TRUE(moved.contains("42"));
+
+    CompactHashSet<std::string, FunctionHash<std::string>> assigned{lengthHash};
+    assigned.add("x");
+    assigned = moved;
+
+    EXPECT_EQ(100, assigned.size());
+    EXPECT_FALSE(assigned.contains("x"));
+    EXPECT_EQ(elementsOf(moved), elementsOf(assigned));
+}
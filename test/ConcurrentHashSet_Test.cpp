@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ConcurrentHashSet.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+}
+
+
+TEST(ConcurrentHashSet_Test, sizeIsZeroWhenDefaultConstructed)
+{
+    ConcurrentHashSet<int, FunctionHash<int>> s{identityHash};
+
+    EXPECT_TRUE(s.isImplemented());
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(0));
+}
+
+TEST(ConcurrentHashSet_Test, addedElementsAreContained)
+{
+    ConcurrentHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+        s.add(i);
+    }
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_GE(s.capacity(), 1250);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(1000));
+}
+
+TEST(ConcurrentHashSet_Test, removedElementsAreNoLongerContained)
+{
+    ConcurrentHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 200; ++i)
+    {
+        s.add(i);
+    }
+
+    for (int i = 0; i < 200; i += 2)
+    {
+        EXPECT_TRUE(s.remove(i));
+    }
+
+    EXPECT_FALSE(s.remove(0));
+    EXPECT_EQ(100, s.size());
+
+    for (int i = 0; i < 200; ++i)
+    {
+        EXPECT_EQ(i % 2 == 1, s.contains(i));
+    }
+}
+
+TEST(ConcurrentHashSet_Test, concurrentWritersAddEveryElementExactlyOnce)
+{
+    ConcurrentHashSet<int, FunctionHash<int>> s{identityHash};
+    const int threads = 8;
+    const int perThread = 5000;
+
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&s, t]
+            {
+                // Every thread adds every element, so duplicates race.
+                for (int i = 0; i < threads * perThread; ++i)
+                {
+                    s.add((i + t * perThread) % (threads * perThread));
+                }
+            });
+    }
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    EXPECT_EQ(threads * perThread, s.size());
+
+    for (int i = 0; i < threads * perThread; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+}
+
+TEST(ConcurrentHashSet_Test, readersNeverMissStableElementsWhileWritersChurnAndResize)
+{
+    ConcurrentHashSet<int, FunctionHash<int>> s{identityHash};
+    const int stable = 1000;
+
+    for (int i = 0; i < stable; ++i)
+    {
+        s.add(i);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < 4; ++t)
+    {
+        workers.emplace_back([&]
+            {
+                while (!done.load())
+                {
+                    for (int i = 0; i < stable; ++i)
+                    {
+                        if (!s.contains(i))
+                        {
+                            ++misses;
+                        }
+                    }
+                }
+            });
+    }
+
+    for (int t = 0; t < 2; ++t)
+    {
+        workers.emplace_back([&s, t]
+            {
+                // Growing the set forces several resizes; removing half of
+                // what was added retires nodes while readers are running.
+                for (int i = 0; i < 50000; ++i)
+                {
+                    int element = stable + t * 50000 + i;
+                    s.add(element);
+
+                    if (i % 2 == 0)
+                    {
+                        s.remove(element);
+                    }
+                }
+            });
+    }
+
+    for (std::size_t i = 4; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+
+    done.store(true);
+
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        workers[i].join();
+    }
+
+    EXPECT_EQ(0, misses.load());
+    EXPECT_EQ(stable + 50000, s.size());
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include "CuckooFilter.hpp"
+#include "Hashing.hpp"
+
+
+TEST(CuckooFilter_Test, emptyFilterContainsNothing)
+{
+    CuckooFilter<> f{1000, 0.01};
+
+    EXPECT_EQ(0u, f.size());
+
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        EXPECT_FALSE(f.mayContain(mix64(i)));
+    }
+}
+
+TEST(CuckooFilter_Test, addedElementsAreNeverFalseNegatives)
+{
+    CuckooFilter<> f{10000, 0.001};
+
+    for (std::uint64_t i = 0; i < 10000; ++i)
+    {
+        ASSERT_TRUE(f.add(mix64(i)));
+    }
+
+    EXPECT_EQ(10000u, f.size());
+
+    for (std::uint64_t i = 0; i < 10000; ++i)
+    {
+        EXPECT_TRUE(f.mayContain(mix64(i)));
+    }
+}
+
+TEST(CuckooFilter_Test, removedElementsAreGone)
+{
+    CuckooFilter<> f{1000, 0.0001};
+
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        f.add(mix64(i));
+    }
+
+    for (std::uint64_t i = 0; i < 1000; i += 2)
+    {
+        EXPECT_TRUE(f.remove(mix64(i)));
+    }
+
+    EXPECT_EQ(500u, f.size());
+
+    for (std::uint64_t i = 1; i < 1000; i += 2)
+    {
+        EXPECT_TRUE(f.mayContain(mix64(i)));
+    }
+
+    unsigned int stillThere = 0;
+
+    for (std::uint64_t i = 0; i < 1000; i += 2)
+    {
+        if (f.mayContain(mix64(i)))
+        {
+            ++stillThere;
+        }
+    }
+
+    EXPECT_LT(stillThere, 5u);
+}
+
+TEST(CuckooFilter_Test, fingerprintWidthFollowsTheRate)
+{
+    CuckooFilter<> loose{1000, 0.03};
+    CuckooFilter<> tight{1000, 0.0001};
+    CuckooFilter<std::uint8_t> narrow{1000, 0.0001};
+
+    EXPECT_EQ(9u, loose.fingerprintBits());
+    EXPECT_EQ(16u, tight.fingerprintBits());
+    EXPECT_EQ(8u, narrow.fingerprintBits());
+}
+
+TEST(CuckooFilter_Test, falsePositiveRateIsNearTheTarget)
+{
+    CuckooFilter<> f{20000, 0.01};
+
+    for (std::uint64_t i = 0; i < 20000; ++i)
+    {
+        f.add(mix64(i));
+    }
+
+    unsigned int falsePositives = 0;
+
+    for (std::uint64_t i = 1000000; i < 1100000; ++i)
+    {
+        if (f.mayContain(mix64(i)))
+        {
+            ++falsePositives;
+        }
+    }
+
+    EXPECT_LT(falsePositives, 1000u);
+}
+
+TEST(CuckooFilter_Test, eightBitFingerprintsMatchWithoutFalseNegatives)
+{
+    CuckooFilter<std::uint8_t> f{5000, 0.05};
+
+    for (std::uint64_t i = 0; i < 5000; ++i)
+    {
+        ASSERT_TRUE(f.add(mix64(i)));
+    }
+
+    for (std::uint64_t i = 0; i < 5000; ++i)
+    {
+        EXPECT_TRUE(f.mayContain(mix64(i)));
+    }
+}
+
+TEST(CuckooFilter_Test, addFailsOnceTheFilterIsFull)
+{
+    CuckooFilter<> f{64, 0.01};
+
+    std::uint64_t i = 0;
+
+    while (f.add(mix64(i)))
+    {
+        ++i;
+        ASSERT_LT(i, 1000u);
+    }
+
+    // Everything that was accepted, including the stashed fingerprint,
+    // is still found.
+    for (std::uint64_t j = 0; j < i; ++j)
+    {
+        EXPECT_TRUE(f.mayContain(mix64(j)));
+    }
+
+    f.clear();
+    EXPECT_EQ(0u, f.size());
+    EXPECT_TRUE(f.add(mix64(i)));
+}
+
+TEST(CuckooFilter_Test, ratesOutsideZeroToOneAreRejected)
+{
+    EXPECT_THROW((CuckooFilter<>{1000, 0.0}), CuckooFilterException);
+    EXPECT_THROW((CuckooFilter<>{1000, -0.5}), CuckooFilterException);
+    EXPECT_THROW((CuckooFilter<>{1000, 1.0}), CuckooFilterException);
+    EXPECT_THROW((CuckooFilter<>{1000, std::nan("")}), CuckooFilterException);
+}
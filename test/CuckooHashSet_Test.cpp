@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include "CuckooHashSet.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+
+    unsigned int zeroHash(const int&)
+    {
+        return 0;
+    }
+
+    unsigned int lengthHash(const std::string& element)
+    {
+        return static_cast<unsigned int>(element.size());
+    }
+}
+
+
+TEST(CuckooHashSet_Test, emptySetsHaveSizeZero)
+{
+    CuckooHashSet<int, FunctionHash<int>> s{identityHash};
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(0));
+}
+
+TEST(CuckooHashSet_Test, containsElementsAfterAdding)
+{
+    CuckooHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        s.add(i * 3);
+    }
+
+    EXPECT_EQ(100000, s.size());
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i * 3));
+        ASSERT_FALSE(s.contains(i * 3 + 1));
+    }
+}
+
+TEST(CuckooHashSet_Test, addingDuplicatesHasNoEffect)
+{
+    CuckooHashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i % 100);
+    }
+
+    EXPECT_EQ(100, s.size());
+}
+
+TEST(CuckooHashSet_Test, runsVeryFullBeforeGrowing)
+{
+    CuckooHashSet<int> s;
+    double growthLoad = 1.0;
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        std::size_t capacity = s.capacity();
+        double load = s.loadFactor();
+        s.add(i);
+
+        // (Tiny tables are left out, since they can easily fill up
+        // completely.)
+        if (s.capacity() != capacity && capacity >= 1024)
+        {
+            growthLoad = std::min(growthLoad, load);
+        }
+    }
+
+    EXPECT_GT(growthLoad, 0.9);
+}
+
+TEST(CuckooHashSet_Test, fourSlotBucketsWorkToo)
+{
+    CuckooHashSet<int, FunctionHash<int>, std::equal_to<int>, 4> s;
+
+    for (int i = 0; i < 50000; ++i)
+    {
+        s.add(i);
+    }
+
+    for (int i = 0; i < 50000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+
+    EXPECT_EQ(50000, s.size());
+    EXPECT_GT(s.loadFactor(), 0.45);
+}
+
+TEST(CuckooHashSet_Test, elementsWithEqualHashesAreAllKept)
+{
+    CuckooHashSet<int, FunctionHash<int>> s{zeroHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(100, s.size());
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(100));
+}
+
+TEST(CuckooHashSet_Test, removedElementsAreGone)
+{
+    CuckooHashSet<int> s;
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        s.add(i);
+    }
+
+    for (int i = 0; i < 10000; i += 2)
+    {
+        EXPECT_TRUE(s.remove(i));
+    }
+
+    EXPECT_FALSE(s.remove(0));
+    EXPECT_EQ(5000, s.size());
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        ASSERT_EQ(i % 2 == 1, s.contains(i));
+    }
+}
+
+TEST(CuckooHashSet_Test, removingFromFullBucketsMakesRoomForTheStash)
+{
+    CuckooHashSet<int, FunctionHash<int>> s{zeroHash};
+
+    for (int i = 0; i < 20; ++i)
+    {
+        s.add(i);
+    }
+
+    // Every element shares the same two buckets, so the first 16 fill
+    // them and the rest are stashed.
+    unsigned int stashed = s.stashSize();
+    ASSERT_GT(stashed, 0);
+
+    s.remove(0);
+    EXPECT_EQ(stashed - 1, s.stashSize());
+    EXPECT_EQ(19, s.size());
+
+    for (int i = 0; i < 20; ++i)
+    {
+        s.remove(i);
+    }
+
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(0, s.stashSize());
+}
+
+TEST(CuckooHashSet_Test, copiesAreIndependent)
+{
+    CuckooHashSet<std::string, FunctionHash<std::string>> s{lengthHash};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(std::to_string(i));
+    }
+
+    CuckooHashSet<std::string, FunctionHash<std::string>> copy{s};
+    copy.add("new");
+    s.remove("500");
+
+    EXPECT_EQ(1001, copy.size());
+    EXPECT_TRUE(copy.contains("500"));
+    EXPECT_TRUE(copy.contains("new"));
+    EXPECT_FALSE(s.contains("new"));
+    EXPECT_FALSE(s.contains("500"));
+}
+
+TEST(CuckooHashSet_Test, canBeMovedAndAssigned)
+{
+    CuckooHashSet<std::string, FunctionHash<std::string>> s{lengthHash};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(std::to_string(i));
+    }
+
+    CuckooHashSet<std::string, FunctionHash<std::string>> moved{std::move(s)};
+    EXPECT_EQ(1000, moved.size());
+    EXPECT_TRUE(moved.contains("999"));
+
+    EXPECT_EQ(0, s.size());
+    s.add("again");
+    EXPECT_TRUE(s.contains("again"));
+
+    CuckooHashSet<std::string, FunctionHash<std::string>> assigned{lengthHash};
+    assigned = moved;
+    EXPECT_EQ(1000, assigned.size());
+    EXPECT_TRUE(assigned.contains("0"));
+}
+
+TEST(CuckooHashSet_Test, copiesOfMovedFromSetsAreEmptyAndUsable)
+{
+    CuckooHashSet<int> s;
+    s.add(1);
+
+    CuckooHashSet<int> moved{std::move(s)};
+    CuckooHashSet<int> copy{s};
+
+    EXPECT_EQ(0, copy.size());
+    EXPECT_FALSE(copy.contains(1));
+    EXPECT_FALSE(copy.remove(1));
+
+    copy.add(5);
+    EXPECT_TRUE(copy.contains(5));
+    EXPECT_EQ(1, copy.size());
+
+    CuckooHashSet<int> assigned;
+    assigned.add(7);
+    assigned = s;
+    EXPECT_EQ(0, assigned.size());
+    assigned.add(8);
+    EXPECT_TRUE(assigned.contains(8));
+}
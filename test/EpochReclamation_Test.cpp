@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "EpochReclamation.hpp"
+
+namespace
+{
+    struct Tracked
+    {
+        Tracked(std::atomic<int>& destroyed)
+            : destroyed{destroyed}
+        {
+        }
+
+        ~Tracked()
+        {
+            ++destroyed;
+        }
+
+        std::atomic<int>& destroyed;
+    };
+}
+
+
+TEST(EpochReclamation_Test, retiredObjectsAreFreedOnceNoThreadIsPinned)
+{
+    EpochDomain& domain = EpochDomain::global();
+    std::atomic<int> destroyed{0};
+
+    domain.retire(new Tracked{destroyed});
+    EXPECT_EQ(0, destroyed.load());
+
+    domain.collect();
+    domain.collect();
+
+    EXPECT_EQ(1, destroyed.load());
+}
+
+TEST(EpochReclamation_Test, pinnedThreadHoldsBackReclamation)
+{
+    EpochDomain& domain = EpochDomain::global();
+    std::atomic<int> destroyed{0};
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> release{false};
+
+    std::thread reader{[&]
+        {
+            EpochDomain::Guard guard = domain.pin();
+            pinned.store(true);
+
+            while (!release.load())
+            {
+                std::this_thread::yield();
+            }
+        }};
+
+    while (!pinned.load())
+    {
+        std::this_thread::yield();
+    }
+
+    domain.retire(new Tracked{destroyed});
+
+    for (int i = 0; i < 5; ++i)
+    {
+        domain.collect();
+    }
+
+    EXPECT_EQ(0, destroyed.load());
+
+    release.store(true);
+    reader.join();
+
+    domain.collect();
+    domain.collect();
+
+    EXPECT_EQ(1, destroyed.load());
+}
+
+TEST(EpochReclamation_Test, guardsNest)
+{
+    EpochDomain& domain = EpochDomain::global();
+    std::atomic<int> destroyed{0};
+
+    {
+        EpochDomain::Guard outer = domain.pin();
+
+        {
+            EpochDomain::Guard inner = domain.pin();
+        }
+
+        // The outer guard still pins this thread, so the epoch can
+        // advance at most once past the one this thread announced.
+        domain.retire(new Tracked{destroyed});
+        domain.collect();
+        domain.collect();
+        EXPECT_EQ(0, destroyed.load());
+    }
+
+    domain.collect();
+    domain.collect();
+    EXPECT_EQ(1, destroyed.load());
+}
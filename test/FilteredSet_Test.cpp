@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include "AVLSet.hpp"
+#include "CuckooFilter.hpp"
+#include "FilteredSet.hpp"
+#include "HashSet.hpp"
+#include "SkipListSet.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+}
+
+
+TEST(FilteredSet_Test, canFilterAHashSet)
+{
+    FilteredSet<int, HashSet<int, FunctionHash<int>>> s{identityHash, 1000, 0.01, HashSet<int, FunctionHash<int>>{identityHash}};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+    }
+
+    s.add(5);
+    EXPECT_EQ(1000u, s.size());
+    EXPECT_TRUE(s.isFiltering());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    for (int i = 1000; i < 2000; ++i)
+    {
+        EXPECT_FALSE(s.contains(i));
+    }
+}
+
+TEST(FilteredSet_Test, canFilterAnAVLSetWithACuckooFilter)
+{
+    FilteredSet<int, AVLSet<int>, CuckooFilter<>> s{identityHash, 500, 0.01};
+
+    for (int i = 0; i < 500; ++i)
+    {
+        s.add(i * 3);
+        s.add(i * 3);
+    }
+
+    EXPECT_EQ(500u, s.size());
+    EXPECT_EQ(500u, s.filter().size());
+
+    for (int i = 0; i < 1500; ++i)
+    {
+        EXPECT_EQ(i % 3 == 0, s.contains(i));
+    }
+}
+
+TEST(FilteredSet_Test, canFilterASkipListSet)
+{
+    FilteredSet<int, SkipListSet<int>> s{identityHash, 100, 0.01};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_TRUE(s.contains(50));
+    EXPECT_FALSE(s.contains(150));
+    EXPECT_EQ(100u, s.set().size());
+}
+
+TEST(FilteredSet_Test, bypassesTheFilterWhenGivenANonEmptySet)
+{
+    AVLSet<int> initial;
+    initial.add(7);
+
+    FilteredSet<int, AVLSet<int>> s{identityHash, 100, 0.01, initial};
+
+    EXPECT_FALSE(s.isFiltering());
+    EXPECT_TRUE(s.contains(7));
+}
+
+TEST(FilteredSet_Test, bypassesAFullCuckooFilterWithoutLosingAnswers)
+{
+    FilteredSet<int, AVLSet<int>, CuckooFilter<>> s{identityHash, 16, 0.01};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_FALSE(s.isFiltering());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(1000));
+}
+
+TEST(FilteredSet_Test, rejectsImpossibleFalsePositiveRates)
+{
+    EXPECT_THROW((FilteredSet<int>{identityHash, 1000, 0.0}), BloomFilterException);
+    EXPECT_THROW((FilteredSet<int>{identityHash, 1000, 1.0}), BloomFilterException);
+    EXPECT_THROW((FilteredSet<int>{identityHash, 1000, std::nan("")}), BloomFilterException);
+
+    typedef FilteredSet<int, HashSet<int>, CuckooFilter<>> CuckooFilteredSet;
+
+    EXPECT_THROW((CuckooFilteredSet{identityHash, 1000, 0.0}), CuckooFilterException);
+    EXPECT_THROW((CuckooFilteredSet{identityHash, 1000, 1.0}), CuckooFilterException);
+    EXPECT_THROW((CuckooFilteredSet{identityHash, 1000, std::nan("")}), CuckooFilterException);
+}
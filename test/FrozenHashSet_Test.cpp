@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FrozenHashSet.hpp"
+#include "HashSet.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+
+    unsigned int parityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element % 2);
+    }
+}
+
+
+TEST(FrozenHashSet_Test, freezingAnEmptySetGivesAnEmptySet)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+    FrozenHashSet<int, FunctionHash<int>> f = s.freeze();
+
+    EXPECT_EQ(0, f.size());
+    EXPECT_FALSE(f.contains(0));
+    EXPECT_EQ(nullptr, f.find(0));
+}
+
+TEST(FrozenHashSet_Test, containsExactlyTheElementsOfTheHashSet)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        s.add(i * 7);
+    }
+
+    FrozenHashSet<int, FunctionHash<int>> f = s.freeze();
+
+    EXPECT_EQ(10000, f.size());
+
+    for (int i = 0; i < 70000; ++i)
+    {
+        EXPECT_EQ(i % 7 == 0, f.contains(i));
+    }
+}
+
+TEST(FrozenHashSet_Test, findReturnsTheStoredElement)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+    s.add(42);
+
+    FrozenHashSet<int, FunctionHash<int>> f = s.freeze();
+
+    ASSERT_NE(nullptr, f.find(42));
+    EXPECT_EQ(42, *f.find(42));
+}
+
+TEST(FrozenHashSet_Test, canBeBuiltFromARangeWithDuplicates)
+{
+    std::vector<int> elements{5, 3, 5, 1, 3};
+    FrozenHashSet<int, FunctionHash<int>> f{elements.begin(), elements.end(), identityHash};
+
+    EXPECT_EQ(3, f.size());
+    EXPECT_TRUE(f.contains(1));
+    EXPECT_TRUE(f.contains(3));
+    EXPECT_TRUE(f.contains(5));
+    EXPECT_FALSE(f.contains(2));
+}
+
+TEST(FrozenHashSet_Test, unequalElementsWithEqualHashesAreFound)
+{
+    std::vector<int> elements{1, 2, 3, 4, 5, 3, 1};
+    FrozenHashSet<int, FunctionHash<int>> f{elements.begin(), elements.end(), parityHash};
+
+    EXPECT_EQ(5, f.size());
+
+    for (int i = 1; i <= 5; ++i)
+    {
+        ASSERT_NE(nullptr, f.find(i));
+        EXPECT_EQ(i, *f.find(i));
+    }
+
+    EXPECT_FALSE(f.contains(0));
+    EXPECT_FALSE(f.contains(6));
+    EXPECT_FALSE(f.contains(-1));
+
+    FrozenHashSet<int, FunctionHash<int>> copy{f};
+    EXPECT_TRUE(copy.contains(4));
+    EXPECT_EQ(5, copy.size());
+}
+
+TEST(FrozenHashSet_Test, freezingAMillionStringsSucceeds)
+{
+    // With this many elements, some pairs of them are all but certain to
+    // share a 32-bit hash.
+    HashSet<std::string> s;
+
+    for (int i = 0; i < 1000000; ++i)
+    {
+        s.add("key" + std::to_string(i));
+    }
+
+    FrozenHashSet<std::string> f = s.freeze();
+
+    EXPECT_EQ(1000000, f.size());
+
+    for (int i = 0; i < 1000000; ++i)
+    {
+        ASSERT_TRUE(f.contains("key" + std::to_string(i)));
+    }
+
+    for (int i = 1000000; i < 1100000; ++i)
+    {
+        ASSERT_FALSE(f.contains("key" + std::to_string(i)));
+    }
+}
+
+TEST(FrozenHashSet_Test, stringsSupportTransparentLookup)
+{
+    HashSet<std::string, StringHash, std::equal_to<>> s{StringHash{}};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add("key" + std::to_string(i));
+    }
+
+    FrozenHashSet<std::string, StringHash, std::equal_to<>> f = s.freeze();
+
+    EXPECT_TRUE(f.contains(std::string_view{"key999"}));
+    EXPECT_TRUE(f.contains("key0"));
+    EXPECT_FALSE(f.contains("key1000"));
+    EXPECT_EQ("key500", *f.find(std::string{"key500"}));
+}
+
+TEST(FrozenHashSet_Test, copiesAndMovesAreIndependent)
+{
+    std::vector<std::string> elements{"a", "b", "c"};
+    FunctionHash<std::string> hash = StringHash{};
+
+    FrozenHashSet<std::string, FunctionHash<std::string>> f{elements.begin(), elements.end(), hash};
+    FrozenHashSet<std::string, FunctionHash<std::string>> copy{f};
+    FrozenHashSet<std::string, FunctionHash<std::string>> moved{std::move(f)};
+
+    EXPECT_EQ(0, f.size());
+    EXPECT_FALSE(f.contains("a"));
+    EXPECT_TRUE(copy.contains("b"));
+    EXPECT_TRUE(moved.contains("c"));
+
+    copy = moved;
+    EXPECT_TRUE(copy.contains("a"));
+    EXPECT_EQ(3, copy.size());
+}
+
+TEST(FrozenHashSet_Test, perfectHashIsCompact)
+{
+    std::vector<int> elements;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        elements.push_back(i);
+    }
+
+    FrozenHashSet<int, FunctionHash<int>> f{elements.begin(), elements.end(), identityHash};
+
+    // Four bits per element of pilots plus under one of remapping.
+    EXPECT_LT(static_cast<double>(f.hashSizeInBits()) / f.size(), 5.0);
+    EXPECT_LT(f.sizeInBytes(), 100000 * sizeof(int) + 100000);
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "HashMap.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& key)
+    {
+        return static_cast<unsigned int>(key);
+    }
+
+
+    // A Pinned value can be neither copied nor moved, so a map can only
+    // hold one if it constructs it in place.
+    struct Pinned
+    {
+        Pinned(int a, int b)
+            : sum{a + b}
+        {
+        }
+
+        Pinned(const Pinned&) = delete;
+        Pinned& operator=(const Pinned&) = delete;
+
+        int sum;
+    };
+}
+
+
+TEST(HashMap_Test, sizeIsZeroWhenDefaultConstructed)
+{
+    HashMap<int, std::string, FunctionHash<int>> m{identityHash};
+
+    EXPECT_EQ(0, m.size());
+    EXPECT_EQ(nullptr, m.find(1));
+    EXPECT_FALSE(m.contains(1));
+}
+
+TEST(HashMap_Test, tryEmplaceOnlyConstructsWhenKeyIsAbsent)
+{
+    HashMap<int, std::string, FunctionHash<int>> m{identityHash};
+
+    std::pair<std::string*, bool> first = m.try_emplace(1, 3, 'a');
+    EXPECT_TRUE(first.second);
+    EXPECT_EQ("aaa", *first.first);
+
+    std::pair<std::string*, bool> second = m.try_emplace(1, 5, 'b');
+    EXPECT_FALSE(second.second);
+    EXPECT_EQ(first.first, second.first);
+    EXPECT_EQ("aaa", *m.find(1));
+    EXPECT_EQ(1, m.size());
+}
+
+TEST(HashMap_Test, tryEmplaceLeavesMovableArgumentsAloneWhenKeyIsPresent)
+{
+    HashMap<int, std::unique_ptr<int>, FunctionHash<int>> m{identityHash};
+    m.try_emplace(1, new int{1});
+
+    std::unique_ptr<int> p{new int{2}};
+    m.try_emplace(1, std::move(p));
+
+    EXPECT_NE(nullptr, p);
+    EXPECT_EQ(1, **m.find(1));
+}
+
+TEST(HashMap_Test, insertOrAssignInsertsThenAssigns)
+{
+    HashMap<std::string, int, StringHash> m{StringHash{}};
+
+    EXPECT_TRUE(m.insert_or_assign("one", 1).second);
+    EXPECT_FALSE(m.insert_or_assign("one", 11).second);
+    EXPECT_TRUE(m.insert_or_assign(std::string{"two"}, 2).second);
+
+    EXPECT_EQ(11, *m.find("one"));
+    EXPECT_EQ(2, *m.find("two"));
+    EXPECT_EQ(2, m.size());
+}
+
+TEST(HashMap_Test, valuesAreConstructedInPlaceAndNeverMoved)
+{
+    HashMap<int, Pinned, FunctionHash<int>> m{identityHash};
+
+    const Pinned* first = m.try_emplace(0, 1, 2).first;
+
+    // Enough insertions to force several resizes.
+    for (int i = 1; i < 200; ++i)
+    {
+        m.try_emplace(i, i, i);
+    }
+
+    EXPECT_EQ(first, m.find(0));
+    EXPECT_EQ(3, m.find(0)->sum);
+    EXPECT_EQ(20, m.find(10)->sum);
+}
+
+TEST(HashMap_Test, eraseRemovesOnlyTheGivenKey)
+{
+    HashMap<int, int, FunctionHash<int>> m{identityHash};
+
+    for (int i = 0; i < 50; ++i)
+    {
+        m.insert_or_assign(i, i * i);
+    }
+
+    EXPECT_TRUE(m.erase(7));
+    EXPECT_FALSE(m.erase(7));
+    EXPECT_EQ(49, m.size());
+    EXPECT_EQ(nullptr, m.find(7));
+    EXPECT_EQ(64, *m.find(8));
+}
+
+TEST(HashMap_Test, valuesSurviveShrinkingAndClearRemovesThemAll)
+{
+    HashMap<int, std::unique_ptr<int>, FunctionHash<int>> m{identityHash};
+
+    for (int i = 0; i < 200; ++i)
+    {
+        m.try_emplace(i, new int{i});
+    }
+
+    const std::unique_ptr<int>* kept = m.find(199);
+
+    for (int i = 0; i < 195; ++i)
+    {
+        m.erase(i);
+    }
+
+    // Shrinking relinks nodes, so pointers to values stay valid.
+    EXPECT_EQ(kept, m.find(199));
+    EXPECT_EQ(199, **kept);
+
+    m.clear();
+    EXPECT_EQ(0, m.size());
+    EXPECT_FALSE(m.contains(199));
+}
+
+TEST(HashMap_Test, findThroughPointerCanModifyValue)
+{
+    HashMap<int, int, FunctionHash<int>> m{identityHash};
+    m.insert_or_assign(1, 1);
+
+    *m.find(1) += 41;
+
+    EXPECT_EQ(42, *m.find(1));
+}
+
+TEST(HashMap_Test, transparentMapsAcceptStringViews)
+{
+    HashMap<std::string, int, StringHash, std::equal_to<>> m{StringHash{}};
+    m.insert_or_assign("alpha", 1);
+
+    const char buffer[] = "alphabet";
+
+    ASSERT_NE(nullptr, m.find(std::string_view{buffer, 5}));
+    EXPECT_EQ(1, *m.find(std::string_view{buffer, 5}));
+    EXPECT_EQ(nullptr, m.find(std::string_view{buffer, 4}));
+}
+
+TEST(HashMap_Test, copiesAreIndependent)
+{
+    HashMap<int, std::string, FunctionHash<int>> m1{identityHash};
+    m1.insert_or_assign(1, "one");
+
+    HashMap<int, std::string, FunctionHash<int>> m2 = m1;
+    *m2.find(1) = "uno";
+    m2.insert_or_assign(2, "dos");
+
+    EXPECT_EQ("one", *m1.find(1));
+    EXPECT_EQ(1, m1.size());
+    EXPECT_EQ("uno", *m2.find(1));
+    EXPECT_EQ(2, m2.size());
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "HashSet.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+
+
+    std::string snapshotPath(const std::string& name)
+    {
+        return testing::TempDir() + "HashSetSnapshot_Test_" + name;
+    }
+
+
+    std::vector<char> readFile(const std::string& path)
+    {
+        std::ifstream in{path, std::ios::binary};
+        return std::vector<char>{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    }
+
+
+    void writeFile(const std::string& path, const std::vector<char>& bytes)
+    {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(bytes.data(), bytes.size());
+    }
+}
+
+
+TEST(HashSetSnapshot_Test, loadedSetsAnswerLookupsFromTheFile)
+{
+    std::string path = snapshotPath("lookups");
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i * 3);
+    }
+
+    s.save(path);
+
+    HashSet<int, FunctionHash<int>> loaded{identityHash};
+    loaded.add(-1);
+    loaded.load(path);
+
+    EXPECT_TRUE(loaded.isMapped());
+    EXPECT_EQ(1000, loaded.size());
+    EXPECT_FALSE(loaded.contains(-1));
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        EXPECT_EQ(i % 3 == 0, loaded.contains(i));
+    }
+
+    // Elements are in the same cells they were in when they were saved.
+    unsigned int capacity = s.diagnostics().capacity;
+
+    for (unsigned int i = 0; i < capacity; ++i)
+    {
+        EXPECT_EQ(s.elementsAtIndex(i), loaded.elementsAtIndex(i));
+    }
+
+    EXPECT_TRUE(loaded.isElementAtIndex(300, 300 % capacity));
+    EXPECT_FALSE(loaded.isElementAtIndex(300, 301 % capacity));
+    ASSERT_NE(nullptr, loaded.find(42));
+    EXPECT_EQ(42, *loaded.find(42));
+
+    int sum = 0;
+    loaded.forEach([&](int element) { sum += element; });
+    EXPECT_EQ(3 * 999 * 1000 / 2, sum);
+
+    std::remove(path.c_str());
+}
+
+TEST(HashSetSnapshot_Test, changesPromoteTheSetAndLeaveTheFileAlone)
+{
+    std::string path = snapshotPath("promote");
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    s.save(path);
+    std::vector<char> saved = readFile(path);
+
+    HashSet<int, FunctionHash<int>> loaded{identityHash};
+    loaded.load(path);
+    HashSet<int, FunctionHash<int>> copy{loaded};
+
+    loaded.add(500);
+    EXPECT_FALSE(loaded.isMapped());
+    EXPECT_EQ(101, loaded.size());
+    EXPECT_TRUE(loaded.contains(500));
+    EXPECT_TRUE(loaded.contains(99));
+
+    // The copy still shares the mapped file, which hasn't changed.
+    EXPECT_TRUE(copy.isMapped());
+    EXPECT_FALSE(copy.contains(500));
+    EXPECT_TRUE(copy.remove(7));
+    EXPECT_FALSE(copy.isMapped());
+    EXPECT_EQ(99, copy.size());
+    EXPECT_FALSE(copy.contains(7));
+
+    EXPECT_EQ(saved, readFile(path));
+
+    HashSet<int, FunctionHash<int>> cleared{identityHash};
+    cleared.load(path);
+    cleared.clear();
+    EXPECT_FALSE(cleared.isMapped());
+    EXPECT_EQ(0, cleared.size());
+
+    std::remove(path.c_str());
+}
+
+TEST(HashSetSnapshot_Test, seedsArePreservedAcrossSavesAndPromotions)
+{
+    std::string path = snapshotPath("seed");
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    // These collide modulo every capacity the table reaches, so the
+    // table starts scrambling them with its seed.
+    for (int i = 0; i < 200; ++i)
+    {
+        s.add(i * 10240);
+    }
+
+    ASSERT_TRUE(s.diagnostics().seeded);
+    s.save(path);
+
+    HashSet<int, FunctionHash<int>> loaded{identityHash};
+    loaded.load(path);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        EXPECT_TRUE(loaded.contains(i * 10240));
+    }
+
+    HashTableDiagnostics d = loaded.diagnostics();
+    EXPECT_TRUE(d.seeded);
+    EXPECT_EQ(s.diagnostics().chainLengths, d.chainLengths);
+
+    // Saving a loaded set writes the same file again.
+    std::string resaved = snapshotPath("seed_resaved");
+    loaded.save(resaved);
+    EXPECT_EQ(readFile(path), readFile(resaved));
+
+    loaded.add(1);
+    EXPECT_TRUE(loaded.diagnostics().seeded);
+    EXPECT_TRUE(loaded.contains(199 * 10240));
+
+    std::remove(path.c_str());
+    std::remove(resaved.c_str());
+}
+
+TEST(HashSetSnapshot_Test, emptySetsRoundTrip)
+{
+    std::string path = snapshotPath("empty");
+    HashSet<int, FunctionHash<int>> s{identityHash};
+    s.save(path);
+
+    HashSet<int, FunctionHash<int>> loaded{identityHash};
+    loaded.load(path);
+
+    EXPECT_TRUE(loaded.isMapped());
+    EXPECT_EQ(0, loaded.size());
+    EXPECT_FALSE(loaded.contains(0));
+
+    std::remove(path.c_str());
+}
+
+TEST(HashSetSnapshot_Test, invalidFilesAreRejected)
+{
+    std::string path = snapshotPath("invalid");
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 50; ++i)
+    {
+        s.add(i);
+    }
+
+    s.save(path);
+    std::vector<char> bytes = readFile(path);
+    HashSet<int, FunctionHash<int>> loaded{identityHash};
+
+    std::vector<char> corrupt = bytes;
+    corrupt[corrupt.size() - 2] ^= 1;
+    writeFile(path, corrupt);
+    EXPECT_THROW(loaded.load(path), SnapshotException);
+
+    // Without the checksum, the corruption goes unnoticed, but cells
+    // pointing past the elements never do.
+    EXPECT_NO_THROW(loaded.load(path, false));
+    loaded.clear();
+
+    std::vector<char> badCells = bytes;
+    badCells[72 + 4] = 100;
+    writeFile(path, badCells);
+    EXPECT_THROW(loaded.load(path, false), SnapshotException);
+
+    std::vector<char> truncated{bytes.begin(), bytes.end() - 1};
+    writeFile(path, truncated);
+    EXPECT_THROW(loaded.load(path, false), SnapshotException);
+
+    std::vector<char> wrongMagic = bytes;
+    wrongMagic[0] = 'X';
+    writeFile(path, wrongMagic);
+    EXPECT_THROW(loaded.load(path), SnapshotException);
+
+    writeFile(path, bytes);
+    HashSet<long long> wrongType;
+    EXPECT_THROW(wrongType.load(path), SnapshotException);
+
+    EXPECT_THROW(loaded.load(snapshotPath("missing")), SnapshotException);
+
+    // A failed load leaves the set as it was.
+    HashSet<int, FunctionHash<int>> untouched{identityHash};
+    untouched.add(-5);
+    EXPECT_THROW(untouched.load(snapshotPath("missing")), SnapshotException);
+    EXPECT_FALSE(untouched.isMapped());
+    EXPECT_TRUE(untouched.contains(-5));
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,587 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HashSet.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+
+    unsigned int zeroHash(const int&)
+    {
+        return 0;
+    }
+}
+
+
+TEST(HashSet_Test, sizeIsZeroWhenDefaultConstructed)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    EXPECT_TRUE(s.isImplemented());
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(1));
+}
+
+TEST(HashSet_Test, addedElementsAreContained)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(100, s.size());
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(100));
+}
+
+TEST(HashSet_Test, addingDuplicateHasNoEffect)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+    s.add(7);
+    s.add(7);
+
+    EXPECT_EQ(1, s.size());
+}
+
+TEST(HashSet_Test, resizesWhenLoadFactorWouldExceedEightTenths)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 8; ++i)
+    {
+        s.add(i);
+    }
+
+    // 8 of 10 cells is exactly 0.8, so the array hasn't grown yet.
+    EXPECT_TRUE(s.isElementAtIndex(0, 0));
+    EXPECT_EQ(0, s.elementsAtIndex(10));
+
+    s.add(10);
+
+    // The ninth element grows the array to 20 cells, so 10 lands at index 10.
+    EXPECT_TRUE(s.isElementAtIndex(10, 10));
+    EXPECT_EQ(1, s.elementsAtIndex(10));
+}
+
+TEST(HashSet_Test, collidingElementsShareAChain)
+{
+    HashSet<int, FunctionHash<int>> s{zeroHash};
+
+    for (int i = 0; i < 5; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(5, s.elementsAtIndex(0));
+    EXPECT_EQ(0, s.elementsAtIndex(1));
+    EXPECT_EQ(0, s.elementsAtIndex(1000));
+    EXPECT_FALSE(s.isElementAtIndex(0, 1000));
+}
+
+TEST(HashSet_Test, removedElementsAreNoLongerContained)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 8; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_TRUE(s.remove(3));
+    EXPECT_FALSE(s.remove(3));
+    EXPECT_FALSE(s.remove(100));
+
+    EXPECT_EQ(7, s.size());
+    EXPECT_FALSE(s.contains(3));
+    EXPECT_TRUE(s.contains(4));
+
+    s.add(3);
+    EXPECT_TRUE(s.contains(3));
+}
+
+TEST(HashSet_Test, removingFromTheMiddleOfAChainKeepsTheRest)
+{
+    HashSet<int, FunctionHash<int>> s{zeroHash};
+
+    for (int i = 0; i < 5; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_TRUE(s.remove(2));
+    EXPECT_TRUE(s.remove(4));
+    EXPECT_TRUE(s.remove(0));
+
+    EXPECT_EQ(2, s.elementsAtIndex(0));
+    EXPECT_TRUE(s.contains(1));
+    EXPECT_TRUE(s.contains(3));
+}
+
+TEST(HashSet_Test, shrinksWhenLoadFactorFallsBelowTwoTenths)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    // 100 elements take the array from 10 to 160 cells.
+    EXPECT_TRUE(s.isElementAtIndex(85, 85));
+
+    for (int i = 10; i < 100; ++i)
+    {
+        if (i != 85)
+        {
+            s.remove(i);
+        }
+    }
+
+    // Falling below 32 elements halves it to 80, and below 16 to 40, where
+    // 11 elements is back above the threshold.
+    EXPECT_EQ(11, s.size());
+    EXPECT_TRUE(s.isElementAtIndex(85, 5));
+
+    for (int i = 0; i < 10; ++i)
+    {
+        s.remove(i);
+    }
+
+    // It never shrinks below the default capacity.
+    EXPECT_TRUE(s.isElementAtIndex(85, 5));
+    EXPECT_EQ(1, s.elementsAtIndex(5));
+}
+
+TEST(HashSet_Test, clearRemovesEverythingButKeepsTheCapacity)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    s.clear();
+
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(5));
+
+    s.add(150);
+    EXPECT_TRUE(s.isElementAtIndex(150, 150));
+}
+
+TEST(HashSet_Test, canBeCopyConstructed_WithSeparateContents)
+{
+    HashSet<int, FunctionHash<int>> s1{identityHash};
+
+    for (int i = 0; i < 20; ++i)
+    {
+        s1.add(i);
+    }
+
+    HashSet<int, FunctionHash<int>> s2 = s1;
+    s2.add(100);
+
+    EXPECT_EQ(20, s1.size());
+    EXPECT_EQ(21, s2.size());
+    EXPECT_FALSE(s1.contains(100));
+    EXPECT_TRUE(s2.contains(19));
+}
+
+TEST(HashSet_Test, canBeMoveConstructed_LeavingOriginalEmpty)
+{
+    HashSet<int, FunctionHash<int>> s1{identityHash};
+    s1.add(1);
+    s1.add(2);
+
+    HashSet<int, FunctionHash<int>> s2 = std::move(s1);
+
+    EXPECT_EQ(0, s1.size());
+    EXPECT_FALSE(s1.contains(1));
+    EXPECT_EQ(2, s2.size());
+    EXPECT_TRUE(s2.contains(2));
+
+    s1.add(3);
+    EXPECT_TRUE(s1.contains(3));
+}
+
+TEST(HashSet_Test, canBeCopyAndMoveAssigned)
+{
+    HashSet<int, FunctionHash<int>> s1{identityHash};
+    HashSet<int, FunctionHash<int>> s2{identityHash};
+    s1.add(1);
+    s2.add(2);
+    s2.add(3);
+
+    s1 = s2;
+    EXPECT_EQ(2, s1.size());
+    EXPECT_TRUE(s1.contains(3));
+    EXPECT_FALSE(s1.contains(1));
+
+    HashSet<int, FunctionHash<int>> s3{identityHash};
+    s3.add(4);
+    s1 = std::move(s3);
+    EXPECT_EQ(1, s1.size());
+    EXPECT_TRUE(s1.contains(4));
+}
+
+TEST(HashSet_Test, findReturnsPointerToStoredElement)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+    s.add(42);
+
+    ASSERT_NE(nullptr, s.find(42));
+    EXPECT_EQ(42, *s.find(42));
+    EXPECT_EQ(nullptr, s.find(43));
+}
+
+TEST(HashSet_Test, transparentSetsAcceptStringViewsAndCharPointers)
+{
+    HashSet<std::string, StringHash, std::equal_to<>> s{StringHash{}};
+    s.add("alpha");
+    s.add("beta");
+
+    const char buffer[] = "alphabet";
+
+    EXPECT_TRUE(s.contains(std::string_view{buffer, 5}));
+    EXPECT_FALSE(s.contains(std::string_view{buffer, 4}));
+    EXPECT_TRUE(s.contains("beta"));
+    EXPECT_TRUE(s.contains(std::string{"beta"}));
+
+    const std::string* found = s.find(std::string_view{buffer, 5});
+    ASSERT_NE(nullptr, found);
+    EXPECT_EQ("alpha", *found);
+}
+
+TEST(HashSet_Test, stringHashAgreesAcrossKeyTypes)
+{
+    StringHash hash;
+
+    EXPECT_EQ(hash(std::string{"key"}), hash(std::string_view{"key"}));
+    EXPECT_EQ(hash(std::string{"key"}), hash("key"));
+}
+
+TEST(HashSet_Test, cachingPolicySkipsSmallTriviallyHashableKeys)
+{
+    EXPECT_FALSE(HashCachingPolicy<int>::value);
+    EXPECT_FALSE(HashCachingPolicy<double>::value);
+    EXPECT_FALSE(HashCachingPolicy<const char*>::value);
+    EXPECT_TRUE(HashCachingPolicy<std::string>::value);
+}
+
+TEST(HashSet_Test, cachedHashesAreReusedWhenResizing)
+{
+    unsigned int calls = 0;
+    HashSet<int, FunctionHash<int>, std::equal_to<int>, true> s{
+        [&calls](const int& element)
+        {
+            ++calls;
+            return static_cast<unsigned int>(element);
+        }};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    // One call per add(), even though the array was resized several times.
+    EXPECT_EQ(100, calls);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(s.isElementAtIndex(i, i));
+    }
+}
+
+TEST(HashSet_Test, uncachedHashesAreRecomputedWhenResizing)
+{
+    unsigned int calls = 0;
+    HashSet<int, FunctionHash<int>, std::equal_to<int>, false> s{
+        [&calls](const int& element)
+        {
+            ++calls;
+            return static_cast<unsigned int>(element);
+        }};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_GT(calls, 100);
+    EXPECT_TRUE(s.contains(99));
+}
+
+TEST(HashSet_Test, cachedHashesSkipComparisonsAgainstMismatchedHashes)
+{
+    unsigned int comparisons = 0;
+    auto countingEqual = [&comparisons](const std::string& a, const std::string& b)
+        {
+            ++comparisons;
+            return a == b;
+        };
+
+    HashSet<std::string, StringHash, std::function<bool(const std::string&, const std::string&)>, true> s{
+        StringHash{}, countingEqual};
+
+    for (int i = 0; i < 50; ++i)
+    {
+        s.add(std::to_string(i));
+    }
+
+    comparisons = 0;
+    EXPECT_TRUE(s.contains("17"));
+    EXPECT_EQ(1, comparisons);
+
+    comparisons = 0;
+    EXPECT_FALSE(s.contains("not there"));
+    EXPECT_EQ(0, comparisons);
+}
+
+TEST(HashSet_Test, copiesKeepCachedHashes)
+{
+    HashSet<std::string, StringHash, std::equal_to<>> s1{StringHash{}};
+
+    for (int i = 0; i < 30; ++i)
+    {
+        s1.add(std::to_string(i));
+    }
+
+    HashSet<std::string, StringHash, std::equal_to<>> s2 = s1;
+
+    for (int i = 0; i < 30; ++i)
+    {
+        EXPECT_TRUE(s2.contains(std::to_string(i)));
+    }
+}
+
+TEST(HashSet_Test, containsBatchAgreesWithContains)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    for (int i = 0; i < 1000; i += 3)
+    {
+        s.add(i);
+    }
+
+    // An odd count leaves a partial group at the end.
+    const std::size_t n = 1001;
+    int keys[n];
+    bool out[n];
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        keys[i] = static_cast<int>(i);
+    }
+
+    s.containsBatch(keys, n, out);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(s.contains(keys[i]), out[i]) << "key " << keys[i];
+    }
+}
+
+TEST(HashSet_Test, containsBatchOnEmptySetFindsNothing)
+{
+    HashSet<int, FunctionHash<int>> s1{identityHash};
+    HashSet<int, FunctionHash<int>> s2 = std::move(s1);
+
+    int keys[] = {1, 2, 3};
+    bool out[] = {true, true, true};
+
+    s1.containsBatch(keys, 3, out);
+
+    EXPECT_FALSE(out[0]);
+    EXPECT_FALSE(out[1]);
+    EXPECT_FALSE(out[2]);
+}
+
+TEST(HashSet_Test, addBatchAddsEveryElementOnceAndResizesLikeAdd)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    int elements[100];
+
+    for (int i = 0; i < 100; ++i)
+    {
+        elements[i] = i % 60;
+    }
+
+    s.addBatch(elements, 100);
+
+    EXPECT_EQ(60, s.size());
+
+    for (int i = 0; i < 60; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+        EXPECT_TRUE(s.isElementAtIndex(i, i));
+    }
+
+    EXPECT_FALSE(s.contains(60));
+}
+
+TEST(HashSet_Test, batchOperationsWorkWithCachedHashes)
+{
+    HashSet<std::string, StringHash, std::equal_to<>> s{StringHash{}};
+
+    std::string elements[] = {"a", "b", "c", "a"};
+    s.addBatch(elements, 4);
+
+    std::string keys[] = {"a", "z", "c"};
+    bool out[3];
+    s.containsBatch(keys, 3, out);
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(out[0]);
+    EXPECT_FALSE(out[1]);
+    EXPECT_TRUE(out[2]);
+}
+
+TEST(HashSet_Test, diagnosticsDescribeTheChains)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    // With 20 cells, 0..9 and 20..24 leave cells 0-4 with two elements,
+    // cells 5-9 with one, and cells 10-19 empty.
+    for (int i = 0; i < 10; ++i)
+    {
+        s.add(i);
+    }
+
+    for (int i = 20; i < 25; ++i)
+    {
+        s.add(i);
+    }
+
+    HashTableDiagnostics d = s.diagnostics();
+
+    EXPECT_EQ(15, d.size);
+    EXPECT_EQ(20, d.capacity);
+    ASSERT_EQ(3, d.chainLengths.size());
+    EXPECT_EQ(10, d.chainLengths[0]);
+    EXPECT_EQ(5, d.chainLengths[1]);
+    EXPECT_EQ(5, d.chainLengths[2]);
+    EXPECT_EQ(2, d.longestChain);
+    EXPECT_EQ(5, d.collisions);
+    EXPECT_NEAR(15 - 20 * (1 - std::pow(0.95, 15)), d.expectedCollisions, 1e-9);
+    EXPECT_GT(d.bytesPerValue, 0.0);
+    EXPECT_FALSE(d.seeded);
+}
+
+TEST(HashSet_Test, reseedsWhenKeysCollideModuloTheCapacity)
+{
+    HashSet<int, FunctionHash<int>> s{identityHash};
+
+    // Multiples of 10 * 2^10 share cell 0 at every capacity up to that
+    // many cells, so without a defense they'd form one long chain.
+    for (int i = 0; i < 200; ++i)
+    {
+        s.add(i * 10240);
+    }
+
+    HashTableDiagnostics d = s.diagnostics();
+
+    EXPECT_TRUE(d.seeded);
+    EXPECT_LT(d.longestChain, HashSet<int>::DEFAULT_CAPACITY);
+    EXPECT_EQ(200, s.size());
+
+    for (int i = 0; i < 200; ++i)
+    {
+        EXPECT_TRUE(s.contains(i * 10240));
+    }
+
+    EXPECT_FALSE(s.contains(5));
+
+    // Copies keep the seed, so they find everything too.
+    HashSet<int, FunctionHash<int>> copy{s};
+    EXPECT_TRUE(copy.contains(199 * 10240));
+    EXPECT_TRUE(copy.diagnostics().seeded);
+}
+
+TEST(HashSet_Test, identicalHashesStillWorkAfterReseeding)
+{
+    HashSet<int, FunctionHash<int>> s{zeroHash};
+
+    for (int i = 0; i < 40; ++i)
+    {
+        s.add(i);
+    }
+
+    HashTableDiagnostics d = s.diagnostics();
+
+    EXPECT_TRUE(d.seeded);
+    EXPECT_EQ(40, d.longestChain);
+    EXPECT_TRUE(s.contains(39));
+    EXPECT_TRUE(s.remove(39));
+    EXPECT_FALSE(s.contains(39));
+}
+
+TEST(HashSet_Test, buildAddsEveryElementOnceWithAnyNumberOfThreads)
+{
+    std::vector<int> elements;
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        elements.push_back(i % 3000);
+    }
+
+    for (unsigned int threads : {0u, 1u, 3u, 8u})
+    {
+        HashSet<int, FunctionHash<int>> s{identityHash};
+        s.add(-1);
+        s.build(elements.begin(), elements.end(), threads);
+
+        EXPECT_EQ(3001, s.size());
+        EXPECT_TRUE(s.contains(-1));
+
+        for (int i = 0; i < 3000; ++i)
+        {
+            ASSERT_TRUE(s.contains(i));
+        }
+
+        EXPECT_FALSE(s.contains(3000));
+    }
+}
+
+TEST(HashSet_Test, buildGrowsTheArrayOnceToFitTheWholeRange)
+{
+    std::vector<int> elements;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        elements.push_back(i);
+    }
+
+    HashSet<int, FunctionHash<int>> s{identityHash};
+    s.build(elements.begin(), elements.end(), 4);
+
+    // 100 elements need 160 cells, just as adding them one at a time would.
+    EXPECT_TRUE(s.isElementAtIndex(99, 99));
+    EXPECT_EQ(0, s.elementsAtIndex(150));
+}
+
+TEST(HashSet_Test, buildWorksWithCachedHashesAndMoreThreadsThanElements)
+{
+    std::vector<std::string> elements{"x", "y", "x"};
+
+    HashSet<std::string, StringHash, std::equal_to<>> s{StringHash{}};
+    s.build(elements.begin(), elements.end(), 16);
+
+    EXPECT_EQ(2, s.size());
+    EXPECT_TRUE(s.contains("x"));
+    EXPECT_TRUE(s.contains("y"));
+}
@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "CompactHashSet.hpp"
+#include "HashMap.hpp"
+#include "HashSet.hpp"
+#include "Hashing.hpp"
+
+namespace
+{
+    // avalancheBias() flips each bit of many random keys of the given
+    // length, and returns the largest amount by which the probability of
+    // any output bit flipping strays from 1/2.
+    template <typename HashFunction>
+    double avalancheBias(HashFunction hash, unsigned int outputBits, std::size_t length, unsigned int samples)
+    {
+        std::mt19937_64 random{length};
+        std::vector<unsigned int> flips(length * 8 * outputBits, 0);
+        std::vector<unsigned char> key(length);
+
+        for (unsigned int sample = 0; sample < samples; ++sample)
+        {
+            for (unsigned char& byte : key)
+            {
+                byte = static_cast<unsigned char>(random());
+            }
+
+            std::uint64_t original = hash(key);
+
+            for (std::size_t bit = 0; bit < length * 8; ++bit)
+            {
+                key[bit / 8] ^= 1 << (bit % 8);
+                std::uint64_t changed = original ^ hash(key);
+                key[bit / 8] ^= 1 << (bit % 8);
+
+                for (unsigned int out = 0; out < outputBits; ++out)
+                {
+                    flips[bit * outputBits + out] += (changed >> out) & 1;
+                }
+            }
+        }
+
+        double worst = 0.0;
+
+        for (unsigned int count : flips)
+        {
+            worst = std::max(worst, std::abs(static_cast<double>(count) / samples - 0.5));
+        }
+
+        return worst;
+    }
+
+
+    // chiSquaredRatio() distributes the hashes among the given number of
+    // buckets (by taking the remainder, as HashSet does) and returns the
+    // chi-squared statistic divided by its expected value; a uniform
+    // distribution gives about 1.
+    double chiSquaredRatio(const std::vector<unsigned int>& hashes, unsigned int buckets)
+    {
+        std::vector<unsigned int> counts(buckets, 0);
+
+        for (unsigned int hash : hashes)
+        {
+            ++counts[hash % buckets];
+        }
+
+        double expected = static_cast<double>(hashes.size()) / buckets;
+        double chiSquared = 0.0;
+
+        for (unsigned int count : counts)
+        {
+            chiSquared += (count - expected) * (count - expected) / expected;
+        }
+
+        return chiSquared / (buckets - 1);
+    }
+
+
+    template <typename Key>
+    std::vector<unsigned int> integerHashes(Key first, Key stride, unsigned int count)
+    {
+        std::vector<unsigned int> hashes;
+        IntegerHash hash;
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            hashes.push_back(hash(first + stride * i));
+        }
+
+        return hashes;
+    }
+}
+
+
+TEST(Hashing_Test, crc32cMatchesTheStandardCheckValue)
+{
+    EXPECT_EQ(0xE3069283u, crc32c("123456789", 9));
+    EXPECT_EQ(0u, crc32c("", 0));
+}
+
+TEST(Hashing_Test, crc32cAgreesWithThePortableVersionAndCanBeChained)
+{
+    std::mt19937 random{46};
+    std::vector<unsigned char> data(300);
+
+    for (unsigned char& byte : data)
+    {
+        byte = static_cast<unsigned char>(random());
+    }
+
+    for (std::size_t length = 0; length <= data.size(); ++length)
+    {
+        std::uint32_t whole = crc32c(data.data(), length);
+        ASSERT_EQ(HashingDetail::crc32cPortable(data.data(), length, 0), whole);
+        ASSERT_EQ(whole, crc32c(data.data() + length / 3, length - length / 3, crc32c(data.data(), length / 3)));
+    }
+}
+
+TEST(Hashing_Test, hashBytesDependsOnLengthAndSeed)
+{
+    const char zeroes[32] = {};
+
+    for (std::size_t length = 0; length < 32; ++length)
+    {
+        EXPECT_NE(hashBytes(zeroes, length), hashBytes(zeroes, length + 1));
+    }
+
+    EXPECT_NE(hashBytes("key", 3, 1), hashBytes("key", 3, 2));
+    EXPECT_EQ(hashBytes("key", 3, 1), hashBytes("key", 3, 1));
+}
+
+TEST(Hashing_Test, hashBytesAvalanches)
+{
+    auto hash = [](const std::vector<unsigned char>& key) { return hashBytes(key.data(), key.size()); };
+
+    // Lengths chosen to cover each of hashBytes()'s code paths.  (One-byte
+    // keys are left out; with only 256 of them, the sample is too small
+    // for this tolerance.)
+    for (std::size_t length : {2, 3, 4, 8, 13, 16, 17, 40, 49, 100})
+    {
+        EXPECT_LT(avalancheBias(hash, 64, length, 2000), 0.06) << "length " << length;
+    }
+}
+
+TEST(Hashing_Test, integerHashAvalanches)
+{
+    auto hash = [](const std::vector<unsigned char>& key)
+    {
+        std::uint64_t value;
+        std::memcpy(&value, key.data(), sizeof(value));
+        return IntegerHash{}(value);
+    };
+
+    EXPECT_LT(avalancheBias(hash, 32, 8, 2000), 0.06);
+}
+
+TEST(Hashing_Test, integerHashSpreadsStructuredKeysUniformly)
+{
+    // Sequential keys, keys with a power-of-two stride, and keys that differ
+    // only in their high bits, into both prime and power-of-two numbers of
+    // buckets.
+    for (unsigned int buckets : {1009u, 1024u})
+    {
+        EXPECT_LT(chiSquaredRatio(integerHashes<std::uint64_t>(0, 1, 100000), buckets), 1.3);
+        EXPECT_LT(chiSquaredRatio(integerHashes<std::uint64_t>(0, 4096, 100000), buckets), 1.3);
+        EXPECT_LT(chiSquaredRatio(integerHashes<std::uint64_t>(0, std::uint64_t{1} << 40, 100000), buckets), 1.3);
+        EXPECT_LT(chiSquaredRatio(integerHashes<int>(-50000, 1, 100000), buckets), 1.3);
+    }
+}
+
+TEST(Hashing_Test, stringHashSpreadsSimilarKeysUniformly)
+{
+    std::vector<unsigned int> hashes;
+    std::vector<unsigned int> crcHashes;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        std::string key = "key" + std::to_string(i);
+        hashes.push_back(StringHash{}(key));
+        crcHashes.push_back(Crc32cHash{}(key));
+    }
+
+    for (unsigned int buckets : {1009u, 1024u})
+    {
+        EXPECT_LT(chiSquaredRatio(hashes, buckets), 1.3);
+        EXPECT_LT(chiSquaredRatio(crcHashes, buckets), 1.3);
+    }
+}
+
+TEST(Hashing_Test, defaultHashesAreUsedWhenNoneIsGiven)
+{
+    HashSet<int> integers;
+    HashSet<std::string> strings;
+    HashMap<const int*, int> pointers;
+    CompactHashSet<long long> compact;
+    std::vector<int> targets(1000);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        integers.add(i);
+        strings.add(std::to_string(i));
+        pointers.insert_or_assign(&targets[i], i);
+        compact.add(i * 1000000007LL);
+    }
+
+    EXPECT_EQ(1000, integers.size());
+    EXPECT_TRUE(integers.contains(999));
+    EXPECT_TRUE(strings.contains("500"));
+    EXPECT_EQ(1000, pointers.size());
+    EXPECT_TRUE(compact.contains(7 * 1000000007LL));
+    EXPECT_LE(integers.diagnostics().longestChain, 6);
+}
+
+
+TEST(Hashing_Test, defaultHashIsTheDefaultHashTypeAndFunctionHashTakesLambdas)
+{
+    EXPECT_TRUE((std::is_same<DefaultHash<int>, HashSet<int>::HashFunction>::value));
+    EXPECT_TRUE((std::is_same<DefaultHash<std::string>, HashMap<std::string, int>::HashFunction>::value));
+
+    HashSet<int, FunctionHash<int>> collisions{[](const int&) { return 0u; }};
+    HashSet<int, FunctionHash<int>> defaulted;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        collisions.add(i);
+        defaulted.add(i);
+    }
+
+    EXPECT_EQ(100, collisions.size());
+    EXPECT_TRUE(collisions.contains(42));
+    EXPECT_EQ(100, collisions.diagnostics().longestChain);
+    EXPECT_TRUE(defaulted.contains(42));
+    EXPECT_LE(defaulted.diagnostics().longestChain, 6);
+}
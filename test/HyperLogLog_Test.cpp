@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "HashSet.hpp"
+#include "HyperLogLog.hpp"
+
+namespace
+{
+    double relativeError(double estimate, double exact)
+    {
+        return std::abs(estimate - exact) / exact;
+    }
+}
+
+
+TEST(HyperLogLog_Test, emptySketchesEstimateZero)
+{
+    HyperLogLog<int> h;
+    EXPECT_EQ(0.0, h.estimate());
+    EXPECT_TRUE(h.isSparse());
+    EXPECT_EQ(0, h.sizeInBytes());
+}
+
+TEST(HyperLogLog_Test, smallCardinalitiesAreNearlyExactWhileSparse)
+{
+    HyperLogLog<int> h;
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        h.add(i);
+        h.add(i);
+    }
+
+    EXPECT_TRUE(h.isSparse());
+    EXPECT_LT(relativeError(h.estimate(), 2000), 0.001);
+}
+
+TEST(HyperLogLog_Test, becomesDenseOnceSparseEntriesOutgrowTheRegisters)
+{
+    HyperLogLog<int> h{10};
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        h.add(i);
+    }
+
+    EXPECT_FALSE(h.isSparse());
+    EXPECT_EQ(1024, h.sizeInBytes());
+    EXPECT_LT(relativeError(h.estimate(), 10000), 4 * HyperLogLog<int>::standardError(10));
+}
+
+// The estimates are compared against the exact size of a HashSet holding
+// the same elements, across precisions and cardinalities that cover the
+// sparse, transitional, and dense ranges.  Each should be within four
+// standard errors (the hashes are deterministic, so this can't be flaky).
+TEST(HyperLogLog_Test, estimatesAreWithinTheExpectedErrorOfExactSizes)
+{
+    for (unsigned int precision : {8u, 11u, 14u})
+    {
+        HyperLogLog<unsigned int> h{precision};
+        HashSet<unsigned int> exact;
+        unsigned int next = 0;
+
+        for (unsigned int target : {100u, 1000u, 10000u, 100000u, 400000u})
+        {
+            for (; next < target; ++next)
+            {
+                h.add(next * 7919u);
+                exact.add(next * 7919u);
+            }
+
+            ASSERT_LT(relativeError(h.estimate(), exact.size()), 4 * HyperLogLog<unsigned int>::standardError(precision))
+                << "precision " << precision << ", " << target << " elements";
+        }
+    }
+}
+
+TEST(HyperLogLog_Test, mergingGivesTheSameSketchAsAddingEverything)
+{
+    for (int secondSize : {50, 5000})
+    {
+        HyperLogLog<int> first{12};
+        HyperLogLog<int> second{12};
+        HyperLogLog<int> both{12};
+
+        for (int i = 0; i < 3000; ++i)
+        {
+            first.add(i);
+            both.add(i);
+        }
+
+        for (int i = 2000; i < 2000 + secondSize; ++i)
+        {
+            second.add(i);
+            both.add(i);
+        }
+
+        HyperLogLog<int> merged = first;
+        merged.merge(second);
+        HyperLogLog<int> mergedTheOtherWay = second;
+        mergedTheOtherWay.merge(first);
+
+        EXPECT_EQ(both.isSparse(), merged.isSparse());
+        EXPECT_EQ(both.toBytes(), merged.toBytes());
+        EXPECT_EQ(both.toBytes(), mergedTheOtherWay.toBytes());
+    }
+}
+
+TEST(HyperLogLog_Test, mergingASketchWithItselfChangesNothing)
+{
+    for (int size : {50, 5000})
+    {
+        HyperLogLog<int> sketch{12};
+
+        for (int i = 0; i < size; ++i)
+        {
+            sketch.add(i);
+        }
+
+        std::vector<std::uint8_t> before = sketch.toBytes();
+        sketch.merge(sketch);
+
+        EXPECT_EQ(before, sketch.toBytes());
+    }
+}
+
+TEST(HyperLogLog_Test, sketchesBuiltOnSeparateThreadsCanBeMerged)
+{
+    constexpr unsigned int THREADS = 4;
+    std::vector<HyperLogLog<unsigned int>> sketches(THREADS);
+    std::vector<std::thread> threads;
+
+    for (unsigned int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back(
+            [&sketches, t]
+            {
+                for (unsigned int i = t; i < 200000; i += THREADS)
+                {
+                    sketches[t].add(i);
+                }
+            });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (unsigned int t = 1; t < THREADS; ++t)
+    {
+        sketches[0].merge(sketches[t]);
+    }
+
+    EXPECT_LT(relativeError(sketches[0].estimate(), 200000), 4 * HyperLogLog<unsigned int>::standardError(14));
+}
+
+TEST(HyperLogLog_Test, sketchesWithDifferentPrecisionsCannotBeMerged)
+{
+    HyperLogLog<int> a{10};
+    HyperLogLog<int> b{11};
+
+    EXPECT_THROW(a.merge(b), HyperLogLogException);
+    EXPECT_THROW(HyperLogLog<int>{3}, HyperLogLogException);
+    EXPECT_THROW(HyperLogLog<int>{19}, HyperLogLogException);
+}
+
+TEST(HyperLogLog_Test, bytesRoundTrip)
+{
+    HyperLogLog<int> sparse{12};
+    HyperLogLog<int> dense{12};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        sparse.add(i);
+    }
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        dense.add(i);
+    }
+
+    for (const HyperLogLog<int>* h : {&sparse, &dense})
+    {
+        std::vector<std::uint8_t> bytes = h->toBytes();
+        HyperLogLog<int> copy = HyperLogLog<int>::fromBytes(bytes.data(), bytes.size());
+
+        EXPECT_EQ(h->isSparse(), copy.isSparse());
+        EXPECT_EQ(h->estimate(), copy.estimate());
+        EXPECT_EQ(bytes, copy.toBytes());
+    }
+}
+
+TEST(HyperLogLog_Test, invalidBytesAreRejected)
+{
+    HyperLogLog<int> h{8};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        h.add(i);
+    }
+
+    std::vector<std::uint8_t> bytes = h.toBytes();
+
+    std::vector<std::uint8_t> truncated{bytes.begin(), bytes.end() - 1};
+    EXPECT_THROW(HyperLogLog<int>::fromBytes(truncated.data(), truncated.size()), HyperLogLogException);
+
+    std::vector<std::uint8_t> wrongMagic = bytes;
+    wrongMagic[0] = 'X';
+    EXPECT_THROW(HyperLogLog<int>::fromBytes(wrongMagic.data(), wrongMagic.size()), HyperLogLogException);
+
+    std::vector<std::uint8_t> wrongPrecision = bytes;
+    wrongPrecision[4] = 30;
+    EXPECT_THROW(HyperLogLog<int>::fromBytes(wrongPrecision.data(), wrongPrecision.size()), HyperLogLogException);
+
+    std::vector<std::uint8_t> unsorted = bytes;
+    std::swap_ranges(unsorted.begin() + 10, unsorted.begin() + 14, unsorted.begin() + 14);
+    EXPECT_THROW(HyperLogLog<int>::fromBytes(unsorted.data(), unsorted.size()), HyperLogLogException);
+}
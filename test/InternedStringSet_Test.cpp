@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InternedStringSet.hpp"
+
+
+TEST(InternedStringSet_Test, emptySetsHaveSizeZero)
+{
+    InternedStringSet s;
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains("anything"));
+    EXPECT_EQ(InternedStringSet::NOT_FOUND, s.find(""));
+}
+
+TEST(InternedStringSet_Test, internGivesConsecutiveIdsToNewStrings)
+{
+    InternedStringSet s;
+
+    EXPECT_EQ(0, s.intern("alpha"));
+    EXPECT_EQ(1, s.intern("beta"));
+    EXPECT_EQ(0, s.intern("alpha"));
+    EXPECT_EQ(2, s.intern(""));
+    EXPECT_EQ(2, s.intern(""));
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_EQ(1, s.find("beta"));
+    EXPECT_EQ(InternedStringSet::NOT_FOUND, s.find("gamma"));
+}
+
+TEST(InternedStringSet_Test, containsStringsAfterAdding)
+{
+    InternedStringSet s;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        s.add("id" + std::to_string(i));
+    }
+
+    EXPECT_EQ(100000, s.size());
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        ASSERT_TRUE(s.contains("id" + std::to_string(i)));
+        ASSERT_FALSE(s.contains("di" + std::to_string(i)));
+    }
+}
+
+TEST(InternedStringSet_Test, viewsReturnTheInternedCharacters)
+{
+    InternedStringSet s;
+    std::vector<InternedStringSet::Id> ids;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ids.push_back(s.intern(std::string(i % 300, 'a' + i % 26)));
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(std::string(i % 300, 'a' + i % 26), s.view(ids[i]));
+    }
+}
+
+TEST(InternedStringSet_Test, viewsRemainValidAsTheSetGrows)
+{
+    InternedStringSet s;
+    std::string_view first = s.view(s.intern("first"));
+
+    // Enough strings to fill several chunks of the arena and grow the table
+    // many times.
+    for (int i = 0; i < 300000; ++i)
+    {
+        s.intern("string number " + std::to_string(i));
+    }
+
+    EXPECT_EQ("first", first);
+    EXPECT_EQ(0, s.find("first"));
+}
+
+TEST(InternedStringSet_Test, stringsLongerThanAChunkAreStored)
+{
+    InternedStringSet s;
+    std::string huge(InternedStringSet::CHUNK_SIZE * 2 + 5, 'x');
+
+    InternedStringSet::Id small = s.intern("small");
+    InternedStringSet::Id big = s.intern(huge);
+    InternedStringSet::Id after = s.intern("after");
+
+    EXPECT_EQ(huge, s.view(big));
+    EXPECT_EQ("small", s.view(small));
+    EXPECT_EQ("after", s.view(after));
+    EXPECT_EQ(big, s.find(huge));
+}
+
+TEST(InternedStringSet_Test, stringsMayContainNulCharacters)
+{
+    InternedStringSet s;
+    std::string withNul{"a\0b", 3};
+
+    s.intern(withNul);
+
+    EXPECT_TRUE(s.contains(withNul));
+    EXPECT_FALSE(s.contains("a"));
+    EXPECT_EQ(withNul, s.view(0));
+}
+
+TEST(InternedStringSet_Test, copiesKeepTheSameIdsAndAreIndependent)
+{
+    InternedStringSet s;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.intern(std::to_string(i));
+    }
+
+    InternedStringSet copy{s};
+    copy.intern("new");
+    s.intern("other");
+
+    EXPECT_EQ(1001, copy.size());
+    EXPECT_EQ(500, copy.find("500"));
+    EXPECT_EQ("500", copy.view(500));
+    EXPECT_TRUE(copy.contains("new"));
+    EXPECT_FALSE(copy.contains("other"));
+}
+
+TEST(InternedStringSet_Test, movedFromSetsAreEmptyAndUsable)
+{
+    InternedStringSet s;
+    s.intern("alpha");
+
+    InternedStringSet moved{std::move(s)};
+    EXPECT_EQ(0, moved.find("alpha"));
+
+    EXPECT_EQ(InternedStringSet::NOT_FOUND, s.find("alpha"));
+    EXPECT_EQ(0, s.intern("beta"));
+    EXPECT_EQ("beta", s.view(0));
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "Parallel.hpp"
+
+
+TEST(Parallel_Test, everyPieceRunsOnce)
+{
+    for (unsigned int threads : {0u, 1u, 4u})
+    {
+        std::vector<std::atomic<int>> runs(threads != 0 ? threads : 1);
+
+        runOnThreads(threads, [&runs](unsigned int t) { ++runs[t]; });
+
+        for (std::atomic<int>& count : runs)
+        {
+            EXPECT_EQ(1, count.load());
+        }
+    }
+}
+
+TEST(Parallel_Test, exceptionsAreRethrownAfterEveryPieceFinishes)
+{
+    std::atomic<int> finished{0};
+
+    EXPECT_THROW(
+        runOnThreads(4,
+            [&finished](unsigned int t)
+            {
+                if (t == 1)
+                {
+                    throw std::runtime_error{"piece 1 failed"};
+                }
+
+                ++finished;
+            }),
+        std::runtime_error);
+
+    EXPECT_EQ(3, finished.load());
+}
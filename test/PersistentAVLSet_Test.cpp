@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <set>
+#include <thread>
+#include <vector>
+#include "Hashing.hpp"
+#include "PersistentAVLSet.hpp"
+
+namespace
+{
+    template <typename T>
+    std::vector<T> elementsOf(const PersistentAVLSet<T>& s)
+    {
+        std::vector<T> elements;
+        s.inorder([&elements](const T& element) { elements.push_back(element); });
+        return elements;
+    }
+
+
+    // A CountedInt counts how many times any CountedInt has been copied,
+    // which shows how many nodes a change to a set rebuilt.
+    struct CountedInt
+    {
+        static unsigned int copies;
+
+        CountedInt(int value)
+            : value{value}
+        {
+        }
+
+        CountedInt(const CountedInt& other)
+            : value{other.value}
+        {
+            ++copies;
+        }
+
+        bool operator<(const CountedInt& other) const
+        {
+            return value < other.value;
+        }
+
+        int value;
+    };
+
+    unsigned int CountedInt::copies = 0;
+}
+
+
+TEST(PersistentAVLSet_Test, containsElementsAfterAdding)
+{
+    PersistentAVLSet<int> s;
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(-1, s.height());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+        s.add(i);
+    }
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_EQ(9, s.height());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(-1));
+    EXPECT_FALSE(s.contains(1000));
+}
+
+
+TEST(PersistentAVLSet_Test, snapshotsAreUnaffectedByLaterChanges)
+{
+    PersistentAVLSet<int> s;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        s.add(i);
+    }
+
+    PersistentAVLSet<int> before = s.snapshot();
+
+    EXPECT_TRUE(s.remove(3));
+    EXPECT_FALSE(s.remove(3));
+    s.add(20);
+
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), elementsOf(before));
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 4, 5, 6, 7, 8, 9, 20}), elementsOf(s));
+
+    before.add(-1);
+    EXPECT_FALSE(s.contains(-1));
+
+    PersistentAVLSet<int> cleared = s;
+    cleared.clear();
+    EXPECT_EQ(0, cleared.size());
+    EXPECT_EQ(10, s.size());
+    EXPECT_EQ(11, before.size());
+}
+
+
+TEST(PersistentAVLSet_Test, everyVersionAgreesWithStdSet)
+{
+    PersistentAVLSet<int> s;
+    std::set<int> expected;
+
+    std::vector<PersistentAVLSet<int>> versions;
+    std::vector<std::set<int>> expectedVersions;
+
+    for (unsigned int i = 0; i < 20000; ++i)
+    {
+        int element = static_cast<int>(mix64(i) % 2000);
+
+        if (mix64(i + 1000000) % 3 == 0)
+        {
+            EXPECT_EQ(expected.erase(element) == 1, s.remove(element));
+        }
+        else
+        {
+            s.add(element);
+            expected.insert(element);
+        }
+
+        if (i % 1000 == 0)
+        {
+            versions.push_back(s.snapshot());
+            expectedVersions.push_back(expected);
+        }
+    }
+
+    versions.push_back(s);
+    expectedVersions.push_back(expected);
+
+    for (std::size_t v = 0; v < versions.size(); ++v)
+    {
+        ASSERT_EQ(expectedVersions[v].size(), versions[v].size());
+        EXPECT_EQ((std::vector<int>{expectedVersions[v].begin(), expectedVersions[v].end()}), elementsOf(versions[v]));
+        EXPECT_LE(versions[v].height(), 1.4405 * std::log2(expectedVersions[v].size() + 2.0) - 0.3277);
+    }
+}
+
+
+TEST(PersistentAVLSet_Test, changesRebuildOnlyALogarithmicNumberOfNodes)
+{
+    PersistentAVLSet<CountedInt> s;
+
+    for (int i = 0; i < 100000; i += 2)
+    {
+        s.add(i);
+    }
+
+    // A path is at most height() + 1 nodes, and a rotation rebuilds at
+    // most two more.
+    unsigned int limit = 2 * (s.height() + 3);
+
+    PersistentAVLSet<CountedInt> snapshot = s.snapshot();
+
+    for (int i = 1; i < 2000; i += 2)
+    {
+        CountedInt::copies = 0;
+        s.add(i);
+        EXPECT_LE(CountedInt::copies, limit);
+
+        CountedInt::copies = 0;
+        EXPECT_TRUE(s.remove(i - 1));
+        EXPECT_LE(CountedInt::copies, limit);
+    }
+
+    CountedInt::copies = 0;
+    s.add(1);
+    EXPECT_FALSE(s.remove(0));
+    EXPECT_EQ(0, CountedInt::copies);
+
+    EXPECT_EQ(50000, snapshot.size());
+    EXPECT_EQ(50000, s.size());
+}
+
+
+TEST(PersistentAVLSet_Test, readersSeeConsistentSnapshotsWhileWriterAdds)
+{
+    PersistentAVLSet<int> s;
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < 3; ++r)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                while (!done.load())
+                {
+                    // The writer adds 0, 1, 2, ... in order, so every
+                    // version holds exactly 0 through its size minus one.
+                    PersistentAVLSet<int> snapshot = s.snapshot();
+                    int next = 0;
+
+                    snapshot.inorder([&next](const int& element) { next += element == next ? 1 : 1000000000; });
+
+                    if (next != static_cast<int>(snapshot.size()))
+                    {
+                        consistent = false;
+                    }
+                }
+            });
+    }
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        s.add(i);
+    }
+
+    done = true;
+
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_TRUE(consistent.load());
+    EXPECT_EQ(20000, s.size());
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include "SetAlgebra.hpp"
+
+namespace
+{
+    unsigned int identityHash(const int& element)
+    {
+        return static_cast<unsigned int>(element);
+    }
+
+
+    // multiplesOf() returns the multiples of step in [0, limit).
+    std::vector<int> multiplesOf(int step, int limit)
+    {
+        std::vector<int> multiples;
+
+        for (int i = 0; i < limit; i += step)
+        {
+            multiples.push_back(i);
+        }
+
+        return multiples;
+    }
+
+
+    template <typename SetType>
+    void addAll(SetType& s, const std::vector<int>& elements)
+    {
+        for (int element : elements)
+        {
+            s.add(element);
+        }
+    }
+
+
+    std::vector<int> sorted(std::vector<int> elements)
+    {
+        std::sort(elements.begin(), elements.end());
+        return elements;
+    }
+
+
+    std::vector<int> expectedIntersection(const std::vector<int>& a, const std::vector<int>& b)
+    {
+        std::vector<int> result;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        return result;
+    }
+
+
+    std::vector<int> expectedUnion(const std::vector<int>& a, const std::vector<int>& b)
+    {
+        std::vector<int> result;
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        return result;
+    }
+
+
+    std::vector<int> expectedDifference(const std::vector<int>& a, const std::vector<int>& b)
+    {
+        std::vector<int> result;
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        return result;
+    }
+}
+
+
+TEST(SetAlgebra_Test, emptySetsCombineToEmptyResults)
+{
+    AVLSet<int> a;
+    HashSet<int, FunctionHash<int>> b{identityHash};
+
+    EXPECT_TRUE(setIntersection(a, b).empty());
+    EXPECT_TRUE(setUnion(a, b).empty());
+    EXPECT_TRUE(setDifference(a, b).empty());
+}
+
+TEST(SetAlgebra_Test, orderedSetsOfSimilarSizesAreMergedInOrder)
+{
+    std::vector<int> aElements = multiplesOf(2, 3000);
+    std::vector<int> bElements = multiplesOf(3, 3000);
+    AVLSet<int> a;
+    SkipListSet<int> b;
+    addAll(a, aElements);
+    addAll(b, bElements);
+
+    EXPECT_EQ(expectedIntersection(aElements, bElements), setIntersection(a, b));
+    EXPECT_EQ(expectedUnion(aElements, bElements), setUnion(a, b));
+    EXPECT_EQ(expectedDifference(aElements, bElements), setDifference(a, b));
+    EXPECT_EQ(expectedDifference(bElements, aElements), setDifference(b, a));
+}
+
+// The size ratios here cover galloping (16x) and probing (200x), in both
+// directions, since setDifference() isn't symmetric.
+TEST(SetAlgebra_Test, orderedSetsOfVeryDifferentSizesGiveTheSameResults)
+{
+    for (int step : {16, 200})
+    {
+        std::vector<int> largeElements = multiplesOf(1, 20000);
+        std::vector<int> smallElements = multiplesOf(step, 20000 + 10 * step);
+        smallElements.push_back(-1);
+        smallElements = sorted(smallElements);
+
+        AVLSet<int> large;
+        AVLSet<int> small;
+        addAll(large, largeElements);
+        addAll(small, smallElements);
+
+        EXPECT_EQ(expectedIntersection(smallElements, largeElements), setIntersection(small, large));
+        EXPECT_EQ(expectedIntersection(smallElements, largeElements), setIntersection(large, small));
+        EXPECT_EQ(expectedUnion(smallElements, largeElements), setUnion(large, small));
+        EXPECT_EQ(expectedDifference(smallElements, largeElements), setDifference(small, large));
+        EXPECT_EQ(expectedDifference(largeElements, smallElements), setDifference(large, small));
+    }
+}
+
+TEST(SetAlgebra_Test, hashSetsAreProbed)
+{
+    std::vector<int> aElements = multiplesOf(2, 5000);
+    std::vector<int> bElements = multiplesOf(5, 1000);
+    HashSet<int, FunctionHash<int>> a{identityHash};
+    HashSet<int, FunctionHash<int>> b{identityHash};
+    addAll(a, aElements);
+    addAll(b, bElements);
+
+    EXPECT_EQ(expectedIntersection(aElements, bElements), sorted(setIntersection(a, b)));
+    EXPECT_EQ(expectedUnion(aElements, bElements), sorted(setUnion(a, b)));
+    EXPECT_EQ(expectedDifference(aElements, bElements), sorted(setDifference(a, b)));
+    EXPECT_EQ(expectedDifference(bElements, aElements), sorted(setDifference(b, a)));
+}
+
+TEST(SetAlgebra_Test, hashSetsAndOrderedSetsCanBeMixed)
+{
+    std::vector<int> aElements = multiplesOf(3, 6000);
+    std::vector<int> bElements = multiplesOf(4, 2000);
+    SkipListSet<int> a;
+    HashSet<int, FunctionHash<int>> b{identityHash};
+    addAll(a, aElements);
+    addAll(b, bElements);
+
+    EXPECT_EQ(expectedIntersection(aElements, bElements), sorted(setIntersection(a, b)));
+    EXPECT_EQ(expectedUnion(aElements, bElements), sorted(setUnion(b, a)));
+    EXPECT_EQ(expectedDifference(aElements, bElements), setDifference(a, b));
+    EXPECT_EQ(expectedDifference(bElements, aElements), sorted(setDifference(b, a)));
+}
+
+TEST(SetAlgebra_Test, parallelResultsMatchSequentialOnes)
+{
+    std::vector<int> aElements = multiplesOf(2, 200000);
+    std::vector<int> bElements = multiplesOf(7, 100000);
+    AVLSet<int> a;
+    AVLSet<int> b;
+    HashSet<int, FunctionHash<int>> h{identityHash};
+    addAll(a, aElements);
+    addAll(b, bElements);
+    addAll(h, bElements);
+
+    for (unsigned int threads : {2u, 3u, 8u})
+    {
+        EXPECT_EQ(expectedIntersection(aElements, bElements), setIntersection(a, b, threads));
+        EXPECT_EQ(expectedUnion(aElements, bElements), setUnion(a, b, threads));
+        EXPECT_EQ(expectedDifference(aElements, bElements), setDifference(a, b, threads));
+        EXPECT_EQ(expectedDifference(aElements, bElements), setDifference(a, h, threads));
+        EXPECT_EQ(expectedUnion(aElements, bElements), sorted(setUnion(a, h, threads)));
+    }
+}
+
+TEST(SetAlgebra_Test, gallopFindsTheFirstElementNotLessThanTheKey)
+{
+    std::vector<int> elements = multiplesOf(2, 200);
+
+    for (int key = -1; key <= 201; ++key)
+    {
+        for (std::size_t start : {0, 1, 7, 50, 99})
+        {
+            const int* first = elements.data() + start;
+            const int* last = elements.data() + elements.size();
+
+            ASSERT_EQ(std::lower_bound(first, last, key), SetAlgebraDetail::gallop(first, last, key));
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "SkipListSet.hpp"
+
+namespace
+{
+    // A ScriptedLevelTester answers the coin flips from a fixed script,
+    // and then always answers "no" once the script runs out.
+    class ScriptedLevelTester : public SkipListLevelTester
+    {
+    public:
+        ScriptedLevelTester(std::vector<bool> script)
+            : script{script}, next{0}
+        {
+        }
+
+        virtual bool shouldOccupyNextLevel() override
+        {
+            return next < script.size() && script[next++];
+        }
+
+        virtual std::unique_ptr<SkipListLevelTester> clone() override
+        {
+            return std::unique_ptr<SkipListLevelTester>{new ScriptedLevelTester{script}};
+        }
+
+    private:
+        std::vector<bool> script;
+        std::size_t next;
+    };
+}
+
+
+TEST(SkipListSet_Test, emptySetHasOneLevelWithOnlyInfinities)
+{
+    SkipListSet<int> s;
+
+    EXPECT_TRUE(s.isImplemented());
+    EXPECT_EQ(0, s.size());
+    EXPECT_EQ(1, s.levelCount());
+    EXPECT_EQ(2, s.nodesOnLevel(0));
+    EXPECT_EQ(0, s.nodesOnLevel(1));
+    EXPECT_FALSE(s.contains(0));
+}
+
+TEST(SkipListSet_Test, addedElementsAreContained)
+{
+    SkipListSet<int> s;
+
+    for (int i = 0; i < 500; i += 5)
+    {
+        s.add(i);
+    }
+
+    s.add(0);
+    EXPECT_EQ(100, s.size());
+    EXPECT_EQ(102, s.nodesOnLevel(0));
+
+    for (int i = 0; i < 500; ++i)
+    {
+        EXPECT_EQ(i % 5 == 0, s.contains(i));
+    }
+}
+
+TEST(SkipListSet_Test, coinFlipsDecideLevels)
+{
+    // 10 occupies levels 0-2; 20 occupies only level 0; 30 occupies 0-1.
+    SkipListSet<int> s{std::make_unique<ScriptedLevelTester>(
+        std::vector<bool>{true, true, false, false, true, false})};
+
+    s.add(10);
+    s.add(20);
+    s.add(30);
+
+    EXPECT_EQ(3, s.levelCount());
+    EXPECT_EQ(5, s.nodesOnLevel(0));
+    EXPECT_EQ(4, s.nodesOnLevel(1));
+    EXPECT_EQ(3, s.nodesOnLevel(2));
+
+    EXPECT_TRUE(s.isElementOnLevel(10, 2));
+    EXPECT_FALSE(s.isElementOnLevel(20, 1));
+    EXPECT_TRUE(s.isElementOnLevel(30, 1));
+    EXPECT_FALSE(s.isElementOnLevel(30, 2));
+    EXPECT_FALSE(s.isElementOnLevel(10, 3));
+}
+
+TEST(SkipListSet_Test, copiesHaveTheSameShapeAndSeparateContents)
+{
+    SkipListSet<int> s1{std::make_unique<ScriptedLevelTester>(
+        std::vector<bool>{true, true, false, false, true, false})};
+
+    s1.add(10);
+    s1.add(20);
+    s1.add(30);
+
+    SkipListSet<int> s2 = s1;
+
+    EXPECT_EQ(3, s2.levelCount());
+    EXPECT_TRUE(s2.isElementOnLevel(10, 2));
+    EXPECT_TRUE(s2.isElementOnLevel(30, 1));
+    EXPECT_FALSE(s2.isElementOnLevel(20, 1));
+
+    s2.add(40);
+    EXPECT_TRUE(s2.contains(40));
+    EXPECT_FALSE(s1.contains(40));
+    EXPECT_EQ(3, s1.size());
+}
+
+TEST(SkipListSet_Test, canBeMoved)
+{
+    SkipListSet<int> s1;
+    s1.add(1);
+    s1.add(2);
+
+    SkipListSet<int> s2 = std::move(s1);
+    EXPECT_EQ(0, s1.size());
+    EXPECT_FALSE(s1.contains(1));
+    EXPECT_TRUE(s2.contains(2));
+
+    s1.add(3);
+    EXPECT_TRUE(s1.contains(3));
+
+    SkipListSet<int> s3;
+    s3 = std::move(s2);
+    EXPECT_EQ(2, s3.size());
+
+    s3 = s1;
+    EXPECT_EQ(1, s3.size());
+    EXPECT_TRUE(s3.contains(3));
+}
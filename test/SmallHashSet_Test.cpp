@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include "SmallHashSet.hpp"
+
+namespace
+{
+    unsigned int lengthHash(const std::string& element)
+    {
+        return static_cast<unsigned int>(element.size());
+    }
+}
+
+
+TEST(SmallHashSet_Test, emptySetsHaveSizeZero)
+{
+    SmallHashSet<int> s;
+    EXPECT_EQ(0, s.size());
+    EXPECT_TRUE(s.isInline());
+    EXPECT_FALSE(s.contains(0));
+}
+
+TEST(SmallHashSet_Test, smallSetsStayInline)
+{
+    SmallHashSet<int, 8> s;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        s.add(i * 10);
+        s.add(i * 10);
+    }
+
+    EXPECT_EQ(8, s.size());
+    EXPECT_TRUE(s.isInline());
+
+    for (int i = 0; i < 80; ++i)
+    {
+        EXPECT_EQ(i % 10 == 0, s.contains(i));
+    }
+}
+
+TEST(SmallHashSet_Test, outgrowingTheInlineArrayKeepsEveryElement)
+{
+    SmallHashSet<int, 4> s;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+
+        if (i == 3)
+        {
+            EXPECT_TRUE(s.isInline());
+        }
+        else if (i == 4)
+        {
+            EXPECT_FALSE(s.isInline());
+        }
+    }
+
+    EXPECT_EQ(1000, s.size());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(1000));
+}
+
+TEST(SmallHashSet_Test, removedElementsAreGone)
+{
+    SmallHashSet<std::int64_t, 6> s;
+
+    for (std::int64_t i = 0; i < 6; ++i)
+    {
+        s.add(i << 32);
+    }
+
+    EXPECT_TRUE(s.remove(0));
+    EXPECT_TRUE(s.remove(std::int64_t{3} << 32));
+    EXPECT_FALSE(s.remove(std::int64_t{3} << 32));
+    EXPECT_FALSE(s.remove(1));
+
+    EXPECT_EQ(4, s.size());
+    EXPECT_FALSE(s.contains(0));
+    EXPECT_FALSE(s.contains(std::int64_t{3} << 32));
+    EXPECT_TRUE(s.contains(std::int64_t{5} << 32));
+
+    // Only the high halves of these match the elements, which an 8-byte
+    // comparison built from 4-byte ones must not be fooled by.
+    EXPECT_FALSE(s.contains((std::int64_t{5} << 32) | 1));
+}
+
+TEST(SmallHashSet_Test, staleSlotsAreNotFound)
+{
+    SmallHashSet<unsigned int, 5> s;
+
+    s.add(7);
+    s.add(8);
+    s.remove(8);
+
+    EXPECT_FALSE(s.contains(8));
+    EXPECT_FALSE(s.contains(0));
+    EXPECT_TRUE(s.contains(7));
+}
+
+TEST(SmallHashSet_Test, clearingReturnsToInline)
+{
+    SmallHashSet<std::string, 2, FunctionHash<std::string>> s{lengthHash};
+    s.add("a");
+    s.add("bb");
+    s.add("ccc");
+    ASSERT_FALSE(s.isInline());
+
+    s.clear();
+    EXPECT_TRUE(s.isInline());
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains("a"));
+
+    s.add("again");
+    EXPECT_TRUE(s.contains("again"));
+}
+
+TEST(SmallHashSet_Test, copiesAreIndependent)
+{
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> small{lengthHash};
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> large{lengthHash};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        small.add(std::to_string(i));
+    }
+
+    for (int i = 0; i < 100; ++i)
+    {
+        large.add(std::to_string(i));
+    }
+
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> smallCopy{small};
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> largeCopy{large};
+    smallCopy.add("new");
+    largeCopy.remove("50");
+
+    EXPECT_EQ(4, smallCopy.size());
+    EXPECT_FALSE(small.contains("new"));
+    EXPECT_EQ(99, largeCopy.size());
+    EXPECT_TRUE(large.contains("50"));
+
+    small = large;
+    EXPECT_FALSE(small.isInline());
+    EXPECT_EQ(100, small.size());
+}
+
+TEST(SmallHashSet_Test, canBeMovedAndAssigned)
+{
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> small{lengthHash};
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> large{lengthHash};
+    small.add("x");
+
+    for (int i = 0; i < 100; ++i)
+    {
+        large.add(std::to_string(i));
+    }
+
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> movedSmall{std::move(small)};
+    SmallHashSet<std::string, 4, FunctionHash<std::string>> movedLarge{std::move(large)};
+
+    EXPECT_TRUE(movedSmall.contains("x"));
+    EXPECT_EQ(100, movedLarge.size());
+    EXPECT_EQ(0, small.size());
+    EXPECT_EQ(0, large.size());
+    EXPECT_TRUE(large.isInline());
+
+    large.add("again");
+    EXPECT_TRUE(large.contains("again"));
+
+    movedSmall = std::move(movedLarge);
+    EXPECT_EQ(100, movedSmall.size());
+    EXPECT_FALSE(movedSmall.contains("x"));
+}